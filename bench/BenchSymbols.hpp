@@ -0,0 +1,24 @@
+#ifndef BENCH_SYMBOLS_HPP
+#define BENCH_SYMBOLS_HPP
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include "OrderStore.hpp"
+
+// Underlying symbols the benchmarks trade: "SYM0000", "SYM0001" and so on,
+// one per index. Indexes are bounded so every symbol fits
+// InstrumentKey::underlying, as distinct symbols, with its terminator.
+constexpr size_t MAX_BENCH_SYMBOLS = 1000000000000;   // "SYM" and up to 12 digits
+
+inline std::string symbolFor(size_t index) {
+    static_assert(sizeof(InstrumentKey::underlying) >= 3 + 12 + 1, "Benchmark symbols must fit an InstrumentKey");
+    if (index >= MAX_BENCH_SYMBOLS) {
+        throw std::out_of_range("Benchmark symbol index " + std::to_string(index) + " is out of range");
+    }
+    char symbol[sizeof(InstrumentKey::underlying)];
+    std::snprintf(symbol, sizeof(symbol), "SYM%04zu", index);
+    return symbol;
+}
+
+#endif
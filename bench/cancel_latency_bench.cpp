@@ -0,0 +1,105 @@
+// Measures cancel-to-ack latency through the execution engine, both for
+// orders still queued (dropped via tombstones) and for resting orders.
+#include "OrderManagementSystem.hpp"
+#include "ExecutionEngine.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    OptionOrder makeRestingOrder() {
+        OptionOrder order{};
+        order.underlying = "SPY";
+        order.optionType = "CALL";
+        order.strike = 450.0;
+        order.quantity = 1;
+        order.type = OptionOrder::Type::BUY_TO_OPEN;
+        order.orderType = OptionOrder::OrderType::LIMIT;
+        order.limitPrice = 1.0;
+        order.timeInForce = OptionOrder::TimeInForce::GTC;
+        return order;
+    }
+
+    double percentile(std::vector<double>& samples, double p) {
+        if (samples.empty()) return 0.0;
+        size_t index = static_cast<size_t>(p * (samples.size() - 1));
+        std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+        return samples[index];
+    }
+
+    void report(const std::string& name, std::vector<double>& micros) {
+        std::cout << name << ": p50 " << percentile(micros, 0.50)
+                  << "us, p99 " << percentile(micros, 0.99)
+                  << "us, max " << percentile(micros, 1.0) << "us\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t orderCount = argc > 1 ? std::stoul(argv[1]) : 20000;
+
+    OrderManagementSystem oms;
+    ExecutionEngine engine;
+    engine.setOrderManagementSystem(&oms);
+    engine.setSimulatedFillRate(0.0);  // Limit orders rest until cancelled
+    oms.setExecutionEngine(&engine);
+
+    auto* coutBuffer = std::cout.rdbuf(nullptr);  // Silence per-order logging
+    oms.start();
+    engine.start();
+
+    std::vector<double> submitMicros, queuedCancelMicros, restingCancelMicros;
+    submitMicros.reserve(orderCount);
+    queuedCancelMicros.reserve(orderCount);
+    restingCancelMicros.reserve(orderCount);
+
+    auto elapsedMicros = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Phase 1: cancel immediately, while the order copy is still queued
+    for (size_t i = 0; i < orderCount; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        auto orderId = oms.submitOptionOrder(makeRestingOrder());
+        submitMicros.push_back(elapsedMicros(start));
+
+        start = std::chrono::steady_clock::now();
+        oms.cancelOrder(orderId);
+        queuedCancelMicros.push_back(elapsedMicros(start));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto queuedStats = engine.getCancelStats();
+
+    // Phase 2: let orders rest in the engine first, then cancel them
+    std::vector<std::string> restingIds;
+    restingIds.reserve(orderCount);
+    for (size_t i = 0; i < orderCount; ++i) {
+        restingIds.push_back(oms.submitOptionOrder(makeRestingOrder()));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    for (const auto& orderId : restingIds) {
+        auto start = std::chrono::steady_clock::now();
+        oms.cancelOrder(orderId);
+        restingCancelMicros.push_back(elapsedMicros(start));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto totalStats = engine.getCancelStats();
+
+    engine.stop();
+    oms.stop();
+    std::cout.rdbuf(coutBuffer);
+
+    std::cout << "Orders per phase: " << orderCount << "\n";
+    report("Submit call", submitMicros);
+    report("Cancel call (queued copy)", queuedCancelMicros);
+    report("Cancel call (resting)", restingCancelMicros);
+    std::cout << "Engine cancel-to-ack after phase 1: avg " << queuedStats.avgAckMicros
+              << "us, max " << queuedStats.maxAckMicros << "us\n"
+              << "Engine cancel-to-ack overall: avg " << totalStats.avgAckMicros
+              << "us, max " << totalStats.maxAckMicros << "us\n"
+              << "Cancels acked: " << totalStats.cancelsAcked
+              << ", stale copies dropped: " << totalStats.staleCopiesDropped << std::endl;
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Drives the delta hedger with a random walk of spot ticks over an option
+// book and measures the tick path: the risk manager's re-price of the
+// underlying, then the hedger's decision. Hedges go through the OMS and the
+// simulated execution engine, and their fills feed back into the hedger.
+// The engine logs every fill; redirect stdout to keep only the summary,
+// which is written to stderr.
+#include "BenchSymbols.hpp"
+#include "DateUtils.hpp"
+#include "DeltaHedger.hpp"
+#include "ExecutionEngine.hpp"
+#include "OrderManagementSystem.hpp"
+#include "RiskManagement.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    void reportLatencies(const std::string& name, std::vector<double>& nanos) {
+        std::sort(nanos.begin(), nanos.end());
+        auto at = [&](double q) { return nanos[static_cast<size_t>(q * (nanos.size() - 1))]; };
+        std::cerr << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(0)
+                  << " p50 " << std::setw(8) << at(0.50) << " ns"
+                  << "  p99 " << std::setw(8) << at(0.99) << " ns"
+                  << "  max " << std::setw(10) << nanos.back() << " ns\n";
+    }
+
+    // A quarter out, where gamma makes delta drift as spots walk
+    std::string expiryInDays(int64_t days) {
+        int64_t today = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count() / NANOS_PER_DAY;
+        int year, month, day;
+        civilFromDays(today + days, year, month, day);
+        char expiry[32];
+        std::snprintf(expiry, sizeof(expiry), "%04d-%02d-%02d", year, month, day);
+        return expiry;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t underlyings = argc > 1 ? std::stoul(argv[1]) : 10;
+    const size_t contractsPerUnderlying = argc > 2 ? std::stoul(argv[2]) : 50;
+    const size_t ticks = argc > 3 ? std::stoul(argv[3]) : 20000;
+    const double band = argc > 4 ? std::stod(argv[4]) : 50.0;
+
+    OrderManagementSystem oms;
+    ExecutionEngine engine;
+    RiskManagement risk;
+    risk.setRiskLimits(RiskLimits{1e12, 1e12, 1e12, 1e12, 1e15, 1e12, 0.0});
+    engine.setOrderManagementSystem(&oms);
+    engine.setSimulatedFillRate(1.0);
+    oms.setExecutionEngine(&engine);
+    oms.setRiskManager(&risk);
+
+    DeltaHedgerConfig config;
+    config.band.trigger = band;
+    config.band.target = band / 4.0;
+    config.minInterval = std::chrono::milliseconds(5);
+    config.maxOrdersPerSecond = 1000;
+    DeltaHedger hedger(oms, risk, config);
+
+    // Option positions straight into the risk manager: the OMS only holds the hedges
+    const std::string expiry = expiryInDays(90);
+    std::mt19937_64 rng(42);
+    std::vector<double> spots(underlyings);
+    for (size_t u = 0; u < underlyings; ++u) {
+        std::string symbol = symbolFor(u);
+        spots[u] = 50.0 + 10.0 * static_cast<double>(u % 40);
+        risk.onUnderlyingPrice(symbol, spots[u]);
+        for (size_t c = 0; c < contractsPerUnderlying; ++c) {
+            double strike = spots[u] * (0.8 + 0.4 * static_cast<double>(c) / contractsPerUnderlying);
+            InstrumentKey key = makeInstrumentKey(symbol, c % 2 ? "PUT" : "CALL", strike, expiry);
+            risk.onFill(key, static_cast<double>(static_cast<int>(rng() % 41) - 20));
+        }
+    }
+
+    oms.start();
+    engine.start();
+    hedger.start();
+
+    std::vector<double> repriceNanos, decisionNanos;
+    repriceNanos.reserve(ticks);
+    decisionNanos.reserve(ticks);
+    std::normal_distribution<double> move(0.0, 0.002);
+    for (size_t i = 0; i < ticks; ++i) {
+        size_t u = rng() % underlyings;
+        std::string symbol = symbolFor(u);
+        spots[u] *= 1.0 + move(rng);
+
+        auto before = Clock::now();
+        risk.onUnderlyingPrice(symbol, spots[u]);
+        auto repriced = Clock::now();
+        hedger.onUnderlyingPrice(symbol, spots[u]);
+        auto decided = Clock::now();
+        repriceNanos.push_back(std::chrono::duration<double, std::nano>(repriced - before).count());
+        decisionNanos.push_back(std::chrono::duration<double, std::nano>(decided - repriced).count());
+
+        // Leave the engine room to fill, as a real feed would between ticks
+        if (i % 64 == 63) std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    hedger.stop();
+    engine.stop();
+    oms.stop();
+
+    DeltaHedger::Stats stats = hedger.getStats();
+    std::cerr << underlyings << " underlyings x " << contractsPerUnderlying << " contracts, " << ticks
+              << " ticks, band " << band << " -> " << config.band.target << "\n";
+    reportLatencies("risk re-price (per tick)", repriceNanos);
+    reportLatencies("hedge decision (per tick)", decisionNanos);
+    std::cerr << "Hedger: " << stats.evaluations << " evaluations, mean " << std::setprecision(0)
+              << stats.meanDecisionNanos << " ns, max " << stats.maxDecisionNanos << " ns; "
+              << stats.hedgesDecided << " decided, " << stats.hedgesSubmitted << " submitted, "
+              << stats.hedgesFilled << " filled, " << stats.hedgesFailed << " failed, "
+              << stats.throttled << " throttled\n";
+
+    double worst = 0.0;
+    for (size_t u = 0; u < underlyings; ++u) {
+        worst = std::max(worst, std::abs(risk.getUnderlyingRisk(symbolFor(u)).delta));
+    }
+    std::cerr << "Largest residual net delta: " << std::setprecision(1) << worst << "\n";
+    return 0;
+}
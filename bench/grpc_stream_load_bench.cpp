@@ -0,0 +1,264 @@
+// Measures unary order RPC latency through the in-process gRPC server,
+// first idle and then with many streaming clients attached: half on
+// StreamRisk, fed by a publisher on a short cadence, half on
+// StreamMarketData, which stay open without quotes as they would between
+// polls of the feed. Usage:
+//   grpc_stream_load_bench [async|sync] [streams] [calls] [cq-threads]
+// The engine logs to stdout; redirect it to keep only the summary, which is
+// written to stderr.
+#include <grpcpp/grpcpp.h>
+#include <boost/asio.hpp>
+#include "ExecutionEngine.hpp"
+#include "MarketDataHandler.hpp"
+#include "OrderEventJournal.hpp"
+#include "OrderManagementSystem.hpp"
+#include "RiskManagement.hpp"
+#include "RiskPublisher.hpp"
+#include "services/execution_service.hpp"
+#include "services/market_data_service.hpp"
+#include "services/market_data_service_v2.hpp"
+#include "services/metrics_service.hpp"
+#include "services/order_management_service.hpp"
+#include "services/order_management_service_v2.hpp"
+#include "services/quote_fanout.hpp"
+#include "services/risk_service.hpp"
+#include "services/rpc_server.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Counts down as streams finish
+    class Latch {
+    public:
+        explicit Latch(size_t count) : count_(count) {}
+
+        void countDown() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--count_ == 0) cv_.notify_all();
+        }
+
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return count_ == 0; });
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        size_t count_;
+    };
+
+    // A client stream that reads until cancelled, on gRPC's callback threads
+    template <class Message>
+    class StreamReader final : public grpc::ClientReadReactor<Message> {
+    public:
+        StreamReader(std::atomic<uint64_t>& received, Latch& done)
+            : received_(received), done_(done) {}
+
+        grpc::ClientContext context;
+
+        void begin() {
+            this->StartRead(&message_);
+            this->StartCall();
+        }
+
+        void OnReadDone(bool ok) override {
+            if (!ok) return;
+            received_.fetch_add(1, std::memory_order_relaxed);
+            this->StartRead(&message_);
+        }
+
+        void OnDone(const grpc::Status&) override {
+            done_.countDown();
+        }
+
+    private:
+        Message message_;
+        std::atomic<uint64_t>& received_;
+        Latch& done_;
+    };
+
+    std::shared_ptr<grpc::Channel> channelTo(int port, int index) {
+        // A distinct argument keeps each channel on its own connection
+        grpc::ChannelArguments args;
+        args.SetInt("bench.channel", index);
+        return grpc::CreateCustomChannel("127.0.0.1:" + std::to_string(port),
+                                         grpc::InsecureChannelCredentials(), args);
+    }
+
+    void reportLatencies(const std::string& name, std::vector<double>& micros) {
+        std::sort(micros.begin(), micros.end());
+        auto at = [&](double q) { return micros[static_cast<size_t>(q * (micros.size() - 1))]; };
+        std::cerr << std::left << std::setw(34) << name << std::right << std::fixed << std::setprecision(1)
+                  << " p50 " << std::setw(8) << at(0.50) << " us"
+                  << "  p99 " << std::setw(8) << at(0.99) << " us"
+                  << "  max " << std::setw(9) << micros.back() << " us\n";
+    }
+
+    // Alternates PlaceOrder and GetOrderStatus on the order just placed
+    void measureOrders(trading::OrderManagementService::Stub& stub, size_t calls,
+                       std::vector<double>& placeMicros, std::vector<double>& statusMicros) {
+        placeMicros.clear();
+        statusMicros.clear();
+        for (size_t i = 0; i < calls; ++i) {
+            trading::OrderRequest request;
+            request.set_symbol("SPY");
+            request.set_option_type(i % 2 ? "PUT" : "CALL");
+            request.set_strike(400.0 + static_cast<double>(i % 20));
+            request.set_expiration_date("2099-12-17");
+            request.set_side(i % 3 ? "BUY" : "SELL");
+            request.set_order_type("LIMIT");
+            request.set_price(1.0);
+            request.set_quantity(1);
+
+            trading::OrderResponse placed;
+            grpc::ClientContext placeContext;
+            auto started = Clock::now();
+            grpc::Status status = stub.PlaceOrder(&placeContext, request, &placed);
+            placeMicros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - started).count());
+            if (!status.ok()) {
+                std::cerr << "PlaceOrder failed: " << status.error_message() << "\n";
+                continue;
+            }
+
+            trading::OrderStatusRequest query;
+            query.set_order_id(placed.order_id());
+            trading::OrderStatusResponse order;
+            grpc::ClientContext statusContext;
+            started = Clock::now();
+            stub.GetOrderStatus(&statusContext, query, &order);
+            statusMicros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - started).count());
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    RpcServerConfig config;
+    config.mode = argc > 1 && std::string(argv[1]) == "sync" ? RpcServerConfig::Mode::SYNC
+                                                              : RpcServerConfig::Mode::ASYNC;
+    const size_t streams = argc > 2 ? std::stoul(argv[2]) : 1000;
+    const size_t calls = argc > 3 ? std::stoul(argv[3]) : 2000;
+    config.completionQueueThreads = argc > 4 ? std::stoul(argv[4]) : 0;
+    const size_t streamChannels = 8;
+
+    boost::asio::io_context io;
+    MarketDataHandler marketData(io, "");   // Never started: streams stay quiet
+    OrderManagementSystem oms;
+    ExecutionEngine engine;
+    RiskManagement risk;
+    risk.setRiskLimits(RiskLimits{1e12, 1e12, 1e12, 1e12, 1e15, 1e12, 0.0});
+    engine.setOrderManagementSystem(&oms);
+    engine.setSimulatedFillRate(0.0);   // Orders stay working, so GetOrderStatus finds them live
+    oms.setExecutionEngine(&engine);
+    oms.setRiskManager(&risk);
+    risk.onUnderlyingPrice("SPY", 410.0);
+
+    RiskPublisherConfig publisherConfig;
+    publisherConfig.cadence = std::chrono::milliseconds(20);
+    publisherConfig.coalesceWindow = std::chrono::milliseconds(5);
+    RiskPublisher publisher(risk, publisherConfig);
+
+    OrderEventJournal journal(oms);
+    QuoteFanout fanout(marketData);
+    MarketDataServiceImpl marketDataService(fanout);
+    OrderManagementServiceImpl orderService(oms);
+    ExecutionServiceImpl executionService(oms, journal);
+    RiskServiceImpl riskService(publisher);
+    MarketDataServiceV2Impl marketDataV2Service(fanout);
+    OrderManagementServiceV2Impl orderV2Service(oms, marketData.instruments());
+    MetricsServiceImpl metricsService;
+
+    RpcServer server({marketDataService, orderService, executionService, riskService,
+                      marketDataV2Service, orderV2Service, metricsService}, config);
+    server.start("127.0.0.1:0");
+    journal.start();
+    oms.start();
+    engine.start();
+    publisher.start();
+
+    auto orderChannel = channelTo(server.port(), -1);
+    auto orders = trading::OrderManagementService::NewStub(orderChannel);
+
+    // Idle: no streams attached
+    std::vector<double> placeMicros, statusMicros;
+    measureOrders(*orders, calls / 10 + 1, placeMicros, statusMicros);   // Warm-up
+    measureOrders(*orders, calls, placeMicros, statusMicros);
+    std::cerr << (config.mode == RpcServerConfig::Mode::SYNC ? "sync" : "async") << " server, "
+              << calls << " order round trips\n";
+    reportLatencies("PlaceOrder, idle", placeMicros);
+    reportLatencies("GetOrderStatus, idle", statusMicros);
+
+    std::vector<std::shared_ptr<grpc::Channel>> channels;
+    std::vector<std::unique_ptr<trading::RiskService::Stub>> riskStubs;
+    std::vector<std::unique_ptr<trading::MarketDataService::Stub>> marketDataStubs;
+    for (size_t c = 0; c < streamChannels; ++c) {
+        channels.push_back(channelTo(server.port(), static_cast<int>(c)));
+        riskStubs.push_back(trading::RiskService::NewStub(channels.back()));
+        marketDataStubs.push_back(trading::MarketDataService::NewStub(channels.back()));
+    }
+
+    std::atomic<uint64_t> riskUpdates{0}, quotes{0};
+    Latch done(streams);
+    std::vector<std::unique_ptr<StreamReader<trading::RiskUpdate>>> riskReaders;
+    std::vector<std::unique_ptr<StreamReader<trading::MarketDataResponse>>> quoteReaders;
+    trading::RiskRequest riskRequest;
+    riskRequest.set_portfolio_only(true);
+    trading::MarketDataRequest quoteRequest;
+    quoteRequest.set_symbol("SPY");
+
+    auto attachStarted = Clock::now();
+    for (size_t i = 0; i < streams; ++i) {
+        size_t c = i % streamChannels;
+        if (i % 2 == 0) {
+            riskReaders.emplace_back(new StreamReader<trading::RiskUpdate>(riskUpdates, done));
+            auto& reader = *riskReaders.back();
+            riskStubs[c]->async()->StreamRisk(&reader.context, &riskRequest, &reader);
+            reader.begin();
+        } else {
+            quoteReaders.emplace_back(new StreamReader<trading::MarketDataResponse>(quotes, done));
+            auto& reader = *quoteReaders.back();
+            marketDataStubs[c]->async()->StreamMarketData(&reader.context, &quoteRequest, &reader);
+            reader.begin();
+        }
+    }
+    // Let every stream connect and take a few snapshots before measuring
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    double attachMillis = std::chrono::duration<double, std::milli>(Clock::now() - attachStarted).count();
+
+    uint64_t updatesBefore = riskUpdates.load();
+    auto measureStarted = Clock::now();
+    measureOrders(*orders, calls, placeMicros, statusMicros);
+    double measureSeconds = std::chrono::duration<double>(Clock::now() - measureStarted).count();
+    uint64_t updatesDuring = riskUpdates.load() - updatesBefore;
+
+    std::string loaded = ", " + std::to_string(streams) + " streams";
+    reportLatencies("PlaceOrder" + loaded, placeMicros);
+    reportLatencies("GetOrderStatus" + loaded, statusMicros);
+    std::cerr << std::setprecision(0) << riskReaders.size() << " risk streams took "
+              << updatesDuring / measureSeconds << " updates/s while measuring ("
+              << publisher.recomputeCount() << " snapshots in all); "
+              << quoteReaders.size() << " market data streams open; "
+              << attachMillis << " ms to attach and settle\n";
+
+    for (auto& reader : riskReaders) reader->context.TryCancel();
+    for (auto& reader : quoteReaders) reader->context.TryCancel();
+    done.wait();
+
+    publisher.stop();
+    server.shutdown();
+    engine.stop();
+    oms.stop();
+    journal.stop();
+    return 0;
+}
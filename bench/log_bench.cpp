@@ -0,0 +1,122 @@
+// Call-site cost of the binary log against the std::ostream logging it
+// replaces (an order fill line ending in std::endl), from one and from
+// several threads at once. Each call is timed on its own, less the cost
+// of reading the clock; the threads log in bursts with a pause between
+// them, as the order path does, so the log thread keeps up and nothing
+// is dropped. Afterwards the log file must hold exactly one line per
+// record logged; the run fails if it does not.
+// Usage: log_bench [records per thread] [threads] [log file]
+#include "BinaryLog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr size_t BURST = 1024;
+    constexpr std::chrono::milliseconds PAUSE{15};
+
+    double clockOverheadNanos() {
+        const int samples = 1000000;
+        auto started = Clock::now();
+        for (int i = 0; i < samples; ++i) {
+            auto a = Clock::now();
+            auto b = Clock::now();
+            if (b < a) std::cerr << "";
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - started).count() / samples / 2.0;
+    }
+
+    // Runs log(i) records times on each thread, timing every call
+    template <class Log>
+    std::vector<double> run(size_t threads, size_t records, double overhead, Log log) {
+        std::vector<std::vector<double>> perThread(threads);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::vector<double>& nanos = perThread[t];
+                nanos.reserve(records);
+                for (size_t i = 0; i < records; ++i) {
+                    auto started = Clock::now();
+                    log(i);
+                    nanos.push_back(std::chrono::duration<double, std::nano>(Clock::now() - started).count() -
+                                    overhead);
+                    if ((i + 1) % BURST == 0) std::this_thread::sleep_for(PAUSE);
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+
+        std::vector<double> all;
+        for (const auto& nanos : perThread) all.insert(all.end(), nanos.begin(), nanos.end());
+        std::sort(all.begin(), all.end());
+        return all;
+    }
+
+    void report(const std::string& name, const std::vector<double>& nanos) {
+        double sum = 0.0;
+        for (double n : nanos) sum += n;
+        auto at = [&](double q) { return nanos[std::min(nanos.size() - 1, static_cast<size_t>(q * nanos.size()))]; };
+        std::cout << std::left << std::setw(30) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(9) << sum / nanos.size() << " ns mean" << std::setw(9) << at(0.5) << " p50"
+                  << std::setw(9) << at(0.99) << " p99" << std::setw(11) << nanos.back() << " max\n";
+    }
+
+    size_t countLines(const std::string& path) {
+        std::ifstream in(path);
+        return static_cast<size_t>(std::count(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>(), '\n'));
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t records = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+    const std::string path = argc > 3 ? argv[3] : "log_bench.log";
+    const double overhead = clockOverheadNanos();
+    const char orderId[] = "ORD-00000000000F4240";
+
+    std::cout << records << " records per thread, clock overhead " << std::fixed << std::setprecision(1)
+              << overhead << " ns subtracted\n";
+    bool ok = true;
+    for (size_t n : {size_t(1), threads}) {
+        std::ofstream(path, std::ios::trunc);
+        const BinaryLog::Stats before = BinaryLog::stats();
+        LogOptions options;
+        options.path = path;
+        BinaryLog::start(options);
+        auto binary = run(n, records, overhead, [&](size_t i) {
+            LOG_INFO("Order filled -> ID: {}, Fill Price: {}, Quantity: {}", orderId, 1.25 + i * 0.01, i);
+        });
+        BinaryLog::stop();
+        const BinaryLog::Stats after = BinaryLog::stats();
+        const uint64_t dropped = after.recordsDropped - before.recordsDropped;
+        size_t lines = countLines(path);
+
+        std::ofstream stream(path, std::ios::trunc);
+        std::mutex streamMutex;   // std::cout's own lock, made explicit for the file
+        auto ostream = run(n, records, overhead, [&](size_t i) {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            stream << "Order filled -> ID: " << orderId << ", Fill Price: " << 1.25 + i * 0.01
+                   << ", Quantity: " << i << std::endl;
+        });
+
+        std::string threadsText = std::to_string(n) + (n == 1 ? " thread" : " threads");
+        report("binary log, " + threadsText, binary);
+        report("ostream + endl, " + threadsText, ostream);
+        std::cout << "  " << lines << " lines written in " << after.batchesWritten - before.batchesWritten
+                  << " batches, " << dropped << " dropped\n";
+        if (lines + dropped != n * records) {
+            std::cerr << "Expected " << n * records << " records, found " << lines << " lines and "
+                      << dropped << " drops\n";
+            ok = false;
+        }
+    }
+    return ok ? 0 : 1;
+}
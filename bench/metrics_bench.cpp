@@ -0,0 +1,106 @@
+// Cost of stamping a stage: TscClock::now() plus Metrics::record() on the
+// calling thread's own histogram, from one and from several threads at
+// once, against the steady_clock read it replaces. Then the cost of a
+// snapshot across every thread's block, and a check that the snapshot
+// counted every value recorded and placed the known percentiles within
+// the histogram's precision; the run fails otherwise.
+// Usage: metrics_bench [records per thread] [threads] [prometheus file]
+#include "Metrics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double nanosSince(Clock::time_point started, size_t operations) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - started).count() / operations;
+    }
+
+    // Every thread records the same ramp: values 1..records ticks, so the
+    // merged percentiles are known
+    double recordRamp(size_t threads, size_t records, LatencyStage stage) {
+        std::vector<double> perCall(threads);
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                auto started = Clock::now();
+                for (size_t i = 1; i <= records; ++i) {
+                    uint64_t start = TscClock::now() - i;
+                    Metrics::recordSince(stage, start);
+                }
+                perCall[t] = nanosSince(started, records);
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        double sum = 0.0;
+        for (double n : perCall) sum += n;
+        return sum / threads;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t records = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t threads = argc > 2 ? std::stoul(argv[2]) : 4;
+    const std::string path = argc > 3 ? argv[3] : "metrics_bench.prom";
+    const double nanosPerTick = TscClock::nanosPerTick();
+
+    std::cout << records << " records per thread, " << std::fixed << std::setprecision(3)
+              << 1.0 / nanosPerTick << " TSC ticks per ns\n" << std::setprecision(1);
+
+    auto started = Clock::now();
+    uint64_t sink = 0;
+    for (size_t i = 0; i < records; ++i) sink += Clock::now().time_since_epoch().count();
+    std::cout << "steady_clock::now()                " << std::setw(7) << nanosSince(started, records) << " ns\n";
+    started = Clock::now();
+    for (size_t i = 0; i < records; ++i) sink += TscClock::now();
+    std::cout << "TscClock::now()                    " << std::setw(7) << nanosSince(started, records) << " ns\n";
+
+    // The ramps go to stages nothing else records in this process
+    std::cout << "now() + record(), 1 thread         " << std::setw(7)
+              << recordRamp(1, records, LatencyStage::PARSE) << " ns\n";
+    std::cout << "now() + record(), " << threads << " threads" << std::string(threads < 10 ? 9 : 8, ' ')
+              << std::setw(7) << recordRamp(threads, records, LatencyStage::FILL) << " ns\n";
+
+    started = Clock::now();
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    std::cout << "snapshot                           " << std::setw(7)
+              << std::chrono::duration<double, std::micro>(Clock::now() - started).count() << " us\n";
+
+    if (sink == 0) std::cerr << "";
+    std::ofstream(path) << Metrics::prometheusText();
+
+    bool ok = true;
+    auto check = [&](LatencyStage stage, size_t expected) {
+        const LatencySummary& summary = snapshot.stages[static_cast<size_t>(stage)];
+        std::cout << std::left << std::setw(16) << Metrics::stageName(stage) << std::right
+                  << " count " << summary.count << ", p50 " << summary.p50Nanos << " ns, p99 "
+                  << summary.p99Nanos << " ns, max " << summary.maxNanos << " ns\n";
+        if (summary.count != expected) {
+            std::cerr << "Expected " << expected << " values, counted " << summary.count << "\n";
+            ok = false;
+        }
+        // The ramp's true percentiles, allowing one sub-bucket of error
+        // plus the ticks between taking start and recording
+        const double tolerance = 2.0 / (1 << Metrics::SUB_BUCKET_BITS);
+        const std::pair<double, double> expectedQuantiles[] = {
+            {summary.p50Nanos, 0.50 * records * nanosPerTick}, {summary.p99Nanos, 0.99 * records * nanosPerTick}
+        };
+        for (const auto& q : expectedQuantiles) {
+            if (std::abs(q.first - q.second) > tolerance * q.second + 1000.0) {
+                std::cerr << "Percentile " << q.first << " ns, expected about " << q.second << " ns\n";
+                ok = false;
+            }
+        }
+    };
+    check(LatencyStage::PARSE, records);
+    check(LatencyStage::FILL, records * threads);
+    std::cout << "Prometheus text written to " << path << "\n";
+    return ok ? 0 : 1;
+}
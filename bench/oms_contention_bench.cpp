@@ -0,0 +1,109 @@
+// Measures OMS throughput under concurrent submit, fill and position reads,
+// comparing a single shard (one global lock) with the sharded layout.
+#include "OrderManagementSystem.hpp"
+#include "OrderStore.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    const char* const UNDERLYINGS[] = {
+        "SPY", "QQQ", "IWM", "AAPL", "MSFT", "NVDA", "AMZN", "META",
+        "TSLA", "GOOGL", "AMD", "NFLX", "JPM", "XOM", "DIA", "GLD"
+    };
+    constexpr size_t UNDERLYING_COUNT = sizeof(UNDERLYINGS) / sizeof(UNDERLYINGS[0]);
+
+    struct Result {
+        double ordersPerSecond;
+        double readsPerSecond;
+    };
+
+    OrderRecord makeRecord(const char* underlying) {
+        OptionOrder order{};
+        order.underlying = underlying;
+        order.optionType = "CALL";
+        order.strike = 100.0;
+        order.expiry = "2099-12-17";
+        order.quantity = 1;
+        order.type = OptionOrder::Type::BUY_TO_OPEN;
+        order.orderType = OptionOrder::OrderType::LIMIT;
+        order.limitPrice = 1.25;
+        order.timeInForce = OptionOrder::TimeInForce::GTC;
+        return makeOrderRecord(order);
+    }
+
+    // Each writer submits and immediately fills orders on its own set of
+    // underlyings; readers poll per-underlying positions until writers finish.
+    Result run(size_t shardCount, size_t writers, size_t readers, size_t ordersPerWriter) {
+        OrderManagementSystem oms(writers * ordersPerWriter, shardCount);
+        oms.start();
+
+        std::atomic<bool> writing{true};
+        std::atomic<uint64_t> reads{0};
+        std::vector<std::thread> threads;
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                OrderRecord record = makeRecord(UNDERLYINGS[w % UNDERLYING_COUNT]);
+                for (size_t i = 0; i < ordersPerWriter; ++i) {
+                    OrderHandle handle = oms.submitOrder(record);
+                    oms.onOrderFilled(handle, 0, 1.25);
+                }
+            });
+        }
+        for (size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&, r] {
+                std::string underlying = UNDERLYINGS[(r * 7) % UNDERLYING_COUNT];
+                uint64_t count = 0;
+                while (writing.load(std::memory_order_relaxed)) {
+                    oms.getPositionsForUnderlying(underlying);
+                    ++count;
+                }
+                reads += count;
+            });
+        }
+
+        for (size_t w = 0; w < writers; ++w) {
+            threads[w].join();
+        }
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        writing = false;
+        for (size_t t = writers; t < threads.size(); ++t) {
+            threads[t].join();
+        }
+
+        oms.stop();
+        return Result{writers * ordersPerWriter / elapsed, reads / elapsed};
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t ordersPerWriter = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t hardware = std::max(2u, std::thread::hardware_concurrency());
+    const size_t writers = std::max<size_t>(1, hardware / 2);
+    const size_t readers = std::max<size_t>(1, hardware / 4);
+
+    std::cout << "Writers: " << writers << ", readers: " << readers
+              << ", orders per writer: " << ordersPerWriter << "\n";
+
+    for (size_t shardCount : {size_t{1}, OrderManagementSystem::DEFAULT_SHARD_COUNT}) {
+        // Silence per-order logging while measuring
+        auto* coutBuffer = std::cout.rdbuf(nullptr);
+        auto* cerrBuffer = std::cerr.rdbuf(nullptr);
+        Result result = run(shardCount, writers, readers, ordersPerWriter);
+        std::cout.rdbuf(coutBuffer);
+        std::cerr.rdbuf(cerrBuffer);
+
+        std::cout << std::setw(2) << shardCount << " shard(s): "
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(12) << result.ordersPerSecond << " submit+fill/s"
+                  << std::setw(14) << result.readsPerSecond << " position reads/s\n";
+    }
+    return 0;
+}
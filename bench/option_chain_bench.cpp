@@ -0,0 +1,166 @@
+// Measures GetOptionChain's work for a full chain: building the response
+// per request on the heap, then on an arena, then served from the
+// OptionChainCache by several threads at once, with and without the chain
+// changing underneath. gRPC transport is left out: every variant ends with
+// the serialized bytes a response would carry.
+// Usage: option_chain_bench [contracts] [seconds per variant] [threads]
+#include <boost/asio.hpp>
+#include <google/protobuf/arena.h>
+#include <grpcpp/grpcpp.h>
+#include "MarketDataHandler.hpp"
+#include "market_data.pb.h"
+#include "services/option_chain_cache.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    void fillContract(const OptionData& data, trading::MarketDataResponse* contract) {
+        contract->set_symbol(data.underlying);
+        contract->set_option_type(data.optionType);
+        contract->set_strike(data.strike);
+        contract->set_bid(data.bid);
+        contract->set_ask(data.ask);
+        contract->set_price(data.lastPrice);
+        contract->set_volume(data.volume);
+        contract->set_implied_volatility(data.impliedVol);
+        contract->set_delta(data.delta);
+        contract->set_gamma(data.gamma);
+        contract->set_theta(data.theta);
+        contract->set_vega(data.vega);
+        contract->set_rho(data.rho);
+    }
+
+    void fillChain(const OptionChain& chain, trading::OptionChainResponse* response) {
+        for (const auto& entry : chain.calls) fillContract(entry.second, response->add_calls());
+        for (const auto& entry : chain.puts) fillContract(entry.second, response->add_puts());
+        response->set_underlying_price(chain.underlyingPrice);
+        response->set_timestamp(std::chrono::system_clock::now().time_since_epoch().count());
+    }
+
+    OptionData quote(size_t c, double price) {
+        char expiry[16];
+        std::snprintf(expiry, sizeof(expiry), "2099-%02zu-15", c / 2 % 10 + 1);
+        OptionData data;
+        data.underlying = "SPY";
+        data.optionType = c % 2 ? "PUT" : "CALL";
+        data.expiry = expiry;
+        data.strike = 300.0 + static_cast<double>(c / 20);
+        data.bid = price - 0.05;
+        data.ask = price + 0.05;
+        data.lastPrice = price;
+        data.volume = 100;
+        data.impliedVol = 0.2;
+        data.delta = 0.5;
+        return data;
+    }
+
+    // Runs body on each thread for the given time; returns calls per second
+    template <class Body>
+    double measure(size_t threads, double seconds, Body body) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> calls{0};
+        std::vector<std::thread> workers;
+        auto started = Clock::now();
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                uint64_t local = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    body(t);
+                    ++local;
+                }
+                calls.fetch_add(local);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (std::thread& worker : workers) worker.join();
+        return calls.load() / std::chrono::duration<double>(Clock::now() - started).count();
+    }
+
+    void report(const std::string& name, double qps, double baseline) {
+        std::cout << std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(12) << qps << " QPS" << std::setprecision(1) << std::setw(9)
+                  << qps / baseline << "x\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 2000;
+    const double seconds = argc > 2 ? std::stod(argv[2]) : 2.0;
+    const size_t threads = argc > 3 ? std::stoul(argv[3]) : 4;
+
+    grpc::internal::GrpcLibraryInitializer initializer;   // The cache's slices need gRPC's core
+    initializer.summon();
+
+    boost::asio::io_context io;
+    MarketDataHandler handler(io, "");   // Never started: the chain is applied directly
+    handler.applyUnderlyingPrice("SPY", 400.0);
+    for (size_t c = 0; c < contracts; ++c) handler.applyQuote(quote(c, 5.0));
+
+    OptionChain chain;
+    handler.getOptionChain("SPY", chain);
+    trading::OptionChainResponse sample;
+    fillChain(chain, &sample);
+    std::cout << contracts << " contracts, " << sample.ByteSizeLong() << " bytes per response, "
+              << threads << " threads\n";
+
+    // Per request: copy the chain, build on the heap, serialize
+    double heap = measure(threads, seconds, [&](size_t) {
+        OptionChain copy;
+        handler.getOptionChain("SPY", copy);
+        trading::OptionChainResponse response;
+        fillChain(copy, &response);
+        std::string bytes;
+        response.SerializeToString(&bytes);
+    });
+    report("heap build per request", heap, heap);
+
+    double arena = measure(threads, seconds, [&](size_t) {
+        OptionChain copy;
+        handler.getOptionChain("SPY", copy);
+        google::protobuf::ArenaOptions options;
+        options.start_block_size = 64 * 1024;
+        google::protobuf::Arena arena(options);
+        auto* response = google::protobuf::Arena::CreateMessage<trading::OptionChainResponse>(&arena);
+        fillChain(copy, response);
+        std::string bytes;
+        response->SerializeToString(&bytes);
+    });
+    report("arena build per request", arena, heap);
+
+    OptionChainCache cache(handler);
+    double cached = measure(threads, seconds, [&](size_t) {
+        grpc::ByteBuffer response;
+        cache.get("SPY", "", &response);
+    });
+    report("cached, unchanged chain", cached, heap);
+
+    double expiry = measure(threads, seconds, [&](size_t t) {
+        grpc::ByteBuffer response;
+        cache.get("SPY", t % 2 ? "2099-03-15" : "2099-07-15", &response);
+    });
+    report("cached, one expiry", expiry, heap);
+
+    // One quote changes after every 100 requests
+    std::atomic<uint64_t> requests{0};
+    double ticking = measure(threads, seconds, [&](size_t) {
+        if (requests.fetch_add(1, std::memory_order_relaxed) % 100 == 99) {
+            handler.applyQuote(quote(requests.load() % contracts, 5.0 + (requests.load() % 7) * 0.01));
+        }
+        grpc::ByteBuffer response;
+        cache.get("SPY", "", &response);
+    });
+    report("cached, 1 change per 100 requests", ticking, heap);
+
+    OptionChainCache::Stats stats = cache.getStats();
+    std::cout << "Cache: " << stats.hits << " hits, " << stats.builds << " builds\n";
+    return 0;
+}
@@ -0,0 +1,305 @@
+// Orders per second over one connection to the in-process gRPC server:
+// unary PlaceOrder and CancelOrder one at a time and with a window of
+// calls in flight, against the OrderEntry stream placing, replacing and
+// cancelling the same number of orders. The stream's acks must come back
+// in request order; the run fails if they do not. Usage:
+//   order_entry_bench [orders] [unary window] [async|sync]
+// The engine logs to stdout; redirect it to keep only the summary, which is
+// written to stderr.
+#include <grpcpp/grpcpp.h>
+#include <boost/asio.hpp>
+#include "ExecutionEngine.hpp"
+#include "MarketDataHandler.hpp"
+#include "OrderEventJournal.hpp"
+#include "OrderManagementSystem.hpp"
+#include "RiskManagement.hpp"
+#include "RiskPublisher.hpp"
+#include "services/execution_service.hpp"
+#include "services/market_data_service.hpp"
+#include "services/market_data_service_v2.hpp"
+#include "services/metrics_service.hpp"
+#include "services/order_management_service.hpp"
+#include "services/order_management_service_v2.hpp"
+#include "services/quote_fanout.hpp"
+#include "services/risk_service.hpp"
+#include "services/rpc_server.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    trading::OrderRequest makeRequest(size_t i, double price) {
+        trading::OrderRequest request;
+        request.set_symbol("SPY");
+        request.set_option_type(i % 2 ? "PUT" : "CALL");
+        request.set_strike(400.0 + static_cast<double>(i % 20));
+        request.set_expiration_date("2099-12-17");
+        request.set_side(i % 3 ? "BUY" : "SELL");
+        request.set_order_type("LIMIT");
+        request.set_price(price);
+        request.set_quantity(1);
+        return request;
+    }
+
+    void report(const std::string& name, size_t calls, double seconds, size_t failures) {
+        std::cerr << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << calls / seconds << " /s" << std::setw(10) << calls << " calls"
+                  << std::setw(8) << failures << " failed\n";
+    }
+
+    // Runs call(i, done) for every i with at most window calls in flight;
+    // done(ok) must be called once per call, from any thread
+    template <class Call>
+    size_t windowed(size_t count, size_t window, Call call) {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t inFlight = 0, finished = 0, failures = 0;
+        auto done = [&](bool ok) {
+            std::lock_guard<std::mutex> lock(mutex);
+            --inFlight;
+            ++finished;
+            if (!ok) ++failures;
+            cv.notify_all();
+        };
+        for (size_t i = 0; i < count; ++i) {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [&] { return inFlight < window; });
+            ++inFlight;
+            lock.unlock();
+            call(i, done);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return finished == count; });
+        return failures;
+    }
+
+    // Writes every request, then half-closes; reads acks until the server
+    // finishes. Each ack must carry the next client sequence.
+    class EntryClient final : public grpc::ClientBidiReactor<trading::OrderEntryRequest, trading::OrderEntryAcks> {
+    public:
+        explicit EntryClient(std::vector<trading::OrderEntryRequest> requests)
+            : requests_(std::move(requests)) {}
+
+        grpc::ClientContext context;
+        std::vector<trading::OrderEntryAck> acks;
+        size_t outOfOrder{0};
+
+        void run(trading::OrderManagementService::Stub& stub) {
+            stub.async()->OrderEntry(&context, this);
+            StartRead(&batch_);
+            if (requests_.empty()) {
+                StartWritesDone();
+            } else {
+                StartWrite(&requests_[0], grpc::WriteOptions().set_buffer_hint());
+            }
+            StartCall();
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return done_; });
+        }
+
+        const grpc::Status& status() const { return status_; }
+
+        void OnWriteDone(bool ok) override {
+            if (ok && ++written_ < requests_.size()) {
+                StartWrite(&requests_[written_], grpc::WriteOptions().set_buffer_hint());
+            } else {
+                StartWritesDone();
+            }
+        }
+
+        void OnReadDone(bool ok) override {
+            if (!ok) return;
+            for (trading::OrderEntryAck& ack : *batch_.mutable_acks()) {
+                if (ack.client_sequence() != acks.size()) ++outOfOrder;
+                acks.push_back(std::move(ack));
+            }
+            StartRead(&batch_);
+        }
+
+        void OnDone(const grpc::Status& status) override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_ = status;
+            done_ = true;
+            cv_.notify_all();
+        }
+
+    private:
+        std::vector<trading::OrderEntryRequest> requests_;
+        size_t written_{0};
+        trading::OrderEntryAcks batch_;
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool done_{false};
+        grpc::Status status_;
+    };
+
+    // One stream carrying the requests; returns false if it failed or its
+    // acks came out of order
+    bool stream(trading::OrderManagementService::Stub& stub, const std::string& name,
+                std::vector<trading::OrderEntryRequest> requests, std::vector<trading::OrderEntryAck>& acks) {
+        size_t count = requests.size();
+        EntryClient client(std::move(requests));
+        auto started = Clock::now();
+        client.run(stub);
+        double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+        size_t rejected = 0;
+        for (const auto& ack : client.acks) {
+            if (ack.status() == "REJECTED") ++rejected;
+        }
+        report(name, count, seconds, rejected);
+        acks = std::move(client.acks);
+        if (!client.status().ok() || acks.size() != count || client.outOfOrder > 0) {
+            std::cerr << name << ": " << client.status().error_message() << ", " << acks.size() << " of "
+                      << count << " acks, " << client.outOfOrder << " out of order\n";
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t orders = argc > 1 ? std::stoul(argv[1]) : 20000;
+    const size_t window = argc > 2 ? std::stoul(argv[2]) : 64;
+    RpcServerConfig config;
+    config.mode = argc > 3 && std::string(argv[3]) == "sync" ? RpcServerConfig::Mode::SYNC
+                                                              : RpcServerConfig::Mode::ASYNC;
+
+    boost::asio::io_context io;
+    MarketDataHandler marketData(io, "");   // Never started
+    OrderManagementSystem oms;
+    ExecutionEngine engine;
+    RiskManagement risk;
+    risk.setRiskLimits(RiskLimits{1e12, 1e12, 1e12, 1e12, 1e15, 1e12, 0.0});
+    engine.setOrderManagementSystem(&oms);
+    engine.setSimulatedFillRate(0.0);   // Orders stay working, so every cancel finds its order
+    oms.setExecutionEngine(&engine);
+    oms.setRiskManager(&risk);
+    risk.onUnderlyingPrice("SPY", 410.0);
+    RiskPublisher publisher(risk);
+
+    OrderEventJournal journal(oms);
+    QuoteFanout fanout(marketData);
+    MarketDataServiceImpl marketDataService(fanout);
+    OrderManagementServiceImpl orderService(oms);
+    ExecutionServiceImpl executionService(oms, journal);
+    RiskServiceImpl riskService(publisher);
+    MarketDataServiceV2Impl marketDataV2Service(fanout);
+    OrderManagementServiceV2Impl orderV2Service(oms, marketData.instruments());
+    MetricsServiceImpl metricsService;
+
+    RpcServer server({marketDataService, orderService, executionService, riskService,
+                      marketDataV2Service, orderV2Service, metricsService}, config);
+    server.start("127.0.0.1:0");
+    journal.start();
+    oms.start();
+    engine.start();
+
+    auto channel = grpc::CreateChannel("127.0.0.1:" + std::to_string(server.port()),
+                                       grpc::InsecureChannelCredentials());
+    auto stub = trading::OrderManagementService::NewStub(channel);
+    std::cerr << (config.mode == RpcServerConfig::Mode::SYNC ? "sync" : "async") << " server, "
+              << orders << " orders per run, one connection\n";
+
+    // Unary, one call at a time
+    std::vector<std::string> placed;
+    size_t failures = 0;
+    auto started = Clock::now();
+    for (size_t i = 0; i < orders; ++i) {
+        grpc::ClientContext context;
+        trading::OrderResponse response;
+        if (stub->PlaceOrder(&context, makeRequest(i, 1.0), &response).ok()) {
+            placed.push_back(response.order_id());
+        } else {
+            ++failures;
+        }
+    }
+    report("unary PlaceOrder, sequential", orders, std::chrono::duration<double>(Clock::now() - started).count(),
+           failures);
+
+    failures = 0;
+    started = Clock::now();
+    for (const std::string& orderId : placed) {
+        grpc::ClientContext context;
+        trading::CancelOrderRequest request;
+        request.set_order_id(orderId);
+        trading::CancelOrderResponse response;
+        if (!stub->CancelOrder(&context, request, &response).ok()) ++failures;
+    }
+    report("unary CancelOrder, sequential", placed.size(),
+           std::chrono::duration<double>(Clock::now() - started).count(), failures);
+
+    // Unary, a window of calls in flight
+    std::vector<std::string> windowPlaced(orders);
+    started = Clock::now();
+    failures = windowed(orders, window, [&](size_t i, const std::function<void(bool)>& done) {
+        auto* context = new grpc::ClientContext();
+        auto* request = new trading::OrderRequest(makeRequest(i, 1.0));
+        auto* response = new trading::OrderResponse();
+        stub->async()->PlaceOrder(context, request, response, [&, i, context, request, response, done](grpc::Status status) {
+            windowPlaced[i] = response->order_id();
+            delete context;
+            delete request;
+            delete response;
+            done(status.ok());
+        });
+    });
+    report("unary PlaceOrder, " + std::to_string(window) + " in flight", orders,
+           std::chrono::duration<double>(Clock::now() - started).count(), failures);
+
+    started = Clock::now();
+    failures = windowed(orders, window, [&](size_t i, const std::function<void(bool)>& done) {
+        auto* context = new grpc::ClientContext();
+        auto* request = new trading::CancelOrderRequest();
+        request->set_order_id(windowPlaced[i]);
+        auto* response = new trading::CancelOrderResponse();
+        stub->async()->CancelOrder(context, request, response, [context, request, response, done](grpc::Status status) {
+            delete context;
+            delete request;
+            delete response;
+            done(status.ok());
+        });
+    });
+    report("unary CancelOrder, " + std::to_string(window) + " in flight", orders,
+           std::chrono::duration<double>(Clock::now() - started).count(), failures);
+
+    // OrderEntry: place, replace and cancel, one stream each
+    bool ok = true;
+    std::vector<trading::OrderEntryRequest> requests(orders);
+    for (size_t i = 0; i < orders; ++i) {
+        requests[i].set_client_sequence(i);
+        *requests[i].mutable_place() = makeRequest(i, 1.0);
+    }
+    std::vector<trading::OrderEntryAck> placeAcks, acks;
+    ok = stream(*stub, "OrderEntry place", std::move(requests), placeAcks) && ok;
+
+    requests.assign(placeAcks.size(), trading::OrderEntryRequest());
+    for (size_t i = 0; i < placeAcks.size(); ++i) {
+        requests[i].set_client_sequence(i);
+        requests[i].mutable_replace()->set_order_id(placeAcks[i].order_id());
+        *requests[i].mutable_replace()->mutable_order() = makeRequest(i, 1.05);
+    }
+    ok = stream(*stub, "OrderEntry replace", std::move(requests), acks) && ok;
+
+    requests.assign(placeAcks.size(), trading::OrderEntryRequest());
+    for (size_t i = 0; i < placeAcks.size(); ++i) {
+        requests[i].set_client_sequence(i);
+        requests[i].mutable_cancel()->set_order_id(placeAcks[i].order_id());
+    }
+    ok = stream(*stub, "OrderEntry cancel", std::move(requests), acks) && ok;
+
+    server.shutdown();
+    engine.stop();
+    oms.stop();
+    journal.stop();
+    return ok ? 0 : 1;
+}
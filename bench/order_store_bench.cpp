@@ -0,0 +1,170 @@
+// Compares the slab OrderStore with the previous string-keyed order map for
+// submit, fill and cancel, and counts heap allocations on each path.
+#include "OrderManagementSystem.hpp"
+#include "OrderStore.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    std::atomic<uint64_t> allocationCount{0};
+}
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* ptr = std::malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+    struct Result {
+        double nanosPerOp;
+        double allocationsPerOp;
+    };
+
+    template <typename Fn>
+    Result measure(size_t ops, Fn&& fn) {
+        uint64_t allocationsBefore = allocationCount;
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return Result{
+            std::chrono::duration<double, std::nano>(elapsed).count() / ops,
+            static_cast<double>(allocationCount - allocationsBefore) / ops
+        };
+    }
+
+    void report(const std::string& name, const Result& result) {
+        std::cout << std::left << std::setw(32) << name
+                  << std::right << std::setw(10) << std::fixed << std::setprecision(1)
+                  << result.nanosPerOp << " ns/op"
+                  << std::setw(10) << std::setprecision(2) << result.allocationsPerOp
+                  << " allocs/op\n";
+    }
+
+    OptionOrder makeOrder() {
+        OptionOrder order{};
+        order.underlying = "SPY";
+        order.optionType = "CALL";
+        order.strike = 450.0;
+        order.expiry = "2099-12-17";
+        order.quantity = 1;
+        order.type = OptionOrder::Type::BUY_TO_OPEN;
+        order.orderType = OptionOrder::OrderType::LIMIT;
+        order.limitPrice = 1.25;
+        order.timeInForce = OptionOrder::TimeInForce::GTC;
+        return order;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t orderCount = argc > 1 ? std::stoul(argv[1]) : 200000;
+    const OptionOrder templateOrder = makeOrder();
+    const OrderRecord templateRecord = makeOrderRecord(templateOrder);
+
+    std::cout << "Orders: " << orderCount << "\n";
+
+    // Previous design: stringstream IDs and a string-keyed unordered_map
+    {
+        std::unordered_map<std::string, OptionOrder> orders;
+        std::vector<std::string> ids;
+        ids.reserve(orderCount);
+        uint64_t counter = 0;
+
+        report("map: submit", measure(orderCount, [&] {
+            for (size_t i = 0; i < orderCount; ++i) {
+                std::stringstream ss;
+                ss << "ORD-" << std::setfill('0') << std::setw(8) << ++counter;
+                OptionOrder order = templateOrder;
+                order.orderId = ss.str();
+                orders[order.orderId] = order;
+                ids.push_back(order.orderId);
+            }
+        }));
+        report("map: fill", measure(orderCount / 2, [&] {
+            for (size_t i = 0; i < orderCount; i += 2) {
+                auto it = orders.find(ids[i]);
+                it->second.status = OptionOrder::Status::FILLED;
+                it->second.isActive = false;
+            }
+        }));
+        report("map: cancel", measure(orderCount / 2, [&] {
+            for (size_t i = 1; i < orderCount; i += 2) {
+                auto it = orders.find(ids[i]);
+                it->second.status = OptionOrder::Status::CANCELLED;
+                it->second.isActive = false;
+            }
+        }));
+    }
+
+    // Slab store with integer handles
+    {
+        OrderStore store(orderCount);
+        std::vector<OrderHandle> handles;
+        handles.reserve(orderCount);
+
+        report("slab: submit", measure(orderCount, [&] {
+            for (size_t i = 0; i < orderCount; ++i) {
+                handles.push_back(store.insert(templateRecord).handle);
+            }
+        }));
+        report("slab: fill", measure(orderCount / 2, [&] {
+            for (size_t i = 0; i < orderCount; i += 2) {
+                OrderRecord* order = store.find(handles[i]);
+                order->status = OptionOrder::Status::FILLED;
+                order->isActive = false;
+            }
+        }));
+        report("slab: cancel", measure(orderCount / 2, [&] {
+            for (size_t i = 1; i < orderCount; i += 2) {
+                OrderRecord* order = store.find(handles[i]);
+                order->status = OptionOrder::Status::CANCELLED;
+                order->isActive = false;
+            }
+        }));
+    }
+
+    // End to end through the OMS handle API (no engine attached)
+    {
+        OrderManagementSystem oms(orderCount);
+        std::vector<OrderHandle> handles;
+        handles.reserve(orderCount);
+
+        auto* coutBuffer = std::cout.rdbuf(nullptr);
+        auto* cerrBuffer = std::cerr.rdbuf(nullptr);
+        oms.start();
+        Result submit = measure(orderCount, [&] {
+            for (size_t i = 0; i < orderCount; ++i) {
+                handles.push_back(oms.submitOrder(templateRecord));
+            }
+        });
+        Result fill = measure(orderCount / 2, [&] {
+            for (size_t i = 0; i < orderCount; i += 2) {
+                oms.onOrderFilled(handles[i], 0, 1.25);
+            }
+        });
+        Result cancel = measure(orderCount / 2, [&] {
+            for (size_t i = 1; i < orderCount; i += 2) {
+                oms.cancelOrder(handles[i]);
+            }
+        });
+        oms.stop();
+        std::cout.rdbuf(coutBuffer);
+        std::cerr.rdbuf(cerrBuffer);
+
+        report("oms handle: submit", submit);
+        report("oms handle: fill", fill);
+        report("oms handle: cancel", cancel);
+    }
+    return 0;
+}
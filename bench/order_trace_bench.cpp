@@ -0,0 +1,124 @@
+// Cost of per-order tracing on the order path: submit latency through the
+// OMS into the execution engine, with tracing off, at a 1% sample rate and
+// with every order traced, each run on a fresh OMS and engine. Each submit
+// also records the handler's spans, as the RPC handlers do. After each
+// traced run the exporter must have written or counted as dropped every
+// span recorded; the run fails if not.
+// Usage: order_trace_bench [orders per run] [trace file]
+#include "OrderManagementSystem.hpp"
+#include "ExecutionEngine.hpp"
+#include "OrderTracer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr size_t BURST = 256;
+    constexpr std::chrono::milliseconds PAUSE{5};
+
+    OrderRecord makeMarketOrder() {
+        OptionOrder order{};
+        order.underlying = "SPY";
+        order.optionType = "CALL";
+        order.strike = 450.0;
+        order.expiry = "2030-01-18";
+        order.quantity = 1;
+        order.type = OptionOrder::Type::BUY_TO_OPEN;
+        order.orderType = OptionOrder::OrderType::MARKET;
+        order.limitPrice = 1.0;
+        order.timeInForce = OptionOrder::TimeInForce::DAY;
+        return makeOrderRecord(order);
+    }
+
+    // Submits in bursts, so the engine keeps up, and returns each submit's
+    // latency in nanoseconds, sorted
+    std::vector<double> submitOrders(OrderManagementSystem& oms, size_t orders) {
+        const OrderRecord order = makeMarketOrder();
+        std::vector<double> nanos;
+        nanos.reserve(orders);
+        for (size_t i = 0; i < orders; ++i) {
+            uint64_t received = TscClock::now();
+            OrderHandle handle = oms.submitOrder(order);
+            const uint64_t submitted = OrderTracer::sampled(handle) ? TscClock::now() : 0;
+            if (submitted) OrderTracer::traceHandler(handle, received, submitted);
+            nanos.push_back(TscClock::toNanos(TscClock::now() - received));
+            if ((i + 1) % BURST == 0) std::this_thread::sleep_for(PAUSE);
+        }
+        std::sort(nanos.begin(), nanos.end());
+        return nanos;
+    }
+
+    void report(const std::string& name, const std::vector<double>& nanos) {
+        double sum = 0.0;
+        for (double n : nanos) sum += n;
+        auto at = [&](double q) { return nanos[std::min(nanos.size() - 1, static_cast<size_t>(q * nanos.size()))]; };
+        std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(8) << sum / nanos.size() << " ns mean" << std::setw(8) << at(0.5) << " p50"
+                  << std::setw(8) << at(0.99) << " p99\n";
+    }
+
+    // A warm-up and then the measured orders, with the tracer running when
+    // options is given
+    std::vector<double> run(size_t orders, const TraceOptions* options) {
+        OrderManagementSystem oms(1 << 20);
+        ExecutionEngine engine;
+        engine.setOrderManagementSystem(&oms);
+        engine.setSimulatedFillRate(1.0);
+        oms.setExecutionEngine(&engine);
+        oms.start();
+        engine.start();
+
+        submitOrders(oms, orders / 10);
+        if (options) OrderTracer::start(*options);
+        std::vector<double> nanos = submitOrders(oms, orders);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));   // Let the engine finish the last burst
+        if (options) OrderTracer::stop();
+
+        engine.stop();
+        oms.stop();
+        return nanos;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t orders = argc > 1 ? std::stoul(argv[1]) : 50000;
+    const std::string path = argc > 2 ? argv[2] : "order_trace_bench.json";
+
+    auto* coutBuffer = std::cout.rdbuf(nullptr);   // Silence the engine's start and stop banners
+    std::vector<double> untraced = run(orders, nullptr);
+    std::cout.rdbuf(coutBuffer);
+    std::cout << orders << " orders per run\n";
+    report("tracing off", untraced);
+
+    bool ok = true;
+    for (double rate : {0.01, 1.0}) {
+        TraceOptions options;
+        options.path = path;
+        options.sampleRate = rate;
+        options.capacity = 1 << 18;
+        const OrderTracer::Stats before = OrderTracer::stats();
+        std::cout.rdbuf(nullptr);
+        std::vector<double> nanos = run(orders, &options);
+        std::cout.rdbuf(coutBuffer);
+        const OrderTracer::Stats after = OrderTracer::stats();
+
+        report("sampled " + std::to_string(static_cast<int>(rate * 100)) + "%", nanos);
+        const uint64_t recorded = after.spansRecorded - before.spansRecorded;
+        const uint64_t exported = after.spansExported - before.spansExported;
+        const uint64_t dropped = after.spansDropped - before.spansDropped;
+        std::cout << "  " << recorded << " spans, " << exported << " exported, " << dropped << " dropped, "
+                  << after.bytesWritten - before.bytesWritten << " bytes\n";
+        if (exported + dropped != recorded) {
+            std::cerr << "Expected " << recorded << " spans accounted for, found " << exported + dropped << "\n";
+            ok = false;
+        }
+    }
+
+    std::cout << "Trace of the last run written to " << path << "\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// Replays a simulated tick stream through the conflation behind
+// SubscribeMarketData and compares the messages a subscriber receives with
+// one message per tick, as StreamMarketData sends. Ticks arrive at a fixed
+// rate with a skew towards near-the-money contracts. A batch is cut every
+// interval unless the reader is still busy with the previous one. At the
+// end, the reader's view of every contract must match the last tick sent.
+// Usage: quote_batching_bench [contracts] [ticks/s] [seconds] [interval ms]
+#include "QuoteConflator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        uint64_t messages{0};
+        uint64_t quotesSent{0};
+        uint64_t conflated{0};
+        uint64_t dropped{0};
+        size_t mismatches{0};
+        double offerNanos{0.0};
+        double drainNanos{0.0};
+    };
+
+    // readerIntervals: how many batch intervals the reader spends on each
+    // batch, so a slow reader leaves writes in flight
+    Result replay(const std::vector<OptionData>& chain, double ticksPerSecond, double seconds,
+                  double intervalMillis, int readerIntervals, size_t maxContracts) {
+        std::mt19937_64 rng(7);
+        std::normal_distribution<double> near(chain.size() / 2.0, chain.size() / 8.0);
+        std::normal_distribution<double> move(0.0, 0.01);
+
+        std::vector<OptionData> latest = chain;
+        std::unordered_map<InstrumentKey, OptionData> readerView;
+        QuoteConflator conflator(maxContracts);
+        std::vector<OptionData> batch;
+        Result result;
+
+        const uint64_t ticks = static_cast<uint64_t>(ticksPerSecond * seconds);
+        const uint64_t ticksPerInterval = std::max<uint64_t>(1, static_cast<uint64_t>(ticksPerSecond * intervalMillis / 1000.0));
+        int busyIntervals = 0;
+        double offerNanos = 0.0, drainNanos = 0.0;
+
+        auto cut = [&] {
+            auto started = Clock::now();
+            result.conflated += conflator.conflated();
+            result.dropped += conflator.dropped();
+            conflator.drain(batch);
+            drainNanos += std::chrono::duration<double, std::nano>(Clock::now() - started).count();
+            ++result.messages;
+            result.quotesSent += batch.size();
+            for (const OptionData& quote : batch) {
+                readerView[makeInstrumentKey(quote.underlying, quote.optionType, quote.strike, quote.expiry)] = quote;
+            }
+            busyIntervals = readerIntervals - 1;
+        };
+
+        for (uint64_t t = 0; t < ticks; ++t) {
+            long index = std::lround(near(rng));
+            size_t c = static_cast<size_t>(std::min<long>(std::max<long>(index, 0), chain.size() - 1));
+            OptionData& quote = latest[c];
+            quote.lastPrice = std::max(0.01, quote.lastPrice * (1.0 + move(rng)));
+            quote.bid = quote.lastPrice - 0.05;
+            quote.ask = quote.lastPrice + 0.05;
+
+            auto started = Clock::now();
+            conflator.offer(quote);
+            offerNanos += std::chrono::duration<double, std::nano>(Clock::now() - started).count();
+
+            if ((t + 1) % ticksPerInterval == 0) {
+                if (busyIntervals > 0) {
+                    --busyIntervals;   // A write is still in flight
+                } else if (!conflator.empty() || conflator.dropped() > 0) {
+                    cut();
+                }
+            }
+        }
+        if (!conflator.empty()) cut();   // The final interval, once the reader catches up
+
+        for (const OptionData& quote : latest) {
+            auto it = readerView.find(makeInstrumentKey(quote.underlying, quote.optionType, quote.strike, quote.expiry));
+            bool seen = it != readerView.end();
+            // Untouched contracts were never sent; the reader still has the initial chain
+            double price = seen ? it->second.lastPrice : chain[&quote - latest.data()].lastPrice;
+            if (price != quote.lastPrice) ++result.mismatches;
+        }
+        result.offerNanos = offerNanos / static_cast<double>(ticks);
+        result.drainNanos = result.messages ? drainNanos / static_cast<double>(result.messages) : 0.0;
+        return result;
+    }
+
+    void report(const std::string& name, const Result& result, uint64_t ticks, double seconds) {
+        std::cout << std::left << std::setw(26) << name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << result.messages / seconds << " msgs/s"
+                  << std::setw(10) << result.quotesSent / seconds << " quotes/s"
+                  << std::setprecision(1) << std::setw(8) << 100.0 * result.conflated / ticks << "% conflated"
+                  << std::setw(8) << result.dropped << " dropped"
+                  << std::setw(6) << result.mismatches << " stale"
+                  << std::setprecision(0) << std::setw(7) << result.offerNanos << " ns/offer"
+                  << std::setw(9) << result.drainNanos << " ns/drain\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 2000;
+    const double ticksPerSecond = argc > 2 ? std::stod(argv[2]) : 200000.0;
+    const double seconds = argc > 3 ? std::stod(argv[3]) : 5.0;
+    const double intervalMillis = argc > 4 ? std::stod(argv[4]) : 50.0;
+
+    // One underlying, ten expiries, calls and puts on a strike ladder
+    std::vector<OptionData> chain(contracts);
+    for (size_t c = 0; c < contracts; ++c) {
+        char expiry[16];
+        std::snprintf(expiry, sizeof(expiry), "2099-%02zu-15", c / 2 % 10 + 1);
+        chain[c].underlying = "SPY";
+        chain[c].optionType = c % 2 ? "PUT" : "CALL";
+        chain[c].expiry = expiry;
+        chain[c].strike = 300.0 + static_cast<double>(c / 20);
+        chain[c].lastPrice = 5.0;
+    }
+
+    const uint64_t ticks = static_cast<uint64_t>(ticksPerSecond * seconds);
+    std::cout << contracts << " contracts, " << ticks << " ticks over " << seconds << " s, batches every "
+              << intervalMillis << " ms\n";
+    std::cout << std::left << std::setw(26) << "one message per tick" << std::right << std::fixed
+              << std::setprecision(0) << std::setw(10) << ticksPerSecond << " msgs/s"
+              << std::setw(10) << ticksPerSecond << " quotes/s\n";
+    report("batched", replay(chain, ticksPerSecond, seconds, intervalMillis, 1, contracts), ticks, seconds);
+    report("batched, reader 4x slow", replay(chain, ticksPerSecond, seconds, intervalMillis, 4, contracts), ticks, seconds);
+    report("batched, 500-slot cap", replay(chain, ticksPerSecond, seconds, intervalMillis, 1, 500), ticks, seconds);
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Scaling of the parallel portfolio revaluation across core counts and
+// book sizes, against the sequential calculatePortfolioRisk where that
+// finishes in reasonable time.
+#include "PortfolioBook.hpp"
+#include "RiskManagement.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // A book spread over 500 underlyings and 8 expiries with strikes
+    // around each spot; the same seed gives the same book every run
+    void makeBook(size_t count, std::vector<OptionPosition>& positions,
+                  std::unordered_map<std::string, double>& prices) {
+        const size_t underlyings = 500;
+        const double expiries[] = {0.02, 0.08, 0.17, 0.25, 0.5, 0.75, 1.0, 2.0};
+        std::mt19937_64 rng(7);
+        positions.clear();
+        positions.reserve(count);
+        prices.clear();
+
+        for (size_t u = 0; u < underlyings; ++u) {
+            char symbol[16];
+            std::snprintf(symbol, sizeof(symbol), "SYM%03zu", u);
+            prices[symbol] = 20.0 + static_cast<double>(rng() % 48000) / 100.0;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            char symbol[16];
+            std::snprintf(symbol, sizeof(symbol), "SYM%03zu", static_cast<size_t>(rng() % underlyings));
+            double spot = prices[symbol];
+            double strike = spot * (0.7 + static_cast<double>(rng() % 600) / 1000.0);
+            double quantity = static_cast<double>(static_cast<int>(rng() % 41) - 20);
+            positions.emplace_back(symbol, strike, quantity == 0.0 ? 1.0 : quantity, rng() % 2 == 0,
+                                   expiries[rng() % 8]);
+        }
+    }
+
+    template <typename Fn>
+    double bestMillis(size_t repetitions, Fn&& fn) {
+        double best = 1e300;
+        for (size_t i = 0; i < repetitions; ++i) {
+            auto start = Clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t maxThreads = argc > 1 ? std::stoul(argv[1])
+                                       : std::max(1u, std::thread::hardware_concurrency());
+    const size_t sizes[] = {1000, 10000, 100000, 1000000};
+
+    RiskManagement risk;
+    std::vector<OptionPosition> positions;
+    std::unordered_map<std::string, double> prices;
+
+    std::cout << std::fixed;
+    for (size_t size : sizes) {
+        makeBook(size, positions, prices);
+        size_t repetitions = size >= 1000000 ? 3 : 10;
+
+        auto buildStart = Clock::now();
+        PortfolioBook book(positions);
+        double buildMillis = std::chrono::duration<double, std::milli>(Clock::now() - buildStart).count();
+        std::cout << size << " positions, " << book.groupCount() << " groups (book built in "
+                  << std::setprecision(1) << buildMillis << " ms)\n";
+
+        if (size <= 100000) {
+            RiskMetrics sequential;
+            double millis = bestMillis(std::min<size_t>(repetitions, 3), [&] {
+                sequential = risk.calculatePortfolioRisk(positions, prices);
+            });
+            std::cout << "  calculatePortfolioRisk     " << std::setw(10) << std::setprecision(2) << millis
+                      << " ms  delta " << std::setprecision(1) << sequential.totalDelta << "\n";
+        }
+
+        // Powers of two up to the core count, then the core count itself
+        std::vector<size_t> coreCounts;
+        for (size_t threads = 1; threads < maxThreads; threads *= 2) coreCounts.push_back(threads);
+        coreCounts.push_back(maxThreads);
+
+        double single = 0.0;
+        for (size_t threads : coreCounts) {
+            PortfolioRevaluation result;
+            double millis = bestMillis(repetitions, [&] {
+                result = risk.revaluePortfolio(book, prices, threads);
+            });
+            if (threads == 1) single = millis;
+            std::cout << "  revaluePortfolio " << std::setw(3) << threads << " cores " << std::setw(10)
+                      << std::setprecision(2) << millis << " ms  " << std::setw(6) << std::setprecision(0)
+                      << size / millis * 1000.0 << " positions/s  speedup " << std::setprecision(2)
+                      << single / millis << "x  delta " << std::setprecision(1) << result.metrics.totalDelta
+                      << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+// Measures the pre-trade risk check, fill update and spot tick re-pricing
+// against incrementally maintained Greeks and scenario margin, and compares
+// the check with a full re-price of the book through calculatePortfolioRisk.
+// The tick and re-price runs are repeated with the pricing cache enabled.
+// A threaded run checks and fills on disjoint product groups at once, then
+// verifies that the portfolio totals still equal the sum per underlying.
+#include "BenchSymbols.hpp"
+#include "RiskManagement.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    void reportLatencies(const std::string& name, std::vector<double>& nanos) {
+        std::sort(nanos.begin(), nanos.end());
+        auto at = [&](double q) { return nanos[static_cast<size_t>(q * (nanos.size() - 1))]; };
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(0)
+                  << " p50 " << std::setw(10) << at(0.50) << " ns"
+                  << "  p99 " << std::setw(10) << at(0.99) << " ns"
+                  << "  max " << std::setw(12) << nanos.back() << " ns\n";
+    }
+
+}
+
+int main(int argc, char** argv) {
+    const size_t underlyings = argc > 1 ? std::stoul(argv[1]) : 100;
+    const size_t contractsPerUnderlying = argc > 2 ? std::stoul(argv[2]) : 100;
+    const size_t iterations = argc > 3 ? std::stoul(argv[3]) : 200000;
+
+    // The check fails closed: nothing trades before its underlying has a
+    // price, and the quantity held in one instrument is capped
+    {
+        RiskManagement strict;
+        InstrumentKey unpriced = makeInstrumentKey("NOPRICE", "CALL", 100.0, "2099-06-18");
+        bool refusedUnpriced = !strict.checkOrderRisk(unpriced, 1.0);
+        strict.onUnderlyingPrice("NOPRICE", 100.0);
+        if (!refusedUnpriced || !strict.checkOrderRisk(unpriced, 1.0) || strict.checkOrderRisk(unpriced, 2e6)) {
+            std::cerr << "Pre-trade check did not fail closed\n";
+            return 1;
+        }
+    }
+
+    RiskManagement risk;
+    RiskLimits limits{1e12, 1e12, 1e12, 1e12, 1e15, 1e12, 1e15};
+    risk.setRiskLimits(limits);
+
+    // Underlyings offset each other in product groups of ten
+    MarginParameters margin;
+    for (size_t u = 0; u < underlyings; ++u) {
+        margin.productGroups[symbolFor(u)] = "GROUP" + std::to_string(u / 10);
+    }
+    risk.setMarginParameters(margin);
+
+    std::vector<InstrumentKey> instruments;
+    std::vector<OptionPosition> positions;
+    std::unordered_map<std::string, double> prices;
+    std::mt19937_64 rng(42);
+    for (size_t u = 0; u < underlyings; ++u) {
+        std::string symbol = symbolFor(u);
+        double spot = 50.0 + 10.0 * static_cast<double>(u % 40);
+        prices[symbol] = spot;
+        risk.onUnderlyingPrice(symbol, spot);
+        for (size_t c = 0; c < contractsPerUnderlying; ++c) {
+            double strike = spot * (0.8 + 0.4 * static_cast<double>(c / 2) / (contractsPerUnderlying / 2));
+            const char* expiry = (c % 4 < 2) ? "2099-06-18" : "2099-12-17";
+            InstrumentKey key = makeInstrumentKey(symbol, c % 2 ? "PUT" : "CALL", strike, expiry);
+            double quantity = static_cast<double>(static_cast<int>(rng() % 21) - 10);
+            risk.onFill(key, quantity);
+            instruments.push_back(key);
+            positions.emplace_back(symbol, strike, quantity, c % 2 == 0, 1.0);
+        }
+    }
+    std::cout << instruments.size() << " contracts across " << underlyings << " underlyings\n";
+
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+    size_t accepted = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        const InstrumentKey& key = instruments[rng() % instruments.size()];
+        auto before = Clock::now();
+        accepted += risk.checkOrderRisk(key, 5.0);
+        latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+    }
+    reportLatencies("checkOrderRisk (marginal)", latencies);
+
+    // Contracts nothing is held in, priced for the check and not kept
+    latencies.clear();
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t u = rng() % underlyings;
+        double strike = prices[symbolFor(u)] * (0.5 + static_cast<double>(rng() % 1000) / 1000.0) + 0.01;
+        InstrumentKey key = makeInstrumentKey(symbolFor(u), "CALL", strike, "2099-09-17");
+        auto before = Clock::now();
+        accepted += risk.checkOrderRisk(key, 5.0);
+        latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+    }
+    reportLatencies("checkOrderRisk (unheld)", latencies);
+
+    latencies.clear();
+    for (size_t i = 0; i < iterations; ++i) {
+        const InstrumentKey& key = instruments[rng() % instruments.size()];
+        auto before = Clock::now();
+        risk.onFill(key, (i % 2) ? 1.0 : -1.0);
+        latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+    }
+    reportLatencies("onFill", latencies);
+
+    // Check and fill from several threads, each on its own product groups
+    const size_t groups = (underlyings + 9) / 10;
+    const size_t threads = std::min<size_t>(std::max(2u, std::thread::hardware_concurrency()), groups);
+    const size_t perThread = iterations / threads;
+    auto threadedStart = Clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 threadRng(100 + t);
+            const size_t owned = (groups - t + threads - 1) / threads;   // Groups t, t + threads, ...
+            for (size_t i = 0; i < perThread; ++i) {
+                size_t group = t + threads * (threadRng() % owned);
+                size_t u = std::min(group * 10 + threadRng() % 10, underlyings - 1);
+                const InstrumentKey& key = instruments[u * contractsPerUnderlying +
+                                                       threadRng() % contractsPerUnderlying];
+                if (risk.checkOrderRisk(key, 1.0)) risk.onFill(key, (i % 2) ? 1.0 : -1.0);
+            }
+        });
+    }
+    for (std::thread& worker : workers) worker.join();
+    double threadedSeconds = std::chrono::duration<double>(Clock::now() - threadedStart).count();
+    std::cout << "check + fill, " << threads << " threads: " << std::fixed << std::setprecision(0)
+              << static_cast<double>(perThread * threads) / threadedSeconds << " orders/s\n";
+
+    GreekTotals summed;
+    for (const RiskBucket& bucket : risk.getUnderlyingRisks()) summed += bucket.totals;
+    RiskMetrics afterThreads = risk.getCurrentRisk();
+    if (std::abs(summed.delta - afterThreads.totalDelta) > 1e-6 * (1.0 + std::abs(summed.delta)) ||
+        std::abs(summed.value - afterThreads.portfolioValue) > 1e-6 * (1.0 + std::abs(summed.value))) {
+        std::cerr << "Portfolio totals drifted from the underlyings: delta " << afterThreads.totalDelta
+                  << " vs " << summed.delta << "\n";
+        return 1;
+    }
+
+    // Spot ticks cycle through a few levels per underlying, as a quiet
+    // market does, so a cache sees the same inputs again
+    const size_t ticks = std::min<size_t>(iterations, 10000);
+    auto runTicks = [&](const std::string& name, uint64_t seed) {
+        std::mt19937_64 tickRng(seed);
+        latencies.clear();
+        for (size_t i = 0; i < ticks; ++i) {
+            size_t u = tickRng() % underlyings;
+            std::string symbol = symbolFor(u);
+            double move = 0.001 * static_cast<double>(static_cast<int>(tickRng() % 21) - 10);
+            double spot = prices[symbol] * (1.0 + move);
+            auto before = Clock::now();
+            risk.onUnderlyingPrice(symbol, spot);
+            latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+        }
+        reportLatencies(name, latencies);
+        double total = 0.0;
+        for (double nanos : latencies) total += nanos;
+        return total;
+    };
+
+    // Baseline: what a check cost when it needed a full re-price
+    const size_t reprices = std::max<size_t>(std::min<size_t>(iterations / 1000, 20), 1);
+    RiskMetrics exact;
+    auto runReprices = [&](const std::string& name, RiskMetrics& metrics) {
+        latencies.clear();
+        for (size_t i = 0; i < reprices; ++i) {
+            auto before = Clock::now();
+            metrics = risk.calculatePortfolioRisk(positions, prices);
+            latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+            accepted += metrics.totalDelta > 0;
+        }
+        reportLatencies(name, latencies);
+        double total = 0.0;
+        for (double nanos : latencies) total += nanos;
+        return total;
+    };
+
+    double uncachedTicks = runTicks("onUnderlyingPrice", 7);
+    double uncachedReprices = runReprices("calculatePortfolioRisk", exact);
+
+    // The same runs again with memoized pricing
+    // Sized to hold every contract at each of its 21 spot levels
+    PricingCacheConfig cacheConfig;
+    cacheConfig.capacity = std::max<size_t>(cacheConfig.capacity, instruments.size() * 21 + positions.size());
+    risk.enablePricingCache(cacheConfig);
+    RiskMetrics cached;
+    double cachedTicks = runTicks("onUnderlyingPrice (cache)", 7);
+    double cachedReprices = runReprices("calculatePortfolioRisk (cache)", cached);
+
+    PricingCache::Stats stats = risk.getPricingCacheStats();
+    std::cout << "Pricing cache: " << stats.hits << " hits, " << stats.misses << " misses ("
+              << std::setprecision(1) << stats.hitRate() * 100.0 << "% hit rate), " << stats.evictions
+              << " evictions, " << stats.entries << " entries\n"
+              << "Speedup: ticks " << std::setprecision(2) << uncachedTicks / cachedTicks << "x, full re-price "
+              << uncachedReprices / cachedReprices << "x; portfolio value error "
+              << std::setprecision(6) << std::abs(cached.portfolioValue - exact.portfolioValue) << "\n";
+
+    RiskMetrics current = risk.getCurrentRisk();
+    std::cout << "Live totals: delta " << std::setprecision(1) << current.totalDelta
+              << ", gamma " << current.totalGamma << ", vega " << current.totalVega
+              << ", value " << current.portfolioValue << ", margin " << current.marginRequirement
+              << " (" << accepted << " checks passed)\n";
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Full-revaluation VaR and expected shortfall: Monte Carlo and historical
+// scenario sets over a synthetic book, timed per core count.
+#include "PortfolioBook.hpp"
+#include "RiskManagement.hpp"
+#include "ScenarioRisk.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    void makeBook(size_t count, size_t underlyings, std::vector<OptionPosition>& positions,
+                  std::unordered_map<std::string, double>& prices) {
+        const double expiries[] = {0.02, 0.08, 0.17, 0.25, 0.5, 0.75, 1.0, 2.0};
+        std::mt19937_64 rng(7);
+        for (size_t u = 0; u < underlyings; ++u) {
+            char symbol[16];
+            std::snprintf(symbol, sizeof(symbol), "SYM%03zu", u);
+            prices[symbol] = 20.0 + static_cast<double>(rng() % 48000) / 100.0;
+        }
+        positions.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            char symbol[16];
+            std::snprintf(symbol, sizeof(symbol), "SYM%03zu", static_cast<size_t>(rng() % underlyings));
+            double spot = prices[symbol];
+            double strike = spot * (0.7 + static_cast<double>(rng() % 600) / 1000.0);
+            double quantity = static_cast<double>(static_cast<int>(rng() % 41) - 20);
+            positions.emplace_back(symbol, strike, quantity == 0.0 ? 1.0 : quantity, rng() % 2 == 0,
+                                   expiries[rng() % 8]);
+        }
+    }
+
+    // Random-walk closes and implied vols standing in for a price history
+    void makeHistory(const std::vector<std::string>& underlyings, size_t days,
+                     std::unordered_map<std::string, std::vector<double>>& closes,
+                     std::unordered_map<std::string, std::vector<double>>& vols) {
+        std::mt19937_64 rng(11);
+        std::normal_distribution<double> normal;
+        for (const auto& symbol : underlyings) {
+            std::vector<double>& close = closes[symbol];
+            std::vector<double>& vol = vols[symbol];
+            close.resize(days);
+            vol.resize(days);
+            close[0] = 100.0;
+            vol[0] = 0.2;
+            for (size_t d = 1; d < days; ++d) {
+                double z = normal(rng);
+                close[d] = close[d - 1] * std::exp(0.0126 * z);
+                vol[d] = std::max(0.05, vol[d - 1] * std::exp(0.06 * (-0.7 * z + 0.71 * normal(rng))));
+            }
+        }
+    }
+
+    void report(const std::string& name, size_t threads, const ScenarioRiskResult& result) {
+        std::cout << "  " << std::left << std::setw(12) << name << std::right << std::setw(3) << threads
+                  << " cores " << std::fixed << std::setprecision(0) << std::setw(8) << result.elapsedMillis
+                  << " ms ";
+        for (const auto& level : result.levels) {
+            std::cout << " | " << std::setprecision(1) << level.confidence * 100.0 << "% VaR "
+                      << std::setprecision(0) << level.valueAtRisk << " ES " << level.expectedShortfall;
+        }
+        std::cout << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t positionCount = argc > 1 ? std::stoul(argv[1]) : 50000;
+    const size_t scenarioCount = argc > 2 ? std::stoul(argv[2]) : 10000;
+    const size_t maxThreads = argc > 3 ? std::stoul(argv[3])
+                                       : std::max(1u, std::thread::hardware_concurrency());
+    const std::vector<double> confidence = {0.95, 0.99, 0.999};
+
+    std::vector<OptionPosition> positions;
+    std::unordered_map<std::string, double> prices;
+    makeBook(positionCount, 500, positions, prices);
+    PortfolioBook book(positions);
+
+    MonteCarloParameters parameters;
+    parameters.scenarios = scenarioCount;
+    ScenarioSet monteCarlo = makeMonteCarloScenarios(book.underlyings(), parameters);
+
+    std::unordered_map<std::string, std::vector<double>> closes, vols;
+    makeHistory(book.underlyings(), scenarioCount + 1, closes, vols);
+    ScenarioSet historical = makeHistoricalScenarios(closes, vols);
+
+    std::cout << positionCount << " positions in " << book.groupCount() << " groups, " << scenarioCount
+              << " scenarios (" << static_cast<double>(positionCount) * scenarioCount / 1e6
+              << "M option valuations per run)\n";
+
+    RiskManagement risk;
+    std::vector<size_t> coreCounts;
+    for (size_t threads = 1; threads < maxThreads; threads *= 2) coreCounts.push_back(threads);
+    coreCounts.push_back(maxThreads);
+
+    for (size_t threads : coreCounts) {
+        report("Monte Carlo", threads, risk.calculateScenarioRisk(book, monteCarlo, prices, confidence, threads));
+        report("historical", threads, risk.calculateScenarioRisk(book, historical, prices, confidence, threads));
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+// Multi-process check of the shared-memory quote table: this process
+// publishes quotes as fast as it can, concentrated on a few hot contracts,
+// while forked reader processes look contracts up and read them through
+// their own SharedQuoteReader mappings. Every quote the writer publishes
+// is self-consistent (each field is the publish count plus a fixed
+// offset), so a reader can tell a torn read, and a count lower than one it
+// read before is a stale one. Reports lookup and read cost, in CPU time
+// so processes sharing cores do not inflate it, and exits 1 if any read
+// was torn or stale or any lookup wrong.
+// Usage: shm_quote_bench [contracts] [readers] [seconds] [hot contracts]
+#include "SharedQuoteTable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double cpuNanos() {
+        timespec now;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+        return now.tv_sec * 1e9 + now.tv_nsec;
+    }
+
+    struct ReaderResult {
+        uint64_t reads{0};
+        uint64_t failed{0};      // Stalled writer or never quoted
+        uint64_t torn{0};        // Fields from different publishes
+        uint64_t stale{0};       // Older than a quote read before
+        uint64_t badLookups{0};
+        double readNanos{0.0};
+        double findNanos{0.0};
+    };
+
+    OptionData contractAt(size_t c) {
+        char expiry[16];
+        std::snprintf(expiry, sizeof(expiry), "2099-%02zu-15", c / 2 % 10 + 1);
+        OptionData data;
+        data.underlying = "SPY";
+        data.optionType = c % 2 ? "PUT" : "CALL";
+        data.expiry = expiry;
+        data.strike = 300.0 + static_cast<double>(c / 20);
+        return data;
+    }
+
+    // Every field derived from n, so any mix of two publishes shows
+    void stamp(OptionData& data, uint64_t n) {
+        double base = static_cast<double>(n);
+        data.bid = base;
+        data.ask = base + 1;
+        data.lastPrice = base + 2;
+        data.volume = static_cast<int>(n % 1000000);
+        data.impliedVol = base + 4;
+        data.delta = base + 5;
+        data.gamma = base + 6;
+        data.theta = base + 7;
+        data.vega = base + 8;
+        data.rho = base + 9;
+    }
+
+    bool consistent(const SharedQuote& quote) {
+        double base = quote.bid;
+        return quote.ask == base + 1 && quote.last == base + 2 &&
+               quote.volume == static_cast<double>(static_cast<uint64_t>(base) % 1000000) &&
+               quote.impliedVol == base + 4 && quote.delta == base + 5 && quote.gamma == base + 6 &&
+               quote.theta == base + 7 && quote.vega == base + 8 && quote.rho == base + 9;
+    }
+
+    ReaderResult runReader(const std::string& name, size_t contracts, size_t hot, double seconds, unsigned seed) {
+        SharedQuoteReader reader(name);
+        ReaderResult result;
+
+        // Every contract must be found under the ID it was published as
+        std::vector<OptionData> chain;
+        for (size_t c = 0; c < contracts; ++c) chain.push_back(contractAt(c));
+        double started = cpuNanos();
+        for (size_t c = 0; c < contracts; ++c) {
+            const OptionData& contract = chain[c];
+            uint32_t id;
+            if (!reader.find(contract.underlying, contract.optionType, contract.strike, contract.expiry, id) ||
+                id != c + 1) {
+                ++result.badLookups;
+            }
+        }
+        result.findNanos = (cpuNanos() - started) / contracts;
+
+        // Nine reads in ten on the hot contracts the writer is hammering
+        std::mt19937 rng(seed);
+        std::vector<uint32_t> ids(4096);
+        for (uint32_t& id : ids) {
+            id = rng() % 10 ? 1 + rng() % hot : 1 + rng() % contracts;
+        }
+        std::vector<double> lastSeen(contracts + 1, 0.0);
+
+        const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(seconds));
+        SharedQuote quote;
+        started = cpuNanos();
+        while (Clock::now() < deadline) {
+            for (uint32_t id : ids) {
+                if (!reader.read(id, quote)) {
+                    ++result.failed;
+                    continue;
+                }
+                if (!consistent(quote)) ++result.torn;
+                if (quote.bid < lastSeen[id]) ++result.stale;
+                lastSeen[id] = quote.bid;
+            }
+            result.reads += ids.size();
+        }
+        result.readNanos = (cpuNanos() - started) / result.reads;
+        return result;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 2000;
+    const size_t readers = argc > 2 ? std::stoul(argv[2]) : 3;
+    const double seconds = argc > 3 ? std::stod(argv[3]) : 3.0;
+    const size_t hot = std::min(contracts, argc > 4 ? std::stoul(argv[4]) : size_t(16));
+
+    const std::string name = "/shm_quote_bench_" + std::to_string(getpid());
+    SharedQuoteTable table(name, static_cast<uint32_t>(contracts));
+    std::vector<OptionData> chain;
+    std::vector<uint64_t> counts(contracts, 1);
+    for (size_t c = 0; c < contracts; ++c) {
+        chain.push_back(contractAt(c));
+        stamp(chain[c], 1);
+        table.publish(static_cast<uint32_t>(c + 1), chain[c]);
+    }
+
+    // Baseline: reads with no writer running
+    double quietNanos;
+    {
+        SharedQuoteReader reader(name);
+        SharedQuote quote;
+        double sum = 0.0;
+        const uint64_t reads = 10000000;
+        double started = cpuNanos();
+        for (uint64_t i = 0; i < reads; ++i) {
+            reader.read(static_cast<uint32_t>(1 + i % hot), quote);
+            sum += quote.bid;
+        }
+        quietNanos = (cpuNanos() - started) / reads;
+        if (sum < 0) std::cout << sum;   // Keeps the loop
+    }
+
+    std::vector<pid_t> children;
+    std::vector<int> pipes;
+    for (size_t r = 0; r < readers; ++r) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            std::perror("pipe");
+            return 2;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            ReaderResult result = runReader(name, contracts, hot, seconds, static_cast<unsigned>(r + 1));
+            ssize_t written = write(fds[1], &result, sizeof(result));
+            _exit(written == sizeof(result) ? 0 : 2);
+        }
+        close(fds[1]);
+        children.push_back(pid);
+        pipes.push_back(fds[0]);
+    }
+
+    // The writer: round-robin over the hot contracts, with every tenth
+    // publish going to a cold one
+    const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(seconds));
+    uint64_t writes = 0;
+    double started = cpuNanos();
+    while (Clock::now() < deadline) {
+        for (int i = 0; i < 1000; ++i, ++writes) {
+            size_t c = writes % 10 ? writes % hot : (writes * 7919) % contracts;
+            stamp(chain[c], ++counts[c]);
+            table.publish(static_cast<uint32_t>(c + 1), chain[c]);
+        }
+    }
+    double writeNanos = (cpuNanos() - started) / writes;
+
+    ReaderResult total;
+    double readNanos = 0.0, findNanos = 0.0;
+    for (size_t r = 0; r < readers; ++r) {
+        ReaderResult result;
+        bool received = read(pipes[r], &result, sizeof(result)) == sizeof(result);
+        close(pipes[r]);
+        int status;
+        waitpid(children[r], &status, 0);
+        if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            std::cerr << "Reader " << r << " failed\n";
+            return 2;
+        }
+        total.reads += result.reads;
+        total.failed += result.failed;
+        total.torn += result.torn;
+        total.stale += result.stale;
+        total.badLookups += result.badLookups;
+        readNanos += result.readNanos / readers;
+        findNanos += result.findNanos / readers;
+    }
+
+    std::cout << contracts << " contracts (" << hot << " hot), " << readers << " reader processes, "
+              << seconds << " s\n" << std::fixed << std::setprecision(1)
+              << "writer   " << std::setw(12) << writes / seconds << " publishes/s  "
+              << std::setw(6) << writeNanos << " ns/publish\n"
+              << "readers  " << std::setw(12) << total.reads / seconds << " reads/s      "
+              << std::setw(6) << readNanos << " ns/read (incl. check)  "
+              << std::setw(6) << findNanos << " ns/lookup\n"
+              << "no writer" << std::setw(39) << quietNanos << " ns/read\n"
+              << "failed " << total.failed << ", torn " << total.torn << ", stale " << total.stale
+              << ", bad lookups " << total.badLookups << "\n";
+    return total.torn || total.stale || total.badLookups ? 1 : 0;
+}
@@ -0,0 +1,141 @@
+// Measures batch what-if evaluation of candidate strategies (verticals,
+// straddles, strangles, iron condors and calendars drawn from the same
+// chains) against a held book, and compares it with pricing every leg of
+// every candidate through the scalar pricer, as a scanner loop would.
+#include "BenchSymbols.hpp"
+#include "DateUtils.hpp"
+#include "RiskManagement.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double percentile(std::vector<double> millis, double q) {
+        std::sort(millis.begin(), millis.end());
+        return millis[static_cast<size_t>(q * (millis.size() - 1))];
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t underlyings = argc > 1 ? std::stoul(argv[1]) : 20;
+    const size_t candidatesWanted = argc > 2 ? std::stoul(argv[2]) : 500;
+    const size_t iterations = argc > 3 ? std::stoul(argv[3]) : 50;
+    const char* nearExpiry = "2099-06-18";
+    const char* farExpiry = "2099-12-17";
+
+    RiskManagement risk;
+    RiskLimits limits{1e6, 1e5, 1e6, 1e6, 1e12, 1e12, 5e7};
+    risk.setRiskLimits(limits);
+    MarginParameters margin;
+    for (size_t u = 0; u < underlyings; ++u) {
+        margin.productGroups[symbolFor(u)] = "GROUP" + std::to_string(u / 5);
+    }
+    risk.setMarginParameters(margin);
+
+    // A held book of 40 contracts per underlying on a 5-wide strike ladder
+    std::mt19937_64 rng(42);
+    std::vector<double> spots(underlyings);
+    for (size_t u = 0; u < underlyings; ++u) {
+        std::string symbol = symbolFor(u);
+        spots[u] = 50.0 + 10.0 * static_cast<double>(u % 40);
+        risk.onUnderlyingPrice(symbol, spots[u]);
+        for (size_t c = 0; c < 40; ++c) {
+            double strike = spots[u] * (0.8 + 0.01 * static_cast<double>(c / 2 * 2));
+            InstrumentKey key = makeInstrumentKey(symbol, c % 2 ? "PUT" : "CALL", strike,
+                                                  c % 4 < 2 ? nearExpiry : farExpiry);
+            risk.onFill(key, static_cast<double>(static_cast<int>(rng() % 21) - 10));
+        }
+    }
+
+    // Candidates cycle through the shapes around each underlying's spot
+    std::vector<Strategy> candidates;
+    candidates.reserve(candidatesWanted);
+    for (size_t i = 0; candidates.size() < candidatesWanted; ++i) {
+        size_t u = i % underlyings;
+        std::string symbol = symbolFor(u);
+        double step = spots[u] * 0.025;
+        double atm = std::round(spots[u] / step) * step;
+        double offset = step * static_cast<double>((i / underlyings) % 4);
+        switch ((i / underlyings / 4) % 5) {
+            case 0: candidates.push_back(makeVerticalSpread(symbol, nearExpiry, true, atm - offset, atm + step + offset)); break;
+            case 1: candidates.push_back(makeStraddle(symbol, farExpiry, atm + offset)); break;
+            case 2: candidates.push_back(makeStrangle(symbol, nearExpiry, atm - step - offset, atm + step + offset)); break;
+            case 3: candidates.push_back(makeIronCondor(symbol, nearExpiry, atm - 2 * step - offset, atm - step - offset,
+                                                        atm + step + offset, atm + 2 * step + offset)); break;
+            default: candidates.push_back(makeCalendarSpread(symbol, nearExpiry, farExpiry, i % 2 == 0, atm + offset)); break;
+        }
+    }
+    size_t legs = 0;
+    for (const Strategy& candidate : candidates) legs += candidate.legs.size();
+
+    std::vector<double> batchMillis;
+    StrategyEvaluation evaluation;
+    for (size_t i = 0; i < iterations; ++i) {
+        evaluation = risk.evaluateStrategies(candidates, 10.0);
+        batchMillis.push_back(evaluation.elapsedMillis);
+    }
+
+    // Baseline: the scalar pricer and a risk array for every leg in turn
+    // As RiskManagement values contracts: to the end of the expiry day
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const double nearYears = yearsToExpiry(nearExpiry, now);
+    const double farYears = yearsToExpiry(farExpiry, now);
+    std::vector<double> scalarMillis;
+    std::vector<double> scalarPrice(candidates.size());
+    double riskArraySum = 0.0;   // Keeps the risk arrays from being optimised away
+    for (size_t i = 0; i < iterations; ++i) {
+        auto started = Clock::now();
+        for (size_t k = 0; k < candidates.size(); ++k) {
+            double price = 0.0;
+            for (const StrategyLeg& leg : candidates[k].legs) {
+                size_t u = std::stoul(std::string(leg.instrument.underlying + 3));
+                double t = std::strcmp(leg.instrument.expiry, nearExpiry) == 0 ? nearYears : farYears;
+                BlackScholesModel::OptionParameters params{spots[u], leg.instrument.strike, 0.02, 0.20, t,
+                                                           leg.instrument.isCall};
+                price += leg.ratio * BlackScholesModel::calculateOptionPrice(params);
+                riskArraySum += BlackScholesModel::calculateGreeks(params).delta;
+                riskArraySum += contractRiskArray(margin, spots[u], leg.instrument.strike,
+                                                  leg.instrument.isCall, t, 0.02, 0.20)[0];
+            }
+            scalarPrice[k] = price;
+        }
+        scalarMillis.push_back(std::chrono::duration<double, std::milli>(Clock::now() - started).count());
+    }
+
+    size_t priced = 0, accepted = 0;
+    double worstDelta = 0.0, bestMargin = 0.0, priceError = 0.0;
+    for (size_t k = 0; k < candidates.size(); ++k) {
+        const StrategyImpact& impact = evaluation.impacts[k];
+        priceError = std::max(priceError, std::abs(impact.price - scalarPrice[k]));
+        priced += impact.priced;
+        accepted += impact.withinLimits;
+        worstDelta = std::max(worstDelta, std::abs(impact.greeks.delta));
+        bestMargin = std::min(bestMargin, impact.marginChange);
+    }
+
+    std::cout << candidates.size() << " candidates, " << legs << " legs, " << evaluation.contractsPriced
+              << " distinct contracts across " << underlyings << " underlyings\n"
+              << std::fixed << std::setprecision(3)
+              << "evaluateStrategies   p50 " << std::setw(9) << percentile(batchMillis, 0.5) << " ms"
+              << "  p99 " << std::setw(9) << percentile(batchMillis, 0.99) << " ms\n"
+              << "scalar leg loop      p50 " << std::setw(9) << percentile(scalarMillis, 0.5) << " ms"
+              << "  p99 " << std::setw(9) << percentile(scalarMillis, 0.99) << " ms"
+              << "  (pricing only, no margin)\n"
+              << "Speedup: " << std::setprecision(2)
+              << percentile(scalarMillis, 0.5) / percentile(batchMillis, 0.5) << "x\n"
+              << priced << " priced, " << accepted << " within limits; largest delta change "
+              << std::setprecision(1) << worstDelta << ", largest margin reduction " << -bestMargin << "\n";
+
+    std::cout << "Largest strategy price difference from the scalar pricer: " << std::scientific
+              << std::setprecision(2) << priceError << " (checksum " << riskArraySum << ")\n";
+    return 0;
+}
@@ -0,0 +1,239 @@
+// Measures write-ahead log append latency under group commit (against an
+// fsync per event), from several threads sharing one lane and each on its
+// own, and OMS recovery time from snapshot plus log tail. Then checks that
+// a restart with a different shard count is refused; the run fails if not.
+// Usage: wal_bench [orders] [fsync events] [threads]
+#include "FileUtils.hpp"
+#include "OrderManagementSystem.hpp"
+#include "OrderStore.hpp"
+#include "WriteAheadLog.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::string makeTempDirectory() {
+        char path[] = "/tmp/wal_bench.XXXXXX";
+        if (!::mkdtemp(path)) {
+            throw std::runtime_error("mkdtemp failed");
+        }
+        return path;
+    }
+
+    void removeDirectory(const std::string& directory) {
+        for (const auto& name : listFiles(directory, "", "")) {
+            if (name != "." && name != "..") ::unlink((directory + "/" + name).c_str());
+        }
+        ::rmdir(directory.c_str());
+    }
+
+    void removeOmsDirectory(const std::string& directory) {
+        removeDirectory(directory + "/archive");
+        removeDirectory(directory);
+    }
+
+    OrderRecord makeRecord() {
+        OptionOrder order{};
+        order.underlying = "SPY";
+        order.optionType = "CALL";
+        order.strike = 450.0;
+        order.expiry = "2099-12-17";
+        order.quantity = 1;
+        order.type = OptionOrder::Type::BUY_TO_OPEN;
+        order.orderType = OptionOrder::OrderType::LIMIT;
+        order.limitPrice = 1.25;
+        order.timeInForce = OptionOrder::TimeInForce::GTC;
+        return makeOrderRecord(order);
+    }
+
+    void reportLatencies(const std::string& name, std::vector<double>& nanos) {
+        std::sort(nanos.begin(), nanos.end());
+        auto at = [&](double q) { return nanos[static_cast<size_t>(q * (nanos.size() - 1))]; };
+        std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(0)
+                  << " p50 " << std::setw(8) << at(0.50) << " ns"
+                  << "  p99 " << std::setw(8) << at(0.99) << " ns"
+                  << "  p99.9 " << std::setw(9) << at(0.999) << " ns"
+                  << "  max " << std::setw(10) << nanos.back() << " ns\n";
+    }
+
+    // events in total, split across threads; with separateLanes each thread
+    // appends to its own lane, as each OMS shard does
+    void benchGroupCommit(size_t events, size_t threads, bool separateLanes) {
+        std::string directory = makeTempDirectory();
+        const size_t perThread = events / threads;
+        std::vector<std::vector<double>> latencies(threads);
+
+        WriteAheadLog::Options options;
+        options.lanes = separateLanes ? threads : 1;
+        WriteAheadLog wal(directory, options);
+        wal.recover(0, [](const OrderEvent&) {});
+        wal.start();
+
+        auto start = Clock::now();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                OrderRecord record = makeRecord();
+                latencies[t].reserve(perThread);
+                for (size_t i = 0; i < perThread; ++i) {
+                    record.handle = t * perThread + i + 1;
+                    auto before = Clock::now();
+                    wal.append(OrderEvent::Type::SUBMITTED, record, t);
+                    latencies[t].push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+                }
+            });
+        }
+        for (std::thread& worker : workers) worker.join();
+        wal.waitDurable(wal.lastSequence());
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        WriteAheadLog::Stats stats = wal.getStats();
+        wal.stop();
+
+        // Recovery checks every sequence made it to disk in order
+        size_t recovered;
+        {
+            WriteAheadLog check(directory);
+            recovered = check.recover(0, [](const OrderEvent&) {});
+        }
+
+        std::vector<double> all;
+        for (const auto& perWorker : latencies) all.insert(all.end(), perWorker.begin(), perWorker.end());
+        std::string name = "group commit, " + std::to_string(threads) + " thread" + (threads > 1 ? "s" : "") +
+                           (threads > 1 ? (separateLanes ? ", own lanes" : ", one lane") : "");
+        reportLatencies(name, all);
+        const size_t appended = perThread * threads;
+        std::cout << "  " << appended << " events durable in " << std::setprecision(3) << seconds << " s ("
+                  << std::setprecision(0) << appended / seconds << " events/s), "
+                  << stats.batchesFlushed << " fsyncs, "
+                  << std::setprecision(1) << static_cast<double>(appended) / std::max<uint64_t>(stats.batchesFlushed, 1)
+                  << " events per fsync, " << recovered << " recovered\n";
+        removeDirectory(directory);
+    }
+
+    // Baseline: what the log would cost with a write and fdatasync per event
+    void benchSyncPerEvent(size_t events) {
+        std::string directory = makeTempDirectory();
+        std::string path = directory + "/sync.log";
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        OrderEvent event{};
+        event.order = makeRecord();
+        std::vector<double> latencies;
+        latencies.reserve(events);
+
+        for (size_t i = 0; i < events; ++i) {
+            event.sequence = i + 1;
+            auto before = Clock::now();
+            if (::write(fd, &event, sizeof(event)) != static_cast<ssize_t>(sizeof(event)) || ::fdatasync(fd) != 0) {
+                std::cerr << "write failed\n";
+                break;
+            }
+            latencies.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+        }
+        ::close(fd);
+
+        reportLatencies("write+fdatasync per event", latencies);
+        removeDirectory(directory);
+    }
+
+    // Submits orders through the OMS, filling every other one, optionally
+    // snapshotting halfway, then measures a cold restart from the directory
+    void benchRecovery(size_t orders, bool snapshotHalfway) {
+        std::string directory = makeTempDirectory();
+        OrderRecord record = makeRecord();
+
+        auto* coutBuffer = std::cout.rdbuf(nullptr);
+        auto* cerrBuffer = std::cerr.rdbuf(nullptr);
+        double writeSeconds;
+        {
+            OrderManagementSystem oms(orders);
+            oms.enablePersistence(directory, std::chrono::hours(24));
+            oms.start();
+            auto start = Clock::now();
+            for (size_t i = 0; i < orders; ++i) {
+                OrderHandle handle = oms.submitOrder(record);
+                if (i % 2 == 0) oms.onOrderFilled(handle, 0, 1.25);
+                if (snapshotHalfway && i == orders / 2) oms.takeSnapshot();
+            }
+            writeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+            oms.stop();
+        }
+
+        RecoveryStats stats;
+        size_t positions;
+        {
+            OrderManagementSystem oms(orders);
+            stats = oms.enablePersistence(directory, std::chrono::hours(24));
+            positions = oms.getPositions().size();
+        }
+        std::cout.rdbuf(coutBuffer);
+        std::cerr.rdbuf(cerrBuffer);
+
+        std::cout << (snapshotHalfway ? "snapshot + log tail" : "log only") << ": "
+                  << orders << " orders written in " << std::setprecision(2) << writeSeconds << " s; recovered "
+                  << stats.ordersRecovered << " orders (" << stats.snapshotOrders << " from snapshot, "
+                  << stats.eventsReplayed << " events replayed, " << positions << " positions) in "
+                  << std::setprecision(1) << stats.elapsedMillis << " ms\n";
+        removeOmsDirectory(directory);
+    }
+
+    // Orders on several underlyings, from the default shard count, then a
+    // restart with half the shards, from the log alone and from a snapshot;
+    // both must be refused rather than split orders from their positions
+    bool checkShardCountChange() {
+        bool ok = true;
+        for (bool snapshot : {false, true}) {
+            std::string directory = makeTempDirectory();
+            auto* coutBuffer = std::cout.rdbuf(nullptr);
+            {
+                OrderManagementSystem oms(1024);
+                oms.enablePersistence(directory, std::chrono::hours(24));
+                oms.start();
+                OrderRecord record = makeRecord();
+                for (int u = 0; u < 16; ++u) {
+                    std::snprintf(record.instrument.underlying, sizeof(record.instrument.underlying), "U%02d", u);
+                    oms.onOrderFilled(oms.submitOrder(record), 0, 1.25);
+                }
+                if (snapshot) oms.takeSnapshot();
+                oms.stop();
+            }
+            bool refused = false;
+            try {
+                OrderManagementSystem oms(1024, OrderManagementSystem::DEFAULT_SHARD_COUNT / 2);
+                oms.enablePersistence(directory, std::chrono::hours(24));
+            } catch (const std::runtime_error&) {
+                refused = true;
+            }
+            std::cout.rdbuf(coutBuffer);
+            std::cout << "restart with half the shards (" << (snapshot ? "snapshot" : "log only") << "): "
+                      << (refused ? "refused" : "accepted  FAILED") << "\n";
+            ok = ok && refused;
+            removeOmsDirectory(directory);
+        }
+        return ok;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t orders = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    const size_t syncEvents = argc > 2 ? std::stoul(argv[2]) : 2000;
+    const size_t threads = argc > 3 ? std::stoul(argv[3]) : 4;
+
+    std::cout << "Event size on disk: " << sizeof(OrderEvent) << " bytes + frame header\n";
+    benchGroupCommit(orders, 1, false);
+    benchGroupCommit(orders, threads, false);
+    benchGroupCommit(orders, threads, true);
+    benchSyncPerEvent(syncEvents);
+    benchRecovery(orders, true);
+    benchRecovery(orders, false);
+    return checkShardCountChange() ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+// Compares the v1 and v2 wire schemas message by message: encoded bytes,
+// the CPU to build and serialize each message, and the CPU to parse it.
+// Covers a single tick, a batch of ticks, a full option chain and an
+// order. Protobuf only: no transport, so the figures are per message on
+// one core.
+// Usage: wire_format_bench [contracts] [iterations] [batch size]
+#include "InstrumentRegistry.hpp"
+#include "MarketDataHandler.hpp"
+#include "market_data.pb.h"
+#include "order_management.pb.h"
+#include "services/wire_v2.hpp"
+#include "trading_v2.pb.h"
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        size_t bytes{0};
+        double buildNanos{0.0};       // Fill and serialize, as a server sends it
+        double parseNanos{0.0};
+    };
+
+    // Builds and serializes the message, then parses it back, each the
+    // given number of times; the string and messages are reused, as a
+    // stream's would be
+    template <class Message, class Fill>
+    Result measure(size_t iterations, Fill fill) {
+        Message message;
+        std::string bytes;
+        Result result;
+
+        auto started = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            message.Clear();
+            fill(message);
+            message.SerializeToString(&bytes);
+        }
+        result.buildNanos = std::chrono::duration<double, std::nano>(Clock::now() - started).count() / iterations;
+        result.bytes = bytes.size();
+
+        Message parsed;
+        started = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            parsed.ParseFromString(bytes);
+        }
+        result.parseNanos = std::chrono::duration<double, std::nano>(Clock::now() - started).count() / iterations;
+        return result;
+    }
+
+    void report(const std::string& name, const Result& v1, const Result& v2, size_t ticks) {
+        auto row = [&](const char* version, const Result& result) {
+            std::cout << std::left << std::setw(26) << (name + " " + version) << std::right << std::fixed
+                      << std::setw(10) << result.bytes << " B"
+                      << std::setprecision(1) << std::setw(9) << static_cast<double>(result.bytes) / ticks << " B/tick"
+                      << std::setprecision(0) << std::setw(10) << result.buildNanos << " ns build"
+                      << std::setw(10) << result.parseNanos << " ns parse\n";
+        };
+        row("v1", v1);
+        row("v2", v2);
+        std::cout << std::left << std::setw(26) << (name + " v2/v1") << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(12) << static_cast<double>(v2.bytes) / v1.bytes << "x"
+                  << std::setw(20) << v2.buildNanos / v1.buildNanos << "x"
+                  << std::setw(19) << v2.parseNanos / v1.parseNanos << "x\n\n";
+    }
+
+    void fillV1(const OptionData& data, trading::MarketDataResponse* response) {
+        response->set_symbol(data.underlying);
+        response->set_option_type(data.optionType);
+        response->set_strike(data.strike);
+        response->set_bid(data.bid);
+        response->set_ask(data.ask);
+        response->set_price(data.lastPrice);
+        response->set_volume(data.volume);
+        response->set_implied_volatility(data.impliedVol);
+        response->set_delta(data.delta);
+        response->set_gamma(data.gamma);
+        response->set_theta(data.theta);
+        response->set_vega(data.vega);
+        response->set_rho(data.rho);
+        response->set_timestamp(std::chrono::system_clock::now().time_since_epoch().count());
+    }
+
+    // A strike ladder over ten expiries, with quoted prices and Greeks as
+    // the pricer produces them (not round numbers)
+    std::vector<OptionData> makeChain(size_t contracts) {
+        std::mt19937_64 rng(11);
+        std::uniform_real_distribution<double> noise(0.0, 1.0);
+        std::vector<OptionData> chain(contracts);
+        for (size_t c = 0; c < contracts; ++c) {
+            char expiry[16];
+            std::snprintf(expiry, sizeof(expiry), "2099-%02zu-15", c / 2 % 10 + 1);
+            OptionData& data = chain[c];
+            data.underlying = "SPY";
+            data.optionType = c % 2 ? "PUT" : "CALL";
+            data.expiry = expiry;
+            data.strike = 300.0 + static_cast<double>(c / 20);
+            data.lastPrice = std::round((0.5 + 20.0 * noise(rng)) * 100.0) / 100.0;
+            data.bid = data.lastPrice - 0.05;
+            data.ask = data.lastPrice + 0.05;
+            data.volume = std::floor(5000.0 * noise(rng));
+            data.impliedVol = 0.15 + 0.2 * noise(rng);
+            data.delta = (c % 2 ? -1.0 : 1.0) * noise(rng);
+            data.gamma = 0.05 * noise(rng);
+            data.theta = -0.2 * noise(rng);
+            data.vega = 0.3 * noise(rng);
+            data.rho = 0.1 * noise(rng);
+        }
+        return chain;
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t contracts = argc > 1 ? std::stoul(argv[1]) : 2000;
+    const size_t iterations = argc > 2 ? std::stoul(argv[2]) : 200000;
+    const size_t batchSize = argc > 3 ? std::stoul(argv[3]) : 100;
+
+    std::vector<OptionData> ticks = makeChain(contracts);
+    InstrumentRegistry instruments;
+    std::vector<uint32_t> ids;
+    OptionChain chain;
+    chain.underlyingPrice = 410.37;
+    for (const OptionData& tick : ticks) {
+        ids.push_back(instruments.idFor(makeInstrumentKey(tick.underlying, tick.optionType, tick.strike, tick.expiry)));
+        auto& side = tick.optionType == "CALL" ? chain.calls : chain.puts;
+        side[{tick.expiry, tick.strike}] = tick;
+    }
+    std::cout << contracts << " contracts, " << iterations << " iterations per message\n\n";
+
+    size_t next = 0;
+    report("tick",
+           measure<trading::MarketDataResponse>(iterations, [&](trading::MarketDataResponse& message) {
+               fillV1(ticks[next++ % contracts], &message);
+           }),
+           measure<trading::v2::Quote>(iterations, [&](trading::v2::Quote& message) {
+               size_t c = next++ % contracts;
+               fillQuote(ids[c], ticks[c], &message);
+           }),
+           1);
+
+    // A conflated batch as SubscribeMarketData sends it; v2 without the
+    // instrument definitions, which each stream gets only once per contract
+    const size_t batchIterations = iterations / batchSize + 1;
+    report("batch",
+           measure<trading::MarketDataBatch>(batchIterations, [&](trading::MarketDataBatch& message) {
+               message.set_sequence(next);
+               for (size_t i = 0; i < batchSize; ++i) fillV1(ticks[next++ % contracts], message.add_ticks());
+               message.set_timestamp(std::chrono::system_clock::now().time_since_epoch().count());
+           }),
+           measure<trading::v2::QuoteBatch>(batchIterations, [&](trading::v2::QuoteBatch& message) {
+               message.set_sequence(next);
+               for (size_t i = 0; i < batchSize; ++i) {
+                   size_t c = next++ % contracts;
+                   fillQuote(ids[c], ticks[c], message.add_quotes());
+               }
+               message.set_timestamp_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count());
+           }),
+           batchSize);
+
+    const size_t chainIterations = iterations / contracts + 1;
+    report("chain",
+           measure<trading::OptionChainResponse>(chainIterations, [&](trading::OptionChainResponse& message) {
+               for (const auto& entry : chain.calls) fillV1(entry.second, message.add_calls());
+               for (const auto& entry : chain.puts) fillV1(entry.second, message.add_puts());
+               message.set_underlying_price(chain.underlyingPrice);
+           }),
+           measure<trading::v2::OptionChainColumns>(chainIterations, [&](trading::v2::OptionChainColumns& message) {
+               fillChainColumns(chain, "", instruments, &message);
+               message.set_underlying("SPY");
+               message.set_underlying_price(toFixedPrice(chain.underlyingPrice));
+           }),
+           contracts);
+
+    report("order",
+           measure<trading::OrderRequest>(iterations, [&](trading::OrderRequest& message) {
+               const OptionData& contract = ticks[next++ % contracts];
+               message.set_symbol(contract.underlying);
+               message.set_option_type(contract.optionType);
+               message.set_strike(contract.strike);
+               message.set_expiration_date(contract.expiry);
+               message.set_side("BUY");
+               message.set_order_type("LIMIT");
+               message.set_quantity(10);
+               message.set_price(contract.bid);
+               message.set_time_in_force("DAY");
+           }),
+           measure<trading::v2::OrderRequest>(iterations, [&](trading::v2::OrderRequest& message) {
+               size_t c = next++ % contracts;
+               message.set_instrument_id(ids[c]);
+               message.set_side(trading::v2::BUY);
+               message.set_order_type(trading::v2::LIMIT);
+               message.set_quantity(10);
+               message.set_limit_price(toFixedPrice(ticks[c].bid));
+           }),
+           1);
+    return 0;
+}
@@ -0,0 +1,199 @@
+#ifndef BINARY_LOG_HPP
+#define BINARY_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include "TscClock.hpp"
+
+// Asynchronous logging for paths that run per order or per event. A call
+// site copies its format's ID, a TSC timestamp and the raw argument values
+// into a ring owned by the calling thread: no lock, no formatting and no
+// syscall. A background thread drains every ring, formats the records in
+// timestamp order and writes each batch with one write().
+//
+// Formats are string literals with "{}" for each argument; the macros
+// check the count at compile time. Arguments may be integers, floating
+// point, bool, NUL-terminated C strings and char arrays, and std::string;
+// strings are copied, up to MAX_STRING_BYTES. A full ring drops the record
+// rather than wait, and the drops are reported in the log. Nothing is
+// recorded while the log is stopped.
+//
+// Start-up, shutdown and fatal messages stay on std::cerr, which is
+// synchronous: a record still in a ring is lost if the process aborts.
+
+enum class LogLevel : uint8_t { DEBUG, INFO, WARN, ERROR };
+
+// One logging statement; the macros make it a function-local static
+struct LogSite {
+    LogLevel level;
+    const char* format;
+    const char* file;
+    int line;
+    std::atomic<uint32_t> id;   // Assigned on first use, 0 until then
+};
+
+struct LogOptions {
+    std::string path = "-";                         // "-" for stdout; appended to otherwise
+    LogLevel level = LogLevel::INFO;                // Lower levels are not recorded
+    size_t threadBufferBytes = 1 << 20;             // Per logging thread
+    std::chrono::milliseconds flushInterval{10};    // Upper bound on a record's wait
+};
+
+class BinaryLog {
+public:
+    struct Stats {
+        uint64_t recordsWritten;
+        uint64_t recordsDropped;
+        uint64_t batchesWritten;
+        uint64_t bytesWritten;
+        size_t threadBuffers;
+    };
+
+    static constexpr size_t MAX_STRING_BYTES = 1024;
+
+    // The argument kinds a record can hold, in the order a site's types list them
+    enum class ArgType : uint8_t { END, INT, UINT, DOUBLE, BOOL, STRING };
+
+    // Throws std::runtime_error if the file cannot be opened. stop()
+    // drains every ring before it returns.
+    static void start(const LogOptions& options = LogOptions());
+    static void stop();
+    static Stats stats();
+
+    template <class... Args>
+    static void write(LogSite& site, const Args&... args) {
+        if (!recording(site.level)) return;
+        uint32_t id = site.id.load(std::memory_order_acquire);
+        if (id == 0) {
+            static const ArgType types[] = {argType<Args>()..., ArgType::END};
+            id = registerSite(site, types);
+        }
+
+        const size_t size = HEADER_BYTES + (0 + ... + encodedSize(args));
+        char* record = reserve(size);
+        if (!record) return;
+        RecordHeader header{id, static_cast<uint32_t>(size), TscClock::now()};
+        std::memcpy(record, &header, sizeof(header));
+        [[maybe_unused]] char* out = record + HEADER_BYTES;
+        (encode(out, args), ...);
+        commit();
+    }
+
+private:
+    struct RecordHeader {
+        uint32_t id;
+        uint32_t size;        // Header included, before padding to 8 bytes
+        uint64_t timestampTicks;  // TscClock; the log thread converts to wall time
+    };
+    static constexpr size_t HEADER_BYTES = sizeof(RecordHeader);
+
+    static std::atomic<int> minLevel_;   // Above every level while stopped
+
+    static bool recording(LogLevel level) {
+        return static_cast<int>(level) >= minLevel_.load(std::memory_order_acquire);
+    }
+
+    static uint32_t registerSite(LogSite& site, const ArgType* types);
+    static char* reserve(size_t size);   // Null if the ring is full
+    static void commit();
+
+    template <class T>
+    static constexpr ArgType argType() {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            return ArgType::BOOL;
+        } else if constexpr (std::is_same_v<U, char*> || std::is_same_v<U, const char*> ||
+                             std::is_same_v<U, std::string>) {
+            return ArgType::STRING;
+        } else if constexpr (std::is_floating_point_v<U>) {
+            return ArgType::DOUBLE;
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            return ArgType::INT;
+        } else if constexpr (std::is_integral_v<U>) {
+            return ArgType::UINT;
+        } else {
+            static_assert(std::is_arithmetic_v<U>, "Unsupported log argument type");
+            return ArgType::END;
+        }
+    }
+
+    static size_t stringLength(const char* text) {
+        return text ? strnlen(text, MAX_STRING_BYTES) : 0;
+    }
+    static size_t stringLength(const std::string& text) {
+        return text.size() < MAX_STRING_BYTES ? text.size() : MAX_STRING_BYTES;
+    }
+
+    template <class T>
+    static size_t encodedSize(const T& value) {
+        if constexpr (argType<T>() == ArgType::STRING) {
+            return sizeof(uint16_t) + stringLength(value);
+        } else if constexpr (argType<T>() == ArgType::BOOL) {
+            return 1;
+        } else {
+            return 8;
+        }
+    }
+
+    template <class T>
+    static void encode(char*& out, const T& value) {
+        constexpr ArgType type = argType<T>();
+        if constexpr (type == ArgType::STRING) {
+            uint16_t length = static_cast<uint16_t>(stringLength(value));
+            std::memcpy(out, &length, sizeof(length));
+            const char* data;
+            if constexpr (std::is_same_v<std::decay_t<T>, std::string>) {
+                data = value.data();
+            } else {
+                data = value;
+            }
+            if (length > 0) std::memcpy(out + sizeof(length), data, length);
+            out += sizeof(length) + length;
+        } else if constexpr (type == ArgType::BOOL) {
+            *out++ = value ? 1 : 0;
+        } else if constexpr (type == ArgType::DOUBLE) {
+            double converted = static_cast<double>(value);
+            std::memcpy(out, &converted, 8);
+            out += 8;
+        } else if constexpr (type == ArgType::INT) {
+            int64_t converted = static_cast<int64_t>(value);
+            std::memcpy(out, &converted, 8);
+            out += 8;
+        } else {
+            uint64_t converted = static_cast<uint64_t>(value);
+            std::memcpy(out, &converted, 8);
+            out += 8;
+        }
+    }
+};
+
+constexpr size_t logPlaceholderCount(const char* format) {
+    size_t count = 0;
+    for (; *format; ++format) {
+        if (format[0] == '{' && format[1] == '}') ++count;
+    }
+    return count;
+}
+
+template <class... Args>
+std::integral_constant<size_t, sizeof...(Args)> logArity(const Args&...);
+
+#define BINARY_LOG(logLevel, logFormat, ...)                                                          \
+    do {                                                                                              \
+        static_assert(logPlaceholderCount(logFormat) == decltype(logArity(__VA_ARGS__))::value,     \
+                      "Log format placeholders do not match the arguments");                         \
+        static LogSite binaryLogSite{logLevel, logFormat, __FILE__, __LINE__, {0}};                   \
+        BinaryLog::write(binaryLogSite, ##__VA_ARGS__);                                               \
+    } while (false)
+
+#define LOG_DEBUG(...) BINARY_LOG(LogLevel::DEBUG, __VA_ARGS__)
+#define LOG_INFO(...) BINARY_LOG(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARN(...) BINARY_LOG(LogLevel::WARN, __VA_ARGS__)
+#define LOG_ERROR(...) BINARY_LOG(LogLevel::ERROR, __VA_ARGS__)
+
+#endif
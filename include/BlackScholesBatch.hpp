@@ -0,0 +1,77 @@
+#ifndef BLACK_SCHOLES_BATCH_HPP
+#define BLACK_SCHOLES_BATCH_HPP
+
+#include <cstddef>
+#include "RiskMetrics.hpp"
+
+// Market inputs shared by every contract in a batch: one underlying, one
+// expiry. Hoisting them out of the loop leaves only the strike-dependent
+// terms per contract.
+struct BatchMarket {
+    double spot;
+    double riskFreeRate;
+    double volatility;
+    double timeToExpiry;   // Years; at or below zero prices at intrinsic
+};
+
+// The same expiry under a block of scenarios, one entry per scenario
+struct ScenarioMarkets {
+    const double* spot;
+    const double* logSpot;
+    const double* volatility;
+    size_t count;              // At most BlackScholesBatch::MAX_SCENARIOS
+    double riskFreeRate;
+    double timeToExpiry;
+};
+
+// Contracts in struct-of-arrays form, so the kernel loads each field as a
+// contiguous vector. callSign is +1 for calls and -1 for puts.
+struct BatchContracts {
+    const double* strike;
+    const double* logStrike;   // log(strike), precomputed once per book
+    const double* callSign;
+    const double* quantity;
+    size_t count;
+};
+
+// Per-contract outputs, one array per field, each with room for the batch
+struct BatchGreeks {
+    double* value;
+    double* delta;
+    double* gamma;
+    double* theta;
+    double* vega;
+    double* rho;
+};
+
+// Vectorized Black-Scholes over a batch of contracts. The loops carry no
+// branches and no calls into the scalar pricer, so the compiler turns them
+// into SIMD code. This translation unit alone is built with -fopenmp-simd
+// and -ffast-math; the latter lets glibc supply vector exp(). On x86-64
+// each kernel also gets an AVX2 clone, selected at load time.
+// Conventions match BlackScholesModel: theta per year, vega and rho per 1%.
+// Strikes must be positive; inputs are not validated.
+class BlackScholesBatch {
+public:
+    // Quantity-weighted sum of value and Greeks over the batch
+    static GreekTotals priceAndSum(const BatchMarket& market, const BatchContracts& contracts);
+
+    // Value and Greeks of each contract per unit (quantities are ignored),
+    // for callers that need the contracts' risk one by one
+    static void priceEach(const BatchMarket& market, const BatchContracts& contracts, const BatchGreeks& out);
+
+    // Quantity-weighted value only: the inner loop of scenario revaluation
+    static double valueSum(const BatchMarket& market, const BatchContracts& contracts);
+
+    // Adds the batch's quantity-weighted value under each scenario to
+    // values[0..count). Vectorized across scenarios rather than contracts,
+    // so it stays efficient for groups of only a few contracts.
+    static void addScenarioValues(const ScenarioMarkets& markets, const BatchContracts& contracts, double* values);
+
+    static constexpr size_t MAX_SCENARIOS = 64;
+
+    // Standard normal CDF, accurate to about 1e-14, without branches
+    static double normalCDF(double x);
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef DATE_UTILS_HPP
+#define DATE_UTILS_HPP
+
+#include <cstdint>
+
+// Calendar arithmetic on UTC days since the Unix epoch (proleptic
+// Gregorian), without locale, time zone or stream machinery. The one
+// exchange time zone the OMS needs, New York, is computed from its rules.
+
+constexpr int64_t NANOS_PER_DAY = 24LL * 60 * 60 * 1000000000;
+
+inline int64_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yearOfEra = year - era * 400;
+    int64_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+inline void civilFromDays(int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t monthIndex = (5 * dayOfYear + 2) / 153;
+    day = static_cast<int>(dayOfYear - (153 * monthIndex + 2) / 5 + 1);
+    month = static_cast<int>(monthIndex < 10 ? monthIndex + 3 : monthIndex - 9);
+    year = static_cast<int>(yearOfEra + era * 400 + (month <= 2));
+}
+
+// Parses a NUL-terminated YYYY-MM-DD date
+inline bool parseIsoDate(const char* date, int64_t& days) {
+    auto digits = [date](int from, int count, int& value) {
+        value = 0;
+        for (int i = from; i < from + count; ++i) {
+            if (date[i] < '0' || date[i] > '9') return false;
+            value = value * 10 + (date[i] - '0');
+        }
+        return true;
+    };
+
+    int year, month, day;
+    if (!digits(0, 4, year) || date[4] != '-' || !digits(5, 2, month) ||
+        date[7] != '-' || !digits(8, 2, day) || date[10] != '\0') {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+    days = daysFromCivil(year, month, day);
+    return true;
+}
+
+// Years of 365.25 days from nowNs to the end of a YYYY-MM-DD expiry day;
+// 1.0 if the date does not parse
+inline double yearsToExpiry(const char* expiry, int64_t nowNs) {
+    int64_t expiryDay;
+    if (!parseIsoDate(expiry, expiryDay)) return 1.0;
+    return static_cast<double>((expiryDay + 1) * NANOS_PER_DAY - nowNs) / (365.25 * NANOS_PER_DAY);
+}
+
+// Day containing a system_clock nanosecond timestamp (floors before 1970)
+inline int64_t dayOfNanos(int64_t nanos) {
+    return nanos >= 0 ? nanos / NANOS_PER_DAY : (nanos + 1) / NANOS_PER_DAY - 1;
+}
+
+// 0 for Sunday through 6 for Saturday
+inline int weekdayOfDays(int64_t days) {
+    int64_t weekday = (days + 4) % 7;   // 1970-01-01 was a Thursday
+    return static_cast<int>(weekday < 0 ? weekday + 7 : weekday);
+}
+
+constexpr int64_t NANOS_PER_HOUR = 60LL * 60 * 1000000000;
+
+// Offset of America/New_York from UTC at a UTC instant: -5 hours, or -4
+// during daylight saving time, which under the US rules in force since 2007
+// runs from 02:00 local on the second Sunday of March to 02:00 local on the
+// first Sunday of November
+inline int64_t newYorkUtcOffsetNs(int64_t utcNs) {
+    int year, month, day;
+    civilFromDays(dayOfNanos(utcNs), year, month, day);
+    auto firstSunday = [year](int inMonth) {
+        int64_t first = daysFromCivil(year, inMonth, 1);
+        return first + (7 - weekdayOfDays(first)) % 7;
+    };
+    int64_t daylightStart = (firstSunday(3) + 7) * NANOS_PER_DAY + 7 * NANOS_PER_HOUR;   // 02:00 EST
+    int64_t daylightEnd = firstSunday(11) * NANOS_PER_DAY + 6 * NANOS_PER_HOUR;          // 02:00 EDT
+    return utcNs >= daylightStart && utcNs < daylightEnd ? -4 * NANOS_PER_HOUR : -5 * NANOS_PER_HOUR;
+}
+
+// UTC instant of a New York wall-clock time, given as nanoseconds since the
+// epoch as if New York were UTC. Wall times skipped or repeated by a clock
+// change resolve to one side of it.
+inline int64_t newYorkToUtc(int64_t localNs) {
+    return localNs - newYorkUtcOffsetNs(localNs + 5 * NANOS_PER_HOUR);
+}
+
+#endif
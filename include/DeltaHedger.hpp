@@ -0,0 +1,111 @@
+#ifndef DELTA_HEDGER_HPP
+#define DELTA_HEDGER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "OrderStore.hpp"
+#include "WriteAheadLog.hpp"
+
+class OrderManagementSystem;
+class RiskManagement;
+
+// Net delta limits for one underlying, in units of the underlying. Once
+// |delta| exceeds trigger, a hedge brings it back to target on the same
+// side (0 hedges flat). The gap between the two is the hysteresis: the
+// hedged book has to move by trigger - target before it is hedged again.
+struct HedgeBand {
+    double trigger = 100.0;
+    double target = 0.0;
+};
+
+struct DeltaHedgerConfig {
+    HedgeBand band;                                   // Default for every underlying
+    std::unordered_map<std::string, HedgeBand> bands; // Per-underlying overrides
+    double minHedgeQuantity = 1.0;                    // Smaller hedges are not worth an order
+    int32_t maxHedgeQuantity = 10000;                 // Per order; larger hedges take several
+    std::chrono::milliseconds minInterval{250};       // Between hedge orders on one underlying
+    uint32_t maxOrdersPerSecond = 20;                 // Across all underlyings
+};
+
+// Hedges each underlying's net delta with market IOC orders on the
+// underlying itself. Feed it every spot tick after the risk manager has
+// taken it; fills arrive through the OMS order event stream. Each event
+// re-checks only its own underlying against RiskManagement's incrementally
+// maintained delta, so the decision takes microseconds and never waits for
+// a full risk recompute.
+//
+// Decisions are made on the thread that delivers the event; the orders are
+// submitted from the hedger's own thread, because fills are delivered under
+// an OMS shard lock. One hedge per underlying is working at a time; while
+// throttled, the next event after the interval re-checks.
+class DeltaHedger {
+public:
+    struct Stats {
+        uint64_t evaluations{0};       // Ticks and fills checked
+        uint64_t hedgesDecided{0};
+        uint64_t hedgesSubmitted{0};
+        uint64_t hedgesFilled{0};
+        uint64_t hedgesFailed{0};      // Rejected by the OMS, the engine or the risk check
+        uint64_t throttled{0};         // Decisions held back by minInterval or the order rate
+        double meanDecisionNanos{0.0}; // From the event reaching the hedger to its decision
+        double maxDecisionNanos{0.0};
+    };
+
+    // Registers for the OMS order events, so construct it before oms.start()
+    DeltaHedger(OrderManagementSystem& oms, RiskManagement& risk,
+                DeltaHedgerConfig config = DeltaHedgerConfig());
+    ~DeltaHedger();
+
+    void start();
+    void stop();
+
+    void onUnderlyingPrice(const std::string& underlying, double spot);
+
+    Stats getStats() const;
+
+private:
+    // Callers hold mutex_
+    struct UnderlyingState {
+        OrderHandle workingOrder{INVALID_ORDER_HANDLE};
+        bool submitting{false};          // Decided; the order is not in the OMS yet
+        std::chrono::steady_clock::time_point lastOrder{};
+    };
+
+    struct HedgeRequest {
+        std::string underlying;
+        int32_t quantity;                // Signed
+    };
+
+    void onOrderEvent(OrderEvent::Type type, const OrderRecord& order);
+    void evaluate(const std::string& underlying, std::chrono::steady_clock::time_point received);
+    bool takeOrderToken(std::chrono::steady_clock::time_point now);
+    void finishHedge(UnderlyingState& state, bool filled);
+    void run();
+    void submit(const HedgeRequest& request);
+
+    OrderManagementSystem& oms_;
+    RiskManagement& risk_;
+    const DeltaHedgerConfig config_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_{false};
+    std::unordered_map<std::string, UnderlyingState> states_;
+    std::deque<HedgeRequest> requests_;
+    std::thread thread_;
+
+    // Order rate: a token bucket refilled at maxOrdersPerSecond
+    double tokens_;
+    std::chrono::steady_clock::time_point tokensRefilled_;
+
+    Stats stats_;
+    double totalDecisionNanos_{0.0};
+};
+
+#endif
@@ -2,25 +2,39 @@
 #define EXECUTION_ENGINE_HPP
 
 #include <vector>
-#include <queue>
 #include <string>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
 #include <thread>
 #include <memory>
+#include <chrono>
 #include "OptionTypes.hpp"
+#include "OrderStore.hpp"
+#include "RingQueue.hpp"
+#include "TscClock.hpp"
 
 class OrderManagementSystem;
 
 class ExecutionEngine {
 public:
+    struct CancelStats {
+        uint64_t cancelsAcked;
+        uint64_t staleCopiesDropped;
+        double avgAckMicros;
+        double maxAckMicros;
+    };
+
     ExecutionEngine();
     ~ExecutionEngine();
 
     // Core execution methods
     void start();
     void stop();
-    void addOrder(const OptionOrder& order);
+    void addOrder(const OrderRecord& order);
+    void addOrder(const OptionOrder& order);  // orderId must be an OMS order ID
+    void cancelOrder(OrderHandle handle);
+    void replaceOrder(const OrderRecord& order);
     
     // OMS connection
     void setOrderManagementSystem(OrderManagementSystem* oms);
@@ -29,20 +43,44 @@ public:
     void setSimulatedSlippage(double slippage);
     void setSimulatedFillRate(double fillRate);
 
+    CancelStats getCancelStats() const;
+
 private:
+    struct EngineCommand {
+        enum class Kind { NEW, CANCEL, REPLACE };
+        Kind kind;
+        OrderRecord order;  // Only the handle is meaningful for CANCEL
+        uint64_t enqueueTicks;   // TscClock
+    };
+
+    // Live revision of the order occupying an OMS slot
+    struct LiveEntry {
+        OrderHandle handle;
+        uint32_t revision;
+    };
+
     // Internal processing methods
-    void processOrders();
-    void processOrder(const OptionOrder& order);
-    bool tryExecuteOrder(const OptionOrder& order);
-    double calculateFillPrice(const OptionOrder& order) const;
-    bool shouldFillOrder(const OptionOrder& order) const;
+    void enqueue(EngineCommand::Kind kind, const OrderRecord& order);
+    void processCommands();
+    void retryRestingOrders();
+    void retireOrder(const OrderRecord& order);
+    void processOrder(const OrderRecord& order);
+    bool tryExecuteOrder(const OrderRecord& order);
+    double calculateFillPrice(const OrderRecord& order) const;
+    bool shouldFillOrder(const OrderRecord& order) const;
     
     // Threading
     void executionLoop();
     
     // Member variables
-    std::queue<OptionOrder> orderQueue_;
+    RingQueue<EngineCommand> commandQueue_{QUEUE_CAPACITY};
     std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+
+    // Latest live revision per order, indexed by OMS slot (guarded by
+    // queueMutex_). Replace bumps it and cancel clears it, so stale queued
+    // copies are dropped in O(1).
+    std::vector<LiveEntry> liveOrders_;
     std::atomic<bool> running_{false};
     std::unique_ptr<std::thread> executionThread_;
     
@@ -57,6 +95,13 @@ private:
     std::atomic<uint64_t> totalOrdersProcessed_{0};
     std::atomic<uint64_t> totalOrdersFilled_{0};
     std::atomic<uint64_t> totalOrdersRejected_{0};
+    std::atomic<uint64_t> totalCancelsAcked_{0};
+    std::atomic<uint64_t> totalStaleDropped_{0};
+    std::atomic<uint64_t> cancelAckNanosTotal_{0};
+    std::atomic<uint64_t> cancelAckNanosMax_{0};
+
+    static constexpr std::chrono::milliseconds RESTING_RETRY_INTERVAL{100};
+    static constexpr size_t QUEUE_CAPACITY = 1 << 14;
 };
 
 #endif
\ No newline at end of file
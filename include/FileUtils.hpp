@@ -0,0 +1,47 @@
+#ifndef FILE_UTILS_HPP
+#define FILE_UTILS_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Read-only memory mapping of a whole file. An empty or missing file maps
+// to an empty view; other failures throw std::runtime_error.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    void release();
+
+    const char* data_{nullptr};
+    size_t size_{0};
+};
+
+// POSIX file helpers shared by the persistence code; all throw
+// std::runtime_error with the failing path and errno text.
+void ensureDirectory(const std::string& path);
+void syncDirectory(const std::string& path);
+void truncateFile(const std::string& path, size_t size);
+
+// Names (not paths) of regular files in a directory matching prefix and suffix, sorted
+std::vector<std::string> listFiles(const std::string& directory,
+                                   const std::string& prefix, const std::string& suffix);
+
+// Writes data to path atomically: temp file, fsync, rename, directory fsync
+void writeFileAtomic(const std::string& directory, const std::string& name,
+                     const std::vector<std::pair<const void*, size_t>>& parts);
+
+#endif
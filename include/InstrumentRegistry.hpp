@@ -0,0 +1,32 @@
+#ifndef INSTRUMENT_REGISTRY_HPP
+#define INSTRUMENT_REGISTRY_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "OrderStore.hpp"
+
+// Dense 32-bit instrument IDs, assigned to contracts on first sight and
+// never reused, so a compact wire format can send the ID in place of the
+// contract. IDs start at 1; 0 means none.
+class InstrumentRegistry {
+public:
+    uint32_t idFor(const InstrumentKey& key);   // Assigns the next ID to a new contract
+
+    bool find(const InstrumentKey& key, uint32_t& id) const;
+    bool lookup(uint32_t id, InstrumentKey& key) const;
+    size_t size() const;
+
+    // Every contract on the underlying, in ID order
+    std::vector<std::pair<uint32_t, InstrumentKey>> instrumentsOf(const std::string& underlying) const;
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<InstrumentKey, uint32_t> ids_;
+    std::vector<InstrumentKey> keys_;   // keys_[id - 1]
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MARGIN_MODEL_HPP
+#define MARGIN_MODEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// TIMS/SPAN-style scenario margin. Every contract carries a risk array: its
+// P&L per unit under a fixed set of spot and volatility scenarios, computed
+// whenever its market data changes. A class group (all contracts on one
+// underlying) sums its contracts' arrays weighted by quantity; its margin is
+// the worst loss across the scenarios. Class groups in the same product
+// group offset each other scenario by scenario, and the portfolio margin is
+// the sum over product groups.
+
+constexpr size_t MARGIN_SCENARIOS = 16;
+using RiskArray = std::array<double, MARGIN_SCENARIOS>;   // Per scenario; gains positive
+
+struct MarginParameters {
+    double priceScanRange = 0.15;        // Largest regular spot move, relative
+    double volScanRange = 0.25;          // Volatility move, relative
+    double extremeMoveMultiple = 3.0;    // Extreme spot moves, in price scan ranges
+    double extremeMoveCoverage = 0.35;   // Share of the extreme-move P&L that counts
+    double shortOptionMinimum = 0.0;     // Floor per unit of short option quantity
+    double productGroupOffset = 0.9;     // Share of one class group's gain that offsets another's loss
+    std::unordered_map<std::string, std::string> productGroups;   // Underlying to product group; others stand alone
+};
+
+// The standard sixteen: spot unchanged and up or down 1/3, 2/3 and 3/3 of the
+// scan range, each with volatility up and down, then the two extreme moves
+struct MarginScenario {
+    double spotMove;
+    double volMove;
+    double weight;
+};
+std::array<MarginScenario, MARGIN_SCENARIOS> marginScenarios(const MarginParameters& parameters);
+
+// Scenario markets for one underlying: the sixteen scenarios, then the
+// unshocked market in the last lane, laid out for
+// BlackScholesBatch::addScenarioValues
+struct MarginMarkets {
+    static constexpr size_t LANES = MARGIN_SCENARIOS + 1;
+    double spot[LANES];
+    double logSpot[LANES];
+    double volatility[LANES];
+
+    MarginMarkets(const MarginParameters& parameters, double spot, double volatility);
+
+    // Risk array from values priced in these lanes: weighted P&L against
+    // the unshocked lane
+    RiskArray riskArray(const MarginParameters& parameters, const double* values) const;
+};
+
+// Per-unit risk array of one contract; a strike of zero or less is the
+// underlying itself
+RiskArray contractRiskArray(const MarginParameters& parameters, double spot, double strike, bool isCall,
+                            double timeToExpiry, double riskFreeRate, double volatility);
+
+// Quantity-weighted risk of one class group
+struct ClassGroupRisk {
+    RiskArray pnl{};
+    double shortOptions{0.0};   // Short option quantity, for the minimum charge
+
+    // Adds (sign +1) or removes (sign -1) a position of the given quantity
+    void add(const RiskArray& unit, double quantity, bool option, double sign) {
+        for (size_t s = 0; s < MARGIN_SCENARIOS; ++s) pnl[s] += sign * quantity * unit[s];
+        if (option && quantity < 0.0) shortOptions -= sign * quantity;
+    }
+    void add(const ClassGroupRisk& other) {
+        for (size_t s = 0; s < MARGIN_SCENARIOS; ++s) pnl[s] += other.pnl[s];
+        shortOptions += other.shortOptions;
+    }
+};
+
+// Margin of one product group: per scenario, the class groups' losses less
+// the offset share of their gains (never more than the losses), at the
+// worst scenario, and no less than the short option minimum. If replaced
+// is one of the classes it is priced as replacement instead, which is how
+// a pre-trade check asks "what if" without touching the live arrays.
+double productGroupMargin(const std::vector<const ClassGroupRisk*>& classes, const MarginParameters& parameters,
+                          const ClassGroupRisk* replaced = nullptr, const ClassGroupRisk* replacement = nullptr);
+
+// Margin of a whole portfolio given each underlying's class group risk
+double portfolioMargin(const std::unordered_map<std::string, ClassGroupRisk>& classes,
+                       const MarginParameters& parameters);
+
+#endif
@@ -8,15 +8,33 @@
 #include <mutex>
 #include <unordered_map>
 #include <chrono>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 #include "OptionTypes.hpp"
 #include <curl/curl.h>
 #include <boost/asio.hpp>
 #include <nlohmann/json.hpp>
 #include "BlackScholesModel.hpp"
+#include "InstrumentRegistry.hpp"
+#include "SharedQuoteTable.hpp"
+
+// Every contract seen on one underlying, calls and puts keyed by
+// (expiry, strike), so each side iterates in chain order
+struct OptionChain {
+    using Contracts = std::map<std::pair<std::string, double>, OptionData>;
+
+    double underlyingPrice{0.0};
+    uint64_t version{0};   // Bumped by every quote or price applied to the chain
+    Contracts calls;
+    Contracts puts;
+};
 
 class MarketDataHandler {
 public:
     using DataCallback = std::function<void(const OptionData&)>;
+    using PriceCallback = std::function<void(const std::string& symbol, double price)>;
     
     MarketDataHandler(boost::asio::io_context& ioc, const std::string& apiKey);
     ~MarketDataHandler();
@@ -24,11 +42,31 @@ public:
     // Public interface
     void start();
     void stop();
-    void setDataCallback(DataCallback cb);
+    void addDataCallback(DataCallback cb);    // Each added callback sees every quote; add before start()
+    void setPriceCallback(PriceCallback cb);  // Underlying price on every quote
     void subscribeToSymbol(const std::string& symbol);
     void unsubscribeFromSymbol(const std::string& symbol);
     OptionData getLatestData(const std::string& symbol) const;
 
+    // The feed's own entry points, public so other sources (replays,
+    // simulations) can drive the same chains and callbacks
+    void applyUnderlyingPrice(const std::string& symbol, double price);
+    void applyQuote(const OptionData& data);
+
+    // False if nothing has been seen for the symbol
+    bool getOptionChain(const std::string& symbol, OptionChain& chain) const;
+    uint64_t getChainVersion(const std::string& symbol) const;   // 0 if none
+
+    // Publishes every quote applied from here on to a shared-memory table
+    // of that name, for SharedQuoteReaders in other processes; call before
+    // start(). Throws std::runtime_error if the table cannot be created.
+    void enableSharedQuotes(const std::string& name, uint32_t capacity = 65536);
+
+    // Every contract the feed has quoted has an ID by the time its quote
+    // reaches the data callback
+    InstrumentRegistry& instruments() { return instruments_; }
+    const InstrumentRegistry& instruments() const { return instruments_; }
+
 private:
     // Network and data handling
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
@@ -47,12 +85,16 @@ private:
     boost::asio::io_context& io_context_;
     std::thread data_thread_;
     std::atomic<bool> running_{false};
-    DataCallback callback_;
+    std::vector<DataCallback> callbacks_;
+    PriceCallback priceCallback_;
     std::string api_key_;
     CURL* curl_;
     
     // Data storage
     std::unordered_map<std::string, OptionData> latestData_;
+    std::unordered_map<std::string, OptionChain> chains_;
+    InstrumentRegistry instruments_;
+    std::unique_ptr<SharedQuoteTable> sharedQuotes_;   // Written under dataMutex_
     mutable std::mutex dataMutex_;
     std::vector<std::string> subscribed_symbols_;
 };
@@ -0,0 +1,100 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TscClock.hpp"
+
+// Where the time goes between a quote arriving and an order being filled.
+// Each stage is a latency in TscClock ticks:
+//
+//   HTTP_RECEIVE    one market data request, sent to response received
+//   PARSE           JSON parse of one response
+//   GREEKS          Greeks for one contract
+//   PUBLISH         one quote or price into the chains and their callbacks
+//   ORDER_RECEIVE   RPC handler entry to the decoded order reaching the OMS
+//   OMS_ACCEPT      OMS validation, risk check, insert, journal and hand-off
+//   ENGINE_DEQUEUE  wait in the execution engine's queue
+//   FILL            engine pickup to the OMS having applied the fill
+//   ACK             RPC handler entry to an accepted order's response being ready
+enum class LatencyStage : uint8_t {
+    HTTP_RECEIVE,
+    PARSE,
+    GREEKS,
+    PUBLISH,
+    ORDER_RECEIVE,
+    OMS_ACCEPT,
+    ENGINE_DEQUEUE,
+    FILL,
+    ACK,
+    COUNT
+};
+
+enum class MetricCounter : uint8_t {
+    HTTP_REQUESTS,
+    HTTP_ERRORS,
+    QUOTES_PUBLISHED,
+    ORDERS_RECEIVED,
+    ORDERS_ACCEPTED,
+    ORDERS_REJECTED,   // By the OMS's validation or risk check, or the engine
+    ORDERS_FILLED,
+    COUNT
+};
+
+struct LatencySummary {
+    LatencyStage stage;
+    uint64_t count;
+    double meanNanos;
+    double p50Nanos;
+    double p90Nanos;
+    double p99Nanos;
+    double p999Nanos;
+    double maxNanos;
+};
+
+struct MetricsSnapshot {
+    std::vector<LatencySummary> stages;                  // In LatencyStage order
+    std::vector<std::pair<MetricCounter, uint64_t>> counters;
+    std::chrono::system_clock::time_point takenAt;
+};
+
+// Process-wide latency histograms and counters. Every recording thread
+// gets its own block of them on first use, so record() and increment()
+// take no lock and no atomic read-modify-write: the owner is the only
+// writer, and a snapshot sums every block with relaxed loads. Blocks of
+// exited threads are handed to new ones, so their counts are kept.
+//
+// Histograms are log-linear in the style of HdrHistogram: 32 sub-buckets
+// per power of two, so a percentile is within about 3% of the true value.
+// Everything is cumulative since start-up.
+class Metrics {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int MAX_VALUE_BITS = 44;   // Longer latencies count as the longest bucket
+
+    static void record(LatencyStage stage, uint64_t ticks);
+    static void recordSince(LatencyStage stage, uint64_t startTicks) {
+        record(stage, TscClock::now() - startTicks);
+    }
+    static void increment(MetricCounter counter, uint64_t count = 1);
+
+    static MetricsSnapshot snapshot();
+
+    // Prometheus text exposition format: one summary per stage, in seconds,
+    // and one counter per MetricCounter
+    static std::string prometheusText();
+
+    // Rewrites path with prometheusText() every interval, for a
+    // node_exporter textfile collector or similar; each write goes to a
+    // temporary file renamed over path, so readers never see half of one.
+    // Throws std::runtime_error if the dump is already running.
+    static void startDump(const std::string& path, std::chrono::seconds interval = std::chrono::seconds(10));
+    static void stopDump();
+
+    static const char* stageName(LatencyStage stage);       // "oms_accept"
+    static const char* counterName(MetricCounter counter);  // "orders_accepted"
+};
+
+#endif
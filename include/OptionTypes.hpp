@@ -3,12 +3,15 @@
 
 #include <string>
 #include <cmath>
+#include <chrono>
+#include <cstdint>
 #include <stdexcept>
 
 struct OptionOrder {
     enum class Type { BUY_TO_OPEN, SELL_TO_OPEN, BUY_TO_CLOSE, SELL_TO_CLOSE };
     enum class OrderType { MARKET, LIMIT, STOP, STOP_LIMIT };
     enum class Status { PENDING, FILLED, CANCELLED, REJECTED };
+    enum class TimeInForce { DAY, GTC, IOC, GTD };
     
     std::string underlying;
     std::string optionType;     // "CALL" or "PUT"
@@ -21,6 +24,10 @@ struct OptionOrder {
     int quantity;
     std::string orderId;
     Status status;
+    TimeInForce timeInForce{TimeInForce::DAY};
+    std::chrono::system_clock::time_point expireTime{};  // Used for GTD orders
+    uint64_t expiryTimer{0};                              // OMS timer wheel handle
+    uint32_t revision{0};                                 // Bumped on every replace
     
     // Order status tracking
     bool isActive;
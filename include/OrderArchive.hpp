@@ -0,0 +1,120 @@
+#ifndef ORDER_ARCHIVE_HPP
+#define ORDER_ARCHIVE_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "FileUtils.hpp"
+#include "OrderStore.hpp"
+
+// Position in history order: submit time, then handle
+struct OrderHistoryCursor {
+    int64_t submitTimeNs = INT64_MIN;
+    OrderHandle handle = INVALID_ORDER_HANDLE;
+
+    bool operator<(const OrderHistoryCursor& other) const {
+        return submitTimeNs != other.submitTimeNs ? submitTimeNs < other.submitTimeNs
+                                                  : handle < other.handle;
+    }
+};
+
+struct OrderHistoryQuery {
+    int64_t startTimeNs = INT64_MIN;   // Inclusive bounds on submit time
+    int64_t endTimeNs = INT64_MAX;
+    std::string underlying;            // Empty matches every underlying
+    bool filterStatus = false;
+    OptionOrder::Status status = OptionOrder::Status::PENDING;
+    size_t pageSize = 100;
+    OrderHistoryCursor after;          // Resume strictly after this order
+
+    bool matches(const OrderRecord& order) const;
+};
+
+struct OrderHistoryPage {
+    std::vector<OrderRecord> orders;   // In history order
+    bool hasMore = false;
+
+    OrderHistoryCursor next() const {
+        return orders.empty() ? OrderHistoryCursor{}
+                              : OrderHistoryCursor{orders.back().submitTimeNs, orders.back().handle};
+    }
+};
+
+// On-disk archive of terminal orders, partitioned by UTC submit day into
+// flat files of OrderRecords (orders-YYYYMMDD.arc) that are read through
+// mmap. Queries skip partitions outside the requested time range and use
+// per-partition indexes by underlying, status, submit time and handle.
+// Indexes are only kept for the most recently used partitions, so memory
+// stays bounded however long the archive grows. Lookups by handle instead
+// go through a small filter per partition (under two bytes per archived
+// order), built the first time a lookup reaches the partition, so only the
+// partition holding the order, and rarely a false match, is searched.
+class OrderArchive {
+public:
+    static constexpr size_t DEFAULT_CACHED_PARTITIONS = 4;
+
+    explicit OrderArchive(const std::string& directory,
+                          size_t cachedPartitions = DEFAULT_CACHED_PARTITIONS);
+
+    // Appends orders to their partitions and syncs them. Orders already in
+    // the archive (re-archived after a crash) are skipped, so after a
+    // std::runtime_error from an I/O failure the same batch can be retried.
+    size_t append(const std::vector<OrderRecord>& orders);
+
+    // At most query.pageSize matches after the cursor
+    OrderHistoryPage query(const OrderHistoryQuery& query) const;
+    bool find(OrderHandle handle, OrderRecord& out) const;
+
+    size_t partitionCount() const;
+
+private:
+    // Bloom filter over a partition's handles
+    struct HandleFilter {
+        std::vector<uint64_t> bits;
+        size_t capacity{0};   // Handles it was sized for
+        size_t count{0};
+
+        explicit HandleFilter(size_t expected);
+        void add(OrderHandle handle);
+        bool mayContain(OrderHandle handle) const;
+    };
+
+    struct Partition {
+        int64_t day;
+        std::string path;
+        MappedFile file;
+        size_t mappedCount{0};   // Records visible through file
+        size_t recordCount{0};   // Records on disk
+        uint64_t lastUsed{0};
+
+        // Record indexes; byTime is sorted lazily since orders are archived
+        // in completion order rather than submit order
+        std::vector<std::pair<int64_t, uint32_t>> byTime;
+        bool timeSorted{true};
+        std::unordered_map<std::string, std::vector<uint32_t>> byUnderlying;
+        std::vector<uint32_t> byStatus[4];
+        std::unordered_map<OrderHandle, uint32_t> byHandle;
+    };
+
+    Partition& loadPartition(int64_t day) const;
+    const OrderRecord* records(Partition& partition) const;
+    void index(Partition& partition, const OrderRecord& order, uint32_t slot) const;
+    const HandleFilter& handleFilter(int64_t day) const;
+    std::string partitionPath(int64_t day) const;
+
+    std::string directory_;
+    size_t cachedPartitions_;
+
+    mutable std::mutex mutex_;
+    std::set<int64_t> days_;   // Every partition on disk
+    mutable std::map<int64_t, std::unique_ptr<Partition>> cache_;
+    mutable std::map<int64_t, HandleFilter> filters_;   // Partitions a lookup has reached
+    mutable uint64_t useClock_{0};
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef ORDER_EVENT_JOURNAL_HPP
+#define ORDER_EVENT_JOURNAL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "OrderStore.hpp"
+#include "WriteAheadLog.hpp"
+
+class OrderManagementSystem;
+
+// One entry of the client-facing order event feed, carrying the order's
+// state after the change
+struct JournalEvent {
+    enum class Type : uint8_t {
+        ACCEPTED,
+        REPLACED,
+        PARTIALLY_FILLED,   // Not produced yet: the engine fills whole orders
+        FILLED,
+        CANCELLED,
+        REJECTED,
+        EXPIRED
+    };
+
+    uint64_t sequence;      // Strictly increasing from 1 for the life of the journal
+    int64_t timestampNs;    // system_clock nanoseconds since epoch
+    Type type;
+    uint64_t executionId;   // Fills only, 0 otherwise
+    OrderRecord order;
+};
+
+// A fill, as GetExecutionReport reports it
+struct ExecutionRecord {
+    uint64_t executionId;   // Strictly increasing from 1
+    uint64_t sequence;      // The journal event that reported it
+    int32_t quantity;
+    double price;
+    int64_t timeNs;
+    OrderRecord order;
+};
+
+// Execution IDs at the API boundary: "EXE-" + 16 hex digits
+std::string formatExecutionId(uint64_t executionId);
+bool parseExecutionId(const std::string& text, uint64_t& executionId);
+
+// The OMS order changes clients care about, numbered so a client that
+// reconnects can resume from the last sequence it saw. Every journaled OMS
+// change except archiving becomes one event, and every fill gets an
+// execution record. Both are held in fixed-size rings in memory: a resume
+// from a sequence that has been overwritten fails rather than skipping
+// events, and reports for old executions are no longer found.
+//
+// Events are staged under the order's OMS shard lock, in a lane the
+// journal keeps per shard, so one order's events are always in order and
+// shards never wait on each other. The journal's thread
+// moves staged events into the ring, numbering them as it goes, and then
+// tells the listeners, never under an OMS lock; an event is readable once
+// moved, within DRAIN_INTERVAL of its append. A lane that fills up while
+// the thread is not running is moved by its appender. The journal starts empty on
+// every run (recovery replay is not journaled); its id tells runs apart.
+class OrderEventJournal {
+public:
+    static constexpr size_t DEFAULT_EVENT_CAPACITY = 1 << 16;
+    static constexpr size_t DEFAULT_EXECUTION_CAPACITY = 1 << 16;   // Fills only, so these outlast events
+    static constexpr std::chrono::milliseconds DRAIN_INTERVAL{1};    // Bounds the wait after a missed wake-up
+
+    // Called with the newest sequence; add listeners before start()
+    using Listener = std::function<void(uint64_t lastSequence)>;
+
+    // Registers for the OMS order events, so construct it before oms.start()
+    explicit OrderEventJournal(OrderManagementSystem& oms,
+                               size_t eventCapacity = DEFAULT_EVENT_CAPACITY,
+                               size_t executionCapacity = DEFAULT_EXECUTION_CAPACITY);
+    ~OrderEventJournal();
+
+    void start();
+    void stop();
+
+    void addListener(Listener listener);
+
+    // Appends up to maxEvents events, from sequence fromSequence on, to out.
+    // False if fromSequence has already been overwritten; nothing is
+    // appended then.
+    bool read(uint64_t fromSequence, size_t maxEvents, std::vector<JournalEvent>& out) const;
+
+    // False if the execution is unknown or no longer retained
+    bool getExecution(uint64_t executionId, ExecutionRecord& out) const;
+
+    uint64_t lastSequence() const;
+    uint64_t firstRetainedSequence() const;   // lastSequence() + 1 while empty
+    uint64_t id() const { return id_; }       // Start time of this journal, in nanoseconds
+
+private:
+    struct StagedEvent {
+        int64_t timestampNs;
+        JournalEvent::Type type;
+        OrderRecord order;
+    };
+
+    // One per OMS shard, appended to under that shard's lock
+    struct alignas(64) Lane {
+        std::mutex mutex;
+        std::vector<StagedEvent> pending;
+    };
+
+    void append(OrderEvent::Type type, const OrderRecord& order);
+    void run();
+    uint64_t drain();   // Moves every lane into the rings; returns the last sequence
+    void publish(Lane& lane);   // Callers hold the lane's lock
+
+    const uint64_t id_;
+    std::vector<Listener> listeners_;
+
+    const size_t laneCount_;
+    std::unique_ptr<Lane[]> lanes_;
+    std::atomic<bool> wakePending_{false};
+
+    std::mutex runMutex_;   // Guards running_ and thread_
+    std::condition_variable cv_;
+    bool running_{false};
+    std::thread thread_;
+
+    mutable std::mutex mutex_;   // Guards the rings; taken inside a lane lock
+    std::vector<JournalEvent> events_;          // Ring: sequence s lives at (s - 1) % size
+    std::vector<ExecutionRecord> executions_;   // Ring: execution e lives at (e - 1) % size
+    uint64_t lastSequence_{0};
+    uint64_t lastExecutionId_{0};
+    uint64_t notifiedSequence_{0};   // The journal thread's
+};
+
+#endif
@@ -4,66 +4,227 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <deque>
 #include <chrono>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
 #include "OptionTypes.hpp"
+#include "OrderArchive.hpp"
+#include "OrderStore.hpp"
+#include "Strategy.hpp"
+#include "TimerWheel.hpp"
+#include "WriteAheadLog.hpp"
 
 class ExecutionEngine;
+class RiskManagement;
 
+// Positions across every shard, captured under all shard locks at once
+struct PositionSnapshot {
+    std::vector<OptionPosition> positions;
+    std::vector<InstrumentKey> instruments;  // Parallel to positions
+    std::chrono::system_clock::time_point takenAt;
+};
+
+// What enablePersistence() restored
+struct RecoveryStats {
+    uint64_t snapshotSequence;  // 0 when no snapshot was found
+    size_t snapshotOrders;
+    size_t eventsReplayed;
+    size_t ordersRecovered;
+    double elapsedMillis;
+};
+
+// Order and position state is sharded by underlying. Each shard owns its
+// orders, positions and expiry timers behind a single mutex, so fills and
+// queries for unrelated underlyings never contend.
+//
+// Lock order: shard mutexes are only ever nested in ascending shard index
+// (multi-shard snapshots), and no shard lock is held while calling into the
+// execution engine. Journal appends happen under the owning shard's lock,
+// so a snapshot taken under every shard lock matches one log sequence;
+// each shard appends to its own log lane, so journaling does not couple
+// the shards either. Order event listeners also run under the shard lock
+// and must stay bounded: the event journal stages into a lane per shard,
+// and the delta hedger takes its own lock only for fills and for the end
+// of orders on an underlying itself, for a constant-time decision.
 class OrderManagementSystem {
 public:
-    OrderManagementSystem();
+    static constexpr size_t DEFAULT_ORDER_CAPACITY = 1 << 16;
+    static constexpr size_t DEFAULT_SHARD_COUNT = OrderStore::MAX_SHARDS;
+
+    explicit OrderManagementSystem(size_t orderCapacity = DEFAULT_ORDER_CAPACITY,
+                                   size_t shardCount = DEFAULT_SHARD_COUNT);
     ~OrderManagementSystem();
 
     // Start and stop methods
     void start();
     void stop();
 
+    // Persistence: call before start(). Restores orders and positions from
+    // the newest snapshot in directory plus the write-ahead log after it,
+    // then journals every order change there and snapshots periodically.
+    // Terminal orders are moved to an on-disk archive under directory/archive
+    // once they have been terminal for ARCHIVE_DELAY. Throws
+    // std::runtime_error if the data was written with a different shard
+    // count: orders and positions would land in different shards.
+    RecoveryStats enablePersistence(const std::string& directory,
+                                    std::chrono::seconds snapshotInterval = std::chrono::seconds(60));
+    uint64_t takeSnapshot();  // Returns the log sequence the snapshot covers
+    WriteAheadLog::Stats getJournalStats() const;
+
     // Set execution engine
     void setExecutionEngine(ExecutionEngine* engine) {
         executionEngine_ = engine;
     }
 
-    // Order management methods
+    // Pre-trade risk: call before start(). Every submit and replace is
+    // checked against the risk manager's live totals and rejected with
+    // std::runtime_error if it would breach a limit; every fill updates them.
+    void setRiskManager(RiskManagement* riskManager);
+
+    // Order event listeners: add them before start(). Each one sees every
+    // order change as it is journaled (recovery replay excepted), under
+    // the order's shard lock, so it must be quick and must not call back
+    // into the OMS.
+    using OrderEventListener = std::function<void(OrderEvent::Type type, const OrderRecord& order)>;
+    void addOrderEventListener(OrderEventListener listener);
+
+    // Order management methods (string order IDs are for the API boundary)
     void sendOrder(const std::string& symbol, double price, int quantity);
     std::string submitOptionOrder(const OptionOrder& order);
     void cancelOrder(const std::string& orderId);
     void modifyOrder(const std::string& orderId, const OptionOrder& newOrder);
-    
-    // Order tracking
+
+    // Handle-based order path: no heap allocation and no string hashing
+    OrderHandle submitOrder(const OrderRecord& order);
+    bool cancelOrder(OrderHandle handle);
+    bool replaceOrder(OrderHandle handle, const OrderRecord& newOrder);
+    bool getOrder(OrderHandle handle, OrderRecord& out) const;
+    // Like getOrder, falling back to the archive once the order has left the slab
+    bool findOrder(OrderHandle handle, OrderRecord& out) const;
+
+    // Multi-leg order, all or nothing: every leg is validated and the legs
+    // are risk checked together (so their offsets count), then all of them
+    // are stored and journaled under their shard locks at once. From then
+    // on the legs are independent orders. Returns the leg handles in leg
+    // order; throws like submitOrder and accepts no leg if it throws.
+    std::vector<OrderHandle> submitStrategy(const StrategyOrder& order);
+
+    // Order tracking (each shard is visited under its own lock)
     std::vector<OptionOrder> getActiveOrders() const;
+    std::vector<OrderRecord> getActiveOrderRecords() const;
     OptionOrder getOrderStatus(const std::string& orderId) const;
 
+    // Live and archived orders matching the query, in submit time order
+    OrderHistoryPage getOrderHistory(const OrderHistoryQuery& query) const;
+
     // Position management
     std::vector<OptionPosition> getPositions() const;
+    std::vector<OptionPosition> getPositionsForUnderlying(const std::string& underlying) const;
     OptionPosition getPosition(const PositionKey& key) const;
+    PositionSnapshot getPositionSnapshot() const;
     double getTotalPositionValue() const;
 
     // Order fill callbacks
-    void onOrderFilled(const std::string& orderId, double fillPrice);
-    void onOrderRejected(const std::string& orderId, const std::string& reason);
+    // Callbacks carry the revision the engine acted on; stale ones are ignored
+    void onOrderFilled(OrderHandle handle, uint32_t revision, double fillPrice);
+    void onOrderRejected(OrderHandle handle, uint32_t revision, const char* reason);
+    void onOrderExpired(OrderHandle handle, uint32_t revision, const char* reason);
+
+    // Time-in-force settings. The close is a New York time of day, so it
+    // follows daylight saving time: 16:00 is 21:00 UTC in winter, 20:00 in summer.
+    void setSessionClose(std::chrono::minutes newYorkTimeOfDay);
+    size_t getScheduledExpiryCount() const;
+
+    size_t getShardCount() const { return shards_.size(); }
 
 private:
-    // Internal methods
-    void updatePosition(const OptionOrder& order, double fillPrice);
-    std::string generateOrderId();
-    void validateOrder(const OptionOrder& order) const;
+    struct alignas(64) Shard {
+        Shard(size_t capacity, uint32_t index, uint64_t startTick)
+            : orders(capacity, index), expiryWheel(startTick, capacity) {}
+
+        mutable std::mutex mutex;
+        OrderStore orders;
+        std::unordered_map<InstrumentKey, OptionPosition> positions;
+        TimerWheel<OrderHandle> expiryWheel;  // Keyed by order handle
+
+        // Orders that went terminal, as (lastUpdateNs, handle) in the order
+        // they did, while persistence is on; the archiver pops the head
+        std::deque<std::pair<int64_t, OrderHandle>> terminalOrders;
+    };
+
+    size_t shardIndexFor(const char* underlying) const;
+    Shard& shardFor(const char* underlying) const;
+    Shard* shardFor(OrderHandle handle) const;
+
+    // Locks every shard in ascending order for a consistent cross-shard view
+    std::vector<std::unique_lock<std::mutex>> lockAllShards() const;
+
+    // Internal methods (callers hold the owning shard's mutex)
+    void updatePosition(Shard& shard, const OrderRecord& order);
+    void validateOrder(const OrderRecord& order) const;
+    void checkOrderRisk(const OrderRecord& order) const;  // No lock needed
+    void syncRiskPositions();                             // Takes every shard lock
+
+    // Time-in-force handling (callers hold the shard mutex); deadlines are
+    // system_clock nanoseconds, NO_EXPIRY when the order never expires
+    int64_t computeExpiry(const OrderRecord& order) const;
+    int64_t nextSessionClose(int64_t fromNs) const;
+    void scheduleExpiry(Shard& shard, OrderRecord& order, int64_t deadlineNs);
+    void cancelExpiry(Shard& shard, OrderRecord& order);
+    void queueForArchive(Shard& shard, const OrderRecord& order) {
+        if (archive_) shard.terminalOrders.emplace_back(order.lastUpdateNs, order.handle);
+    }
+    void expireOrders(std::chrono::system_clock::time_point now);
+    void expiryLoop();
+
+    // Persistence (journal() callers hold the shard mutex)
+    void journal(OrderEvent::Type type, const OrderRecord& order) {
+        if (wal_) wal_->append(type, order, OrderStore::shardOf(order.handle));
+        for (const OrderEventListener& listener : orderEventListeners_) listener(type, order);
+    }
+    void applyEvent(const OrderEvent& event);
+    Shard& recoveredShard(const OrderRecord& order) const;   // Throws if the shard layout changed
+    void snapshotLoop();
+    size_t archiveTerminalOrders(int64_t terminalBeforeNs);
+    void archiveLoop();
 
     // Execution engine
     ExecutionEngine* executionEngine_{nullptr};
+    RiskManagement* riskManager_{nullptr};
+    std::vector<OrderEventListener> orderEventListeners_;
 
     // Data storage
-    std::unordered_map<std::string, OptionOrder> orders_;
-    std::unordered_map<PositionKey, OptionPosition> positions_;
-    
-    // Thread safety
-    mutable std::mutex ordersMutex_;
-    mutable std::mutex positionsMutex_;
-    
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    // Time-in-force expiry
+    std::thread expiryThread_;
+    std::atomic<int64_t> sessionCloseNs_;  // New York time of day
+
+    // Persistence
+    std::unique_ptr<WriteAheadLog> wal_;
+    std::string dataDirectory_;
+    std::chrono::seconds snapshotInterval_{60};
+    std::thread snapshotThread_;
+    std::unique_ptr<OrderArchive> archive_;
+    std::thread archiveThread_;
+    std::mutex snapshotMutex_;      // One snapshot writer at a time
+    std::mutex persistenceWaitMutex_;       // Wakes the snapshot and archive threads on stop
+    std::condition_variable persistenceCv_;
+
     // State tracking
     std::atomic<bool> isRunning_;
-    std::atomic<uint64_t> orderCounter_;
+
+    static constexpr std::chrono::milliseconds EXPIRY_POLL_INTERVAL{10};
+    static constexpr std::chrono::minutes DEFAULT_SESSION_CLOSE{16 * 60};  // 16:00 New York
+    static constexpr int64_t NO_EXPIRY = INT64_MAX;
+    static constexpr std::chrono::seconds ARCHIVE_DELAY{60};     // Terminal orders stay queryable in memory this long
+    static constexpr std::chrono::seconds ARCHIVE_INTERVAL{1};
+    static constexpr size_t ARCHIVE_BATCH = 4096;                // Per shard per pass, bounds lock hold time
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,64 @@
+#ifndef ORDER_SNAPSHOT_HPP
+#define ORDER_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "FileUtils.hpp"
+#include "OrderStore.hpp"
+
+// Net position in one instrument as stored in a snapshot
+struct PositionRecord {
+    InstrumentKey instrument;
+    double quantity;
+};
+
+static_assert(std::is_trivially_copyable<PositionRecord>::value,
+              "PositionRecord is written to disk as raw bytes");
+
+// Complete OMS state as of one write-ahead log sequence number
+struct OrderSnapshot {
+    uint64_t sequence;      // Last log event reflected in the snapshot
+    int64_t takenAtNs;
+    uint32_t shardCount;
+    std::vector<OrderRecord> orders;
+    std::vector<PositionRecord> positions;
+    std::vector<uint64_t> generations;   // Per shard generation high-water mark
+};
+
+// Writes snapshot-<sequence>.snap atomically, then removes all but the
+// newest `keep` snapshots. Throws std::runtime_error on I/O failure.
+void writeSnapshot(const std::string& directory, const OrderSnapshot& snapshot, size_t keep = 2);
+
+// Memory-mapped view of the newest intact snapshot in a directory. The
+// records are used in place, straight from the page cache; a snapshot that
+// fails its checksum is skipped in favour of the one before it.
+class MappedSnapshot {
+public:
+    explicit MappedSnapshot(const std::string& directory);
+
+    bool empty() const { return file_.empty(); }
+    uint64_t sequence() const { return sequence_; }
+    uint32_t shardCount() const { return shardCount_; }
+
+    const OrderRecord* orders() const { return orders_; }
+    size_t orderCount() const { return orderCount_; }
+    const PositionRecord* positions() const { return positions_; }
+    size_t positionCount() const { return positionCount_; }
+    const uint64_t* generations() const { return generations_; }  // shardCount() entries
+
+private:
+    bool load(const std::string& path);
+
+    MappedFile file_;
+    uint64_t sequence_{0};
+    uint32_t shardCount_{0};
+    const OrderRecord* orders_{nullptr};
+    size_t orderCount_{0};
+    const PositionRecord* positions_{nullptr};
+    size_t positionCount_{0};
+    const uint64_t* generations_{nullptr};
+};
+
+#endif
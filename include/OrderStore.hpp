@@ -0,0 +1,177 @@
+#ifndef ORDER_STORE_HPP
+#define ORDER_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "OptionTypes.hpp"
+
+// 64-bit order handle: (generation << 32) | (slot << SHARD_BITS) | shard.
+// Generations start at 1, so 0 is never a valid handle and a reused slot
+// never matches a stale one.
+using OrderHandle = uint64_t;
+constexpr OrderHandle INVALID_ORDER_HANDLE = 0;
+
+// Fixed-size identification of an option contract
+struct InstrumentKey {
+    char underlying[16];
+    char expiry[11];        // YYYY-MM-DD, NUL-terminated
+    bool isCall;
+    double strike;
+
+    bool operator==(const InstrumentKey& other) const {
+        return std::strncmp(underlying, other.underlying, sizeof(underlying)) == 0 &&
+               std::strncmp(expiry, other.expiry, sizeof(expiry)) == 0 &&
+               isCall == other.isCall &&
+               strike == other.strike;
+    }
+};
+
+namespace std {
+    template<>
+    struct hash<InstrumentKey> {
+        size_t operator()(const InstrumentKey& k) const {
+            // FNV-1a over the fixed-size fields, no allocation
+            uint64_t h = 14695981039346656037ull;
+            auto mix = [&h](const char* data, size_t len) {
+                for (size_t i = 0; i < len && data[i] != '\0'; ++i) {
+                    h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+                }
+            };
+            mix(k.underlying, sizeof(k.underlying));
+            mix(k.expiry, sizeof(k.expiry));
+            h = (h ^ (k.isCall ? 1u : 2u)) * 1099511628211ull;
+            return h ^ hash<double>()(k.strike);
+        }
+    };
+}
+
+// Fixed-size, trivially copyable order record stored in the OrderStore slab
+struct OrderRecord {
+    InstrumentKey instrument;
+    OrderHandle handle;
+    OptionOrder::Type type;
+    OptionOrder::OrderType orderType;
+    OptionOrder::Status status;
+    OptionOrder::TimeInForce timeInForce;
+    int32_t quantity;
+    uint32_t revision;
+    double limitPrice;
+    double stopPrice;
+    double fillPrice;
+    int64_t submitTimeNs;   // system_clock nanoseconds since epoch
+    int64_t fillTimeNs;
+    int64_t lastUpdateNs;   // Last status change
+    int64_t expireTimeNs;   // GTD expiry
+    uint64_t expiryTimer;   // OMS timer wheel handle
+    bool isActive;
+};
+
+static_assert(std::is_trivially_copyable<OrderRecord>::value,
+              "OrderRecord must stay trivially copyable");
+
+// Conversions between the API-level OptionOrder and the compact record.
+// makeOrderRecord throws std::invalid_argument if a field does not fit.
+InstrumentKey makeInstrumentKey(const std::string& underlying, const std::string& optionType,
+                                double strike, const std::string& expiry);
+OrderRecord makeOrderRecord(const OptionOrder& order);
+OptionOrder makeOptionOrder(const OrderRecord& record);
+
+// Human-readable order IDs ("ORD-" + 16 hex digits of the handle) exist only
+// at the API boundary; parsing them back to a handle needs no lookup.
+constexpr size_t ORDER_ID_LENGTH = 20;
+void formatOrderId(OrderHandle handle, char (&buffer)[ORDER_ID_LENGTH + 1]);
+std::string formatOrderId(OrderHandle handle);
+bool parseOrderId(const std::string& orderId, OrderHandle& handle);
+
+// Slab of fixed-size order records with an intrusive free list. Slots are
+// allocated in chunks up front; a new chunk is only allocated once every
+// preallocated slot is in use, and records never move once inserted.
+// Each store owns one shard index, which is encoded in its handles.
+class OrderStore {
+public:
+    static constexpr unsigned SHARD_BITS = 4;
+    static constexpr uint32_t MAX_SHARDS = 1u << SHARD_BITS;
+
+    explicit OrderStore(size_t initialCapacity, uint32_t shard = 0);
+
+    // Stores a copy of the record, assigns its handle and returns it
+    OrderRecord& insert(const OrderRecord& record);
+    OrderRecord* find(OrderHandle handle);
+    const OrderRecord* find(OrderHandle handle) const;
+    bool erase(OrderHandle handle);
+
+    // Recovery: places a record at the slot and generation its handle names.
+    // insert() must not be called until rebuildFreeList() has run, which
+    // moves every free slot past the highest generation ever issued so no
+    // handle from before the restart (including erased ones) is reissued.
+    OrderRecord& restore(const OrderRecord& record);
+    void rebuildFreeList();
+
+    // Highest generation issued by this store; persisted with snapshots
+    uint32_t generationHighWater() const { return maxGeneration_; }
+    void raiseGenerationHighWater(uint32_t generation) {
+        if (generation > maxGeneration_) maxGeneration_ = generation;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return chunks_.size() * CHUNK_SIZE; }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) {
+        for (auto& chunk : chunks_) {
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                if (chunk[i].live) fn(chunk[i].record);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& chunk : chunks_) {
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                if (chunk[i].live) fn(chunk[i].record);
+            }
+        }
+    }
+
+    // Dense index across all shards, suitable for indexing flat side tables
+    static uint32_t slotOf(OrderHandle handle) { return static_cast<uint32_t>(handle); }
+    static uint32_t shardOf(OrderHandle handle) { return slotOf(handle) & (MAX_SHARDS - 1); }
+    static uint32_t generationOf(OrderHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+
+private:
+    static constexpr unsigned CHUNK_BITS = 14;
+    static constexpr size_t CHUNK_SIZE = size_t{1} << CHUNK_BITS;
+    static constexpr uint32_t MAX_LOCAL_SLOTS = UINT32_MAX >> SHARD_BITS;
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    static uint32_t localSlotOf(OrderHandle handle) { return slotOf(handle) >> SHARD_BITS; }
+
+    struct Slot {
+        OrderRecord record;
+        uint32_t generation;
+        uint32_t nextFree;
+        bool live;
+    };
+
+    Slot* slotAt(uint32_t index) const {
+        size_t chunk = index >> CHUNK_BITS;
+        if (chunk >= chunks_.size()) return nullptr;
+        return &chunks_[chunk][index & (CHUNK_SIZE - 1)];
+    }
+    void addChunk();
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    uint32_t shard_;
+    uint32_t freeHead_{NO_SLOT};
+    uint32_t maxGeneration_{1};
+    size_t size_{0};
+};
+
+#endif
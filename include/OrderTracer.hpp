@@ -0,0 +1,97 @@
+#ifndef ORDER_TRACER_HPP
+#define ORDER_TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "OrderStore.hpp"
+#include "TscClock.hpp"
+
+// The life of one order, stage by stage, on the thread that ran it:
+//
+//   GRPC_HANDLER  RPC handler entry to its response being ready
+//   VALIDATION    OMS validation and pre-trade risk check
+//   OMS_INSERT    OMS insert and journal, under the shard lock
+//   QUEUE_WAIT    hand-off to the execution engine until it dequeues the order
+//   EXECUTION     the engine's attempt that fills, rejects or expires it
+//   OMS_FILL      the OMS applying the fill
+//   RESPONSE      building the response once the OMS has accepted the order
+enum class TraceStage : uint8_t {
+    GRPC_HANDLER,
+    VALIDATION,
+    OMS_INSERT,
+    QUEUE_WAIT,
+    EXECUTION,
+    OMS_FILL,
+    RESPONSE,
+    COUNT
+};
+
+struct TraceOptions {
+    std::string path = "order_trace.json";           // Truncated on start()
+    double sampleRate = 0.01;                        // Fraction of orders traced
+    size_t capacity = 1 << 16;                       // Spans awaiting export; a power of two
+    std::chrono::milliseconds flushInterval{100};
+};
+
+// Opt-in, sampled per-order tracing. Whether an order is traced follows
+// from its handle alone, so every thread that touches it agrees without
+// passing anything along. A traced stage costs one slot in a preallocated
+// ring: a fetch_add and a few stores. A background thread exports the
+// spans as Chrome trace JSON, which chrome://tracing and Perfetto open
+// directly; each order is a process named by its order ID, with its spans
+// on the threads that ran them.
+//
+// A writer that laps the exporter overwrites spans it has not exported
+// yet; those are counted as dropped. Until stop() closes the JSON array
+// the file is a valid unterminated trace, so it can be opened mid-run.
+class OrderTracer {
+public:
+    struct Stats {
+        uint64_t spansRecorded;
+        uint64_t spansExported;
+        uint64_t spansDropped;
+        uint64_t bytesWritten;
+    };
+
+    // Throws std::invalid_argument for a bad option and std::runtime_error
+    // if the file cannot be opened or tracing is already running
+    static void start(const TraceOptions& options = TraceOptions());
+    static void stop();   // Exports every span recorded before it
+    static Stats stats();
+
+    static bool enabled() {
+        return threshold_.load(std::memory_order_relaxed) != 0;
+    }
+
+    static bool sampled(OrderHandle handle) {
+        uint64_t threshold = threshold_.load(std::memory_order_acquire);
+        return threshold != 0 && mix(handle) <= threshold;
+    }
+
+    // Callers check sampled() first
+    static void span(TraceStage stage, OrderHandle handle, uint64_t startTicks, uint64_t endTicks);
+
+    // The handler's two spans, ending now: GRPC_HANDLER from received and
+    // RESPONSE from submitted, when the OMS returned
+    static void traceHandler(OrderHandle handle, uint64_t receivedTicks, uint64_t submittedTicks) {
+        uint64_t now = TscClock::now();
+        span(TraceStage::RESPONSE, handle, submittedTicks, now);
+        span(TraceStage::GRPC_HANDLER, handle, receivedTicks, now);
+    }
+
+    static const char* stageName(TraceStage stage);   // "queue_wait"
+
+private:
+    static std::atomic<uint64_t> threshold_;   // 0 while stopped
+
+    // splitmix64's finalizer: consecutive handles sample independently
+    static uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+};
+
+#endif
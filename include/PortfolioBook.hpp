@@ -0,0 +1,112 @@
+#ifndef PORTFOLIO_BOOK_HPP
+#define PORTFOLIO_BOOK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "MarginModel.hpp"
+#include "OptionTypes.hpp"
+#include "RiskMetrics.hpp"
+#include "ScenarioRisk.hpp"
+
+// Risk of one slice of the book
+struct RiskBucket {
+    std::string underlying;   // Empty for per-expiry buckets
+    double timeToExpiry;      // Years; -1 for per-underlying buckets
+    size_t positions;
+    GreekTotals totals;
+};
+
+struct PortfolioRevaluation {
+    RiskMetrics metrics;                   // Greeks and value; margin is filled in by RiskManagement
+    std::vector<RiskBucket> byUnderlying;  // In symbol order
+    std::vector<RiskBucket> byExpiry;      // Across all underlyings, nearest first
+    std::vector<RiskBucket> byGroup;       // One per underlying and expiry
+    size_t positionsPriced{0};
+    size_t positionsSkipped{0};            // No price for their underlying
+};
+
+// Positions regrouped once for repeated revaluation. Contracts sharing an
+// underlying and expiry form a group, so spot, rate, volatility and time
+// are hoisted out of the pricing loop, and each group's strikes, call/put
+// signs and quantities sit in contiguous arrays (struct of arrays) for the
+// vectorized kernel. Building the book is the only step that touches the
+// position strings; a revaluation looks up one price per underlying.
+//
+// Positions without a strike are positions in the underlying itself and
+// are carried as linear exposure (delta one) in their group.
+class PortfolioBook {
+public:
+    explicit PortfolioBook(const std::vector<OptionPosition>& positions);
+
+    size_t size() const { return positionCount_; }
+    size_t groupCount() const { return groups_.size(); }
+    const std::vector<std::string>& underlyings() const { return underlyings_; }
+
+    // Values the book at the given spots. Groups are split into chunks that
+    // are priced in parallel on at most maxThreads cores (0 uses them all)
+    // and summed with a parallel reduction.
+    PortfolioRevaluation revalue(const std::unordered_map<std::string, double>& underlyingPrices,
+                                 double riskFreeRate, double volatility, size_t maxThreads = 0) const;
+
+    // Full revaluation under every scenario: P&L against the unshocked book
+    // value (returned through baseValue), in scenario order. Scenarios are
+    // split into blocks across at most maxThreads cores; within a block each
+    // group's contracts are priced under all of its scenarios at once.
+    // Underlyings without a price are left out, as in revalue().
+    std::vector<double> scenarioPnL(const ScenarioSet& scenarios,
+                                    const std::unordered_map<std::string, double>& underlyingPrices,
+                                    double riskFreeRate, double volatility, size_t maxThreads = 0,
+                                    double* baseValue = nullptr) const;
+
+    // Full-revaluation stress grid for every priced underlying and for the
+    // portfolio. Each (underlying, block of grid points) is one parallel
+    // task: shocked spots and their logs are built once per row, the
+    // contract-independent terms once per group, and each contract is then
+    // priced across the block's grid points in SIMD lanes.
+    StressGrid stressGrid(const StressGridSpec& spec,
+                          const std::unordered_map<std::string, double>& underlyingPrices,
+                          double riskFreeRate, double volatility, size_t maxThreads = 0) const;
+
+    // Scenario margin risk of every priced underlying's class group, for
+    // portfolioMargin(). Groups are priced in parallel, all sixteen margin
+    // scenarios in one vectorized pass.
+    std::unordered_map<std::string, ClassGroupRisk> classGroupRisk(
+        const MarginParameters& parameters, const std::unordered_map<std::string, double>& underlyingPrices,
+        double riskFreeRate, double volatility, size_t maxThreads = 0) const;
+
+private:
+    struct Group {
+        uint32_t underlying;     // Index into underlyings_
+        double timeToExpiry;
+        size_t begin;            // Option contracts [begin, end) in the arrays below
+        size_t end;
+        double linearQuantity;   // Net position in the underlying itself
+        size_t positions;
+    };
+
+    // A unit of parallel work: part of one group's contracts
+    struct Chunk {
+        uint32_t group;
+        size_t begin;
+        size_t end;
+    };
+
+    std::vector<double> spotsFor(const std::unordered_map<std::string, double>& underlyingPrices) const;
+
+    std::vector<std::string> underlyings_;   // Sorted
+    std::vector<Group> groups_;              // Sorted by underlying, then expiry
+    std::vector<Chunk> chunks_;
+    size_t positionCount_{0};
+
+    std::vector<double> strike_;
+    std::vector<double> logStrike_;
+    std::vector<double> callSign_;
+    std::vector<double> quantity_;
+
+    static constexpr size_t CHUNK_SIZE = 2048;   // Contracts per task: enough to amortise scheduling
+};
+
+#endif
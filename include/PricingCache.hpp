@@ -0,0 +1,114 @@
+#ifndef PRICING_CACHE_HPP
+#define PRICING_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "BlackScholesModel.hpp"
+#include "MarginModel.hpp"
+
+struct PricingCacheConfig {
+    size_t capacity = 1 << 16;                     // Entries across all shards
+    double spotTolerance = 1e-4;                   // Spot bucket width, relative
+    double volTolerance = 1e-4;                    // Volatility bucket width, absolute
+    double timeTolerance = 1.0 / (365.0 * 24.0);   // Time bucket width in years: one hour
+    bool taylorCorrection = true;                  // Correct a hit by the cached Greeks
+};
+
+struct PricedOption {
+    double price{0.0};
+    BlackScholesModel::Greeks greeks;
+    RiskArray riskArray{};   // Only when asked for with margin parameters
+};
+
+// Bounded memo of BlackScholesModel price and Greeks. Inputs are quantized
+// into buckets (strike, side and rate exact; spot, volatility and time to
+// expiry to the configured tolerances), so the same contract under the same
+// few spot and vol shocks is priced once. A hit is returned as cached or,
+// with taylorCorrection, moved from the cached point to the requested one
+// with delta, gamma, vega and theta. Margin risk arrays can be memoized
+// alongside; they are returned as cached, so a cache must not outlive the
+// margin parameters it was filled under. Entries are split across shards, each
+// with its own lock, and evicted by CLOCK: a hit sets the entry's reference
+// bit, and the hand evicts the first entry it finds without one.
+class PricingCache {
+public:
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t entries{0};
+
+        double hitRate() const {
+            uint64_t lookups = hits + misses;
+            return lookups > 0 ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+        }
+    };
+
+    explicit PricingCache(PricingCacheConfig config = PricingCacheConfig());
+
+    // Same validation as BlackScholesModel: invalid inputs throw and are not
+    // cached. With margin parameters the contract's risk array is filled in.
+    PricedOption price(const BlackScholesModel::OptionParameters& params,
+                       const MarginParameters* margin = nullptr);
+
+    Stats stats() const;
+    void clear();
+    const PricingCacheConfig& config() const { return config_; }
+
+private:
+    struct Key {
+        double strike;
+        double riskFreeRate;
+        int64_t spotBucket;
+        int64_t volBucket;
+        int64_t timeBucket;
+        bool isCall;
+
+        bool operator==(const Key& other) const {
+            return strike == other.strike && riskFreeRate == other.riskFreeRate &&
+                   spotBucket == other.spotBucket && volBucket == other.volBucket &&
+                   timeBucket == other.timeBucket && isCall == other.isCall;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        Key key;
+        double spot;           // Exact inputs it was priced at
+        double volatility;
+        double timeToExpiry;
+        PricedOption priced;
+        bool hasRiskArray{false};
+        bool referenced{false};
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Entry> entries;   // Grows to its share of the capacity, then recycles
+        std::unordered_map<Key, size_t, KeyHash> index;
+        size_t hand{0};
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+    };
+
+    Key keyFor(const BlackScholesModel::OptionParameters& params) const;
+    PricedOption fromCache(const Entry& entry, const BlackScholesModel::OptionParameters& params) const;
+    static void addRiskArray(PricedOption& priced, const BlackScholesModel::OptionParameters& params,
+                             const MarginParameters& margin);
+
+    static constexpr size_t SHARD_COUNT = 16;
+
+    const PricingCacheConfig config_;
+    const size_t shardCapacity_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef QUOTE_CONFLATOR_HPP
+#define QUOTE_CONFLATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "OptionTypes.hpp"
+#include "OrderStore.hpp"
+
+// The latest quote per contract since the last drain, in the order each
+// contract first changed. A newer quote for a pending contract replaces
+// the older one in place; once maxContracts are pending, quotes for other
+// contracts are dropped until the next drain. Not thread-safe.
+class QuoteConflator {
+public:
+    explicit QuoteConflator(size_t maxContracts);
+
+    // False if the quote was dropped
+    bool offer(const OptionData& quote);
+
+    // Swaps the pending quotes into out, which is cleared first, and
+    // resets the conflated and dropped counts
+    void drain(std::vector<OptionData>& out);
+
+    bool empty() const { return pending_.empty(); }
+    size_t size() const { return pending_.size(); }
+    uint32_t conflated() const { return conflated_; }   // Since the last drain
+    uint32_t dropped() const { return dropped_; }
+
+private:
+    const size_t maxContracts_;
+    std::unordered_map<InstrumentKey, size_t> index_;   // Into pending_
+    std::vector<OptionData> pending_;
+    uint32_t conflated_{0};
+    uint32_t dropped_{0};
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef RING_QUEUE_HPP
+#define RING_QUEUE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// FIFO over a preallocated power-of-two ring. Not thread-safe: callers
+// synchronise externally. Pushing never allocates until the ring is full,
+// at which point it doubles.
+template <typename T>
+class RingQueue {
+public:
+    explicit RingQueue(size_t capacity = 1024) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        buffer_.resize(rounded);
+        mask_ = rounded - 1;
+    }
+
+    void push(const T& value) {
+        if (size() == buffer_.size()) grow();
+        buffer_[tail_++ & mask_] = value;
+    }
+
+    T& front() { return buffer_[head_ & mask_]; }
+    void pop() { ++head_; }
+
+    bool empty() const { return head_ == tail_; }
+    size_t size() const { return tail_ - head_; }
+    size_t capacity() const { return buffer_.size(); }
+
+private:
+    void grow() {
+        std::vector<T> larger(buffer_.size() * 2);
+        size_t count = size();
+        for (size_t i = 0; i < count; ++i) {
+            larger[i] = std::move(buffer_[(head_ + i) & mask_]);
+        }
+        buffer_.swap(larger);
+        mask_ = buffer_.size() - 1;
+        head_ = 0;
+        tail_ = count;
+    }
+
+    std::vector<T> buffer_;
+    size_t mask_{0};
+    size_t head_{0};
+    size_t tail_{0};
+};
+
+#endif
@@ -1,38 +1,212 @@
 #ifndef RISK_MANAGEMENT_HPP
 #define RISK_MANAGEMENT_HPP
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
 #include <vector>
 #include <unordered_map>
 #include "BlackScholesModel.hpp"
+#include "MarginModel.hpp"
+#include "PricingCache.hpp"
 #include "RiskMetrics.hpp"
 #include "OptionTypes.hpp"
+#include "OrderSnapshot.hpp"
+#include "OrderStore.hpp"
+#include "PortfolioBook.hpp"
+#include "ScenarioRisk.hpp"
+#include "Strategy.hpp"
 
 struct RiskLimits {
     double maxDelta;
     double maxGamma;
     double maxVega;
     double maxTheta;
-    double maxPositionSize;
+    double maxPositionSize;   // Contracts held in any one instrument, and the portfolio's value
     double maxLoss;
+    double marginCapital;   // Margin utilization is measured against it; 0 turns the margin check off
 };
 
+// Besides the batch calculations, RiskManagement keeps live Greek totals
+// per underlying and for the whole portfolio. Fills and market ticks adjust
+// them by the change they cause, so reading the current risk or checking an
+// order against the limits never re-prices the book. The same updates keep
+// each contract's margin risk array and each class group's sum of them, so
+// scenario margin is also maintained incrementally and checked pre-trade.
+// Each product group has its own lock, so fills, ticks and checks on
+// unrelated underlyings run in parallel; the portfolio sums are atomics
+// that each group moves by the change it makes.
 class RiskManagement {
 public:
     RiskManagement();
-    
+
     RiskMetrics calculatePortfolioRisk(
         const std::vector<OptionPosition>& positions,
         const std::unordered_map<std::string, double>& underlyingPrices
     );
-    
+
+    // Parallel full revaluation of a prepared book, with per-underlying and
+    // per-expiry breakdowns; for books too large for calculatePortfolioRisk
+    PortfolioRevaluation revaluePortfolio(
+        const PortfolioBook& book,
+        const std::unordered_map<std::string, double>& underlyingPrices,
+        size_t maxThreads = 0
+    ) const;
+
+    // Historical or Monte Carlo VaR and expected shortfall by full
+    // revaluation of the book under every scenario, at each confidence level
+    ScenarioRiskResult calculateScenarioRisk(
+        const PortfolioBook& book,
+        const ScenarioSet& scenarios,
+        const std::unordered_map<std::string, double>& underlyingPrices,
+        const std::vector<double>& confidenceLevels = {0.95, 0.99},
+        size_t maxThreads = 0
+    ) const;
+
+    // Full-revaluation spot x volatility stress grid per underlying and for
+    // the portfolio; see PortfolioBook::stressGrid
+    StressGrid calculateStressGrid(
+        const PortfolioBook& book,
+        const std::unordered_map<std::string, double>& underlyingPrices,
+        const StressGridSpec& spec = StressGridSpec(),
+        size_t maxThreads = 0
+    ) const;
+
+    // Copies the first confidence level's VaR and ES into metrics
+    static void applyScenarioRisk(RiskMetrics& metrics, const ScenarioRiskResult& risk);
+
     bool checkOrderRisk(const OptionPosition& newPosition, const RiskMetrics& currentRisk);
     void setRiskLimits(const RiskLimits& limits);
+
+    // Memoizes scalar pricing (batch and live) from here on; replaces any
+    // previous cache. Off by default, so prices are exact unless enabled.
+    void enablePricingCache(const PricingCacheConfig& config = PricingCacheConfig());
+    PricingCache::Stats getPricingCacheStats() const;   // Zeros when disabled
+
+    // Replaces the margin scenarios and product groups and re-prices every
+    // held contract's risk array
+    void setMarginParameters(const MarginParameters& parameters);
     double calculateValueAtRisk(const std::vector<OptionPosition>& positions, double confidenceLevel);
 
+    // Pre-trade check against the live totals: true if trading
+    // signedQuantity more of the instrument keeps every limit, or moves a
+    // breached total back towards it. That includes margin against
+    // marginCapital, re-evaluated for the instrument's product group only.
+    // O(1) in the size of the book. Leaves no state behind: a contract not
+    // held or quoted is priced for the check alone.
+    //
+    // The check fails closed. The instrument's held quantity after the
+    // trade is held to maxPositionSize, priced or not. An instrument whose
+    // underlying has no spot price yet cannot be valued, so only orders
+    // that reduce its held quantity pass; everything else is rejected
+    // until a price arrives.
+    bool checkOrderRisk(const InstrumentKey& instrument, double signedQuantity);
+
+    // Batch what-if for a strategy scanner: each candidate's price and the
+    // change quantity units of it alone would make to the live portfolio
+    // Greeks and scenario margin. Contracts shared between candidates are
+    // priced once; they are grouped by underlying, expiry and volatility
+    // and priced through the vectorized kernels, and each product group's
+    // lock is held only to copy the live state they touch. Throws std::invalid_argument if a
+    // candidate fails validateStrategy.
+    StrategyEvaluation evaluateStrategies(const std::vector<Strategy>& candidates, double quantity = 1.0) const;
+
+    // Pre-trade check of every leg of a strategy together, with the same
+    // rules as checkOrderRisk, including its unpriced-leg policy; margin
+    // offsets between the legs count
+    bool checkStrategyRisk(const Strategy& strategy, double quantity) const;
+
+    // Incremental updates (thread-safe)
+    void onFill(const InstrumentKey& instrument, double signedQuantity);
+    void onUnderlyingPrice(const std::string& underlying, double spot);  // Re-prices that underlying's contracts
+    void onOptionQuote(const OptionData& quote);                          // Takes the contract's implied vol
+    void loadPositions(const std::vector<PositionRecord>& positions);     // Replaces all held quantities
+
+    RiskMetrics getCurrentRisk() const;
+    GreekTotals getUnderlyingRisk(const std::string& underlying) const;
+    std::vector<RiskBucket> getUnderlyingRisks() const;   // Held underlyings, in symbol order
+
 private:
+    // Per-unit risk of one contract at the last price it was valued at
+    struct ContractRisk {
+        double quantity{0.0};
+        double volatility{DEFAULT_VOLATILITY};
+        GreekTotals perUnit;
+        RiskArray riskArray{};   // Per-unit P&L under the margin scenarios
+        bool option{false};
+        bool priced{false};      // Stale until the underlying has a spot price
+    };
+
+    // Class groups whose margins offset each other. The lock guards the
+    // live state of every underlying in the group.
+    struct ProductGroup {
+        std::mutex mutex;
+        std::vector<const ClassGroupRisk*> classes;
+        double margin{0.0};
+    };
+
+    // Portfolio sums; each product group adds the change it makes
+    struct PortfolioTotals {
+        std::atomic<double> delta{0.0};
+        std::atomic<double> gamma{0.0};
+        std::atomic<double> theta{0.0};
+        std::atomic<double> vega{0.0};
+        std::atomic<double> rho{0.0};
+        std::atomic<double> value{0.0};
+
+        void add(const GreekTotals& before, const GreekTotals& after);
+        GreekTotals load() const;
+    };
+
+    struct UnderlyingRisk {
+        double spot{0.0};
+        GreekTotals totals;
+        ClassGroupRisk margin;            // This underlying's class group
+        ProductGroup* group{nullptr};
+        std::unordered_map<InstrumentKey, ContractRisk> contracts;
+    };
+
+    using SharedLock = std::shared_lock<std::shared_mutex>;
+
+    // Callers hold stateMutex_ shared; an underlying first seen is added
+    // under the exclusive lock, after which the shared lock is retaken
+    UnderlyingRisk& underlyingFor(const std::string& underlying, SharedLock& lock);
+
+    // Callers hold stateMutex_ exclusively
+    UnderlyingRisk& addUnderlying(const std::string& underlying);   // Or finds it
+    void joinProductGroup(const std::string& underlying, UnderlyingRisk& risk);
+
+    // Callers hold stateMutex_ shared and the underlying's group lock, or
+    // stateMutex_ exclusively
+    void repriceUnderlying(UnderlyingRisk& underlying, int64_t nowNs);
+    void refreshMargin(ProductGroup& group);
+    ContractRisk& contractFor(UnderlyingRisk& underlying, const InstrumentKey& instrument);  // Adds it if new
+    void refreshContract(const UnderlyingRisk& underlying, const InstrumentKey& instrument,
+                         ContractRisk& contract) const;   // Prices it if stale and the spot is known
+    void priceContract(const InstrumentKey& instrument, ContractRisk& contract, double spot, int64_t nowNs) const;
+    void applyContract(UnderlyingRisk& underlying, const ContractRisk& contract, double sign);
+    bool withinLimit(double current, double marginal, double limit) const;
+    static PricedOption priceOption(PricingCache* cache, const BlackScholesModel::OptionParameters& params,
+                                    const MarginParameters* margin);
+    static void applyMargin(RiskMetrics& metrics, double margin, const RiskLimits& limits);
+
+    // Guards the configuration and both maps' structure: shared for every
+    // update, check and read, exclusive to add an underlying or change the
+    // settings. Taken before any product group's lock.
+    mutable std::shared_mutex stateMutex_;
     RiskLimits limits_;
+    MarginParameters marginParameters_;
+    std::shared_ptr<PricingCache> pricingCache_;   // Null when disabled
+    std::unordered_map<std::string, UnderlyingRisk> underlyings_;
+    std::unordered_map<std::string, ProductGroup> productGroups_;
+
+    PortfolioTotals portfolio_;
+    std::atomic<double> margin_{0.0};   // Sum of the product groups' margins
+
     static constexpr double DEFAULT_RISK_FREE_RATE = 0.02;  // 2% risk-free rate
     static constexpr double DEFAULT_VOLATILITY = 0.20;      // 20% volatility
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,6 +4,26 @@
 #include <cmath>
 #include <vector>
 
+// Sum of position-weighted Greeks and value over a set of contracts
+struct GreekTotals {
+    double delta{0.0};
+    double gamma{0.0};
+    double theta{0.0};
+    double vega{0.0};
+    double rho{0.0};
+    double value{0.0};
+
+    GreekTotals& operator+=(const GreekTotals& other) {
+        delta += other.delta;
+        gamma += other.gamma;
+        theta += other.theta;
+        vega += other.vega;
+        rho += other.rho;
+        value += other.value;
+        return *this;
+    }
+};
+
 struct RiskMetrics {
     double totalDelta;
     double totalGamma;
@@ -52,6 +72,7 @@ struct RiskMetrics {
 
     double getPortfolioStress(double marketMove) const {
         // Calculate potential P&L for a given market move using Greeks
+        // (a Taylor approximation; RiskManagement::calculateStressGrid revalues in full)
         return totalDelta * marketMove + 
                0.5 * totalGamma * marketMove * marketMove +
                totalTheta / 365.0;  // Daily theta
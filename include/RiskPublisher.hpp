@@ -0,0 +1,81 @@
+#ifndef RISK_PUBLISHER_HPP
+#define RISK_PUBLISHER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "PortfolioBook.hpp"
+#include "RiskMetrics.hpp"
+
+class RiskManagement;
+
+// One computed view of the live risk, shared read-only by every consumer
+struct RiskSnapshot {
+    uint64_t sequence{0};
+    int64_t timestampNs{0};
+    std::string trigger;                  // "CADENCE" or "MOVE"
+    RiskMetrics metrics;
+    std::vector<RiskBucket> underlyings;  // Held underlyings, in symbol order
+};
+
+struct RiskPublisherConfig {
+    std::chrono::milliseconds cadence{1000};       // Recompute at least this often
+    std::chrono::milliseconds coalesceWindow{50};  // Minimum gap between recomputes
+    double significantMove{0.005};                 // Relative spot move since the last snapshot
+};
+
+// Recomputes risk on a background thread and hands each snapshot to the
+// registered listeners, so any number of readers share one computation.
+// A recompute happens every cadence, or sooner once some underlying has
+// moved by significantMove since the last snapshot. Ticks only set a flag:
+// a burst of them arriving within coalesceWindow of the previous recompute
+// is folded into the next one.
+class RiskPublisher {
+public:
+    using Listener = std::function<void(const std::shared_ptr<const RiskSnapshot>&)>;
+
+    explicit RiskPublisher(RiskManagement& risk, RiskPublisherConfig config = RiskPublisherConfig());
+    ~RiskPublisher();
+
+    void start();
+    void stop();
+
+    // Listeners are called on the publisher thread; add them before start()
+    void addListener(Listener listener);
+
+    // Feed every spot tick after the risk manager has taken it
+    void onUnderlyingPrice(const std::string& underlying, double spot);
+
+    std::shared_ptr<const RiskSnapshot> latest() const;   // Null before the first recompute
+    uint64_t recomputeCount() const { return recomputes_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    std::shared_ptr<const RiskSnapshot> compute(const char* trigger);
+
+    RiskManagement& risk_;
+    const RiskPublisherConfig config_;
+    std::vector<Listener> listeners_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_{false};
+    bool moved_{false};                                    // A significant move awaits a recompute
+    std::unordered_map<std::string, double> spots_;        // Latest tick per underlying
+    std::unordered_map<std::string, double> references_;   // Spot at the last snapshot
+    std::shared_ptr<const RiskSnapshot> latest_;
+    std::thread thread_;
+
+    uint64_t sequence_{0};
+    std::atomic<uint64_t> recomputes_{0};
+};
+
+#endif
@@ -0,0 +1,113 @@
+#ifndef SCENARIO_RISK_HPP
+#define SCENARIO_RISK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Joint spot and implied volatility moves, one row per scenario and one
+// column per underlying. Shocks are relative: a scenario values the book at
+// spot * (1 + spotShock) and volatility * (1 + volShock). Underlyings the
+// set does not cover are left unshocked.
+struct ScenarioSet {
+    std::vector<std::string> underlyings;
+    size_t count{0};
+    std::vector<double> spotShocks;   // count x underlyings.size(), scenario-major
+    std::vector<double> volShocks;    // Same shape, or empty for spot-only scenarios
+
+    double spotShock(size_t scenario, size_t underlying) const {
+        return spotShocks[scenario * underlyings.size() + underlying];
+    }
+    double volShock(size_t scenario, size_t underlying) const {
+        return volShocks.empty() ? 0.0 : volShocks[scenario * underlyings.size() + underlying];
+    }
+};
+
+// Historical simulation: one scenario per overlapping window of horizonDays
+// in daily closes (oldest first), applying every underlying's move over the
+// same window. Histories of different lengths are aligned on their most
+// recent close, so the set has as many scenarios as the shortest allows.
+// Implied volatility histories, where given and long enough, supply the
+// volatility shocks. Throws std::invalid_argument if no scenario fits.
+ScenarioSet makeHistoricalScenarios(
+    const std::unordered_map<std::string, std::vector<double>>& closes,
+    const std::unordered_map<std::string, std::vector<double>>& impliedVols = {},
+    size_t horizonDays = 1);
+
+struct MonteCarloParameters {
+    size_t scenarios = 10000;
+    double horizonDays = 1.0;          // Trading days; 252 to a year
+    double correlation = 0.5;          // Between any two spots, through one market factor
+    double volOfVol = 1.0;             // Annualised volatility of implied volatility
+    double spotVolCorrelation = -0.7;  // Volatility rises as spots fall
+    double defaultVolatility = 0.20;   // For underlyings missing from the volatility map
+    uint64_t seed = 42;
+};
+
+// Monte Carlo: lognormal spot moves at each underlying's volatility,
+// correlated through a single market factor, with lognormal volatility
+// moves correlated to the underlying's own return. Deterministic per seed.
+ScenarioSet makeMonteCarloScenarios(
+    const std::vector<std::string>& underlyings,
+    const MonteCarloParameters& parameters,
+    const std::unordered_map<std::string, double>& volatilities = {});
+
+struct ScenarioRiskLevel {
+    double confidence;
+    double valueAtRisk;         // Loss not exceeded with this confidence, positive for a loss
+    double expectedShortfall;   // Average loss in the scenarios beyond it
+};
+
+struct ScenarioRiskResult {
+    double baseValue{0.0};
+    std::vector<double> pnl;                 // Per scenario, in scenario order
+    std::vector<ScenarioRiskLevel> levels;   // One per requested confidence level
+    double elapsedMillis{0.0};
+};
+
+// Axes of a spot x volatility stress grid. Shifts are relative (-0.30 is a
+// 30% fall in spot, +0.50 a 50% rise in volatility) and both ranges include
+// their end points. decayDays rolls every expiry forward by that many
+// calendar days, so the grid also carries the time decay over the period.
+struct StressGridSpec {
+    double spotMin = -0.30;
+    double spotMax = 0.30;
+    double spotStep = 0.01;
+    double volMin = -0.50;
+    double volMax = 0.50;
+    double volStep = 0.05;
+    double decayDays = 0.0;
+
+    std::vector<double> spotShifts() const;
+    std::vector<double> volShifts() const;
+};
+
+// Full-revaluation P&L at every grid point, against the book at today's
+// spot and volatility with no decay. Points are stored spot-major: point
+// (i, j) is spotShifts[i] with volShifts[j].
+struct StressGrid {
+    std::vector<double> spotShifts;
+    std::vector<double> volShifts;
+    std::vector<std::string> underlyings;   // Those with a price, in symbol order
+    std::vector<double> underlyingPnL;      // underlyings.size() grids, one after another
+    std::vector<double> portfolioPnL;       // Every underlying moved by the same shifts
+    double elapsedMillis{0.0};
+
+    size_t points() const { return spotShifts.size() * volShifts.size(); }
+    double pnl(size_t underlying, size_t spot, size_t vol) const {
+        return underlyingPnL[underlying * points() + spot * volShifts.size() + vol];
+    }
+    double portfolio(size_t spot, size_t vol) const {
+        return portfolioPnL[spot * volShifts.size() + vol];
+    }
+};
+
+// VaR and expected shortfall of a P&L distribution at each confidence
+// level. At confidence c the worst ceil(n * (1 - c)) scenarios form the
+// tail: VaR is the smallest loss among them and ES their mean loss.
+std::vector<ScenarioRiskLevel> lossQuantiles(std::vector<double> pnl,
+                                             const std::vector<double>& confidenceLevels);
+
+#endif
@@ -0,0 +1,192 @@
+#ifndef SHARED_QUOTE_TABLE_HPP
+#define SHARED_QUOTE_TABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "OptionTypes.hpp"
+
+// Latest quote per contract in a POSIX shared-memory region, for readers
+// in other processes on the same host. One process writes; any number of
+// processes read without a syscall or a lock.
+//
+// Region layout, fixed for a given capacity:
+//   SharedQuoteHeader
+//   SharedQuoteSlot[capacity]           quotes, one 128-byte slot each
+//   SharedDirectoryEntry[capacity]      the directory: which contract a slot holds
+//   std::atomic<uint32_t>[indexSize]    open-addressed hash of the directory
+//
+// Slot i holds instrument ID i + 1 (see InstrumentRegistry), and a
+// contract keeps its slot for the life of the region. Every slot is a
+// seqlock: the writer makes its sequence odd, stores the fields and makes
+// it even again, so a reader that sees the same even sequence before and
+// after copying the fields has a consistent quote.
+
+constexpr uint64_t SHARED_QUOTE_MAGIC = 0x5154534f4d444b31ull;   // Set last, once the region is laid out
+constexpr uint32_t SHARED_QUOTE_LAYOUT_VERSION = 1;
+
+struct SharedQuoteHeader {
+    std::atomic<uint64_t> magic;
+    uint32_t layoutVersion;
+    uint32_t capacity;
+    uint32_t indexSize;            // Power of two, at least twice the capacity
+    uint32_t reserved;
+    int64_t createdNs;             // Tells a restarted writer's region from the old one
+    std::atomic<uint32_t> contracts;   // Directory entries published
+    std::atomic<uint32_t> overflows;   // Quotes not published: beyond the capacity, or fields too long
+};
+
+// Quote fields as readers get them
+struct SharedQuote {
+    double bid;
+    double ask;
+    double last;
+    double volume;
+    double impliedVol;
+    double delta;
+    double gamma;
+    double theta;
+    double vega;
+    double rho;
+    int64_t updateNs;   // system_clock nanoseconds at publication
+};
+
+struct alignas(64) SharedQuoteSlot {
+    std::atomic<uint32_t> sequence;   // Odd while being written; 0 until first written
+    uint32_t reserved;
+    std::atomic<int64_t> updateNs;
+    std::atomic<double> bid;
+    std::atomic<double> ask;
+    std::atomic<double> last;
+    std::atomic<double> volume;
+    std::atomic<double> impliedVol;
+    std::atomic<double> delta;
+    std::atomic<double> gamma;
+    std::atomic<double> theta;
+    std::atomic<double> vega;
+    std::atomic<double> rho;
+};
+
+struct SharedDirectoryEntry {
+    char underlying[16];
+    char expiry[11];   // YYYY-MM-DD, NUL-terminated
+    bool isCall;
+    std::atomic<uint32_t> defined;   // Set once the entry is written
+    double strike;
+};
+
+// A directory entry as readers get it
+struct SharedContract {
+    std::string underlying;
+    std::string optionType;   // CALL or PUT
+    double strike;
+    std::string expiry;
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int64_t>::is_always_lock_free &&
+              std::atomic<double>::is_always_lock_free,
+              "Shared quote slots need address-free atomics");
+static_assert(sizeof(SharedQuoteSlot) == 128, "SharedQuoteSlot is two cache lines");
+
+// The writer. It creates the region (replacing any left by an earlier
+// run), publishes quotes into it and unlinks it on destruction; readers
+// still attached keep their mapping. publish() must not be called from
+// two threads at once. Throws std::runtime_error if the region cannot be
+// created.
+class SharedQuoteTable {
+public:
+    SharedQuoteTable(const std::string& name, uint32_t capacity);
+    ~SharedQuoteTable();
+
+    SharedQuoteTable(const SharedQuoteTable&) = delete;
+    SharedQuoteTable& operator=(const SharedQuoteTable&) = delete;
+
+    // False, counting an overflow, if the ID is beyond the capacity or the
+    // contract's underlying or expiry does not fit a directory entry
+    bool publish(uint32_t id, const OptionData& data);
+
+    const std::string& name() const { return name_; }
+    uint32_t capacity() const { return header_->capacity; }
+    uint32_t overflows() const { return header_->overflows.load(std::memory_order_relaxed); }
+
+private:
+    bool define(uint32_t slot, const OptionData& data);   // False if the contract does not fit
+
+    std::string name_;
+    size_t size_;
+    void* region_;
+    SharedQuoteHeader* header_;
+    SharedQuoteSlot* slots_;
+    SharedDirectoryEntry* directory_;
+    std::atomic<uint32_t>* index_;
+    std::vector<bool> defined_;
+};
+
+// The reader, for co-located processes: maps the region read-only, looks
+// a contract up once and then reads its quote with a handful of loads.
+// Throws std::runtime_error if the region does not exist or is not a
+// quote table of this layout.
+class SharedQuoteReader {
+public:
+    // A writer stalled mid-update for this many attempts fails the read
+    static constexpr int MAX_READ_ATTEMPTS = 10000;
+
+    explicit SharedQuoteReader(const std::string& name);
+    ~SharedQuoteReader();
+
+    SharedQuoteReader(const SharedQuoteReader&) = delete;
+    SharedQuoteReader& operator=(const SharedQuoteReader&) = delete;
+
+    // The contract's instrument ID, for read(); false if it has not been
+    // published yet
+    bool find(const std::string& underlying, const std::string& optionType, double strike,
+              const std::string& expiry, uint32_t& id) const;
+
+    // False if the contract has never been quoted, or the writer stayed
+    // mid-update through every attempt
+    bool read(uint32_t id, SharedQuote& quote) const {
+        if (id == 0 || id > header_->capacity) return false;
+        const SharedQuoteSlot& slot = slots_[id - 1];
+        for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; ++attempt) {
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1u) continue;
+
+            quote.bid = slot.bid.load(std::memory_order_relaxed);
+            quote.ask = slot.ask.load(std::memory_order_relaxed);
+            quote.last = slot.last.load(std::memory_order_relaxed);
+            quote.volume = slot.volume.load(std::memory_order_relaxed);
+            quote.impliedVol = slot.impliedVol.load(std::memory_order_relaxed);
+            quote.delta = slot.delta.load(std::memory_order_relaxed);
+            quote.gamma = slot.gamma.load(std::memory_order_relaxed);
+            quote.theta = slot.theta.load(std::memory_order_relaxed);
+            quote.vega = slot.vega.load(std::memory_order_relaxed);
+            quote.rho = slot.rho.load(std::memory_order_relaxed);
+            quote.updateNs = slot.updateNs.load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) return true;
+        }
+        return false;
+    }
+
+    // The contract held by an ID's slot; false if none
+    bool contract(uint32_t id, SharedContract& contract) const;
+
+    uint32_t size() const { return header_->contracts.load(std::memory_order_acquire); }
+    uint32_t capacity() const { return header_->capacity; }
+    uint32_t overflows() const { return header_->overflows.load(std::memory_order_relaxed); }
+    int64_t createdNs() const { return header_->createdNs; }
+
+private:
+    size_t size_;
+    void* region_;
+    const SharedQuoteHeader* header_;
+    const SharedQuoteSlot* slots_;
+    const SharedDirectoryEntry* directory_;
+    const std::atomic<uint32_t>* index_;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef STRATEGY_HPP
+#define STRATEGY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "OrderStore.hpp"
+#include "RiskMetrics.hpp"
+
+// One leg of a multi-leg strategy. The ratio is signed: +1 buys one
+// contract per strategy unit, -2 sells two. A strike of zero or less is
+// the underlying itself.
+struct StrategyLeg {
+    InstrumentKey instrument;
+    int32_t ratio;
+};
+
+struct Strategy {
+    std::string name;   // For display only
+    std::vector<StrategyLeg> legs;
+};
+
+constexpr size_t MAX_STRATEGY_LEGS = 8;
+
+// Throws std::invalid_argument unless the strategy has 1 to
+// MAX_STRATEGY_LEGS legs, each with a nonzero ratio, an underlying and a
+// distinct instrument
+void validateStrategy(const Strategy& strategy);
+
+// The common shapes, one unit each. Expiries are YYYY-MM-DD.
+// Vertical: calls are long the lower strike and short the upper (a bull
+// call spread); puts are long the upper strike and short the lower (a bear
+// put spread).
+Strategy makeVerticalSpread(const std::string& underlying, const std::string& expiry, bool isCall,
+                            double lowerStrike, double upperStrike);
+Strategy makeStraddle(const std::string& underlying, const std::string& expiry, double strike);
+Strategy makeStrangle(const std::string& underlying, const std::string& expiry,
+                      double putStrike, double callStrike);
+// Short iron condor: short the inner put and call, long the wings.
+// Strikes must ascend: putWing < putShort < callShort < callWing.
+Strategy makeIronCondor(const std::string& underlying, const std::string& expiry,
+                        double putWing, double putShort, double callShort, double callWing);
+// Long calendar: short the near expiry, long the far one, same strike
+Strategy makeCalendarSpread(const std::string& underlying, const std::string& nearExpiry,
+                            const std::string& farExpiry, bool isCall, double strike);
+
+// Multi-leg order: quantity strategy units, so each leg trades
+// ratio * quantity contracts. LIMIT orders carry one limit price per leg.
+struct StrategyOrder {
+    Strategy strategy;
+    int32_t quantity{0};
+    OptionOrder::OrderType orderType{OptionOrder::OrderType::MARKET};
+    OptionOrder::TimeInForce timeInForce{OptionOrder::TimeInForce::DAY};
+    std::vector<double> limitPrices;   // Parallel to the legs
+    int64_t expireTimeNs{0};           // GTD expiry, system_clock nanoseconds
+};
+
+// What trading one candidate strategy would do to the live portfolio
+struct StrategyImpact {
+    double price{0.0};        // Per strategy unit: positive for a debit, negative for a credit
+    GreekTotals greeks;       // Change in the portfolio's Greeks and value for the quantity evaluated
+    double marginChange{0.0};
+    double marginAfter{0.0};  // Portfolio margin if only this candidate were traded
+    bool priced{false};       // False if a leg's underlying has no spot price yet; its legs add nothing,
+                              // and only count as within limits if they reduce what is held
+    bool withinLimits{false};
+};
+
+struct StrategyEvaluation {
+    std::vector<StrategyImpact> impacts;   // Parallel to the candidates
+    size_t contractsPriced{0};             // Distinct contracts across all candidates
+    double elapsedMillis{0.0};
+};
+
+#endif
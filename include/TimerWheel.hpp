@@ -0,0 +1,190 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Hierarchical timer wheel. Timers live in a pooled array of intrusive list
+// nodes, so schedule() and cancel() are O(1) and never touch other timers.
+// advance() walks one level-0 slot per tick and cascades coarser levels
+// down as the finer ones wrap around.
+template <typename Payload>
+class TimerWheel {
+public:
+    // Encodes (generation << 32) | node index, so a stale ID never cancels
+    // a timer that has since reused the same node.
+    using TimerId = uint64_t;
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    explicit TimerWheel(uint64_t startTick, size_t initialCapacity = 1024)
+        : currentTick_(startTick) {
+        heads_.fill(NIL);
+        nodes_.reserve(initialCapacity);
+    }
+
+    // Schedule a timer to fire once advance() reaches expiryTick.
+    // Ticks already in the past fire on the next advance().
+    TimerId schedule(uint64_t expiryTick, Payload payload) {
+        uint32_t index = allocateNode();
+        Node& node = nodes_[index];
+        node.expiry = expiryTick;
+        node.payload = std::move(payload);
+        link(index);
+        ++size_;
+        return (static_cast<uint64_t>(node.generation) << 32) | index;
+    }
+
+    // Returns false if the timer already fired or was cancelled.
+    bool cancel(TimerId id) {
+        uint32_t index = static_cast<uint32_t>(id);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (id == INVALID_TIMER || index >= nodes_.size()) return false;
+
+        Node& node = nodes_[index];
+        if (node.bucket == NIL || node.generation != generation) return false;
+
+        unlink(index);
+        releaseNode(index);
+        --size_;
+        return true;
+    }
+
+    // Fire every timer due at or before nowTick. onExpire(Payload&) is called
+    // after the timer is released, so it may schedule or cancel other timers.
+    template <typename Fn>
+    size_t advance(uint64_t nowTick, Fn&& onExpire) {
+        size_t fired = 0;
+        while (currentTick_ <= nowTick) {
+            // Cascade coarser levels whenever the finer level wraps to slot 0
+            for (unsigned level = 1; level < LEVELS; ++level) {
+                if (slotIndex(currentTick_, level - 1) != 0) break;
+                cascade(level, slotIndex(currentTick_, level));
+            }
+
+            uint32_t bucket = slotIndex(currentTick_, 0);
+            uint32_t index = heads_[bucket];
+            heads_[bucket] = NIL;
+
+            while (index != NIL) {
+                uint32_t next = nodes_[index].next;
+                Node& node = nodes_[index];
+                if (node.expiry > currentTick_) {
+                    // Clamped beyond the wheel's range: put it back further out
+                    link(index);
+                } else {
+                    Payload payload = std::move(node.payload);
+                    node.bucket = NIL;
+                    releaseNode(index);
+                    --size_;
+                    ++fired;
+                    onExpire(payload);
+                }
+                index = next;
+            }
+            ++currentTick_;
+        }
+        return fired;
+    }
+
+    size_t size() const { return size_; }
+    uint64_t currentTick() const { return currentTick_; }
+
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr unsigned SLOTS = 1u << SLOT_BITS;
+    static constexpr unsigned LEVELS = 6;  // 2^36 ticks of range
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint64_t MAX_DELTA = (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        uint64_t expiry{0};
+        uint32_t prev{NIL};
+        uint32_t next{NIL};
+        uint32_t bucket{NIL};   // NIL when the node is free
+        uint32_t generation{1};
+        Payload payload{};
+    };
+
+    static uint32_t slotIndex(uint64_t tick, unsigned level) {
+        return static_cast<uint32_t>((tick >> (level * SLOT_BITS)) & SLOT_MASK);
+    }
+
+    void link(uint32_t index) {
+        Node& node = nodes_[index];
+        uint64_t expiry = node.expiry;
+        if (expiry < currentTick_) {
+            expiry = currentTick_;
+        } else if (expiry - currentTick_ > MAX_DELTA) {
+            expiry = currentTick_ + MAX_DELTA;
+        }
+
+        uint64_t delta = expiry - currentTick_;
+        unsigned level = 0;
+        while (level + 1 < LEVELS && delta >= (uint64_t{1} << ((level + 1) * SLOT_BITS))) {
+            ++level;
+        }
+
+        uint32_t bucket = level * SLOTS + slotIndex(expiry, level);
+        node.bucket = bucket;
+        node.prev = NIL;
+        node.next = heads_[bucket];
+        if (node.next != NIL) nodes_[node.next].prev = index;
+        heads_[bucket] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != NIL) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.bucket] = node.next;
+        }
+        if (node.next != NIL) nodes_[node.next].prev = node.prev;
+        node.prev = node.next = NIL;
+        node.bucket = NIL;
+    }
+
+    void cascade(unsigned level, uint32_t slot) {
+        uint32_t bucket = level * SLOTS + slot;
+        uint32_t index = heads_[bucket];
+        heads_[bucket] = NIL;
+        while (index != NIL) {
+            uint32_t next = nodes_[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    uint32_t allocateNode() {
+        if (freeHead_ != NIL) {
+            uint32_t index = freeHead_;
+            freeHead_ = nodes_[index].next;
+            nodes_[index].next = NIL;
+            return index;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void releaseNode(uint32_t index) {
+        Node& node = nodes_[index];
+        node.payload = Payload{};
+        // Skip generation 0 so a recycled node never produces INVALID_TIMER
+        if (++node.generation == 0) node.generation = 1;
+        node.prev = NIL;
+        node.next = freeHead_;
+        freeHead_ = index;
+    }
+
+    std::vector<Node> nodes_;
+    std::array<uint32_t, LEVELS * SLOTS> heads_;
+    uint32_t freeHead_{NIL};
+    uint64_t currentTick_;
+    size_t size_{0};
+};
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef TSC_CLOCK_HPP
+#define TSC_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Timestamps for latency measurement from the CPU's time-stamp counter:
+// reading it takes a few nanoseconds where clock_gettime() takes tens.
+// Ticks only mean something as differences; nanosPerTick() converts them.
+//
+// Assumes an invariant TSC (constant rate, synchronized across cores), as
+// on every x86 server CPU of the last decade, so ticks taken on different
+// threads can be subtracted. On other targets ticks are steady_clock
+// nanoseconds.
+class TscClock {
+public:
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Measured against steady_clock on the first call, which takes about
+    // CALIBRATION_TIME; call it once at start-up, off the hot path
+    static double nanosPerTick();
+
+    static double toNanos(uint64_t ticks) {
+        return static_cast<double>(ticks) * nanosPerTick();
+    }
+
+    static constexpr std::chrono::milliseconds CALIBRATION_TIME{20};
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef WRITE_AHEAD_LOG_HPP
+#define WRITE_AHEAD_LOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "OrderStore.hpp"
+
+// A change to one order, carrying the order's full state after the change
+// so replay is a straight overwrite of the slab slot.
+struct OrderEvent {
+    enum class Type : uint8_t { SUBMITTED, REPLACED, FILLED, CANCELLED, REJECTED, EXPIRED, ARCHIVED };
+
+    uint64_t sequence;      // Assigned by the log, strictly increasing from 1
+    int64_t timestampNs;    // system_clock nanoseconds since epoch
+    Type type;
+    OrderRecord order;
+};
+
+static_assert(std::is_trivially_copyable<OrderEvent>::value,
+              "OrderEvent is written to disk as raw bytes");
+
+// Append-only log of order events with group commit. append() only copies
+// the event into an in-memory batch; a background thread writes each batch
+// with one write() and one fdatasync(), so callers never pay for a syscall.
+//
+// Appenders write to one of several lanes, each with its own buffer and
+// lock, so callers on different lanes share nothing but the sequence
+// counter. The writer takes every lane at once and merges them back into
+// sequence order, so the file is the same as with a single buffer.
+//
+// On disk the log is a directory of segments named by the sequence of their
+// first event (wal-<sequence>.log). Each record is framed with a checksum so
+// a torn write at the tail is detected and discarded on recovery.
+class WriteAheadLog {
+public:
+    struct Options {
+        std::chrono::microseconds flushInterval{1000};  // Upper bound on batch age
+        size_t flushBytes = 1 << 20;                     // Flush early once a batch is this big
+        size_t segmentBytes = 64 << 20;                  // Roll to a new segment past this size
+        size_t lanes = 1;                                // Independent append buffers
+    };
+
+    struct Stats {
+        uint64_t eventsAppended;
+        uint64_t batchesFlushed;
+        uint64_t bytesWritten;
+        uint64_t durableSequence;
+    };
+
+    // Creates the directory if needed; nothing is opened for writing until start()
+    explicit WriteAheadLog(const std::string& directory);
+    WriteAheadLog(const std::string& directory, const Options& options);
+    ~WriteAheadLog();
+
+    // Replays every intact event after afterSequence in order, truncating a
+    // torn tail. Must be called before start(); returns the events replayed.
+    // Throws std::runtime_error if events between afterSequence and the
+    // first logged event are missing.
+    size_t recover(uint64_t afterSequence, const std::function<void(const OrderEvent&)>& apply);
+
+    void start();
+    void stop();  // Flushes everything appended so far
+
+    // Thread-safe; returns the event's sequence number. Appends to
+    // different lanes never contend; lane is taken modulo Options::lanes.
+    // Events appended after stop() are never written.
+    uint64_t append(OrderEvent::Type type, const OrderRecord& order, size_t lane = 0);
+
+    // Blocks until every event up to sequence is on disk
+    void waitDurable(uint64_t sequence);
+
+    // Removes segments whose events are all at or before sequence
+    void truncateBefore(uint64_t sequence);
+
+    uint64_t lastSequence() const { return lastSequence_.load(std::memory_order_acquire); }
+    uint64_t durableSequence() const { return durableSequence_.load(std::memory_order_acquire); }
+    Stats getStats() const;
+
+private:
+    struct Frame {
+        uint32_t magic;
+        uint32_t checksum;
+        OrderEvent event;
+    };
+
+    struct Segment {
+        uint64_t firstSequence;
+        std::string path;
+    };
+
+    // Frames in sequence order; the writer swaps pending for an empty buffer
+    struct alignas(64) Lane {
+        std::mutex mutex;
+        std::vector<char> pending;
+    };
+
+    std::vector<Segment> listSegments() const;
+    void openSegment(uint64_t firstSequence);
+    void flushLoop();
+    uint64_t collectBatch();  // Merges every lane into batch_; returns its last sequence
+    void writeBatch(const std::vector<char>& batch);
+
+    static uint32_t checksum(const OrderEvent& event);
+
+    std::string directory_;
+    Options options_;
+
+    // Appenders fill their lane; the flusher swaps each lane's buffer
+    // with its flushing_ buffer and merges them into batch_
+    std::unique_ptr<Lane[]> lanes_;
+    std::vector<std::vector<char>> flushing_;
+    std::vector<char> batch_;
+    std::atomic<uint64_t> lastSequence_{0};    // Assigned under the appending lane's lock
+    std::atomic<uint64_t> flushedSequence_{0};  // Last sequence handed to the flusher
+
+    // Guards the flusher's state and lifecycle, never taken by append()
+    mutable std::mutex mutex_;
+    std::condition_variable flushCv_;
+    std::condition_variable durableCv_;
+
+    std::atomic<uint64_t> durableSequence_{0};
+    std::atomic<uint64_t> eventsAppended_{0};
+    std::atomic<uint64_t> batchesFlushed_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+
+    int fd_{-1};
+    size_t segmentSize_{0};
+    bool recovered_{false};
+    bool running_{false};
+    std::thread flushThread_;
+
+    static constexpr uint32_t FRAME_MAGIC = 0x4C41574F;  // "OWAL"
+};
+
+#endif
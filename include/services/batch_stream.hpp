@@ -0,0 +1,162 @@
+#ifndef BATCH_STREAM_HPP
+#define BATCH_STREAM_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "QuoteConflator.hpp"
+#include "services/quote_fanout.hpp"
+
+constexpr size_t MAX_BATCH_CONTRACTS = 8192;   // Pending per batch stream before dropping
+
+// A bidirectional market data stream: the client adds and removes filters
+// as it goes, and every batch interval the stream writes the latest tick
+// of each matching contract that changed, with at most one write in
+// flight. A reader that falls behind gets the newest tick of each contract
+// in its next batch rather than every tick between.
+//
+// The Codec gives the wire format:
+//   using Request = ...;   // Subscription message
+//   using Batch = ...;
+//   // False with an error message for a malformed ADD
+//   static bool parse(const Request& request, uint32_t& id, bool& add, QuoteFilter& filter,
+//                     std::string& error);
+//   // Fills the batch; may keep per-stream state
+//   void encode(uint64_t sequence, uint32_t conflated, uint32_t dropped,
+//               const std::vector<OptionData>& ticks, Batch& batch);
+template <class Codec>
+class BatchStream final
+    : public grpc::ServerBidiReactor<typename Codec::Request, typename Codec::Batch>,
+      public QuoteSink {
+public:
+    template <class... CodecArgs>
+    explicit BatchStream(QuoteFanout& fanout, CodecArgs&&... codecArgs)
+        : fanout_(fanout), codec_(std::forward<CodecArgs>(codecArgs)...), conflator_(MAX_BATCH_CONTRACTS) {
+        fanout_.addBatched(this);
+        this->StartRead(&request_);
+    }
+
+    void offer(const OptionData& data) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        for (const auto& entry : filters_) {
+            if (entry.second.matches(data)) {
+                conflator_.offer(data);
+                return;
+            }
+        }
+    }
+
+    // A write still in flight means the reader is behind: the ticks keep
+    // conflating until an interval finds it done
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writing_ || finished_ || (conflator_.empty() && conflator_.dropped() == 0)) return;
+
+        uint32_t conflated = conflator_.conflated();
+        uint32_t dropped = conflator_.dropped();
+        conflator_.drain(ticks_);
+        batch_.Clear();
+        codec_.encode(++sequence_, conflated, dropped, ticks_, batch_);
+        writing_ = true;
+        this->StartWrite(&batch_);
+    }
+
+    void OnReadDone(bool ok) override {
+        if (!ok) {
+            // The client is done changing filters; ticks flow until it
+            // cancels, unless it left nothing subscribed
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (filters_.empty()) finish(grpc::Status::OK);
+            return;
+        }
+
+        uint32_t id;
+        bool add;
+        QuoteFilter filter;
+        std::string error;
+        std::string added, removed;   // Underlyings this stream starts or stops watching
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished_) return;
+            if (!Codec::parse(request_, id, add, filter, error)) {
+                finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, error));
+                return;
+            }
+            if (add && !QuoteFanout::validSymbol(filter.underlying)) {
+                finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                                    "Subscription " + std::to_string(id) + " has an invalid underlying"));
+                return;
+            }
+            auto existing = filters_.find(id);
+            if (existing != filters_.end()) {
+                if (--underlyingFilters_[existing->second.underlying] == 0) {
+                    underlyingFilters_.erase(existing->second.underlying);
+                    removed = existing->second.underlying;
+                }
+                filters_.erase(existing);
+            }
+            if (add) {
+                if (underlyingFilters_[filter.underlying]++ == 0) added = filter.underlying;
+                filters_[id] = std::move(filter);
+                if (added == removed) {
+                    // Replaced by a filter on the same underlying
+                    added.clear();
+                    removed.clear();
+                }
+            }
+        }
+
+        if (!removed.empty()) fanout_.unwatch(this, removed);
+        if (!added.empty() && !fanout_.watch(this, added)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Too many underlyings watched"));
+            return;
+        }
+        this->StartRead(&request_);
+    }
+
+    void OnWriteDone(bool ok) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        if (!ok) finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Market data stream write failed"));
+    }
+
+    void OnCancel() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(grpc::Status::CANCELLED);
+    }
+
+    void OnDone() override {
+        fanout_.remove(this);
+        delete this;
+    }
+
+private:
+    // Callers hold mutex_
+    void finish(const grpc::Status& status) {
+        if (finished_) return;
+        finished_ = true;
+        this->Finish(status);
+    }
+
+    QuoteFanout& fanout_;
+    typename Codec::Request request_;   // Touched only by the read callbacks
+
+    std::mutex mutex_;
+    Codec codec_;
+    std::unordered_map<uint32_t, QuoteFilter> filters_;     // By subscription ID
+    std::unordered_map<std::string, size_t> underlyingFilters_;
+    QuoteConflator conflator_;
+    std::vector<OptionData> ticks_;
+    typename Codec::Batch batch_;   // Untouched until OnWriteDone
+    uint64_t sequence_{0};
+    bool writing_{false};
+    bool finished_{false};
+};
+
+#endif
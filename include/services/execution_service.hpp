@@ -2,12 +2,28 @@
 #define EXECUTION_SERVICE_HPP
 
 #include <grpcpp/grpcpp.h>
+#include <mutex>
+#include <unordered_set>
 #include "execution.grpc.pb.h"
-#include "ExecutionEngine.hpp"
+#include "OrderEventJournal.hpp"
 
-class ExecutionServiceImpl final : public trading::ExecutionService::Service {
+class OrderManagementSystem;
+
+// ExecuteTrade submits through the OMS like any other order and only
+// acknowledges it; fills, cancels and rejects reach clients on
+// StreamExecutionEvents, read from the order event journal, and
+// GetExecutionReport looks fills up there by execution ID.
+//
+// Each stream reads the journal from its own position, one batch per
+// write, so a slow client only falls behind; once its position has been
+// overwritten the stream ends with OUT_OF_RANGE and the client resyncs.
+class ExecutionServiceImpl final
+    : public trading::ExecutionService::WithCallbackMethod_StreamExecutionEvents<trading::ExecutionService::Service> {
 public:
-    explicit ExecutionServiceImpl(ExecutionEngine& execEngine);
+    static constexpr size_t MAX_BATCH_EVENTS = 256;
+
+    // Registers with the journal, so construct it before journal.start()
+    ExecutionServiceImpl(OrderManagementSystem& oms, OrderEventJournal& journal);
 
     grpc::Status ExecuteTrade(
         grpc::ServerContext* context,
@@ -19,8 +35,21 @@ public:
         const trading::ExecutionReportRequest* request,
         trading::ExecutionReportResponse* response) override;
 
+    grpc::ServerWriteReactor<trading::ExecutionEventBatch>* StreamExecutionEvents(
+        grpc::CallbackServerContext* context,
+        const trading::ExecutionEventsRequest* request) override;
+
 private:
-    ExecutionEngine& execEngine_;
+    class EventStream;
+
+    void notify();
+    void unsubscribe(EventStream* stream);
+
+    OrderManagementSystem& oms_;
+    OrderEventJournal& journal_;
+
+    std::mutex mutex_;
+    std::unordered_set<EventStream*> streams_;
 };
 
-#endif
\ No newline at end of file
+#endif
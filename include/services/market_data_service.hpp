@@ -4,23 +4,48 @@
 #include <grpcpp/grpcpp.h>
 #include "market_data.grpc.pb.h"
 #include "MarketDataHandler.hpp"
+#include "services/option_chain_cache.hpp"
+#include "services/quote_fanout.hpp"
 
-class MarketDataServiceImpl final : public trading::MarketDataService::Service {
+// Every method is a callback method: the service needs no server threads
+// of its own in either server mode. Ticks come through the shared
+// QuoteFanout.
+//
+// A StreamMarketData stream still writing keeps at most MAX_PENDING_QUOTES
+// queued, dropping the oldest, so a slow client never holds up the feed or
+// the other clients. SubscribeMarketData streams are BatchStreams: filters
+// added and removed on the fly, conflated ticks in batches.
+//
+// GetOptionChain is a raw method answered from an OptionChainCache, so a
+// chain that has not changed is never serialized twice.
+class MarketDataServiceImpl
+    : public trading::MarketDataService::WithRawCallbackMethod_GetOptionChain<
+          trading::MarketDataService::WithCallbackMethod_SubscribeMarketData<
+              trading::MarketDataService::WithCallbackMethod_StreamMarketData<trading::MarketDataService::Service>>> {
 public:
-    explicit MarketDataServiceImpl(MarketDataHandler& marketDataHandler);
-    
-    grpc::Status StreamMarketData(
-        grpc::ServerContext* context,
-        const trading::MarketDataRequest* request,
-        grpc::ServerWriter<trading::MarketDataResponse>* writer) override;
-
-    grpc::Status GetOptionChain(
-        grpc::ServerContext* context,
-        const trading::OptionChainRequest* request,
-        trading::OptionChainResponse* response) override;
+    static constexpr size_t MAX_PENDING_QUOTES = 256;
+
+    explicit MarketDataServiceImpl(QuoteFanout& fanout);
+
+    grpc::ServerWriteReactor<trading::MarketDataResponse>* StreamMarketData(
+        grpc::CallbackServerContext* context,
+        const trading::MarketDataRequest* request) override;
+
+    grpc::ServerBidiReactor<trading::MarketDataSubscription, trading::MarketDataBatch>* SubscribeMarketData(
+        grpc::CallbackServerContext* context) override;
+
+    grpc::ServerUnaryReactor* GetOptionChain(
+        grpc::CallbackServerContext* context,
+        const grpc::ByteBuffer* request,
+        grpc::ByteBuffer* response) override;
+
+    OptionChainCache::Stats getChainCacheStats() const { return chainCache_.getStats(); }
 
 private:
-    MarketDataHandler& marketDataHandler_;
+    class Subscription;
+
+    QuoteFanout& fanout_;
+    OptionChainCache chainCache_;
 };
 
-#endif
\ No newline at end of file
+#endif
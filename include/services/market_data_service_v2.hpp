@@ -0,0 +1,41 @@
+#ifndef MARKET_DATA_SERVICE_V2_HPP
+#define MARKET_DATA_SERVICE_V2_HPP
+
+#include <grpcpp/grpcpp.h>
+#include "trading_v2.grpc.pb.h"
+#include "services/option_chain_cache.hpp"
+#include "services/quote_fanout.hpp"
+
+// Market data on the compact v2 schema, from the same feed and fan-out as
+// v1. Quotes carry instrument IDs; a SubscribeMarketData stream sends each
+// contract's definition in the first batch that quotes it. GetOptionChain
+// is served as packed columns from its own OptionChainCache.
+class MarketDataServiceV2Impl
+    : public trading::v2::MarketDataService::WithRawCallbackMethod_GetOptionChain<
+          trading::v2::MarketDataService::WithCallbackMethod_SubscribeMarketData<
+              trading::v2::MarketDataService::WithCallbackMethod_GetInstruments<
+                  trading::v2::MarketDataService::Service>>> {
+public:
+    explicit MarketDataServiceV2Impl(QuoteFanout& fanout);
+
+    grpc::ServerUnaryReactor* GetInstruments(
+        grpc::CallbackServerContext* context,
+        const trading::v2::InstrumentsRequest* request,
+        trading::v2::InstrumentsResponse* response) override;
+
+    grpc::ServerUnaryReactor* GetOptionChain(
+        grpc::CallbackServerContext* context,
+        const grpc::ByteBuffer* request,
+        grpc::ByteBuffer* response) override;
+
+    grpc::ServerBidiReactor<trading::v2::Subscription, trading::v2::QuoteBatch>* SubscribeMarketData(
+        grpc::CallbackServerContext* context) override;
+
+    OptionChainCache::Stats getChainCacheStats() const { return chainCache_.getStats(); }
+
+private:
+    QuoteFanout& fanout_;
+    OptionChainCache chainCache_;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef METRICS_SERVICE_HPP
+#define METRICS_SERVICE_HPP
+
+#include <grpcpp/grpcpp.h>
+#include "metrics.grpc.pb.h"
+
+// Serves Metrics::snapshot(). Summing the per-thread histograms takes a
+// few hundred microseconds, on the calling RPC thread only; the recording
+// threads never wait on it.
+class MetricsServiceImpl final : public trading::MetricsService::Service {
+public:
+    grpc::Status GetMetrics(
+        grpc::ServerContext* context,
+        const trading::MetricsRequest* request,
+        trading::MetricsResponse* response) override;
+};
+
+#endif
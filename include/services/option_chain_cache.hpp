@@ -0,0 +1,59 @@
+#ifndef OPTION_CHAIN_CACHE_HPP
+#define OPTION_CHAIN_CACHE_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "MarketDataHandler.hpp"
+
+// Serialized chain response per (underlying, expiration), rebuilt only
+// when the handler's chain version has moved since the last build. Any
+// number of clients asking for an unchanged chain share one serialization:
+// each gets a reference to the same bytes. Concurrent requests for a stale
+// chain wait for one rebuild rather than each doing their own. Only
+// chains that exist get a slot: NOT_FOUND requests leave nothing cached.
+class OptionChainCache {
+public:
+    enum class Encoding {
+        ROWS,      // v1 OptionChainResponse
+        COLUMNS    // v2 OptionChainColumns
+    };
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t builds{0};
+    };
+
+    explicit OptionChainCache(const MarketDataHandler& handler, Encoding encoding = Encoding::ROWS);
+
+    // An empty expiration takes every expiry. NOT_FOUND if the handler has
+    // no contracts for the underlying, or none on that expiration.
+    grpc::Status get(const std::string& underlying, const std::string& expiration, grpc::ByteBuffer* response);
+
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        std::mutex mutex;
+        uint64_t version{0};   // Chain version the bytes were built from; 0 before the first build
+        grpc::Slice bytes;
+    };
+
+    // Callers hold entry.mutex, or have the entry to themselves
+    bool build(const std::string& underlying, const std::string& expiration, Entry& entry);
+
+    const MarketDataHandler& handler_;
+    const Encoding encoding_;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;   // By underlying + '\0' + expiration
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> builds_{0};
+};
+
+#endif
@@ -5,8 +5,15 @@
 #include "order_management.grpc.pb.h"
 #include "OrderManagementSystem.hpp"
 
-class OrderManagementServiceImpl final : public trading::OrderManagementService::Service {
+// OrderEntry is a callback method, so it needs no server thread in
+// either server mode; the unary methods are synchronous handlers.
+class OrderManagementServiceImpl final
+    : public trading::OrderManagementService::WithCallbackMethod_OrderEntry<trading::OrderManagementService::Service> {
 public:
+    // Acks a stream has not yet written; past this it stops reading until
+    // the client takes them
+    static constexpr int MAX_PENDING_ACKS = 4096;
+
     explicit OrderManagementServiceImpl(OrderManagementSystem& oms);
 
     grpc::Status PlaceOrder(
@@ -29,7 +36,15 @@ public:
         const trading::OrderHistoryRequest* request,
         trading::OrderHistoryResponse* response) override;
 
+    grpc::ServerBidiReactor<trading::OrderEntryRequest, trading::OrderEntryAcks>* OrderEntry(
+        grpc::CallbackServerContext* context) override;
+
 private:
+    class OrderEntryStream;
+
+    // Carries out one order entry request; a refused one is acked REJECTED
+    void enter(const trading::OrderEntryRequest& request, trading::OrderEntryAck* ack);
+
     OrderManagementSystem& oms_;
 };
 
@@ -0,0 +1,38 @@
+#ifndef ORDER_MANAGEMENT_SERVICE_V2_HPP
+#define ORDER_MANAGEMENT_SERVICE_V2_HPP
+
+#include <grpcpp/grpcpp.h>
+#include "trading_v2.grpc.pb.h"
+#include "InstrumentRegistry.hpp"
+#include "OrderManagementSystem.hpp"
+
+// Orders on the compact v2 schema. Contracts are the market data
+// instrument IDs and orders are their 64-bit handles, so an order goes
+// to the OMS handle path without touching a string.
+class OrderManagementServiceV2Impl final : public trading::v2::OrderManagementService::Service {
+public:
+    OrderManagementServiceV2Impl(OrderManagementSystem& oms, const InstrumentRegistry& instruments);
+
+    // An order the OMS refuses is answered OK with status REJECTED and
+    // the reason in message
+    grpc::Status PlaceOrder(
+        grpc::ServerContext* context,
+        const trading::v2::OrderRequest* request,
+        trading::v2::OrderResponse* response) override;
+
+    grpc::Status CancelOrder(
+        grpc::ServerContext* context,
+        const trading::v2::CancelOrderRequest* request,
+        trading::v2::CancelOrderResponse* response) override;
+
+    grpc::Status GetOrderStatus(
+        grpc::ServerContext* context,
+        const trading::v2::OrderStatusRequest* request,
+        trading::v2::OrderStatusResponse* response) override;
+
+private:
+    OrderManagementSystem& oms_;
+    const InstrumentRegistry& instruments_;
+};
+
+#endif
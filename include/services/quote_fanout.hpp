@@ -0,0 +1,90 @@
+#ifndef QUOTE_FANOUT_HPP
+#define QUOTE_FANOUT_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include "MarketDataHandler.hpp"
+
+constexpr size_t MAX_FEED_SYMBOLS = 256;   // Underlyings watched at once, across every client
+
+// Contracts on one underlying; empty or zero fields match everything
+struct QuoteFilter {
+    std::string underlying;
+    std::string optionType;   // CALL or PUT
+    std::string expiry;       // YYYY-MM-DD
+    double minStrike{0.0};
+    double maxStrike{0.0};
+
+    bool matches(const OptionData& data) const {
+        return underlying == data.underlying &&
+               (optionType.empty() || optionType == data.optionType) &&
+               (expiry.empty() || expiry == data.expiry) &&
+               (minStrike <= 0.0 || data.strike >= minStrike) &&
+               (maxStrike <= 0.0 || data.strike <= maxStrike);
+    }
+};
+
+// One market data stream, in whichever wire format
+class QuoteSink {
+public:
+    virtual ~QuoteSink() = default;
+
+    // Called with the fan-out lock held, for ticks on a watched underlying
+    virtual void offer(const OptionData& data) = 0;
+
+    // Called with the fan-out lock held, every batch interval, for sinks
+    // added as batched
+    virtual void flush() {}
+};
+
+// Adds a data callback to the handler and hands each tick to the sinks
+// watching its underlying, so every market data service and wire version
+// shares one feed. The handler polls each underlying once, however many
+// sinks watch it, and stops polling it when the last one leaves. Batched
+// sinks are flushed together from the fan-out's
+// own thread every batchInterval.
+class QuoteFanout {
+public:
+    explicit QuoteFanout(MarketDataHandler& handler,
+                         std::chrono::milliseconds batchInterval = std::chrono::milliseconds(50));
+    ~QuoteFanout();
+
+    MarketDataHandler& handler() { return handler_; }
+
+    // Symbols a client may watch: 1 to 15 letters, digits, '.', '-', '/' or '^'
+    static bool validSymbol(const std::string& symbol);
+
+    // False, watching nothing, if the symbol is not valid or
+    // MAX_FEED_SYMBOLS other underlyings are already watched
+    bool watch(QuoteSink* sink, const std::string& underlying);
+    void unwatch(QuoteSink* sink, const std::string& underlying);
+    void addBatched(QuoteSink* sink);
+
+    // From every underlying and the batch list; after it returns the sink
+    // is never called again
+    void remove(QuoteSink* sink);
+
+private:
+    void publish(const OptionData& data);
+    void runBatches();
+
+    MarketDataHandler& handler_;
+    const std::chrono::milliseconds batchInterval_;
+
+    std::mutex mutex_;   // Before any sink's own lock
+    // By underlying; each key is subscribed with the handler once, for as
+    // long as any sink watches it
+    std::unordered_map<std::string, std::unordered_set<QuoteSink*>> watchers_;
+    std::unordered_set<QuoteSink*> batched_;
+
+    std::condition_variable cv_;
+    bool running_{true};
+    std::thread batchThread_;
+};
+
+#endif
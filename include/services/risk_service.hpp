@@ -0,0 +1,47 @@
+#ifndef RISK_SERVICE_HPP
+#define RISK_SERVICE_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include "risk.grpc.pb.h"
+#include "RiskPublisher.hpp"
+
+// StreamRisk is a raw callback method: every snapshot from the publisher is
+// serialized once, in each of its two shapes, and the same bytes are queued
+// on all subscriber streams. A subscriber still writing the previous
+// snapshot keeps only the newest pending one, so a slow client never holds
+// up the publisher or the other clients.
+class RiskServiceImpl final
+    : public trading::RiskService::WithRawCallbackMethod_StreamRisk<trading::RiskService::Service> {
+public:
+    explicit RiskServiceImpl(RiskPublisher& publisher);
+
+    grpc::Status GetRisk(
+        grpc::ServerContext* context,
+        const trading::RiskRequest* request,
+        trading::RiskUpdate* response) override;
+
+    grpc::ServerWriteReactor<grpc::ByteBuffer>* StreamRisk(
+        grpc::CallbackServerContext* context,
+        const grpc::ByteBuffer* request) override;
+
+private:
+    struct EncodedSnapshot {
+        grpc::ByteBuffer full;
+        grpc::ByteBuffer portfolioOnly;
+    };
+    class Subscription;
+
+    void publish(const std::shared_ptr<const RiskSnapshot>& snapshot);
+    void unsubscribe(Subscription* subscription);
+
+    RiskPublisher& publisher_;
+
+    std::mutex mutex_;
+    std::shared_ptr<const EncodedSnapshot> latest_;
+    std::unordered_set<Subscription*> subscriptions_;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef RPC_SERVER_HPP
+#define RPC_SERVER_HPP
+
+#include <grpcpp/grpcpp.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MarketDataServiceImpl;
+class MarketDataServiceV2Impl;
+class OrderManagementServiceImpl;
+class OrderManagementServiceV2Impl;
+class ExecutionServiceImpl;
+class RiskServiceImpl;
+class MetricsServiceImpl;
+
+struct RpcServerConfig {
+    enum class Mode {
+        SYNC,    // gRPC's own thread pool runs every handler
+        ASYNC    // Unary RPCs on completion queues polled by our threads
+    };
+
+    Mode mode = Mode::ASYNC;
+
+    // ASYNC: polling threads, one completion queue each; 0 takes one per core
+    size_t completionQueueThreads = 0;
+    // ASYNC: pin polling thread i to CPU (firstCpu + i) modulo the core count
+    bool pinThreads = false;
+    int firstCpu = 0;
+
+    // SYNC: bounds on gRPC's polling threads
+    int syncMinPollers = 1;
+    int syncMaxPollers = 64;
+};
+
+// The trading services behind one listening port, v1 and v2 schemas side
+// by side.
+//
+// In either mode the streaming RPCs and GetOptionChain are callback
+// methods, so an open stream costs no thread. In ASYNC mode each polling thread drains its own
+// completion queue and runs the unary handlers inline; they only touch
+// in-memory state behind short locks, so no handler blocks a queue for
+// long. In SYNC mode the handlers run on gRPC's pool, as before.
+class RpcServer {
+public:
+    struct Services {
+        MarketDataServiceImpl& marketData;
+        OrderManagementServiceImpl& orders;
+        ExecutionServiceImpl& execution;
+        RiskServiceImpl& risk;
+        MarketDataServiceV2Impl& marketDataV2;
+        OrderManagementServiceV2Impl& ordersV2;
+        MetricsServiceImpl& metrics;
+    };
+
+    RpcServer(const Services& services, RpcServerConfig config = RpcServerConfig());
+    ~RpcServer();
+
+    // Throws std::runtime_error if the server cannot bind the address. An
+    // address ending in ":0" takes any free port; port() tells which.
+    void start(const std::string& address);
+    int port() const { return port_; }
+
+    // Blocks until shutdown() is called from another thread
+    void wait();
+    void shutdown();
+
+private:
+    struct AsyncServices;
+
+    void listen(grpc::ServerCompletionQueue* cq);
+    void poll(grpc::ServerCompletionQueue* cq, size_t index);
+
+    Services services_;
+    const RpcServerConfig config_;
+
+    std::unique_ptr<AsyncServices> async_;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> queues_;
+    std::vector<std::thread> pollers_;
+    std::unique_ptr<grpc::Server> server_;
+    int port_{0};
+    std::atomic<bool> stopped_{false};
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef WIRE_V2_HPP
+#define WIRE_V2_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include "trading_v2.pb.h"
+#include "InstrumentRegistry.hpp"
+#include "MarketDataHandler.hpp"
+
+// Conversions between the core types and the compact v2 wire schema
+
+constexpr int64_t PRICE_SCALE = 10000;   // Fixed-point prices in 1/10000
+
+inline int64_t toFixedPrice(double price) {
+    return std::llround(price * PRICE_SCALE);
+}
+
+inline double fromFixedPrice(int64_t fixed) {
+    return static_cast<double>(fixed) / PRICE_SCALE;
+}
+
+// YYYY-MM-DD to YYYYMMDD; 0 for an empty or malformed date
+uint32_t toExpiryCode(const std::string& expiry);
+// Empty for 0
+std::string fromExpiryCode(uint32_t code);
+
+void fillInstrument(uint32_t id, const InstrumentKey& key, trading::v2::Instrument* instrument);
+void fillQuote(uint32_t id, const OptionData& data, trading::v2::Quote* quote);
+
+// Appends the chain's calls, then its puts, to the columns, optionally
+// only one expiry's; returns the number of rows added. Contracts without
+// an ID in the registry get 0.
+size_t fillChainColumns(const OptionChain& chain, const std::string& expiry,
+                        const InstrumentRegistry& instruments, trading::v2::OptionChainColumns* columns);
+
+trading::v2::OrderStatus toWireStatus(OptionOrder::Status status);
+
+#endif
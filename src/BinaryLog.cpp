@@ -0,0 +1,421 @@
+#include "BinaryLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<int> BinaryLog::minLevel_{INT_MAX};
+
+namespace {
+    constexpr size_t MAX_LOG_SITES = 4096;
+    constexpr size_t RECORD_HEADER_BYTES = 16;   // ID, size, timestamp
+
+    size_t padded(size_t size) {
+        return (size + 7) & ~size_t(7);
+    }
+
+    // Single-producer, single-consumer byte ring. Positions count bytes
+    // since the ring was created; a record that would straddle the end is
+    // preceded by a padding marker (ID 0) filling the rest of the ring.
+    struct ThreadBuffer {
+        // Touched up front, so no page fault lands on a logging call
+        explicit ThreadBuffer(size_t bytes) : data(new char[bytes]()), mask(bytes - 1) {}
+
+        std::unique_ptr<char[]> data;
+        const uint64_t mask;
+
+        alignas(64) std::atomic<uint64_t> head{0};   // Written by the log thread
+        alignas(64) std::atomic<uint64_t> tail{0};   // Written by the owning thread
+        uint64_t cachedHead{0};                      // Owning thread only
+        uint64_t pending{0};                         // Bytes reserved, not committed yet
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> retired{false};            // The owning thread has exited
+        uint64_t droppedReported{0};                 // Log thread only
+    };
+
+    // Retires the calling thread's ring when the thread exits; the log
+    // thread frees it once drained
+    struct ThreadBufferHandle {
+        ThreadBuffer* buffer{nullptr};
+        ~ThreadBufferHandle() {
+            if (buffer) buffer->retired.store(true, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadBufferHandle threadBuffer;
+
+    struct SiteInfo {
+        const LogSite* site;
+        std::vector<BinaryLog::ArgType> types;
+    };
+
+    struct PendingRecord {
+        int64_t timestampNs;
+        const char* record;
+    };
+
+    const char* levelName(LogLevel level) {
+        switch (level) {
+            case LogLevel::DEBUG: return "DEBUG";
+            case LogLevel::INFO: return "INFO ";
+            case LogLevel::WARN: return "WARN ";
+            case LogLevel::ERROR: return "ERROR";
+        }
+        return "?    ";
+    }
+
+    const char* baseName(const char* path) {
+        const char* slash = std::strrchr(path, '/');
+        return slash ? slash + 1 : path;
+    }
+
+    class Logger {
+    public:
+        ThreadBuffer* attach() {
+            size_t bytes = 64;
+            while (bytes < options_.threadBufferBytes) bytes <<= 1;
+            auto* buffer = new ThreadBuffer(bytes);
+            std::lock_guard<std::mutex> lock(buffersMutex_);
+            buffers_.push_back(buffer);
+            return buffer;
+        }
+
+        uint32_t registerSite(LogSite& site, const BinaryLog::ArgType* types) {
+            std::lock_guard<std::mutex> lock(sitesMutex_);
+            uint32_t id = site.id.load(std::memory_order_relaxed);
+            if (id != 0) return id;   // Another thread got here first
+
+            uint32_t count = siteCount_.load(std::memory_order_relaxed);
+            if (count == MAX_LOG_SITES) return 0;
+            auto info = std::make_unique<SiteInfo>();
+            info->site = &site;
+            for (const BinaryLog::ArgType* type = types; *type != BinaryLog::ArgType::END; ++type) {
+                info->types.push_back(*type);
+            }
+            sites_[count] = std::move(info);
+            siteCount_.store(count + 1, std::memory_order_release);
+            site.id.store(count + 1, std::memory_order_release);
+            return count + 1;
+        }
+
+        void start(const LogOptions& options) {
+            std::lock_guard<std::mutex> lock(runMutex_);
+            if (running_) throw std::runtime_error("Binary log already started");
+
+            int fd = STDOUT_FILENO;
+            if (options.path != "-") {
+                fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+                if (fd < 0) {
+                    throw std::runtime_error("Failed to open log file " + options.path + ": " + std::strerror(errno));
+                }
+            }
+            options_ = options;
+            fd_ = fd;
+            running_ = true;
+            thread_ = std::thread(&Logger::run, this);
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(runMutex_);
+                if (!running_) return;
+                running_ = false;
+            }
+            cv_.notify_all();
+            thread_.join();   // Drains once more on the way out
+            if (fd_ != STDOUT_FILENO) ::close(fd_);
+            fd_ = -1;
+        }
+
+        BinaryLog::Stats stats() {
+            BinaryLog::Stats stats{};
+            stats.recordsWritten = recordsWritten_.load(std::memory_order_relaxed);
+            stats.batchesWritten = batchesWritten_.load(std::memory_order_relaxed);
+            stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+            stats.recordsDropped = droppedRetired_.load(std::memory_order_relaxed);
+            std::lock_guard<std::mutex> lock(buffersMutex_);
+            for (ThreadBuffer* buffer : buffers_) {
+                stats.recordsDropped += buffer->dropped.load(std::memory_order_relaxed);
+            }
+            stats.threadBuffers = buffers_.size();
+            return stats;
+        }
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock(runMutex_);
+            while (running_) {
+                cv_.wait_for(lock, options_.flushInterval);
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+            lock.unlock();
+            drain();
+        }
+
+        // One pass: every committed record in every ring, formatted in
+        // timestamp order and written with one write()
+        void drain() {
+            std::vector<ThreadBuffer*> buffers;
+            {
+                std::lock_guard<std::mutex> lock(buffersMutex_);
+                buffers = buffers_;
+            }
+
+            // Ticks become wall time relative to a fresh reading, so the
+            // calibrated rate only spans the age of the oldest record
+            const uint64_t anchorTicks = TscClock::now();
+            const int64_t anchorNs = nowNanos();
+            const double nanosPerTick = TscClock::nanosPerTick();
+
+            pending_.clear();
+            tails_.resize(buffers.size());
+            retired_.resize(buffers.size());
+            uint64_t dropped = 0;
+            for (size_t b = 0; b < buffers.size(); ++b) {
+                ThreadBuffer& buffer = *buffers[b];
+                retired_[b] = buffer.retired.load(std::memory_order_acquire);   // Before the tail: nothing follows it
+                uint64_t tail = buffer.tail.load(std::memory_order_acquire);
+                for (uint64_t position = buffer.head.load(std::memory_order_relaxed); position < tail;) {
+                    const char* record = buffer.data.get() + (position & buffer.mask);
+                    uint32_t header[2];
+                    std::memcpy(header, record, sizeof(header));
+                    if (header[0] != 0) {
+                        uint64_t ticks;
+                        std::memcpy(&ticks, record + 2 * sizeof(uint32_t), sizeof(ticks));
+                        int64_t age = static_cast<int64_t>(anchorTicks - ticks);   // Negative if logged after the anchor
+                        pending_.push_back({anchorNs - static_cast<int64_t>(age * nanosPerTick), record});
+                    }
+                    position += padded(header[1]);
+                }
+                tails_[b] = tail;
+
+                uint64_t total = buffer.dropped.load(std::memory_order_relaxed);
+                dropped += total - buffer.droppedReported;
+                buffer.droppedReported = total;
+            }
+
+            // Sites are registered before their first record is committed
+            const uint32_t siteCount = siteCount_.load(std::memory_order_acquire);
+            std::stable_sort(pending_.begin(), pending_.end(),
+                             [](const PendingRecord& a, const PendingRecord& b) { return a.timestampNs < b.timestampNs; });
+
+            out_.clear();
+            for (const PendingRecord& record : pending_) {
+                format(record, siteCount);
+            }
+            if (dropped > 0) {
+                appendPrefix(pending_.empty() ? nowNanos() : pending_.back().timestampNs, LogLevel::WARN,
+                             "BinaryLog.cpp", 0);
+                out_ += std::to_string(dropped) + " log records dropped: a thread's ring was full\n";
+            }
+            if (!out_.empty()) writeOut();
+
+            for (size_t b = 0; b < buffers.size(); ++b) {
+                buffers[b]->head.store(tails_[b], std::memory_order_release);
+            }
+            recordsWritten_.fetch_add(pending_.size(), std::memory_order_relaxed);
+
+            // Rings of threads that have exited, now empty
+            std::lock_guard<std::mutex> lock(buffersMutex_);
+            for (size_t b = 0; b < buffers.size(); ++b) {
+                if (!retired_[b]) continue;
+                droppedRetired_.fetch_add(buffers[b]->dropped.load(std::memory_order_relaxed),
+                                          std::memory_order_relaxed);
+                buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffers[b]));
+                delete buffers[b];
+            }
+        }
+
+        void format(const PendingRecord& pending, uint32_t siteCount) {
+            uint32_t header[2];
+            std::memcpy(header, pending.record, sizeof(header));
+            if (header[0] > siteCount) return;
+            const SiteInfo& info = *sites_[header[0] - 1];
+            const LogSite& site = *info.site;
+            appendPrefix(pending.timestampNs, site.level, baseName(site.file), site.line);
+
+            const char* arg = pending.record + RECORD_HEADER_BYTES;
+            size_t next = 0;
+            for (const char* text = site.format; *text; ++text) {
+                if (text[0] != '{' || text[1] != '}' || next == info.types.size()) {
+                    out_ += *text;
+                    continue;
+                }
+                arg = appendArg(info.types[next++], arg);
+                ++text;
+            }
+            out_ += '\n';
+        }
+
+        const char* appendArg(BinaryLog::ArgType type, const char* arg) {
+            char digits[32];
+            switch (type) {
+                case BinaryLog::ArgType::INT: {
+                    int64_t value;
+                    std::memcpy(&value, arg, sizeof(value));
+                    out_.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+                    return arg + 8;
+                }
+                case BinaryLog::ArgType::UINT: {
+                    uint64_t value;
+                    std::memcpy(&value, arg, sizeof(value));
+                    out_.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+                    return arg + 8;
+                }
+                case BinaryLog::ArgType::DOUBLE: {
+                    double value;
+                    std::memcpy(&value, arg, sizeof(value));
+                    int length = std::snprintf(digits, sizeof(digits), "%g", value);   // As std::ostream prints it
+                    out_.append(digits, static_cast<size_t>(length));
+                    return arg + 8;
+                }
+                case BinaryLog::ArgType::BOOL:
+                    out_ += *arg ? "true" : "false";
+                    return arg + 1;
+                case BinaryLog::ArgType::STRING: {
+                    uint16_t length;
+                    std::memcpy(&length, arg, sizeof(length));
+                    out_.append(arg + sizeof(length), length);
+                    return arg + sizeof(length) + length;
+                }
+                case BinaryLog::ArgType::END:
+                    break;
+            }
+            return arg;
+        }
+
+        // "2026-10-18T14:03:07.123456789Z INFO  File.cpp:123 "
+        void appendPrefix(int64_t timestampNs, LogLevel level, const char* file, int line) {
+            time_t seconds = static_cast<time_t>(timestampNs / 1000000000);
+            if (seconds != cachedSecond_) {
+                tm utc;
+                gmtime_r(&seconds, &utc);
+                std::strftime(secondText_, sizeof(secondText_), "%Y-%m-%dT%H:%M:%S", &utc);
+                cachedSecond_ = seconds;
+            }
+            char text[96];
+            int length = std::snprintf(text, sizeof(text), "%s.%09lldZ %s %s:%d ", secondText_,
+                                       static_cast<long long>(timestampNs % 1000000000), levelName(level),
+                                       file, line);
+            out_.append(text, static_cast<size_t>(std::min<int>(length, sizeof(text) - 1)));
+        }
+
+        void writeOut() {
+            const char* data = out_.data();
+            size_t remaining = out_.size();
+            while (remaining > 0) {
+                ssize_t written = ::write(fd_, data, remaining);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    break;   // Nowhere left to report it; the batch is lost
+                }
+                data += written;
+                remaining -= static_cast<size_t>(written);
+            }
+            bytesWritten_.fetch_add(out_.size() - remaining, std::memory_order_relaxed);
+            batchesWritten_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static int64_t nowNanos() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        LogOptions options_;
+        int fd_{-1};
+
+        std::mutex sitesMutex_;
+        std::unique_ptr<SiteInfo> sites_[MAX_LOG_SITES];   // Entry i is site ID i + 1, immutable once set
+        std::atomic<uint32_t> siteCount_{0};
+
+        std::mutex buffersMutex_;
+        std::vector<ThreadBuffer*> buffers_;
+
+        std::mutex runMutex_;
+        std::condition_variable cv_;
+        bool running_{false};
+        std::thread thread_;
+
+        // Log thread only
+        std::vector<PendingRecord> pending_;
+        std::vector<uint64_t> tails_;
+        std::vector<char> retired_;
+        std::string out_;
+        time_t cachedSecond_{-1};
+        char secondText_[32]{};
+
+        std::atomic<uint64_t> recordsWritten_{0};
+        std::atomic<uint64_t> droppedRetired_{0};
+        std::atomic<uint64_t> batchesWritten_{0};
+        std::atomic<uint64_t> bytesWritten_{0};
+    };
+
+    // Never destroyed: threads may still log during static destruction
+    Logger& logger() {
+        static Logger* instance = new Logger();
+        return *instance;
+    }
+}
+
+void BinaryLog::start(const LogOptions& options) {
+    TscClock::nanosPerTick();   // Calibrated before any record is stamped
+    logger().start(options);
+    minLevel_.store(static_cast<int>(options.level), std::memory_order_release);   // Publishes the options
+}
+
+void BinaryLog::stop() {
+    minLevel_.store(INT_MAX, std::memory_order_relaxed);
+    logger().stop();
+}
+
+BinaryLog::Stats BinaryLog::stats() {
+    return logger().stats();
+}
+
+uint32_t BinaryLog::registerSite(LogSite& site, const ArgType* types) {
+    return logger().registerSite(site, types);
+}
+
+char* BinaryLog::reserve(size_t size) {
+    ThreadBuffer* buffer = threadBuffer.buffer;
+    if (!buffer) buffer = threadBuffer.buffer = logger().attach();
+
+    const uint64_t capacity = buffer->mask + 1;
+    const uint64_t bytes = padded(size);
+    const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+    const uint64_t offset = tail & buffer->mask;
+    const uint64_t padding = offset + bytes > capacity ? capacity - offset : 0;
+    const uint64_t needed = padding + bytes;
+
+    if (bytes > capacity || tail + needed - buffer->cachedHead > capacity) {
+        buffer->cachedHead = buffer->head.load(std::memory_order_acquire);
+        if (bytes > capacity || tail + needed - buffer->cachedHead > capacity) {
+            buffer->dropped.store(buffer->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+
+    if (padding > 0) {
+        uint32_t marker[2] = {0, static_cast<uint32_t>(padding)};
+        std::memcpy(buffer->data.get() + offset, marker, sizeof(marker));
+    }
+    buffer->pending = needed;
+    return buffer->data.get() + ((tail + padding) & buffer->mask);
+}
+
+void BinaryLog::commit() {
+    ThreadBuffer* buffer = threadBuffer.buffer;
+    buffer->tail.store(buffer->tail.load(std::memory_order_relaxed) + buffer->pending, std::memory_order_release);
+}
@@ -0,0 +1,204 @@
+#include "DeltaHedger.hpp"
+#include "BinaryLog.hpp"
+#include "OrderManagementSystem.hpp"
+#include "RiskManagement.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+DeltaHedger::DeltaHedger(OrderManagementSystem& oms, RiskManagement& risk, DeltaHedgerConfig config)
+    : oms_(oms)
+    , risk_(risk)
+    , config_(std::move(config))
+    , tokens_(config_.maxOrdersPerSecond)
+    , tokensRefilled_(std::chrono::steady_clock::now()) {
+    oms_.addOrderEventListener([this](OrderEvent::Type type, const OrderRecord& order) {
+        onOrderEvent(type, order);
+    });
+}
+
+DeltaHedger::~DeltaHedger() {
+    stop();
+}
+
+void DeltaHedger::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&DeltaHedger::run, this);
+}
+
+void DeltaHedger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        requests_.clear();
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void DeltaHedger::onUnderlyingPrice(const std::string& underlying, double spot) {
+    if (!(spot > 0.0)) return;
+    evaluate(underlying, std::chrono::steady_clock::now());
+}
+
+DeltaHedger::Stats DeltaHedger::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    if (stats.evaluations > 0) {
+        stats.meanDecisionNanos = totalDecisionNanos_ / static_cast<double>(stats.evaluations);
+    }
+    return stats;
+}
+
+void DeltaHedger::onOrderEvent(OrderEvent::Type type, const OrderRecord& order) {
+    // Called under the order's shard lock
+    auto received = std::chrono::steady_clock::now();
+    if (type == OrderEvent::Type::SUBMITTED || type == OrderEvent::Type::REPLACED ||
+        type == OrderEvent::Type::ARCHIVED) {
+        return;
+    }
+    // Hedges are orders on the underlying itself: an option order ending
+    // unfilled concerns the hedger no more than its submission did
+    if (type != OrderEvent::Type::FILLED && order.instrument.strike > 0.0) return;
+
+    std::string underlying(order.instrument.underlying,
+                           strnlen(order.instrument.underlying, sizeof(order.instrument.underlying)));
+    bool ownHedge = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto state = states_.find(underlying);
+        if (state != states_.end() && state->second.workingOrder == order.handle) {
+            finishHedge(state->second, type == OrderEvent::Type::FILLED);
+            ownHedge = true;
+        }
+    }
+    // Only fills move delta; a hedge that ended unfilled frees the underlying for another
+    if (type == OrderEvent::Type::FILLED || ownHedge) {
+        evaluate(underlying, received);
+    }
+}
+
+void DeltaHedger::evaluate(const std::string& underlying, std::chrono::steady_clock::time_point received) {
+    // Read before taking mutex_, so the risk manager's lock is never held
+    // inside the hedger's
+    double delta = risk_.getUnderlyingRisk(underlying).delta;
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.evaluations;
+        UnderlyingState& state = states_[underlying];
+
+        auto override = config_.bands.find(underlying);
+        const HedgeBand& band = override != config_.bands.end() ? override->second : config_.band;
+        if (running_ && !state.submitting && state.workingOrder == INVALID_ORDER_HANDLE &&
+            std::abs(delta) > band.trigger) {
+            // Back to the target on the same side, rounded towards it so the
+            // hedge never overshoots into the other side of the band
+            double side = delta > 0.0 ? 1.0 : -1.0;
+            double hedge = std::trunc(side * std::min(band.target, band.trigger) - delta);
+            hedge = std::max(std::min(hedge, static_cast<double>(config_.maxHedgeQuantity)),
+                             -static_cast<double>(config_.maxHedgeQuantity));
+
+            if (std::abs(hedge) >= config_.minHedgeQuantity) {
+                auto now = std::chrono::steady_clock::now();
+                if (now - state.lastOrder < config_.minInterval || !takeOrderToken(now)) {
+                    ++stats_.throttled;
+                } else {
+                    state.submitting = true;
+                    state.lastOrder = now;
+                    requests_.push_back(HedgeRequest{underlying, static_cast<int32_t>(hedge)});
+                    ++stats_.hedgesDecided;
+                    wake = true;
+                }
+            }
+        }
+
+        double nanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - received).count();
+        totalDecisionNanos_ += nanos;
+        stats_.maxDecisionNanos = std::max(stats_.maxDecisionNanos, nanos);
+    }
+    if (wake) cv_.notify_one();
+}
+
+bool DeltaHedger::takeOrderToken(std::chrono::steady_clock::time_point now) {
+    double rate = config_.maxOrdersPerSecond;
+    double elapsed = std::chrono::duration<double>(now - tokensRefilled_).count();
+    tokens_ = std::min(rate, tokens_ + elapsed * rate);
+    tokensRefilled_ = now;
+    if (tokens_ < 1.0) return false;
+    tokens_ -= 1.0;
+    return true;
+}
+
+void DeltaHedger::finishHedge(UnderlyingState& state, bool filled) {
+    state.workingOrder = INVALID_ORDER_HANDLE;
+    if (filled) ++stats_.hedgesFilled;
+    else ++stats_.hedgesFailed;
+}
+
+void DeltaHedger::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return !running_ || !requests_.empty(); });
+        if (!running_) break;
+
+        HedgeRequest request = std::move(requests_.front());
+        requests_.pop_front();
+        lock.unlock();
+        submit(request);
+        lock.lock();
+    }
+}
+
+void DeltaHedger::submit(const HedgeRequest& request) {
+    // An order on the underlying itself: no option type, strike or expiry
+    OptionOrder order{};
+    order.underlying = request.underlying;
+    order.strike = 0.0;
+    order.type = request.quantity > 0 ? OptionOrder::Type::BUY_TO_OPEN : OptionOrder::Type::SELL_TO_OPEN;
+    order.orderType = OptionOrder::OrderType::MARKET;
+    order.timeInForce = OptionOrder::TimeInForce::IOC;
+    order.quantity = std::abs(request.quantity);
+    order.status = OptionOrder::Status::PENDING;
+    order.isActive = true;
+
+    OrderHandle handle = INVALID_ORDER_HANDLE;
+    try {
+        parseOrderId(oms_.submitOptionOrder(order), handle);
+    } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        UnderlyingState& state = states_[request.underlying];
+        state.submitting = false;
+        ++stats_.hedgesFailed;
+        LOG_WARN("Delta hedge of {} {} not submitted: {}", request.quantity, request.underlying, e.what());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        UnderlyingState& state = states_[request.underlying];
+        state.submitting = false;
+        state.workingOrder = handle;
+        ++stats_.hedgesSubmitted;
+    }
+
+    // The engine may have finished the order before its handle was
+    // recorded above, in which case its event went unmatched
+    OrderRecord record;
+    if (oms_.getOrder(handle, record) && record.isActive) return;
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        UnderlyingState& state = states_[request.underlying];
+        if (state.workingOrder == handle) {
+            finishHedge(state, record.status == OptionOrder::Status::FILLED);
+            finished = true;
+        }
+    }
+    if (finished) evaluate(request.underlying, std::chrono::steady_clock::now());
+}
@@ -1,7 +1,11 @@
 #include "ExecutionEngine.hpp"
 #include "OptionTypes.hpp"
+#include "BinaryLog.hpp"
+#include "Metrics.hpp"
+#include "OrderTracer.hpp"
 #include "OrderManagementSystem.hpp"
 #include <iostream>
+#include <algorithm>
 #include <random>
 #include <chrono>
 
@@ -14,6 +18,7 @@ ExecutionEngine::~ExecutionEngine() {
 void ExecutionEngine::start() {
     if (running_) return;
     
+    TscClock::nanosPerTick();   // Calibrated now, not on the first cancel ack
     running_ = true;
     executionThread_ = std::make_unique<std::thread>(&ExecutionEngine::executionLoop, this);
     
@@ -21,65 +26,181 @@ void ExecutionEngine::start() {
 }
 
 void ExecutionEngine::stop() {
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        running_ = false;
+    }
+    queueCv_.notify_all();
     
     if (executionThread_ && executionThread_->joinable()) {
         executionThread_->join();
     }
     
+    auto cancelStats = getCancelStats();
     std::cout << "Execution Engine stopped. Statistics:\n"
               << "Total orders processed: " << totalOrdersProcessed_ << "\n"
               << "Total orders filled: " << totalOrdersFilled_ << "\n"
-              << "Total orders rejected: " << totalOrdersRejected_ << std::endl;
+              << "Total orders rejected: " << totalOrdersRejected_ << "\n"
+              << "Total cancels acknowledged: " << cancelStats.cancelsAcked << "\n"
+              << "Stale order copies dropped: " << cancelStats.staleCopiesDropped << "\n"
+              << "Cancel-to-ack latency (us): avg " << cancelStats.avgAckMicros
+              << ", max " << cancelStats.maxAckMicros << std::endl;
 }
 
 void ExecutionEngine::setOrderManagementSystem(OrderManagementSystem* oms) {
     oms_ = oms;
 }
 
+void ExecutionEngine::addOrder(const OrderRecord& order) {
+    enqueue(EngineCommand::Kind::NEW, order);
+}
+
 void ExecutionEngine::addOrder(const OptionOrder& order) {
+    OrderRecord record = makeOrderRecord(order);
+    if (!parseOrderId(order.orderId, record.handle)) {
+        throw std::invalid_argument("Unknown order ID: " + order.orderId);
+    }
+    enqueue(EngineCommand::Kind::NEW, record);
+}
+
+void ExecutionEngine::cancelOrder(OrderHandle handle) {
+    OrderRecord order{};
+    order.handle = handle;
+    enqueue(EngineCommand::Kind::CANCEL, order);
+}
+
+void ExecutionEngine::replaceOrder(const OrderRecord& order) {
+    enqueue(EngineCommand::Kind::REPLACE, order);
+}
+
+void ExecutionEngine::enqueue(EngineCommand::Kind kind, const OrderRecord& order) {
     if (!running_) {
+        // Nothing can execute once stopped, so a cancel is trivially satisfied
+        if (kind == EngineCommand::Kind::CANCEL) return;
         throw std::runtime_error("Execution Engine is not running");
     }
     
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    orderQueue_.push(order);
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        // Update the tombstone table at enqueue time so that copies already
+        // queued ahead of this command are recognised as stale
+        uint32_t slot = OrderStore::slotOf(order.handle);
+        if (slot >= liveOrders_.size()) {
+            if (kind == EngineCommand::Kind::CANCEL) return;
+            liveOrders_.resize(std::max<size_t>(slot + 1, liveOrders_.size() * 2),
+                               LiveEntry{INVALID_ORDER_HANDLE, 0});
+        }
+        if (kind == EngineCommand::Kind::CANCEL) {
+            if (liveOrders_[slot].handle == order.handle) {
+                liveOrders_[slot].handle = INVALID_ORDER_HANDLE;
+            }
+        } else {
+            liveOrders_[slot] = LiveEntry{order.handle, order.revision};
+        }
+        commandQueue_.push(EngineCommand{kind, order, TscClock::now()});
+    }
+    queueCv_.notify_one();
 }
 
 void ExecutionEngine::executionLoop() {
+    auto nextRetry = std::chrono::steady_clock::now() + RESTING_RETRY_INTERVAL;
+    
     while (running_) {
-        processOrders();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Simulate processing time
+        {
+            // Wake immediately for new commands, otherwise at the retry cadence
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            queueCv_.wait_until(lock, nextRetry, [this] {
+                return !commandQueue_.empty() || !running_;
+            });
+        }
+        
+        processCommands();
+        
+        auto now = std::chrono::steady_clock::now();
+        if (now >= nextRetry) {
+            retryRestingOrders();
+            nextRetry = now + RESTING_RETRY_INTERVAL;
+        }
     }
 }
 
-void ExecutionEngine::processOrders() {
-    // First process queued orders
+void ExecutionEngine::processCommands() {
     std::unique_lock<std::mutex> lock(queueMutex_);
     
-    while (!orderQueue_.empty() && running_) {
-        OptionOrder order = orderQueue_.front();
-        orderQueue_.pop();
+    while (!commandQueue_.empty() && running_) {
+        EngineCommand command = commandQueue_.front();
+        commandQueue_.pop();
+        const uint64_t dequeued = TscClock::now();
+        
+        if (command.kind == EngineCommand::Kind::CANCEL) {
+            // Every copy queued before the cancel has now been seen
+            auto ackNanos = static_cast<uint64_t>(TscClock::toNanos(dequeued - command.enqueueTicks));
+            ++totalCancelsAcked_;
+            cancelAckNanosTotal_ += ackNanos;
+            uint64_t currentMax = cancelAckNanosMax_;
+            while (ackNanos > currentMax &&
+                   !cancelAckNanosMax_.compare_exchange_weak(currentMax, ackNanos)) {}
+            continue;
+        }
+        
+        // Drop copies that were cancelled or replaced after being queued
+        const LiveEntry& live = liveOrders_[OrderStore::slotOf(command.order.handle)];
+        if (live.handle != command.order.handle || live.revision != command.order.revision) {
+            ++totalStaleDropped_;
+            continue;
+        }
+        Metrics::record(LatencyStage::ENGINE_DEQUEUE, dequeued - command.enqueueTicks);
+        if (OrderTracer::sampled(command.order.handle)) {
+            OrderTracer::span(TraceStage::QUEUE_WAIT, command.order.handle, command.enqueueTicks, dequeued);
+        }
+        
         lock.unlock();  // Unlock while processing order
         
-        processOrder(order);
+        processOrder(command.order);
         
         lock.lock();  // Relock for next iteration
     }
+}
 
-    // Then check OMS for any pending orders that might have been missed
-    if (oms_) {
-        auto activeOrders = oms_->getActiveOrders();
-        for (const auto& order : activeOrders) {
-            if (order.status == OptionOrder::Status::PENDING) {
-                processOrder(order);
-            }
+void ExecutionEngine::retryRestingOrders() {
+    // Resting LIMIT/STOP orders are retried from the OMS's view of active orders
+    if (!oms_) return;
+    
+    auto activeOrders = oms_->getActiveOrderRecords();
+    for (const auto& order : activeOrders) {
+        if (!running_) break;
+        if (order.status == OptionOrder::Status::PENDING) {
+            processOrder(order);
         }
     }
 }
 
-void ExecutionEngine::processOrder(const OptionOrder& order) {
+void ExecutionEngine::retireOrder(const OrderRecord& order) {
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    uint32_t slot = OrderStore::slotOf(order.handle);
+    if (slot < liveOrders_.size() && liveOrders_[slot].handle == order.handle &&
+        liveOrders_[slot].revision == order.revision) {
+        liveOrders_[slot].handle = INVALID_ORDER_HANDLE;
+    }
+}
+
+ExecutionEngine::CancelStats ExecutionEngine::getCancelStats() const {
+    CancelStats stats{};
+    stats.cancelsAcked = totalCancelsAcked_;
+    stats.staleCopiesDropped = totalStaleDropped_;
+    if (stats.cancelsAcked > 0) {
+        stats.avgAckMicros = cancelAckNanosTotal_ / 1000.0 / stats.cancelsAcked;
+    }
+    stats.maxAckMicros = cancelAckNanosMax_ / 1000.0;
+    return stats;
+}
+
+void ExecutionEngine::processOrder(const OrderRecord& order) {
+    const uint64_t started = TscClock::now();
+    const bool traced = OrderTracer::sampled(order.handle);
     ++totalOrdersProcessed_;
+    char orderId[ORDER_ID_LENGTH + 1];
+    formatOrderId(order.handle, orderId);
     
     if (tryExecuteOrder(order)) {
         ++totalOrdersFilled_;
@@ -87,24 +208,42 @@ void ExecutionEngine::processOrder(const OptionOrder& order) {
         // Calculate and report fill price
         double fillPrice = calculateFillPrice(order);
         
+        const uint64_t executed = traced ? TscClock::now() : 0;
         if (oms_) {
-            oms_->onOrderFilled(order.orderId, fillPrice);
+            oms_->onOrderFilled(order.handle, order.revision, fillPrice);
+        }
+        if (traced) {
+            OrderTracer::span(TraceStage::EXECUTION, order.handle, started, executed);
+            OrderTracer::span(TraceStage::OMS_FILL, order.handle, executed, TscClock::now());
         }
+        retireOrder(order);
+        Metrics::recordSince(LatencyStage::FILL, started);
+        Metrics::increment(MetricCounter::ORDERS_FILLED);
         
-        std::cout << "Order filled -> ID: " << order.orderId
-                  << ", Fill Price: " << fillPrice << std::endl;
-    } else {
+        LOG_INFO("Order filled -> ID: {}, Fill Price: {}", orderId, fillPrice);
+    } else if (order.timeInForce == OptionOrder::TimeInForce::IOC) {
+        // Immediate-or-cancel: no second attempt
+        if (oms_) {
+            oms_->onOrderExpired(order.handle, order.revision, "IOC order not filled");
+        }
+        if (traced) OrderTracer::span(TraceStage::EXECUTION, order.handle, started, TscClock::now());
+        retireOrder(order);
+    } else if (order.orderType == OptionOrder::OrderType::MARKET) {
         ++totalOrdersRejected_;
+        Metrics::increment(MetricCounter::ORDERS_REJECTED);
         
         if (oms_) {
-            oms_->onOrderRejected(order.orderId, "Order execution failed");
+            oms_->onOrderRejected(order.handle, order.revision, "Order execution failed");
         }
+        if (traced) OrderTracer::span(TraceStage::EXECUTION, order.handle, started, TscClock::now());
+        retireOrder(order);
         
-        std::cout << "Order rejected -> ID: " << order.orderId << std::endl;
+        LOG_INFO("Order rejected -> ID: {}", orderId);
     }
+    // Unfilled LIMIT/STOP orders rest in the OMS until filled, cancelled or expired
 }
 
-bool ExecutionEngine::tryExecuteOrder(const OptionOrder& order) {
+bool ExecutionEngine::tryExecuteOrder(const OrderRecord& order) {
     // Implement basic order validation
     if (order.quantity == 0) return false;
     
@@ -147,7 +286,7 @@ bool ExecutionEngine::tryExecuteOrder(const OptionOrder& order) {
     return false;
 }
 
-double ExecutionEngine::calculateFillPrice(const OptionOrder& order) const {
+double ExecutionEngine::calculateFillPrice(const OrderRecord& order) const {
     // In a real system, this would use actual market data
     // For simulation, we'll use the limit price with some random slippage
     static std::random_device rd;
@@ -168,7 +307,7 @@ double ExecutionEngine::calculateFillPrice(const OptionOrder& order) const {
     return basePrice + slippageAmount;
 }
 
-bool ExecutionEngine::shouldFillOrder(const OptionOrder& order) const {
+bool ExecutionEngine::shouldFillOrder(const OrderRecord& order) const {
     // Simulate random fill probability based on configured fill rate
     static std::random_device rd;
     static std::mt19937 gen(rd());
@@ -0,0 +1,158 @@
+#include "FileUtils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    [[noreturn]] void throwErrno(const std::string& what, const std::string& path) {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    void writeAll(int fd, const void* data, size_t size, const std::string& path) {
+        const char* bytes = static_cast<const char*>(data);
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                throwErrno("Failed to write", path);
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return;
+        throwErrno("Failed to open", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throwErrno("Failed to stat", path);
+    }
+
+    if (st.st_size > 0) {
+        void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throwErrno("Failed to map", path);
+        }
+        // Recovery reads front to back
+        ::madvise(mapped, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(mapped);
+        size_ = static_cast<size_t>(st.st_size);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = other.data_;
+        size_ = other.size_;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if (data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+void ensureDirectory(const std::string& path) {
+    if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        throwErrno("Failed to create directory", path);
+    }
+}
+
+void syncDirectory(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throwErrno("Failed to open directory", path);
+    }
+    ::fsync(fd);
+    ::close(fd);
+}
+
+void truncateFile(const std::string& path, size_t size) {
+    if (::truncate(path.c_str(), static_cast<off_t>(size)) != 0) {
+        throwErrno("Failed to truncate", path);
+    }
+}
+
+std::vector<std::string> listFiles(const std::string& directory,
+                                   const std::string& prefix, const std::string& suffix) {
+    std::vector<std::string> names;
+    DIR* dir = ::opendir(directory.c_str());
+    if (!dir) {
+        throwErrno("Failed to list directory", directory);
+    }
+
+    while (dirent* entry = ::readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() >= prefix.size() + suffix.size() &&
+            name.compare(0, prefix.size(), prefix) == 0 &&
+            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            names.push_back(std::move(name));
+        }
+    }
+    ::closedir(dir);
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void writeFileAtomic(const std::string& directory, const std::string& name,
+                     const std::vector<std::pair<const void*, size_t>>& parts) {
+    std::string path = directory + "/" + name;
+    std::string tempPath = path + ".tmp";
+
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throwErrno("Failed to create", tempPath);
+    }
+
+    try {
+        for (const auto& part : parts) {
+            writeAll(fd, part.first, part.second, tempPath);
+        }
+        if (::fsync(fd) != 0) {
+            throwErrno("Failed to sync", tempPath);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+    ::close(fd);
+
+    if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+        throwErrno("Failed to rename", tempPath);
+    }
+    syncDirectory(directory);
+}
@@ -0,0 +1,39 @@
+#include "InstrumentRegistry.hpp"
+
+uint32_t InstrumentRegistry::idFor(const InstrumentKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto inserted = ids_.emplace(key, static_cast<uint32_t>(keys_.size() + 1));
+    if (inserted.second) keys_.push_back(key);
+    return inserted.first->second;
+}
+
+bool InstrumentRegistry::find(const InstrumentKey& key, uint32_t& id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(key);
+    if (it == ids_.end()) return false;
+    id = it->second;
+    return true;
+}
+
+bool InstrumentRegistry::lookup(uint32_t id, InstrumentKey& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (id == 0 || id > keys_.size()) return false;
+    key = keys_[id - 1];
+    return true;
+}
+
+size_t InstrumentRegistry::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return keys_.size();
+}
+
+std::vector<std::pair<uint32_t, InstrumentKey>> InstrumentRegistry::instrumentsOf(const std::string& underlying) const {
+    std::vector<std::pair<uint32_t, InstrumentKey>> instruments;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < keys_.size(); ++i) {
+        if (underlying == keys_[i].underlying) {
+            instruments.emplace_back(static_cast<uint32_t>(i + 1), keys_[i]);
+        }
+    }
+    return instruments;
+}
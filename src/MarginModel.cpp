@@ -0,0 +1,94 @@
+#include "MarginModel.hpp"
+#include "BlackScholesBatch.hpp"
+#include <algorithm>
+#include <cmath>
+
+std::array<MarginScenario, MARGIN_SCENARIOS> marginScenarios(const MarginParameters& parameters) {
+    std::array<MarginScenario, MARGIN_SCENARIOS> scenarios;
+    const double range = parameters.priceScanRange;
+    const double vol = parameters.volScanRange;
+    const double moves[] = {0.0, 1.0 / 3.0, -1.0 / 3.0, 2.0 / 3.0, -2.0 / 3.0, 1.0, -1.0};
+
+    size_t s = 0;
+    for (double move : moves) {
+        scenarios[s++] = MarginScenario{move * range, vol, 1.0};
+        scenarios[s++] = MarginScenario{move * range, -vol, 1.0};
+    }
+    scenarios[s++] = MarginScenario{parameters.extremeMoveMultiple * range, 0.0, parameters.extremeMoveCoverage};
+    scenarios[s++] = MarginScenario{-parameters.extremeMoveMultiple * range, 0.0, parameters.extremeMoveCoverage};
+    return scenarios;
+}
+
+MarginMarkets::MarginMarkets(const MarginParameters& parameters, double spotPrice, double vol) {
+    auto scenarios = marginScenarios(parameters);
+    for (size_t s = 0; s < LANES; ++s) {
+        double spotMove = s < MARGIN_SCENARIOS ? scenarios[s].spotMove : 0.0;
+        double volMove = s < MARGIN_SCENARIOS ? scenarios[s].volMove : 0.0;
+        spot[s] = std::max(spotPrice * (1.0 + spotMove), 1e-12);
+        logSpot[s] = std::log(spot[s]);
+        volatility[s] = std::max(vol * (1.0 + volMove), 1e-4);
+    }
+}
+
+RiskArray MarginMarkets::riskArray(const MarginParameters& parameters, const double* values) const {
+    auto scenarios = marginScenarios(parameters);
+    RiskArray array;
+    for (size_t s = 0; s < MARGIN_SCENARIOS; ++s) {
+        array[s] = scenarios[s].weight * (values[s] - values[MARGIN_SCENARIOS]);
+    }
+    return array;
+}
+
+RiskArray contractRiskArray(const MarginParameters& parameters, double spot, double strike, bool isCall,
+                            double timeToExpiry, double riskFreeRate, double volatility) {
+    MarginMarkets markets(parameters, spot, volatility);
+    double values[MarginMarkets::LANES] = {};
+
+    if (strike <= 0.0) {
+        for (size_t s = 0; s < MarginMarkets::LANES; ++s) values[s] = markets.spot[s];
+    } else {
+        double logStrike = std::log(strike);
+        double callSign = isCall ? 1.0 : -1.0;
+        double quantity = 1.0;
+        ScenarioMarkets scenarioMarkets{markets.spot, markets.logSpot, markets.volatility, MarginMarkets::LANES,
+                                        riskFreeRate, timeToExpiry};
+        BatchContracts contract{&strike, &logStrike, &callSign, &quantity, 1};
+        BlackScholesBatch::addScenarioValues(scenarioMarkets, contract, values);
+    }
+    return markets.riskArray(parameters, values);
+}
+
+double productGroupMargin(const std::vector<const ClassGroupRisk*>& classes, const MarginParameters& parameters,
+                          const ClassGroupRisk* replaced, const ClassGroupRisk* replacement) {
+    double worst = 0.0;
+    double shortOptions = 0.0;
+    for (const ClassGroupRisk* risk : classes) {
+        shortOptions += (risk == replaced ? replacement : risk)->shortOptions;
+    }
+
+    for (size_t s = 0; s < MARGIN_SCENARIOS; ++s) {
+        double losses = 0.0, gains = 0.0;
+        for (const ClassGroupRisk* risk : classes) {
+            double pnl = (risk == replaced ? replacement : risk)->pnl[s];
+            if (pnl < 0.0) losses -= pnl;
+            else gains += pnl;
+        }
+        worst = std::max(worst, losses - parameters.productGroupOffset * std::min(gains, losses));
+    }
+    return std::max(worst, parameters.shortOptionMinimum * shortOptions);
+}
+
+double portfolioMargin(const std::unordered_map<std::string, ClassGroupRisk>& classes,
+                       const MarginParameters& parameters) {
+    std::unordered_map<std::string, std::vector<const ClassGroupRisk*>> groups;
+    for (const auto& risk : classes) {
+        auto group = parameters.productGroups.find(risk.first);
+        groups[group != parameters.productGroups.end() ? group->second : risk.first].push_back(&risk.second);
+    }
+
+    double margin = 0.0;
+    for (const auto& group : groups) {
+        margin += productGroupMargin(group.second, parameters);
+    }
+    return margin;
+}
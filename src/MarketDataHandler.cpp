@@ -1,5 +1,6 @@
 // MarketDataHandler.cpp
 #include "MarketDataHandler.hpp"
+#include "Metrics.hpp"
 #include <iostream>
 #include <chrono>
 #include <sstream>
@@ -41,7 +42,13 @@ void MarketDataHandler::start() {
     running_ = true;
     data_thread_ = std::thread([this]() {
         while (running_) {
-            for (const auto& symbol : subscribed_symbols_) {
+            // Streams subscribe from gRPC threads while this pass runs
+            std::vector<std::string> symbols;
+            {
+                std::lock_guard<std::mutex> lock(dataMutex_);
+                symbols = subscribed_symbols_;
+            }
+            for (const auto& symbol : symbols) {
                 try {
                     fetchMarketData(symbol);
                     // Alpha Vantage rate limit: 5 API calls per minute for standard API
@@ -68,13 +75,18 @@ void MarketDataHandler::fetchMarketData(const std::string& symbol) {
     curl_easy_setopt(curl_, CURLOPT_URL, quote_url.c_str());
     curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &readBuffer);
 
+    uint64_t sent = TscClock::now();
     CURLcode res = curl_easy_perform(curl_);
+    Metrics::recordSince(LatencyStage::HTTP_RECEIVE, sent);
+    Metrics::increment(MetricCounter::HTTP_REQUESTS);
     if (res != CURLE_OK) {
+        Metrics::increment(MetricCounter::HTTP_ERRORS);
         throw std::runtime_error(std::string("CURL error: ") + curl_easy_strerror(res));
     }
 
     // Process stock quote first
     double underlying_price = processStockQuote(readBuffer);
+    applyUnderlyingPrice(symbol, underlying_price);
     
     // Now fetch options data
     readBuffer.clear();
@@ -85,8 +97,12 @@ void MarketDataHandler::fetchMarketData(const std::string& symbol) {
 
     curl_easy_setopt(curl_, CURLOPT_URL, options_url.c_str());
     
+    sent = TscClock::now();
     res = curl_easy_perform(curl_);
+    Metrics::recordSince(LatencyStage::HTTP_RECEIVE, sent);
+    Metrics::increment(MetricCounter::HTTP_REQUESTS);
     if (res != CURLE_OK) {
+        Metrics::increment(MetricCounter::HTTP_ERRORS);
         throw std::runtime_error(std::string("CURL error: ") + curl_easy_strerror(res));
     }
 
@@ -95,7 +111,9 @@ void MarketDataHandler::fetchMarketData(const std::string& symbol) {
 
 double MarketDataHandler::processStockQuote(const std::string& rawData) {
     try {
+        uint64_t received = TscClock::now();
         nlohmann::json j = nlohmann::json::parse(rawData);
+        Metrics::recordSince(LatencyStage::PARSE, received);
         
         if (j.contains("Error Message")) {
             throw std::runtime_error(j["Error Message"].get<std::string>());
@@ -114,7 +132,9 @@ double MarketDataHandler::processStockQuote(const std::string& rawData) {
 
 void MarketDataHandler::processOptionsData(const std::string& rawData, double underlying_price) {
     try {
+        uint64_t received = TscClock::now();
         nlohmann::json j = nlohmann::json::parse(rawData);
+        Metrics::recordSince(LatencyStage::PARSE, received);
         
         if (j.contains("Error Message")) {
             throw std::runtime_error(j["Error Message"].get<std::string>());
@@ -150,15 +170,7 @@ void MarketDataHandler::processExpiryOptions(const nlohmann::json& expiry_data,
         data.impliedVol = std::stod(call["impliedVolatility"].get<std::string>());
 
         calculateGreeks(data, underlying_price);
-        
-        {
-            std::lock_guard<std::mutex> lock(dataMutex_);
-            latestData_[data.underlying] = data;
-        }
-
-        if (callback_) {
-            callback_(data);
-        }
+        applyQuote(data);
     }
 
     // Process puts (similar to calls)
@@ -175,19 +187,67 @@ void MarketDataHandler::processExpiryOptions(const nlohmann::json& expiry_data,
         data.impliedVol = std::stod(put["impliedVolatility"].get<std::string>());
 
         calculateGreeks(data, underlying_price);
-        
-        {
-            std::lock_guard<std::mutex> lock(dataMutex_);
-            latestData_[data.underlying] = data;
-        }
+        applyQuote(data);
+    }
+}
 
-        if (callback_) {
-            callback_(data);
-        }
+void MarketDataHandler::enableSharedQuotes(const std::string& name, uint32_t capacity) {
+    std::unique_ptr<SharedQuoteTable> table(new SharedQuoteTable(name, capacity));
+    std::lock_guard<std::mutex> lock(dataMutex_);
+    sharedQuotes_ = std::move(table);
+}
+
+void MarketDataHandler::applyUnderlyingPrice(const std::string& symbol, double price) {
+    uint64_t started = TscClock::now();
+    {
+        std::lock_guard<std::mutex> lock(dataMutex_);
+        OptionChain& chain = chains_[symbol];
+        chain.underlyingPrice = price;
+        ++chain.version;
+    }
+
+    if (priceCallback_) {
+        priceCallback_(symbol, price);
     }
+    Metrics::recordSince(LatencyStage::PUBLISH, started);
+}
+
+void MarketDataHandler::applyQuote(const OptionData& data) {
+    uint64_t started = TscClock::now();
+    uint32_t id = instruments_.idFor(makeInstrumentKey(data.underlying, data.optionType, data.strike, data.expiry));
+    {
+        std::lock_guard<std::mutex> lock(dataMutex_);
+        if (sharedQuotes_) sharedQuotes_->publish(id, data);
+        latestData_[data.underlying] = data;
+        OptionChain& chain = chains_[data.underlying];
+        OptionChain::Contracts& side = data.optionType == "CALL" ? chain.calls : chain.puts;
+        side[std::make_pair(data.expiry, data.strike)] = data;
+        ++chain.version;
+    }
+
+    for (const DataCallback& callback : callbacks_) {
+        callback(data);
+    }
+    Metrics::recordSince(LatencyStage::PUBLISH, started);
+    Metrics::increment(MetricCounter::QUOTES_PUBLISHED);
+}
+
+bool MarketDataHandler::getOptionChain(const std::string& symbol, OptionChain& chain) const {
+    std::lock_guard<std::mutex> lock(dataMutex_);
+    auto it = chains_.find(symbol);
+    if (it == chains_.end()) return false;
+    chain = it->second;
+    return true;
+}
+
+uint64_t MarketDataHandler::getChainVersion(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(dataMutex_);
+    auto it = chains_.find(symbol);
+    return it == chains_.end() ? 0 : it->second.version;
 }
 
 void MarketDataHandler::calculateGreeks(OptionData& data, double underlying_price) {
+    uint64_t started = TscClock::now();
     // Convert expiry string to time to expiry in years
     auto expiry_tp = parseExpiryDate(data.expiry);
     auto now = std::chrono::system_clock::now();
@@ -208,6 +268,7 @@ void MarketDataHandler::calculateGreeks(OptionData& data, double underlying_pric
     data.theta = greeks.theta;
     data.vega = greeks.vega;
     data.rho = greeks.rho;
+    Metrics::recordSince(LatencyStage::GREEKS, started);
 }
 
 std::chrono::system_clock::time_point MarketDataHandler::parseExpiryDate(const std::string& date_str) {
@@ -221,10 +282,12 @@ std::chrono::system_clock::time_point MarketDataHandler::parseExpiryDate(const s
 }
 
 void MarketDataHandler::subscribeToSymbol(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(dataMutex_);
     subscribed_symbols_.push_back(symbol);
 }
 
 void MarketDataHandler::unsubscribeFromSymbol(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(dataMutex_);
     auto it = std::find(subscribed_symbols_.begin(), subscribed_symbols_.end(), symbol);
     if (it != subscribed_symbols_.end()) {
         subscribed_symbols_.erase(it);
@@ -247,6 +310,10 @@ void MarketDataHandler::stop() {
     }
 }
 
-void MarketDataHandler::setDataCallback(DataCallback cb) {
-    callback_ = std::move(cb);
+void MarketDataHandler::addDataCallback(DataCallback cb) {
+    callbacks_.push_back(std::move(cb));
+}
+
+void MarketDataHandler::setPriceCallback(PriceCallback cb) {
+    priceCallback_ = std::move(cb);
 }
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "Metrics.hpp"
+#include "BinaryLog.hpp"
+#include "FileUtils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr size_t STAGE_COUNT = static_cast<size_t>(LatencyStage::COUNT);
+    constexpr size_t COUNTER_COUNT = static_cast<size_t>(MetricCounter::COUNT);
+    constexpr uint64_t SUB_BUCKETS = uint64_t(1) << Metrics::SUB_BUCKET_BITS;
+    constexpr uint64_t MAX_VALUE = (uint64_t(1) << Metrics::MAX_VALUE_BITS) - 1;
+    constexpr size_t BUCKET_COUNT = SUB_BUCKETS * (Metrics::MAX_VALUE_BITS - Metrics::SUB_BUCKET_BITS + 1);
+
+    // Values below SUB_BUCKETS have a bucket each; above that, each power
+    // of two is split into SUB_BUCKETS equal buckets
+    size_t bucketFor(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        int msb = 63 - __builtin_clzll(value);
+        int shift = msb - Metrics::SUB_BUCKET_BITS;
+        return static_cast<size_t>(SUB_BUCKETS * (shift + 1) + ((value >> shift) - SUB_BUCKETS));
+    }
+
+    // Largest value that lands in the bucket
+    uint64_t bucketHighest(size_t bucket) {
+        if (bucket < SUB_BUCKETS) return bucket;
+        uint64_t shift = bucket / SUB_BUCKETS - 1;
+        uint64_t sub = bucket % SUB_BUCKETS;
+        return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+    }
+
+    // Written by its owning thread only, so plain load-then-store; the
+    // atomics are for the snapshot reading concurrently
+    void add(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    struct Histogram {
+        std::atomic<uint64_t> buckets[BUCKET_COUNT];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> max;
+    };
+
+    struct alignas(64) ThreadMetrics {
+        Histogram histograms[STAGE_COUNT];
+        std::atomic<uint64_t> counters[COUNTER_COUNT];
+        std::atomic<bool> inUse{true};
+        ThreadMetrics* next{nullptr};   // Immutable once published
+    };
+
+    // Every block ever handed out; never freed, so a snapshot can walk the
+    // list while threads come and go
+    std::atomic<ThreadMetrics*> allMetrics{nullptr};
+
+    ThreadMetrics* acquireMetrics() {
+        for (ThreadMetrics* m = allMetrics.load(std::memory_order_acquire); m; m = m->next) {
+            bool free = false;
+            if (!m->inUse.load(std::memory_order_relaxed) &&
+                m->inUse.compare_exchange_strong(free, true, std::memory_order_acquire)) {
+                return m;
+            }
+        }
+
+        // Value-initialized: every count starts at zero
+        ThreadMetrics* m = new ThreadMetrics();
+        ThreadMetrics* head = allMetrics.load(std::memory_order_relaxed);
+        do {
+            m->next = head;
+        } while (!allMetrics.compare_exchange_weak(head, m, std::memory_order_release, std::memory_order_relaxed));
+        return m;
+    }
+
+    // Hands the calling thread's block back when the thread exits
+    struct ThreadMetricsHandle {
+        ThreadMetrics* metrics{nullptr};
+        ~ThreadMetricsHandle() {
+            if (metrics) metrics->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadMetricsHandle threadMetrics;
+
+    ThreadMetrics& localMetrics() {
+        ThreadMetrics* m = threadMetrics.metrics;
+        if (!m) m = threadMetrics.metrics = acquireMetrics();
+        return *m;
+    }
+
+    LatencySummary summarize(LatencyStage stage, const std::vector<uint64_t>& buckets,
+                             uint64_t count, uint64_t sum, uint64_t max) {
+        const double nanosPerTick = TscClock::nanosPerTick();
+        LatencySummary summary{stage, count, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        if (count == 0) return summary;
+
+        // The buckets and the totals are read at slightly different
+        // moments, so clamp to what the buckets hold
+        uint64_t bucketTotal = 0;
+        for (uint64_t n : buckets) bucketTotal += n;
+        auto percentile = [&](double q) {
+            uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * bucketTotal + 0.5));
+            uint64_t seen = 0;
+            for (size_t b = 0; b < buckets.size(); ++b) {
+                seen += buckets[b];
+                if (seen >= rank) return std::min(bucketHighest(b), max) * nanosPerTick;
+            }
+            return max * nanosPerTick;
+        };
+
+        summary.meanNanos = static_cast<double>(sum) / count * nanosPerTick;
+        summary.p50Nanos = percentile(0.50);
+        summary.p90Nanos = percentile(0.90);
+        summary.p99Nanos = percentile(0.99);
+        summary.p999Nanos = percentile(0.999);
+        summary.maxNanos = max * nanosPerTick;
+        return summary;
+    }
+
+    class Dumper {
+    public:
+        void start(const std::string& path, std::chrono::seconds interval) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (running_) throw std::runtime_error("Metrics dump already running");
+            size_t slash = path.rfind('/');
+            directory_ = slash == std::string::npos ? "." : path.substr(0, slash);
+            name_ = slash == std::string::npos ? path : path.substr(slash + 1);
+            interval_ = interval;
+            running_ = true;
+            thread_ = std::thread(&Dumper::run, this);
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!running_) return;
+                running_ = false;
+            }
+            cv_.notify_all();
+            thread_.join();
+        }
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (running_) {
+                cv_.wait_for(lock, interval_);
+                lock.unlock();
+                write();
+                lock.lock();
+            }
+            lock.unlock();
+            write();   // So the file ends with the final figures
+        }
+
+        void write() {
+            std::string text = Metrics::prometheusText();
+            try {
+                writeFileAtomic(directory_, name_, {{text.data(), text.size()}});
+            } catch (const std::exception& e) {
+                LOG_WARN("Metrics dump failed: {}", e.what());
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool running_{false};
+        std::thread thread_;
+        std::string directory_;
+        std::string name_;
+        std::chrono::seconds interval_{10};
+    };
+
+    // Never destroyed, like the block list
+    Dumper& dumper() {
+        static Dumper* instance = new Dumper();
+        return *instance;
+    }
+
+    void appendSample(std::string& out, const std::string& series, double value) {
+        char text[32];
+        std::snprintf(text, sizeof(text), " %.9g\n", value);
+        out += series;
+        out += text;
+    }
+}
+
+void Metrics::record(LatencyStage stage, uint64_t ticks) {
+    Histogram& histogram = localMetrics().histograms[static_cast<size_t>(stage)];
+    // A start stamped on another core can read a hair later than the end
+    uint64_t value = static_cast<int64_t>(ticks) < 0 ? 0 : std::min(ticks, MAX_VALUE);
+    add(histogram.buckets[bucketFor(value)], 1);
+    add(histogram.count, 1);
+    add(histogram.sum, value);
+    if (value > histogram.max.load(std::memory_order_relaxed)) {
+        histogram.max.store(value, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::increment(MetricCounter counter, uint64_t count) {
+    add(localMetrics().counters[static_cast<size_t>(counter)], count);
+}
+
+MetricsSnapshot Metrics::snapshot() {
+    MetricsSnapshot snapshot;
+    snapshot.takenAt = std::chrono::system_clock::now();
+
+    std::vector<uint64_t> buckets(BUCKET_COUNT);
+    for (size_t s = 0; s < STAGE_COUNT; ++s) {
+        std::fill(buckets.begin(), buckets.end(), 0);
+        uint64_t count = 0, sum = 0, max = 0;
+        for (ThreadMetrics* m = allMetrics.load(std::memory_order_acquire); m; m = m->next) {
+            const Histogram& histogram = m->histograms[s];
+            count += histogram.count.load(std::memory_order_relaxed);
+            sum += histogram.sum.load(std::memory_order_relaxed);
+            max = std::max(max, histogram.max.load(std::memory_order_relaxed));
+            for (size_t b = 0; b < BUCKET_COUNT; ++b) {
+                buckets[b] += histogram.buckets[b].load(std::memory_order_relaxed);
+            }
+        }
+        snapshot.stages.push_back(summarize(static_cast<LatencyStage>(s), buckets, count, sum, max));
+    }
+
+    for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+        uint64_t total = 0;
+        for (ThreadMetrics* m = allMetrics.load(std::memory_order_acquire); m; m = m->next) {
+            total += m->counters[c].load(std::memory_order_relaxed);
+        }
+        snapshot.counters.emplace_back(static_cast<MetricCounter>(c), total);
+    }
+    return snapshot;
+}
+
+std::string Metrics::prometheusText() {
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    std::string out;
+    out.reserve(4096);
+
+    out += "# HELP trading_stage_latency_seconds Latency of each tick-to-trade stage since start-up\n"
+           "# TYPE trading_stage_latency_seconds summary\n";
+    for (const LatencySummary& stage : snapshot.stages) {
+        const std::string label = std::string("stage=\"") + stageName(stage.stage) + "\"";
+        const std::pair<const char*, double> quantiles[] = {
+            {"0.5", stage.p50Nanos}, {"0.9", stage.p90Nanos}, {"0.99", stage.p99Nanos},
+            {"0.999", stage.p999Nanos}, {"1", stage.maxNanos}
+        };
+        for (const auto& quantile : quantiles) {
+            appendSample(out, "trading_stage_latency_seconds{" + label + ",quantile=\"" + quantile.first + "\"}",
+                         quantile.second / 1e9);
+        }
+        appendSample(out, "trading_stage_latency_seconds_sum{" + label + "}", stage.meanNanos * stage.count / 1e9);
+        appendSample(out, "trading_stage_latency_seconds_count{" + label + "}", static_cast<double>(stage.count));
+    }
+
+    for (const auto& counter : snapshot.counters) {
+        const std::string series = std::string("trading_") + counterName(counter.first) + "_total";
+        out += "# TYPE " + series + " counter\n";
+        appendSample(out, series, static_cast<double>(counter.second));
+    }
+    return out;
+}
+
+void Metrics::startDump(const std::string& path, std::chrono::seconds interval) {
+    TscClock::nanosPerTick();   // Calibrated here rather than on the first dump
+    dumper().start(path, interval);
+}
+
+void Metrics::stopDump() {
+    dumper().stop();
+}
+
+const char* Metrics::stageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::HTTP_RECEIVE: return "http_receive";
+        case LatencyStage::PARSE: return "parse";
+        case LatencyStage::GREEKS: return "greeks";
+        case LatencyStage::PUBLISH: return "publish";
+        case LatencyStage::ORDER_RECEIVE: return "order_receive";
+        case LatencyStage::OMS_ACCEPT: return "oms_accept";
+        case LatencyStage::ENGINE_DEQUEUE: return "engine_dequeue";
+        case LatencyStage::FILL: return "fill";
+        case LatencyStage::ACK: return "ack";
+        case LatencyStage::COUNT: break;
+    }
+    return "unknown";
+}
+
+const char* Metrics::counterName(MetricCounter counter) {
+    switch (counter) {
+        case MetricCounter::HTTP_REQUESTS: return "http_requests";
+        case MetricCounter::HTTP_ERRORS: return "http_errors";
+        case MetricCounter::QUOTES_PUBLISHED: return "quotes_published";
+        case MetricCounter::ORDERS_RECEIVED: return "orders_received";
+        case MetricCounter::ORDERS_ACCEPTED: return "orders_accepted";
+        case MetricCounter::ORDERS_REJECTED: return "orders_rejected";
+        case MetricCounter::ORDERS_FILLED: return "orders_filled";
+        case MetricCounter::COUNT: break;
+    }
+    return "unknown";
+}
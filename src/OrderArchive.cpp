@@ -0,0 +1,358 @@
+#include "OrderArchive.hpp"
+#include "DateUtils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const std::string PARTITION_PREFIX = "orders-";
+    const std::string PARTITION_SUFFIX = ".arc";
+
+    constexpr size_t FILTER_BITS_PER_HANDLE = 12;
+    constexpr int FILTER_PROBES = 8;           // About 0.3% false matches when full
+    constexpr size_t MIN_FILTER_CAPACITY = 1024;
+
+    uint64_t mixHandle(OrderHandle handle) {
+        // Handles are structured (generation, slot, shard); spread the bits
+        uint64_t h = handle;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ull;
+        return h ^ (h >> 33);
+    }
+
+    bool historyLess(const OrderRecord& a, const OrderRecord& b) {
+        return OrderHistoryCursor{a.submitTimeNs, a.handle} < OrderHistoryCursor{b.submitTimeNs, b.handle};
+    }
+
+    bool parsePartitionDay(const std::string& name, int64_t& day) {
+        if (name.size() != PARTITION_PREFIX.size() + 8 + PARTITION_SUFFIX.size()) return false;
+        const char* digits = name.c_str() + PARTITION_PREFIX.size();
+        int value[3] = {0, 0, 0};
+        const int widths[3] = {4, 2, 2};
+        for (int field = 0, pos = 0; field < 3; ++field) {
+            for (int i = 0; i < widths[field]; ++i, ++pos) {
+                if (digits[pos] < '0' || digits[pos] > '9') return false;
+                value[field] = value[field] * 10 + (digits[pos] - '0');
+            }
+        }
+        day = daysFromCivil(value[0], value[1], value[2]);
+        return true;
+    }
+
+    void appendAndSync(const std::string& path, const std::vector<OrderRecord>& orders) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open archive partition " + path + ": " + std::strerror(errno));
+        }
+
+        const char* data = reinterpret_cast<const char*>(orders.data());
+        size_t remaining = orders.size() * sizeof(OrderRecord);
+        while (remaining > 0) {
+            ssize_t written = ::write(fd, data, remaining);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                ::close(fd);
+                throw std::runtime_error("Failed to write archive partition " + path + ": " + std::strerror(errno));
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+
+        if (::fdatasync(fd) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to sync archive partition " + path + ": " + std::strerror(errno));
+        }
+        ::close(fd);
+    }
+}
+
+bool OrderHistoryQuery::matches(const OrderRecord& order) const {
+    if (order.submitTimeNs < startTimeNs || order.submitTimeNs > endTimeNs) return false;
+    if (!(after < OrderHistoryCursor{order.submitTimeNs, order.handle})) return false;
+    if (filterStatus && order.status != status) return false;
+    if (!underlying.empty() &&
+        std::strncmp(order.instrument.underlying, underlying.c_str(), sizeof(order.instrument.underlying)) != 0) {
+        return false;
+    }
+    return true;
+}
+
+OrderArchive::OrderArchive(const std::string& directory, size_t cachedPartitions)
+    : directory_(directory)
+    , cachedPartitions_(std::max<size_t>(cachedPartitions, 1)) {
+    ensureDirectory(directory_);
+    for (const auto& name : listFiles(directory_, PARTITION_PREFIX, PARTITION_SUFFIX)) {
+        int64_t day;
+        if (parsePartitionDay(name, day)) {
+            days_.insert(day);
+        }
+    }
+}
+
+OrderArchive::HandleFilter::HandleFilter(size_t expected)
+    // Headroom so the partition still being appended to is not rebuilt on every batch
+    : capacity(std::max(expected + expected / 4, MIN_FILTER_CAPACITY)) {
+    bits.assign((capacity * FILTER_BITS_PER_HANDLE + 63) / 64, 0);
+}
+
+void OrderArchive::HandleFilter::add(OrderHandle handle) {
+    uint64_t h = mixHandle(handle);
+    uint64_t step = (h >> 32) | 1;
+    uint64_t size = bits.size() * 64;
+    for (int i = 0; i < FILTER_PROBES; ++i, h += step) {
+        uint64_t bit = h % size;
+        bits[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+    ++count;
+}
+
+bool OrderArchive::HandleFilter::mayContain(OrderHandle handle) const {
+    uint64_t h = mixHandle(handle);
+    uint64_t step = (h >> 32) | 1;
+    uint64_t size = bits.size() * 64;
+    for (int i = 0; i < FILTER_PROBES; ++i, h += step) {
+        uint64_t bit = h % size;
+        if ((bits[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) return false;
+    }
+    return true;
+}
+
+std::string OrderArchive::partitionPath(int64_t day) const {
+    int year, month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+    char name[32];
+    std::snprintf(name, sizeof(name), "orders-%04d%02d%02d.arc", year, month, dayOfMonth);
+    return directory_ + "/" + name;
+}
+
+OrderArchive::Partition& OrderArchive::loadPartition(int64_t day) const {
+    auto it = cache_.find(day);
+    if (it != cache_.end()) {
+        it->second->lastUsed = ++useClock_;
+        return *it->second;
+    }
+
+    if (cache_.size() >= cachedPartitions_) {
+        auto victim = std::min_element(cache_.begin(), cache_.end(), [](const auto& a, const auto& b) {
+            return a.second->lastUsed < b.second->lastUsed;
+        });
+        cache_.erase(victim);
+    }
+
+    std::unique_ptr<Partition> partition(new Partition());
+    partition->day = day;
+    partition->path = partitionPath(day);
+    partition->lastUsed = ++useClock_;
+    partition->file = MappedFile(partition->path);
+
+    // A crash mid-append can leave a partial record at the end
+    size_t count = partition->file.size() / sizeof(OrderRecord);
+    if (count * sizeof(OrderRecord) != partition->file.size()) {
+        partition->file = MappedFile();
+        truncateFile(partition->path, count * sizeof(OrderRecord));
+        partition->file = MappedFile(partition->path);
+    }
+    partition->mappedCount = count;
+    partition->recordCount = count;
+
+    const OrderRecord* stored = reinterpret_cast<const OrderRecord*>(partition->file.data());
+    partition->byTime.reserve(count);
+    partition->byHandle.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        index(*partition, stored[i], static_cast<uint32_t>(i));
+    }
+
+    Partition& result = *partition;
+    cache_[day] = std::move(partition);
+    return result;
+}
+
+const OrderRecord* OrderArchive::records(Partition& partition) const {
+    if (partition.mappedCount < partition.recordCount) {
+        partition.file = MappedFile(partition.path);
+        partition.mappedCount = partition.file.size() / sizeof(OrderRecord);
+    }
+    return reinterpret_cast<const OrderRecord*>(partition.file.data());
+}
+
+void OrderArchive::index(Partition& partition, const OrderRecord& order, uint32_t slot) const {
+    if (!partition.byTime.empty() && order.submitTimeNs < partition.byTime.back().first) {
+        partition.timeSorted = false;
+    }
+    partition.byTime.emplace_back(order.submitTimeNs, slot);
+    partition.byUnderlying[std::string(order.instrument.underlying,
+                                       strnlen(order.instrument.underlying, sizeof(order.instrument.underlying)))]
+        .push_back(slot);
+    partition.byStatus[static_cast<size_t>(order.status)].push_back(slot);
+    partition.byHandle.emplace(order.handle, slot);
+}
+
+const OrderArchive::HandleFilter& OrderArchive::handleFilter(int64_t day) const {
+    auto it = filters_.find(day);
+    if (it != filters_.end()) return it->second;
+
+    // Built from the index if the partition is cached, otherwise from one
+    // pass over the file, so building never evicts the working set
+    auto cached = cache_.find(day);
+    if (cached != cache_.end()) {
+        const Partition& partition = *cached->second;
+        HandleFilter filter(partition.recordCount);
+        for (const auto& entry : partition.byHandle) filter.add(entry.first);
+        return filters_.emplace(day, std::move(filter)).first->second;
+    }
+
+    MappedFile file(partitionPath(day));
+    const OrderRecord* stored = reinterpret_cast<const OrderRecord*>(file.data());
+    size_t count = file.size() / sizeof(OrderRecord);
+    HandleFilter filter(count);
+    for (size_t i = 0; i < count; ++i) filter.add(stored[i].handle);
+    return filters_.emplace(day, std::move(filter)).first->second;
+}
+
+size_t OrderArchive::append(const std::vector<OrderRecord>& orders) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Group by partition, dropping orders that are already archived
+    std::map<int64_t, std::vector<OrderRecord>> batches;
+    for (const auto& order : orders) {
+        int64_t day = dayOfNanos(order.submitTimeNs);
+        Partition& partition = loadPartition(day);
+        if (partition.byHandle.count(order.handle) == 0) {
+            batches[day].push_back(order);
+        }
+    }
+
+    size_t appended = 0;
+    for (auto& batch : batches) {
+        Partition& partition = loadPartition(batch.first);
+        try {
+            appendAndSync(partition.path, batch.second);
+        } catch (...) {
+            // Reloading re-reads whatever made it to disk
+            cache_.erase(batch.first);
+            filters_.erase(batch.first);
+            throw;
+        }
+        days_.insert(batch.first);
+
+        for (const auto& order : batch.second) {
+            index(partition, order, static_cast<uint32_t>(partition.recordCount++));
+        }
+        // A filter that would overfill is rebuilt, larger, by the next lookup
+        auto filter = filters_.find(batch.first);
+        if (filter != filters_.end()) {
+            if (filter->second.count + batch.second.size() > filter->second.capacity) {
+                filters_.erase(filter);
+            } else {
+                for (const auto& order : batch.second) filter->second.add(order.handle);
+            }
+        }
+        appended += batch.second.size();
+    }
+    if (!batches.empty()) {
+        syncDirectory(directory_);
+    }
+    return appended;
+}
+
+OrderHistoryPage OrderArchive::query(const OrderHistoryQuery& query) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    OrderHistoryPage page;
+    if (query.pageSize == 0) return page;
+
+    int64_t from = std::max(query.startTimeNs, query.after.submitTimeNs);
+    if (from > query.endTimeNs) return page;
+    std::vector<uint32_t> hits;
+
+    for (auto day = days_.lower_bound(dayOfNanos(from));
+         day != days_.end() && *day <= dayOfNanos(query.endTimeNs); ++day) {
+        Partition& partition = loadPartition(*day);
+        const OrderRecord* stored = records(partition);
+        size_t needed = query.pageSize + 1 - page.orders.size();
+        hits.clear();
+
+        auto consider = [&](uint32_t slot) {
+            if (query.matches(stored[slot])) hits.push_back(slot);
+        };
+
+        // Use the most selective index the query allows
+        if (!query.underlying.empty()) {
+            auto it = partition.byUnderlying.find(query.underlying);
+            if (it != partition.byUnderlying.end()) {
+                for (uint32_t slot : it->second) consider(slot);
+            }
+        } else if (query.filterStatus) {
+            for (uint32_t slot : partition.byStatus[static_cast<size_t>(query.status)]) consider(slot);
+        } else {
+            if (!partition.timeSorted) {
+                std::sort(partition.byTime.begin(), partition.byTime.end());
+                partition.timeSorted = true;
+            }
+            auto it = std::lower_bound(partition.byTime.begin(), partition.byTime.end(),
+                                       std::make_pair(from, uint32_t{0}));
+            for (; it != partition.byTime.end() && it->first <= query.endTimeNs; ++it) {
+                // Sorted by time: stop once enough hits are in and no tie can follow
+                if (hits.size() >= needed && it->first > stored[hits.back()].submitTimeNs) break;
+                consider(it->second);
+            }
+        }
+
+        std::sort(hits.begin(), hits.end(), [stored](uint32_t a, uint32_t b) {
+            return historyLess(stored[a], stored[b]);
+        });
+        for (size_t i = 0; i < hits.size() && page.orders.size() <= query.pageSize; ++i) {
+            page.orders.push_back(stored[hits[i]]);
+        }
+        if (page.orders.size() > query.pageSize) break;
+    }
+
+    if (page.orders.size() > query.pageSize) {
+        page.orders.resize(query.pageSize);
+        page.hasMore = true;
+    }
+    return page;
+}
+
+bool OrderArchive::find(OrderHandle handle, OrderRecord& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Newest partitions first, skipping those whose filter rules the handle
+    // out; uncached ones are scanned in place rather than indexed, so a
+    // lookup never evicts the working set
+    for (auto day = days_.rbegin(); day != days_.rend(); ++day) {
+        if (!handleFilter(*day).mayContain(handle)) continue;
+
+        auto cached = cache_.find(*day);
+        if (cached != cache_.end()) {
+            Partition& partition = *cached->second;
+            auto it = partition.byHandle.find(handle);
+            if (it != partition.byHandle.end()) {
+                out = records(partition)[it->second];
+                return true;
+            }
+            continue;
+        }
+
+        MappedFile file(partitionPath(*day));
+        const OrderRecord* stored = reinterpret_cast<const OrderRecord*>(file.data());
+        size_t count = file.size() / sizeof(OrderRecord);
+        for (size_t i = 0; i < count; ++i) {
+            if (stored[i].handle == handle) {
+                out = stored[i];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t OrderArchive::partitionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return days_.size();
+}
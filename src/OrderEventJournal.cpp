@@ -0,0 +1,200 @@
+#include "OrderEventJournal.hpp"
+#include "OrderManagementSystem.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+    constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+    int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // False for changes the feed does not carry
+    bool feedType(OrderEvent::Type type, JournalEvent::Type& out) {
+        switch (type) {
+            case OrderEvent::Type::SUBMITTED: out = JournalEvent::Type::ACCEPTED; return true;
+            case OrderEvent::Type::REPLACED: out = JournalEvent::Type::REPLACED; return true;
+            case OrderEvent::Type::FILLED: out = JournalEvent::Type::FILLED; return true;
+            case OrderEvent::Type::CANCELLED: out = JournalEvent::Type::CANCELLED; return true;
+            case OrderEvent::Type::REJECTED: out = JournalEvent::Type::REJECTED; return true;
+            case OrderEvent::Type::EXPIRED: out = JournalEvent::Type::EXPIRED; return true;
+            case OrderEvent::Type::ARCHIVED: return false;
+        }
+        return false;
+    }
+}
+
+std::string formatExecutionId(uint64_t executionId) {
+    std::string text("EXE-");
+    for (int i = 0; i < 16; ++i) {
+        text += HEX_DIGITS[(executionId >> (60 - 4 * i)) & 0xF];
+    }
+    return text;
+}
+
+bool parseExecutionId(const std::string& text, uint64_t& executionId) {
+    if (text.size() != 20 || text.compare(0, 4, "EXE-") != 0) return false;
+
+    uint64_t value = 0;
+    for (size_t i = 4; i < text.size(); ++i) {
+        char c = text[i];
+        uint64_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+    executionId = value;
+    return true;
+}
+
+OrderEventJournal::OrderEventJournal(OrderManagementSystem& oms, size_t eventCapacity, size_t executionCapacity)
+    : id_(static_cast<uint64_t>(nowNanos()))
+    , laneCount_(oms.getShardCount())
+    , lanes_(new Lane[oms.getShardCount()])
+    , events_(eventCapacity)
+    , executions_(executionCapacity) {
+    if (eventCapacity == 0 || executionCapacity == 0) {
+        throw std::invalid_argument("Order event journal capacities must be positive");
+    }
+    oms.addOrderEventListener([this](OrderEvent::Type type, const OrderRecord& order) {
+        append(type, order);
+    });
+}
+
+OrderEventJournal::~OrderEventJournal() {
+    stop();
+}
+
+void OrderEventJournal::start() {
+    std::lock_guard<std::mutex> lock(runMutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&OrderEventJournal::run, this);
+}
+
+void OrderEventJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(runMutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void OrderEventJournal::addListener(Listener listener) {
+    listeners_.push_back(std::move(listener));
+}
+
+void OrderEventJournal::append(OrderEvent::Type type, const OrderRecord& order) {
+    // Called under the order's shard lock: only that shard appends to its lane
+    JournalEvent::Type feed;
+    if (!feedType(type, feed)) return;
+
+    Lane& lane = lanes_[OrderStore::shardOf(order.handle) % laneCount_];
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        lane.pending.push_back(StagedEvent{nowNanos(), feed, order});
+        if (lane.pending.size() >= events_.size()) publish(lane);   // Nobody is draining
+    }
+
+    // One wake-up per drain, with no lock: a notify that slips in before
+    // the thread waits is covered by DRAIN_INTERVAL
+    if (!wakePending_.load(std::memory_order_relaxed) && !wakePending_.exchange(true, std::memory_order_acq_rel)) {
+        cv_.notify_one();
+    }
+}
+
+void OrderEventJournal::run() {
+    std::unique_lock<std::mutex> lock(runMutex_);
+    while (true) {
+        cv_.wait_for(lock, DRAIN_INTERVAL, [this] {
+            return !running_ || wakePending_.load(std::memory_order_acquire);
+        });
+        bool stopping = !running_;
+        lock.unlock();
+
+        // Everything staged since the last drain goes out in one call; the
+        // final pass picks up what was staged before stop()
+        wakePending_.store(false, std::memory_order_release);
+        uint64_t last = drain();
+        if (last > notifiedSequence_) {
+            notifiedSequence_ = last;
+            for (const Listener& listener : listeners_) listener(last);
+        }
+        lock.lock();
+        if (stopping) return;
+    }
+}
+
+uint64_t OrderEventJournal::drain() {
+    for (size_t i = 0; i < laneCount_; ++i) {
+        std::lock_guard<std::mutex> lock(lanes_[i].mutex);
+        if (!lanes_[i].pending.empty()) publish(lanes_[i]);
+    }
+    return lastSequence();
+}
+
+void OrderEventJournal::publish(Lane& lane) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const StagedEvent& staged : lane.pending) {
+        JournalEvent& event = events_[lastSequence_ % events_.size()];
+        event.sequence = ++lastSequence_;
+        event.timestampNs = staged.timestampNs;
+        event.type = staged.type;
+        event.executionId = 0;
+        event.order = staged.order;
+
+        if (staged.type == JournalEvent::Type::FILLED) {
+            ExecutionRecord& execution = executions_[lastExecutionId_ % executions_.size()];
+            execution.executionId = ++lastExecutionId_;
+            execution.sequence = event.sequence;
+            execution.quantity = staged.order.quantity;
+            execution.price = staged.order.fillPrice;
+            execution.timeNs = staged.order.fillTimeNs;
+            execution.order = staged.order;
+            event.executionId = execution.executionId;
+        }
+    }
+    lane.pending.clear();
+}
+
+bool OrderEventJournal::read(uint64_t fromSequence, size_t maxEvents, std::vector<JournalEvent>& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t first = lastSequence_ > events_.size() ? lastSequence_ - events_.size() + 1 : 1;
+    if (fromSequence < first) return false;
+
+    for (uint64_t sequence = fromSequence; sequence <= lastSequence_ && maxEvents > 0; ++sequence, --maxEvents) {
+        out.push_back(events_[(sequence - 1) % events_.size()]);
+    }
+    return true;
+}
+
+bool OrderEventJournal::getExecution(uint64_t executionId, ExecutionRecord& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (executionId == 0 || executionId > lastExecutionId_) return false;
+    const ExecutionRecord& execution = executions_[(executionId - 1) % executions_.size()];
+    if (execution.executionId != executionId) return false;   // Overwritten by a later fill
+    out = execution;
+    return true;
+}
+
+uint64_t OrderEventJournal::lastSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastSequence_;
+}
+
+uint64_t OrderEventJournal::firstRetainedSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lastSequence_ > events_.size() ? lastSequence_ - events_.size() + 1 : 1;
+}
@@ -1,13 +1,61 @@
 #include "OrderManagementSystem.hpp"
 #include "OptionTypes.hpp"
+#include "BinaryLog.hpp"
 #include "ExecutionEngine.hpp"
+#include "Metrics.hpp"
+#include "OrderTracer.hpp"
+#include "RiskManagement.hpp"
+#include "OrderSnapshot.hpp"
+#include "DateUtils.hpp"
 #include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
-OrderManagementSystem::OrderManagementSystem() 
-    : isRunning_(false), orderCounter_(0) {}
+namespace {
+    int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    // Timer wheel ticks are wall-clock milliseconds since the Unix epoch
+    uint64_t toExpiryTick(int64_t nanos) {
+        return static_cast<uint64_t>(nanos / 1000000);
+    }
+
+    // FNV-1a over the underlying symbol; picks the owning shard
+    size_t hashUnderlying(const char* underlying, size_t length) {
+        uint64_t h = 14695981039346656037ull;
+        for (size_t i = 0; i < length && underlying[i] != '\0'; ++i) {
+            h = (h ^ static_cast<unsigned char>(underlying[i])) * 1099511628211ull;
+        }
+        return static_cast<size_t>(h);
+    }
+
+    // Change in position a fill of the order causes
+    double signedQuantity(const OrderRecord& order) {
+        bool buy = order.type == OptionOrder::Type::BUY_TO_OPEN ||
+                   order.type == OptionOrder::Type::BUY_TO_CLOSE;
+        return buy ? order.quantity : -static_cast<double>(order.quantity);
+    }
+}
+
+OrderManagementSystem::OrderManagementSystem(size_t orderCapacity, size_t shardCount)
+    : sessionCloseNs_(std::chrono::nanoseconds(DEFAULT_SESSION_CLOSE).count())
+    , isRunning_(false) {
+    if (shardCount == 0 || shardCount > OrderStore::MAX_SHARDS) {
+        throw std::invalid_argument("Shard count must be between 1 and " +
+                                    std::to_string(OrderStore::MAX_SHARDS));
+    }
+
+    size_t shardCapacity = (orderCapacity + shardCount - 1) / shardCount;
+    uint64_t startTick = toExpiryTick(nowNanos());
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards_.push_back(std::unique_ptr<Shard>(
+            new Shard(shardCapacity, static_cast<uint32_t>(i), startTick)));
+    }
+}
 
 OrderManagementSystem::~OrderManagementSystem() {
     stop();
@@ -15,14 +63,64 @@ OrderManagementSystem::~OrderManagementSystem() {
 
 void OrderManagementSystem::start() {
     isRunning_ = true;
+    if (wal_) {
+        wal_->start();
+        if (!snapshotThread_.joinable()) {
+            snapshotThread_ = std::thread(&OrderManagementSystem::snapshotLoop, this);
+        }
+        if (!archiveThread_.joinable()) {
+            archiveThread_ = std::thread(&OrderManagementSystem::archiveLoop, this);
+        }
+    }
+    if (!expiryThread_.joinable()) {
+        expiryThread_ = std::thread(&OrderManagementSystem::expiryLoop, this);
+    }
     std::cout << "OMS started." << std::endl;
 }
 
 void OrderManagementSystem::stop() {
-    isRunning_ = false;
+    {
+        std::lock_guard<std::mutex> lock(persistenceWaitMutex_);
+        isRunning_ = false;
+    }
+    persistenceCv_.notify_all();
+    if (expiryThread_.joinable()) {
+        expiryThread_.join();
+    }
+    if (snapshotThread_.joinable()) {
+        snapshotThread_.join();
+    }
+    if (archiveThread_.joinable()) {
+        archiveThread_.join();
+    }
+    if (wal_) {
+        wal_->stop();
+    }
     std::cout << "OMS stopped." << std::endl;
 }
 
+size_t OrderManagementSystem::shardIndexFor(const char* underlying) const {
+    return hashUnderlying(underlying, sizeof(InstrumentKey::underlying)) % shards_.size();
+}
+
+OrderManagementSystem::Shard& OrderManagementSystem::shardFor(const char* underlying) const {
+    return *shards_[shardIndexFor(underlying)];
+}
+
+OrderManagementSystem::Shard* OrderManagementSystem::shardFor(OrderHandle handle) const {
+    uint32_t shard = OrderStore::shardOf(handle);
+    return shard < shards_.size() ? shards_[shard].get() : nullptr;
+}
+
+std::vector<std::unique_lock<std::mutex>> OrderManagementSystem::lockAllShards() const {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shards_.size());
+    for (const auto& shard : shards_) {
+        locks.emplace_back(shard->mutex);
+    }
+    return locks;
+}
+
 void OrderManagementSystem::sendOrder(const std::string& symbol, double price, int quantity) {
     OptionOrder order;
     order.underlying = symbol;
@@ -30,165 +128,519 @@ void OrderManagementSystem::sendOrder(const std::string& symbol, double price, i
     order.quantity = quantity;
     order.type = quantity > 0 ? OptionOrder::Type::BUY_TO_OPEN : OptionOrder::Type::SELL_TO_OPEN;
     order.orderType = OptionOrder::OrderType::LIMIT;
-    
+
     submitOptionOrder(order);
 }
 
 std::string OrderManagementSystem::submitOptionOrder(const OptionOrder& order) {
+    return formatOrderId(submitOrder(makeOrderRecord(order)));
+}
+
+OrderHandle OrderManagementSystem::submitOrder(const OrderRecord& order) {
     if (!isRunning_) {
         throw std::runtime_error("OMS is not running");
     }
 
-    validateOrder(order);
-    
-    auto orderId = generateOrderId();
-    OptionOrder newOrder = order;
-    newOrder.orderId = orderId;
+    uint64_t received = TscClock::now();
+    try {
+        validateOrder(order);
+        checkOrderRisk(order);
+    } catch (...) {
+        Metrics::increment(MetricCounter::ORDERS_REJECTED);
+        throw;
+    }
+    // Stamped for every order while tracing is on: the handle, which
+    // decides sampling, only exists once the order is inserted
+    const bool tracing = OrderTracer::enabled();
+    const uint64_t validated = tracing ? TscClock::now() : 0;
+
+    OrderRecord newOrder = order;
     newOrder.status = OptionOrder::Status::PENDING;
     newOrder.isActive = true;
-    newOrder.submitTime = std::chrono::system_clock::now();
+    newOrder.submitTimeNs = nowNanos();
+    newOrder.lastUpdateNs = newOrder.submitTimeNs;
+    newOrder.fillTimeNs = 0;
+    newOrder.fillPrice = 0.0;
+    newOrder.expiryTimer = 0;
+    newOrder.revision = 0;
 
+    int64_t deadline = computeExpiry(newOrder);
+    Shard& shard = shardFor(newOrder.instrument.underlying);
     {
-        std::lock_guard<std::mutex> lock(ordersMutex_);
-        orders_[orderId] = newOrder;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        OrderRecord& stored = shard.orders.insert(newOrder);
+        scheduleExpiry(shard, stored, deadline);
+        journal(OrderEvent::Type::SUBMITTED, stored);
+        newOrder = stored;
+    }
+    if (tracing && OrderTracer::sampled(newOrder.handle)) {
+        OrderTracer::span(TraceStage::VALIDATION, newOrder.handle, received, validated);
+        OrderTracer::span(TraceStage::OMS_INSERT, newOrder.handle, validated, TscClock::now());
     }
 
     // Forward order to execution engine
     if (executionEngine_) {
         executionEngine_->addOrder(newOrder);
     } else {
-        std::cerr << "Warning: No execution engine connected to OMS" << std::endl;
+        LOG_WARN("No execution engine connected to OMS");
+    }
+
+    char orderId[ORDER_ID_LENGTH + 1];
+    formatOrderId(newOrder.handle, orderId);
+    LOG_INFO("Order submitted -> ID: {}, Symbol: {}, Type: {}, Quantity: {}, Price: {}",
+             orderId, newOrder.instrument.underlying, newOrder.quantity > 0 ? "BUY" : "SELL",
+             std::abs(newOrder.quantity), newOrder.limitPrice);
+
+    Metrics::recordSince(LatencyStage::OMS_ACCEPT, received);
+    Metrics::increment(MetricCounter::ORDERS_ACCEPTED);
+    return newOrder.handle;
+}
+
+std::vector<OrderHandle> OrderManagementSystem::submitStrategy(const StrategyOrder& order) {
+    if (!isRunning_) {
+        throw std::runtime_error("OMS is not running");
+    }
+
+    const Strategy& strategy = order.strategy;
+    validateStrategy(strategy);
+    if (order.quantity <= 0) {
+        throw std::invalid_argument("Strategy quantity must be positive");
+    }
+    if (order.orderType == OptionOrder::OrderType::STOP || order.orderType == OptionOrder::OrderType::STOP_LIMIT) {
+        throw std::invalid_argument("Stop orders are not supported for strategies");
+    }
+    if (order.orderType == OptionOrder::OrderType::LIMIT && order.limitPrices.size() != strategy.legs.size()) {
+        throw std::invalid_argument("A limit strategy order needs one limit price per leg");
+    }
+
+    const size_t legCount = strategy.legs.size();
+    const int64_t now = nowNanos();
+    std::vector<OrderRecord> legs(legCount);
+    std::vector<int64_t> deadlines(legCount);
+    for (size_t i = 0; i < legCount; ++i) {
+        int64_t traded = static_cast<int64_t>(strategy.legs[i].ratio) * order.quantity;
+        if (std::abs(traded) > INT32_MAX) {
+            throw std::invalid_argument("Strategy leg quantity is too large");
+        }
+
+        OrderRecord& leg = legs[i];
+        leg = OrderRecord{};
+        leg.instrument = strategy.legs[i].instrument;
+        leg.type = traded > 0 ? OptionOrder::Type::BUY_TO_OPEN : OptionOrder::Type::SELL_TO_OPEN;
+        leg.orderType = order.orderType;
+        leg.status = OptionOrder::Status::PENDING;
+        leg.timeInForce = order.timeInForce;
+        leg.quantity = static_cast<int32_t>(std::abs(traded));
+        leg.limitPrice = order.orderType == OptionOrder::OrderType::LIMIT ? order.limitPrices[i] : 0.0;
+        leg.submitTimeNs = now;
+        leg.lastUpdateNs = now;
+        leg.expireTimeNs = order.expireTimeNs;
+        leg.isActive = true;
+        validateOrder(leg);
+        deadlines[i] = computeExpiry(leg);
+    }
+    if (riskManager_ && !riskManager_->checkStrategyRisk(strategy, order.quantity)) {
+        throw std::runtime_error("Strategy rejected: it would breach the portfolio risk limits");
+    }
+
+    // Every shard the legs live on, locked in ascending index
+    std::vector<size_t> legShards(legCount);
+    for (size_t i = 0; i < legCount; ++i) {
+        legShards[i] = shardIndexFor(legs[i].instrument.underlying);
+    }
+    std::vector<size_t> lockOrder = legShards;
+    std::sort(lockOrder.begin(), lockOrder.end());
+    lockOrder.erase(std::unique(lockOrder.begin(), lockOrder.end()), lockOrder.end());
+    {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(lockOrder.size());
+        for (size_t index : lockOrder) {
+            locks.emplace_back(shards_[index]->mutex);
+        }
+
+        // Nothing is journaled until every leg has a slot, so a failed
+        // insert can be undone without a trace
+        size_t inserted = 0;
+        try {
+            for (; inserted < legCount; ++inserted) {
+                legs[inserted] = shards_[legShards[inserted]]->orders.insert(legs[inserted]);
+            }
+        } catch (...) {
+            for (size_t i = 0; i < inserted; ++i) {
+                shards_[legShards[i]]->orders.erase(legs[i].handle);
+            }
+            throw;
+        }
+        for (size_t i = 0; i < legCount; ++i) {
+            Shard& shard = *shards_[legShards[i]];
+            OrderRecord& stored = *shard.orders.find(legs[i].handle);
+            scheduleExpiry(shard, stored, deadlines[i]);
+            journal(OrderEvent::Type::SUBMITTED, stored);
+            legs[i] = stored;
+        }
+    }
+
+    std::vector<OrderHandle> handles(legCount);
+    for (size_t i = 0; i < legCount; ++i) {
+        handles[i] = legs[i].handle;
+        if (executionEngine_) {
+            executionEngine_->addOrder(legs[i]);
+        }
+    }
+    if (!executionEngine_) {
+        LOG_WARN("No execution engine connected to OMS");
     }
 
-    std::cout << "Order submitted -> ID: " << orderId
-              << ", Symbol: " << order.underlying
-              << ", Type: " << (order.quantity > 0 ? "BUY" : "SELL")
-              << ", Quantity: " << std::abs(order.quantity)
-              << ", Price: " << order.limitPrice << std::endl;
+    char firstOrderId[ORDER_ID_LENGTH + 1];
+    formatOrderId(handles.front(), firstOrderId);
+    LOG_INFO("Strategy submitted -> {}, Legs: {}, Quantity: {}, First order ID: {}",
+             strategy.name.empty() ? "Strategy" : strategy.name.c_str(), legCount, order.quantity, firstOrderId);
 
-    return orderId;
+    return handles;
 }
 
 void OrderManagementSystem::cancelOrder(const std::string& orderId) {
-    std::lock_guard<std::mutex> lock(ordersMutex_);
-    auto it = orders_.find(orderId);
-    if (it != orders_.end() && it->second.isActive) {
-        it->second.isActive = false;
-        it->second.status = OptionOrder::Status::CANCELLED;
+    OrderHandle handle;
+    if (parseOrderId(orderId, handle)) {
+        cancelOrder(handle);
+    }
+}
+
+bool OrderManagementSystem::cancelOrder(OrderHandle handle) {
+    Shard* shard = shardFor(handle);
+    if (!shard) return false;
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        OrderRecord* order = shard->orders.find(handle);
+        if (!order || !order->isActive) return false;
+
+        order->isActive = false;
+        order->status = OptionOrder::Status::CANCELLED;
+        order->lastUpdateNs = nowNanos();
+        cancelExpiry(*shard, *order);
+        journal(OrderEvent::Type::CANCELLED, *order);
+        queueForArchive(*shard, *order);
     }
+
+    // Tombstone any copy still queued in the engine
+    if (executionEngine_) {
+        executionEngine_->cancelOrder(handle);
+    }
+    return true;
 }
 
 void OrderManagementSystem::modifyOrder(const std::string& orderId, const OptionOrder& newOrder) {
-    std::lock_guard<std::mutex> lock(ordersMutex_);
-    auto it = orders_.find(orderId);
-    if (it != orders_.end() && it->second.isActive) {
+    OrderHandle handle;
+    if (parseOrderId(orderId, handle)) {
+        replaceOrder(handle, makeOrderRecord(newOrder));
+    }
+}
+
+bool OrderManagementSystem::replaceOrder(OrderHandle handle, const OrderRecord& newOrder) {
+    Shard* shard = shardFor(handle);
+    if (!shard) return false;
+
+    OrderRecord replacement;
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        OrderRecord* order = shard->orders.find(handle);
+        if (!order || !order->isActive) return false;
+
         validateOrder(newOrder);
-        it->second = newOrder;
-        it->second.orderId = orderId; // Preserve original order ID
+        checkOrderRisk(newOrder);
+
+        // The underlying selects the shard, so it cannot change in place
+        if (std::strncmp(newOrder.instrument.underlying, order->instrument.underlying,
+                         sizeof(order->instrument.underlying)) != 0) {
+            throw std::invalid_argument("Replace cannot change the underlying symbol");
+        }
+
+        // Preserve the OMS-owned fields of the original order
+        OrderRecord updated = newOrder;
+        updated.handle = handle;
+        updated.status = order->status;
+        updated.isActive = true;
+        updated.submitTimeNs = order->submitTimeNs;
+        updated.lastUpdateNs = nowNanos();
+        updated.fillTimeNs = 0;
+        updated.fillPrice = 0.0;
+        updated.expiryTimer = 0;
+        updated.revision = order->revision + 1;
+        int64_t deadline = computeExpiry(updated);
+
+        cancelExpiry(*shard, *order);
+        *order = updated;
+        scheduleExpiry(*shard, *order, deadline);
+        journal(OrderEvent::Type::REPLACED, *order);
+        replacement = *order;
+    }
+
+    // The new revision supersedes any copy still queued in the engine
+    if (executionEngine_) {
+        executionEngine_->replaceOrder(replacement);
     }
+    return true;
+}
+
+bool OrderManagementSystem::getOrder(OrderHandle handle, OrderRecord& out) const {
+    Shard* shard = shardFor(handle);
+    if (!shard) return false;
+
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    const OrderRecord* order = shard->orders.find(handle);
+    if (!order) return false;
+    out = *order;
+    return true;
+}
+
+bool OrderManagementSystem::findOrder(OrderHandle handle, OrderRecord& out) const {
+    // Orders reach the archive before they leave the slab, so looking in
+    // this order never misses one being archived
+    return getOrder(handle, out) || (archive_ && archive_->find(handle, out));
 }
 
 std::vector<OptionOrder> OrderManagementSystem::getActiveOrders() const {
-    std::lock_guard<std::mutex> lock(ordersMutex_);
     std::vector<OptionOrder> activeOrders;
-    for (const auto& pair : orders_) {
-        if (pair.second.isActive) {
-            activeOrders.push_back(pair.second);
-        }
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->orders.forEach([&](const OrderRecord& order) {
+            if (order.isActive) {
+                activeOrders.push_back(makeOptionOrder(order));
+            }
+        });
+    }
+    return activeOrders;
+}
+
+std::vector<OrderRecord> OrderManagementSystem::getActiveOrderRecords() const {
+    std::vector<OrderRecord> activeOrders;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->orders.forEach([&](const OrderRecord& order) {
+            if (order.isActive) {
+                activeOrders.push_back(order);
+            }
+        });
     }
     return activeOrders;
 }
 
 OptionOrder OrderManagementSystem::getOrderStatus(const std::string& orderId) const {
-    std::lock_guard<std::mutex> lock(ordersMutex_);
-    auto it = orders_.find(orderId);
-    if (it != orders_.end()) {
-        return it->second;
+    OrderHandle handle;
+    OrderRecord order;
+    if (!parseOrderId(orderId, handle)) {
+        return OptionOrder{};
+    }
+    if (findOrder(handle, order)) {
+        return makeOptionOrder(order);
     }
     return OptionOrder{};
 }
 
+OrderHistoryPage OrderManagementSystem::getOrderHistory(const OrderHistoryQuery& query) const {
+    auto historyLess = [](const OrderRecord& a, const OrderRecord& b) {
+        return OrderHistoryCursor{a.submitTimeNs, a.handle} < OrderHistoryCursor{b.submitTimeNs, b.handle};
+    };
+
+    // Live orders: an underlying filter narrows the scan to its one shard
+    std::vector<OrderRecord> live;
+    auto collect = [&](const Shard& shard) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.orders.forEach([&](const OrderRecord& order) {
+            if (query.matches(order)) live.push_back(order);
+        });
+    };
+    if (!query.underlying.empty()) {
+        if (query.underlying.size() < sizeof(InstrumentKey::underlying)) {
+            collect(shardFor(query.underlying.c_str()));
+        }
+    } else {
+        for (const auto& shard : shards_) {
+            collect(*shard);
+        }
+    }
+    std::sort(live.begin(), live.end(), historyLess);
+
+    OrderHistoryPage archived;
+    if (archive_) {
+        archived = archive_->query(query);
+    }
+
+    // An order being archived can briefly be in both; keep one copy
+    OrderHistoryPage page;
+    page.orders.reserve(std::min(live.size() + archived.orders.size(), query.pageSize + 1));
+    auto a = live.begin();
+    auto b = archived.orders.begin();
+    while (page.orders.size() <= query.pageSize && (a != live.end() || b != archived.orders.end())) {
+        const OrderRecord* next;
+        if (b == archived.orders.end() || (a != live.end() && !historyLess(*b, *a))) {
+            next = &*a++;
+        } else {
+            next = &*b++;
+        }
+        if (page.orders.empty() || page.orders.back().handle != next->handle) {
+            page.orders.push_back(*next);
+        }
+    }
+
+    page.hasMore = archived.hasMore;
+    if (page.orders.size() > query.pageSize) {
+        page.orders.resize(query.pageSize);
+        page.hasMore = true;
+    }
+    return page;
+}
+
 std::vector<OptionPosition> OrderManagementSystem::getPositions() const {
-    std::lock_guard<std::mutex> lock(positionsMutex_);
+    return getPositionSnapshot().positions;
+}
+
+std::vector<OptionPosition> OrderManagementSystem::getPositionsForUnderlying(const std::string& underlying) const {
+    InstrumentKey key{};
+    try {
+        key = makeInstrumentKey(underlying, "CALL", 0.0, "");
+    } catch (const std::invalid_argument&) {
+        return {};  // Cannot match any stored instrument
+    }
+
+    Shard& shard = shardFor(key.underlying);
+    std::lock_guard<std::mutex> lock(shard.mutex);
     std::vector<OptionPosition> result;
-    for (const auto& pair : positions_) {
-        result.push_back(pair.second);
+    for (const auto& pair : shard.positions) {
+        if (std::strncmp(pair.first.underlying, key.underlying, sizeof(key.underlying)) == 0) {
+            result.push_back(pair.second);
+        }
     }
     return result;
 }
 
 OptionPosition OrderManagementSystem::getPosition(const PositionKey& key) const {
-    std::lock_guard<std::mutex> lock(positionsMutex_);
-    auto it = positions_.find(key);
-    if (it != positions_.end()) {
+    InstrumentKey instrument;
+    try {
+        instrument = makeInstrumentKey(key.underlying, key.optionType, key.strike, key.expiry);
+    } catch (const std::invalid_argument&) {
+        return OptionPosition{};  // Cannot match any stored instrument
+    }
+
+    Shard& shard = shardFor(instrument.underlying);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.positions.find(instrument);
+    if (it != shard.positions.end()) {
         return it->second;
     }
     return OptionPosition{};
 }
 
-void OrderManagementSystem::onOrderFilled(const std::string& orderId, double fillPrice) {
-    std::lock_guard<std::mutex> orderLock(ordersMutex_);
-    auto orderIt = orders_.find(orderId);
-    if (orderIt == orders_.end()) return;
+PositionSnapshot OrderManagementSystem::getPositionSnapshot() const {
+    PositionSnapshot snapshot;
+    auto locks = lockAllShards();
+    snapshot.takenAt = std::chrono::system_clock::now();
 
-    OptionOrder& order = orderIt->second;
-    order.status = OptionOrder::Status::FILLED;
-    order.isActive = false;
-    order.fillPrice = fillPrice;
-    order.fillTime = std::chrono::system_clock::now();
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        count += shard->positions.size();
+    }
+    snapshot.positions.reserve(count);
+    snapshot.instruments.reserve(count);
 
-    updatePosition(order, fillPrice);
+    for (const auto& shard : shards_) {
+        for (const auto& pair : shard->positions) {
+            snapshot.instruments.push_back(pair.first);
+            snapshot.positions.push_back(pair.second);
+        }
+    }
+    return snapshot;
 }
 
-void OrderManagementSystem::onOrderRejected(const std::string& orderId, const std::string& reason) {
-    std::lock_guard<std::mutex> lock(ordersMutex_);
-    auto it = orders_.find(orderId);
-    if (it != orders_.end()) {
-        it->second.isActive = false;
-        it->second.status = OptionOrder::Status::REJECTED;
+void OrderManagementSystem::onOrderFilled(OrderHandle handle, uint32_t revision, double fillPrice) {
+    Shard* shard = shardFor(handle);
+    if (!shard) return;
+
+    // Order and position live in the same shard: one lock covers the fill
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    OrderRecord* order = shard->orders.find(handle);
+    // Unknown, or cancelled, expired or replaced while in flight
+    if (!order || !order->isActive || order->revision != revision) return;
+
+    cancelExpiry(*shard, *order);
+    order->status = OptionOrder::Status::FILLED;
+    order->isActive = false;
+    order->fillPrice = fillPrice;
+    order->fillTimeNs = nowNanos();
+    order->lastUpdateNs = order->fillTimeNs;
+
+    updatePosition(*shard, *order);
+    journal(OrderEvent::Type::FILLED, *order);
+    queueForArchive(*shard, *order);
+}
+
+void OrderManagementSystem::onOrderRejected(OrderHandle handle, uint32_t revision, const char* reason) {
+    if (Shard* shard = shardFor(handle)) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        OrderRecord* order = shard->orders.find(handle);
+        if (order && order->isActive && order->revision == revision) {
+            order->isActive = false;
+            order->status = OptionOrder::Status::REJECTED;
+            order->lastUpdateNs = nowNanos();
+            cancelExpiry(*shard, *order);
+            journal(OrderEvent::Type::REJECTED, *order);
+            queueForArchive(*shard, *order);
+        }
+    }
+
+    char orderId[ORDER_ID_LENGTH + 1];
+    formatOrderId(handle, orderId);
+    LOG_WARN("Order {} rejected: {}", orderId, reason);
+}
+
+void OrderManagementSystem::onOrderExpired(OrderHandle handle, uint32_t revision, const char* reason) {
+    Shard* shard = shardFor(handle);
+    if (!shard) return;
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        OrderRecord* order = shard->orders.find(handle);
+        if (!order || !order->isActive || order->revision != revision) return;
+
+        order->isActive = false;
+        order->status = OptionOrder::Status::CANCELLED;
+        order->lastUpdateNs = nowNanos();
+        cancelExpiry(*shard, *order);
+        journal(OrderEvent::Type::EXPIRED, *order);
+        queueForArchive(*shard, *order);
     }
-    std::cerr << "Order " << orderId << " rejected: " << reason << std::endl;
+
+    char orderId[ORDER_ID_LENGTH + 1];
+    formatOrderId(handle, orderId);
+    LOG_INFO("Order {} expired: {}", orderId, reason);
 }
 
-void OrderManagementSystem::updatePosition(const OptionOrder& order, double fillPrice) {
-    PositionKey key{order.underlying, order.optionType, order.strike, order.expiry};
-    
-    std::lock_guard<std::mutex> lock(positionsMutex_);
-    auto& position = positions_[key];
-    
-    // Initialize position if it doesn't exist
+void OrderManagementSystem::updatePosition(Shard& shard, const OrderRecord& order) {
+    auto& position = shard.positions[order.instrument];
+
+    // Initialize position if it doesn't exist; timed from the fill, so a
+    // replayed fill opens the same position
     if (position.symbol.empty()) {
-        position.symbol = order.underlying;
-        position.strike = order.strike;
-        position.isCall = (order.optionType == "CALL");
-        // Calculate time to expiry based on expiry date
-        // This needs proper date calculation
-        position.timeToExpiry = 1.0; // Placeholder
+        position.symbol = order.instrument.underlying;
+        position.strike = order.instrument.strike;
+        position.isCall = order.instrument.isCall;
+        position.timeToExpiry = yearsToExpiry(order.instrument.expiry, order.fillTimeNs);
     }
 
     // Update quantity based on order type
-    if (order.type == OptionOrder::Type::BUY_TO_OPEN ||
-        order.type == OptionOrder::Type::BUY_TO_CLOSE) {
-        position.quantity += order.quantity;
-    } else {
-        position.quantity -= order.quantity;
+    double change = signedQuantity(order);
+    position.quantity += change;
+    if (riskManager_) {
+        riskManager_->onFill(order.instrument, change);
     }
 
     // Remove position if quantity becomes zero
     if (position.quantity == 0) {
-        positions_.erase(key);
+        shard.positions.erase(order.instrument);
     }
 }
 
-std::string OrderManagementSystem::generateOrderId() {
-    std::stringstream ss;
-    ss << "ORD-" << std::setfill('0') << std::setw(8) 
-       << ++orderCounter_;
-    return ss.str();
-}
-
-void OrderManagementSystem::validateOrder(const OptionOrder& order) const {
-    if (order.underlying.empty()) {
+void OrderManagementSystem::validateOrder(const OrderRecord& order) const {
+    if (order.instrument.underlying[0] == '\0') {
         throw std::invalid_argument("Missing underlying symbol");
     }
     if (order.quantity == 0) {
@@ -200,15 +652,402 @@ void OrderManagementSystem::validateOrder(const OptionOrder& order) const {
     if (order.orderType == OptionOrder::OrderType::STOP && order.stopPrice <= 0) {
         throw std::invalid_argument("Invalid stop price");
     }
+    if (order.timeInForce == OptionOrder::TimeInForce::GTD && order.expireTimeNs <= nowNanos()) {
+        throw std::invalid_argument("GTD expire time must be in the future");
+    }
+}
+
+void OrderManagementSystem::checkOrderRisk(const OrderRecord& order) const {
+    if (riskManager_ && !riskManager_->checkOrderRisk(order.instrument, signedQuantity(order))) {
+        throw std::runtime_error("Order rejected: it would breach the portfolio risk limits");
+    }
+}
+
+void OrderManagementSystem::setRiskManager(RiskManagement* riskManager) {
+    if (isRunning_) {
+        throw std::runtime_error("Risk manager must be set before the OMS starts");
+    }
+    riskManager_ = riskManager;
+    syncRiskPositions();
+}
+
+void OrderManagementSystem::addOrderEventListener(OrderEventListener listener) {
+    if (isRunning_) {
+        throw std::runtime_error("Order event listeners must be added before the OMS starts");
+    }
+    orderEventListeners_.push_back(std::move(listener));
+}
+
+void OrderManagementSystem::syncRiskPositions() {
+    if (!riskManager_) return;
+
+    // Positions restored from a snapshot never went through updatePosition,
+    // so the risk manager is seeded from the full book instead
+    auto locks = lockAllShards();
+    std::vector<PositionRecord> positions;
+    for (const auto& shard : shards_) {
+        for (const auto& pair : shard->positions) {
+            positions.push_back(PositionRecord{pair.first, pair.second.quantity});
+        }
+    }
+    riskManager_->loadPositions(positions);
 }
 
 double OrderManagementSystem::getTotalPositionValue() const {
-    std::lock_guard<std::mutex> lock(positionsMutex_);
+    auto locks = lockAllShards();
     double total = 0.0;
-    for (const auto& pair : positions_) {
-        // This is a simplified calculation
-        // In reality, you'd need current market prices
-        total += pair.second.quantity * pair.second.strike;
+    for (const auto& shard : shards_) {
+        for (const auto& pair : shard->positions) {
+            // This is a simplified calculation
+            // In reality, you'd need current market prices
+            total += pair.second.quantity * pair.second.strike;
+        }
     }
     return total;
-}
\ No newline at end of file
+}
+
+void OrderManagementSystem::setSessionClose(std::chrono::minutes newYorkTimeOfDay) {
+    if (newYorkTimeOfDay < std::chrono::minutes(0) || newYorkTimeOfDay >= std::chrono::hours(24)) {
+        throw std::invalid_argument("Session close must be within a day");
+    }
+    sessionCloseNs_ = std::chrono::nanoseconds(newYorkTimeOfDay).count();
+}
+
+size_t OrderManagementSystem::getScheduledExpiryCount() const {
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        count += shard->expiryWheel.size();
+    }
+    return count;
+}
+
+int64_t OrderManagementSystem::nextSessionClose(int64_t fromNs) const {
+    // The close on the New York date of fromNs, else the next day's; each
+    // day is converted on its own, so the close stays on New York time
+    // across a daylight saving change
+    int64_t closeOfDay = sessionCloseNs_.load(std::memory_order_relaxed);
+    int64_t day = dayOfNanos(fromNs + newYorkUtcOffsetNs(fromNs));
+    int64_t close = newYorkToUtc(day * NANOS_PER_DAY + closeOfDay);
+    if (close <= fromNs) {
+        close = newYorkToUtc((day + 1) * NANOS_PER_DAY + closeOfDay);
+    }
+    return close;
+}
+
+int64_t OrderManagementSystem::computeExpiry(const OrderRecord& order) const {
+    int64_t deadline = NO_EXPIRY;
+
+    switch (order.timeInForce) {
+        case OptionOrder::TimeInForce::DAY:
+            deadline = nextSessionClose(order.submitTimeNs);
+            break;
+        case OptionOrder::TimeInForce::GTD:
+            deadline = order.expireTimeNs;
+            break;
+        case OptionOrder::TimeInForce::GTC:
+            break;
+        case OptionOrder::TimeInForce::IOC:
+            // IOC orders are expired by the execution engine after one attempt
+            return deadline;
+    }
+
+    // Auto-cancel at the session close of the option's expiration date
+    if (order.instrument.expiry[0] != '\0') {
+        int64_t expiryDays;
+        if (!parseIsoDate(order.instrument.expiry, expiryDays)) {
+            throw std::invalid_argument("Invalid expiry date: " + std::string(order.instrument.expiry));
+        }
+        int64_t expiryClose = newYorkToUtc(expiryDays * NANOS_PER_DAY + sessionCloseNs_.load(std::memory_order_relaxed));
+        deadline = std::min(deadline, expiryClose);
+    }
+
+    return deadline;
+}
+
+void OrderManagementSystem::scheduleExpiry(Shard& shard, OrderRecord& order, int64_t deadlineNs) {
+    if (deadlineNs == NO_EXPIRY) return;
+    order.expiryTimer = shard.expiryWheel.schedule(toExpiryTick(deadlineNs), order.handle);
+}
+
+void OrderManagementSystem::cancelExpiry(Shard& shard, OrderRecord& order) {
+    if (order.expiryTimer != 0) {
+        shard.expiryWheel.cancel(order.expiryTimer);
+        order.expiryTimer = 0;
+    }
+}
+
+void OrderManagementSystem::expireOrders(std::chrono::system_clock::time_point now) {
+    int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    uint64_t nowTick = toExpiryTick(nowNs);
+
+    std::vector<OrderHandle> expired;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->expiryWheel.advance(nowTick, [&](OrderHandle handle) {
+            OrderRecord* order = shard->orders.find(handle);
+            if (!order || !order->isActive) return;
+
+            order->isActive = false;
+            order->status = OptionOrder::Status::CANCELLED;
+            order->lastUpdateNs = nowNs;
+            order->expiryTimer = 0;
+            journal(OrderEvent::Type::EXPIRED, *order);
+            queueForArchive(*shard, *order);
+            expired.push_back(handle);
+        });
+    }
+
+    if (expired.empty()) return;
+
+    // Expiry is a cancel as far as the engine is concerned
+    if (executionEngine_) {
+        for (OrderHandle handle : expired) {
+            executionEngine_->cancelOrder(handle);
+        }
+    }
+    LOG_INFO("Expired {} orders (time in force)", expired.size());
+}
+
+void OrderManagementSystem::expiryLoop() {
+    while (isRunning_) {
+        expireOrders(std::chrono::system_clock::now());
+        std::this_thread::sleep_for(EXPIRY_POLL_INTERVAL);
+    }
+}
+
+RecoveryStats OrderManagementSystem::enablePersistence(const std::string& directory,
+                                                       std::chrono::seconds snapshotInterval) {
+    if (isRunning_) {
+        throw std::runtime_error("Persistence must be enabled before the OMS starts");
+    }
+    if (wal_) {
+        throw std::runtime_error("Persistence is already enabled");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    RecoveryStats stats{};
+
+    // Creates the directory, so it comes before the snapshot lookup
+    WriteAheadLog::Options walOptions;
+    walOptions.lanes = shards_.size();
+    std::unique_ptr<WriteAheadLog> wal(new WriteAheadLog(directory, walOptions));
+    std::unique_ptr<OrderArchive> archive(new OrderArchive(directory + "/archive"));
+
+    {
+        MappedSnapshot snapshot(directory);
+        if (snapshot.shardCount() != 0 && snapshot.shardCount() != shards_.size()) {
+            throw std::runtime_error("Snapshot was written with " + std::to_string(snapshot.shardCount()) +
+                                     " shards; the OMS has " + std::to_string(shards_.size()));
+        }
+        for (size_t i = 0; i < snapshot.orderCount(); ++i) {
+            const OrderRecord& record = snapshot.orders()[i];
+            recoveredShard(record).orders.restore(record);
+        }
+        const int64_t now = nowNanos();
+        for (size_t i = 0; i < snapshot.positionCount(); ++i) {
+            const PositionRecord& record = snapshot.positions()[i];
+            const InstrumentKey& key = record.instrument;
+            shardFor(key.underlying).positions[key] = OptionPosition(
+                key.underlying, key.strike, record.quantity, key.isCall, yearsToExpiry(key.expiry, now));
+        }
+        for (uint32_t i = 0; i < snapshot.shardCount(); ++i) {
+            shards_[i]->orders.raiseGenerationHighWater(static_cast<uint32_t>(snapshot.generations()[i]));
+        }
+        stats.snapshotSequence = snapshot.sequence();
+        stats.snapshotOrders = snapshot.orderCount();
+    }
+
+    stats.eventsReplayed = wal->recover(stats.snapshotSequence, [this](const OrderEvent& event) {
+        applyEvent(event);
+    });
+
+    // Timer handles are not persisted: re-arm expiry for every live order.
+    // Deadlines that passed while the OMS was down fire on the first tick.
+    // Terminal orders not yet archived queue up again in completion order.
+    for (auto& shard : shards_) {
+        shard->orders.rebuildFreeList();
+        shard->terminalOrders.clear();
+        shard->orders.forEach([&](OrderRecord& order) {
+            order.expiryTimer = 0;
+            if (order.isActive) {
+                scheduleExpiry(*shard, order, computeExpiry(order));
+            } else {
+                shard->terminalOrders.emplace_back(order.lastUpdateNs, order.handle);
+            }
+        });
+        std::sort(shard->terminalOrders.begin(), shard->terminalOrders.end());
+        stats.ordersRecovered += shard->orders.size();
+    }
+
+    wal_ = std::move(wal);
+    archive_ = std::move(archive);
+    dataDirectory_ = directory;
+    snapshotInterval_ = snapshotInterval;
+    syncRiskPositions();
+
+    stats.elapsedMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << "OMS recovered " << stats.ordersRecovered << " orders from " << directory
+              << " (snapshot at " << stats.snapshotSequence << ", " << stats.eventsReplayed
+              << " events replayed) in " << stats.elapsedMillis << " ms" << std::endl;
+    return stats;
+}
+
+void OrderManagementSystem::applyEvent(const OrderEvent& event) {
+    Shard& shard = recoveredShard(event.order);
+
+    if (event.type == OrderEvent::Type::ARCHIVED) {
+        shard.orders.restore(event.order);
+        shard.orders.erase(event.order.handle);
+        return;
+    }
+
+    // The same shard onOrderFilled updates
+    OrderRecord& order = shard.orders.restore(event.order);
+    if (event.type == OrderEvent::Type::FILLED) {
+        updatePosition(shard, order);
+    }
+}
+
+OrderManagementSystem::Shard& OrderManagementSystem::recoveredShard(const OrderRecord& order) const {
+    // An order's handle names the shard its underlying hashed to when it
+    // was submitted. The WAL does not record the shard count, so a journal
+    // from a differently sharded OMS shows up as a handle in the wrong shard.
+    Shard* shard = shardFor(order.handle);
+    if (!shard || shard != &shardFor(order.instrument.underlying)) {
+        throw std::runtime_error("Order " + formatOrderId(order.handle) +
+                                 " was persisted by an OMS with a different shard count; this one has " +
+                                 std::to_string(shards_.size()));
+    }
+    return *shard;
+}
+
+uint64_t OrderManagementSystem::takeSnapshot() {
+    if (!wal_) {
+        throw std::runtime_error("Persistence is not enabled");
+    }
+
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);
+    OrderSnapshot snapshot;
+    snapshot.shardCount = static_cast<uint32_t>(shards_.size());
+    {
+        // Every append happens under a shard lock, so with all of them held
+        // the log's last sequence is exactly the state being copied
+        auto locks = lockAllShards();
+        snapshot.sequence = wal_->lastSequence();
+
+        size_t orderCount = 0;
+        size_t positionCount = 0;
+        for (const auto& shard : shards_) {
+            orderCount += shard->orders.size();
+            positionCount += shard->positions.size();
+        }
+        snapshot.orders.reserve(orderCount);
+        snapshot.positions.reserve(positionCount);
+        snapshot.generations.reserve(shards_.size());
+
+        for (const auto& shard : shards_) {
+            const OrderStore& orders = shard->orders;
+            orders.forEach([&](const OrderRecord& order) {
+                snapshot.orders.push_back(order);
+            });
+            for (const auto& pair : shard->positions) {
+                snapshot.positions.push_back(PositionRecord{pair.first, pair.second.quantity});
+            }
+            snapshot.generations.push_back(orders.generationHighWater());
+        }
+    }
+    snapshot.takenAtNs = nowNanos();
+
+    // Serialisation and fsync happen without any shard lock held
+    writeSnapshot(dataDirectory_, snapshot);
+    wal_->truncateBefore(snapshot.sequence);
+    return snapshot.sequence;
+}
+
+WriteAheadLog::Stats OrderManagementSystem::getJournalStats() const {
+    return wal_ ? wal_->getStats() : WriteAheadLog::Stats{};
+}
+
+void OrderManagementSystem::snapshotLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(persistenceWaitMutex_);
+            if (persistenceCv_.wait_for(lock, snapshotInterval_, [this] { return !isRunning_; })) {
+                break;
+            }
+        }
+
+        try {
+            uint64_t sequence = takeSnapshot();
+            LOG_INFO("OMS snapshot written at sequence {}", sequence);
+        } catch (const std::exception& e) {
+            LOG_ERROR("OMS snapshot failed: {}", e.what());
+        }
+    }
+}
+
+size_t OrderManagementSystem::archiveTerminalOrders(int64_t terminalBeforeNs) {
+    size_t archived = 0;
+    std::vector<OrderRecord> batch;
+    batch.reserve(ARCHIVE_BATCH);
+
+    for (auto& shard : shards_) {
+        // Only the head of the terminal queue is visited, never the slab.
+        // Entries stay queued until the archive has them, so a failed
+        // append is retried on the next pass.
+        batch.clear();
+        size_t taken = 0;
+        {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            for (const auto& entry : shard->terminalOrders) {
+                if (taken == ARCHIVE_BATCH || entry.first > terminalBeforeNs) break;
+                ++taken;
+                const OrderRecord* order = shard->orders.find(entry.second);
+                if (order && !order->isActive) {
+                    batch.push_back(*order);
+                }
+            }
+        }
+        if (taken == 0) continue;
+
+        // Archive first (synced), then drop from the slab; a crash in between
+        // only means the orders are archived again, which the archive ignores
+        if (!batch.empty()) {
+            archive_->append(batch);
+        }
+
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        // Only this thread pops, so the head is still the entries taken
+        shard->terminalOrders.erase(shard->terminalOrders.begin(), shard->terminalOrders.begin() + taken);
+        for (const auto& record : batch) {
+            // Terminal orders never change, so the copy is still current
+            const OrderRecord* order = shard->orders.find(record.handle);
+            if (order && !order->isActive) {
+                journal(OrderEvent::Type::ARCHIVED, *order);
+                shard->orders.erase(record.handle);
+                ++archived;
+            }
+        }
+    }
+    return archived;
+}
+
+void OrderManagementSystem::archiveLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(persistenceWaitMutex_);
+            if (persistenceCv_.wait_for(lock, ARCHIVE_INTERVAL, [this] { return !isRunning_; })) {
+                break;
+            }
+        }
+
+        try {
+            int64_t cutoff = nowNanos() - std::chrono::nanoseconds(ARCHIVE_DELAY).count();
+            archiveTerminalOrders(cutoff);
+        } catch (const std::exception& e) {
+            LOG_ERROR("OMS archiving failed: {}", e.what());
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include "OrderSnapshot.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+    const std::string SNAPSHOT_PREFIX = "snapshot-";
+    const std::string SNAPSHOT_SUFFIX = ".snap";
+    constexpr char SNAPSHOT_MAGIC[8] = {'O', 'M', 'S', 'S', 'N', 'A', 'P', '1'};
+    constexpr uint32_t SNAPSHOT_VERSION = 2;
+
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t shardCount;
+        uint32_t orderRecordSize;      // Guards against layout changes
+        uint32_t positionRecordSize;
+        uint64_t sequence;
+        int64_t takenAtNs;
+        uint64_t orderCount;
+        uint64_t positionCount;
+        uint64_t checksum;             // Over everything after the header
+    };
+
+    // FNV-style mix a word at a time; record sizes are multiples of 8
+    uint64_t checksumWords(const void* data, size_t size, uint64_t h) {
+        const char* bytes = static_cast<const char*>(data);
+        for (size_t i = 0; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i, sizeof(word));
+            h = (h ^ word) * 1099511628211ull;
+        }
+        return h;
+    }
+
+    constexpr uint64_t CHECKSUM_SEED = 14695981039346656037ull;
+
+    std::string snapshotName(uint64_t sequence) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "snapshot-%020" PRIu64 ".snap", sequence);
+        return name;
+    }
+}
+
+static_assert(sizeof(OrderRecord) % 8 == 0 && sizeof(PositionRecord) % 8 == 0,
+              "Snapshot checksum works on whole words");
+
+void writeSnapshot(const std::string& directory, const OrderSnapshot& snapshot, size_t keep) {
+    size_t orderBytes = snapshot.orders.size() * sizeof(OrderRecord);
+    size_t positionBytes = snapshot.positions.size() * sizeof(PositionRecord);
+    size_t generationBytes = snapshot.generations.size() * sizeof(uint64_t);
+    if (snapshot.generations.size() != snapshot.shardCount) {
+        throw std::invalid_argument("Snapshot needs one generation mark per shard");
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.shardCount = snapshot.shardCount;
+    header.orderRecordSize = sizeof(OrderRecord);
+    header.positionRecordSize = sizeof(PositionRecord);
+    header.sequence = snapshot.sequence;
+    header.takenAtNs = snapshot.takenAtNs;
+    header.orderCount = snapshot.orders.size();
+    header.positionCount = snapshot.positions.size();
+    header.checksum = checksumWords(snapshot.generations.data(), generationBytes,
+                                    checksumWords(snapshot.positions.data(), positionBytes,
+                                    checksumWords(snapshot.orders.data(), orderBytes, CHECKSUM_SEED)));
+
+    writeFileAtomic(directory, snapshotName(snapshot.sequence), {
+        {&header, sizeof(header)},
+        {snapshot.orders.data(), orderBytes},
+        {snapshot.positions.data(), positionBytes},
+        {snapshot.generations.data(), generationBytes}
+    });
+
+    std::vector<std::string> names = listFiles(directory, SNAPSHOT_PREFIX, SNAPSHOT_SUFFIX);
+    for (size_t i = 0; i + keep < names.size(); ++i) {
+        ::unlink((directory + "/" + names[i]).c_str());
+    }
+}
+
+MappedSnapshot::MappedSnapshot(const std::string& directory) {
+    std::vector<std::string> names = listFiles(directory, SNAPSHOT_PREFIX, SNAPSHOT_SUFFIX);
+    for (auto it = names.rbegin(); it != names.rend(); ++it) {
+        std::string path = directory + "/" + *it;
+        if (load(path)) return;
+        std::cerr << "Skipping invalid snapshot " << path << std::endl;
+    }
+}
+
+bool MappedSnapshot::load(const std::string& path) {
+    MappedFile file(path);
+    if (file.size() < sizeof(SnapshotHeader)) return false;
+
+    SnapshotHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SNAPSHOT_VERSION ||
+        header.orderRecordSize != sizeof(OrderRecord) ||
+        header.positionRecordSize != sizeof(PositionRecord)) {
+        return false;
+    }
+
+    size_t orderBytes = header.orderCount * sizeof(OrderRecord);
+    size_t positionBytes = header.positionCount * sizeof(PositionRecord);
+    size_t generationBytes = header.shardCount * sizeof(uint64_t);
+    if (file.size() != sizeof(SnapshotHeader) + orderBytes + positionBytes + generationBytes) return false;
+
+    const char* body = file.data() + sizeof(SnapshotHeader);
+    uint64_t checksum = checksumWords(body + orderBytes + positionBytes, generationBytes,
+                                      checksumWords(body + orderBytes, positionBytes,
+                                      checksumWords(body, orderBytes, CHECKSUM_SEED)));
+    if (checksum != header.checksum) return false;
+
+    file_ = std::move(file);
+    sequence_ = header.sequence;
+    shardCount_ = header.shardCount;
+    orders_ = reinterpret_cast<const OrderRecord*>(file_.data() + sizeof(SnapshotHeader));
+    orderCount_ = header.orderCount;
+    positions_ = reinterpret_cast<const PositionRecord*>(file_.data() + sizeof(SnapshotHeader) + orderBytes);
+    positionCount_ = header.positionCount;
+    generations_ = reinterpret_cast<const uint64_t*>(body + orderBytes + positionBytes);
+    return true;
+}
@@ -0,0 +1,238 @@
+#include "OrderStore.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+    template <size_t N>
+    void copyFixed(char (&dst)[N], const std::string& src, const char* field) {
+        if (src.size() >= N) {
+            throw std::invalid_argument(std::string(field) + " too long: " + src);
+        }
+        std::memset(dst, 0, N);
+        std::memcpy(dst, src.data(), src.size());
+    }
+
+    template <size_t N>
+    std::string fromFixed(const char (&src)[N]) {
+        return std::string(src, strnlen(src, N));
+    }
+
+    int64_t toNanos(std::chrono::system_clock::time_point tp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(tp.time_since_epoch()).count();
+    }
+
+    std::chrono::system_clock::time_point fromNanos(int64_t nanos) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanos)));
+    }
+
+    constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+}
+
+InstrumentKey makeInstrumentKey(const std::string& underlying, const std::string& optionType,
+                                double strike, const std::string& expiry) {
+    InstrumentKey key{};
+    copyFixed(key.underlying, underlying, "Underlying symbol");
+    copyFixed(key.expiry, expiry, "Expiry");
+    key.isCall = (optionType == "CALL");
+    key.strike = strike;
+    return key;
+}
+
+OrderRecord makeOrderRecord(const OptionOrder& order) {
+    OrderRecord record{};
+    record.instrument = makeInstrumentKey(order.underlying, order.optionType, order.strike, order.expiry);
+    record.type = order.type;
+    record.orderType = order.orderType;
+    record.status = order.status;
+    record.timeInForce = order.timeInForce;
+    record.quantity = order.quantity;
+    record.revision = order.revision;
+    record.limitPrice = order.limitPrice;
+    record.stopPrice = order.stopPrice;
+    record.fillPrice = order.fillPrice;
+    record.submitTimeNs = toNanos(order.submitTime);
+    record.fillTimeNs = toNanos(order.fillTime);
+    record.lastUpdateNs = record.submitTimeNs;
+    record.expireTimeNs = toNanos(order.expireTime);
+    record.expiryTimer = order.expiryTimer;
+    record.isActive = order.isActive;
+    return record;
+}
+
+OptionOrder makeOptionOrder(const OrderRecord& record) {
+    OptionOrder order{};
+    order.underlying = fromFixed(record.instrument.underlying);
+    order.optionType = record.instrument.isCall ? "CALL" : "PUT";
+    order.strike = record.instrument.strike;
+    order.expiry = fromFixed(record.instrument.expiry);
+    order.type = record.type;
+    order.orderType = record.orderType;
+    order.limitPrice = record.limitPrice;
+    order.stopPrice = record.stopPrice;
+    order.quantity = record.quantity;
+    order.orderId = formatOrderId(record.handle);
+    order.status = record.status;
+    order.timeInForce = record.timeInForce;
+    order.expireTime = fromNanos(record.expireTimeNs);
+    order.expiryTimer = record.expiryTimer;
+    order.revision = record.revision;
+    order.isActive = record.isActive;
+    order.submitTime = fromNanos(record.submitTimeNs);
+    order.fillTime = fromNanos(record.fillTimeNs);
+    order.fillPrice = record.fillPrice;
+    return order;
+}
+
+void formatOrderId(OrderHandle handle, char (&buffer)[ORDER_ID_LENGTH + 1]) {
+    std::memcpy(buffer, "ORD-", 4);
+    for (int i = 0; i < 16; ++i) {
+        buffer[4 + i] = HEX_DIGITS[(handle >> (60 - 4 * i)) & 0xF];
+    }
+    buffer[ORDER_ID_LENGTH] = '\0';
+}
+
+std::string formatOrderId(OrderHandle handle) {
+    char buffer[ORDER_ID_LENGTH + 1];
+    formatOrderId(handle, buffer);
+    return std::string(buffer, ORDER_ID_LENGTH);
+}
+
+bool parseOrderId(const std::string& orderId, OrderHandle& handle) {
+    if (orderId.size() != ORDER_ID_LENGTH || orderId.compare(0, 4, "ORD-") != 0) {
+        return false;
+    }
+
+    OrderHandle value = 0;
+    for (size_t i = 4; i < ORDER_ID_LENGTH; ++i) {
+        char c = orderId[i];
+        uint64_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else {
+            return false;
+        }
+        value = (value << 4) | digit;
+    }
+
+    handle = value;
+    return value != INVALID_ORDER_HANDLE;
+}
+
+OrderStore::OrderStore(size_t initialCapacity, uint32_t shard)
+    : shard_(shard) {
+    if (shard >= MAX_SHARDS) {
+        throw std::invalid_argument("Order store shard out of range");
+    }
+    size_t chunks = (initialCapacity + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    for (size_t i = 0; i < std::max<size_t>(chunks, 1); ++i) {
+        addChunk();
+    }
+}
+
+void OrderStore::addChunk() {
+    if ((chunks_.size() + 1) * CHUNK_SIZE > MAX_LOCAL_SLOTS) {
+        throw std::runtime_error("Order store exhausted");
+    }
+
+    std::unique_ptr<Slot[]> chunk(new Slot[CHUNK_SIZE]);
+    uint32_t base = static_cast<uint32_t>(chunks_.size() * CHUNK_SIZE);
+
+    // Thread the new slots onto the free list in ascending order
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+        chunk[i].record = OrderRecord{};
+        chunk[i].generation = 1;
+        chunk[i].live = false;
+        chunk[i].nextFree = (i + 1 < CHUNK_SIZE) ? base + static_cast<uint32_t>(i + 1) : freeHead_;
+    }
+    freeHead_ = base;
+    chunks_.push_back(std::move(chunk));
+}
+
+OrderRecord& OrderStore::insert(const OrderRecord& record) {
+    if (freeHead_ == NO_SLOT) {
+        addChunk();
+    }
+
+    uint32_t index = freeHead_;
+    Slot* slot = slotAt(index);
+    freeHead_ = slot->nextFree;
+
+    slot->record = record;
+    slot->record.handle = (static_cast<uint64_t>(slot->generation) << 32) |
+                          (static_cast<uint64_t>(index) << SHARD_BITS) | shard_;
+    slot->live = true;
+    ++size_;
+    return slot->record;
+}
+
+OrderRecord* OrderStore::find(OrderHandle handle) {
+    if (shardOf(handle) != shard_) return nullptr;
+    Slot* slot = slotAt(localSlotOf(handle));
+    if (!slot || !slot->live || slot->generation != generationOf(handle)) {
+        return nullptr;
+    }
+    return &slot->record;
+}
+
+const OrderRecord* OrderStore::find(OrderHandle handle) const {
+    return const_cast<OrderStore*>(this)->find(handle);
+}
+
+bool OrderStore::erase(OrderHandle handle) {
+    if (shardOf(handle) != shard_) return false;
+    uint32_t index = localSlotOf(handle);
+    Slot* slot = slotAt(index);
+    if (!slot || !slot->live || slot->generation != generationOf(handle)) {
+        return false;
+    }
+
+    slot->live = false;
+    if (++slot->generation == 0) slot->generation = 1;
+    raiseGenerationHighWater(slot->generation);
+    slot->nextFree = freeHead_;
+    freeHead_ = index;
+    --size_;
+    return true;
+}
+
+OrderRecord& OrderStore::restore(const OrderRecord& record) {
+    if (shardOf(record.handle) != shard_ || generationOf(record.handle) == 0) {
+        throw std::invalid_argument("Order handle does not belong to this store");
+    }
+
+    uint32_t index = localSlotOf(record.handle);
+    while (index >= capacity()) {
+        addChunk();
+    }
+
+    Slot* slot = slotAt(index);
+    if (!slot->live) {
+        slot->live = true;
+        ++size_;
+    }
+    slot->generation = generationOf(record.handle);
+    slot->record = record;
+    raiseGenerationHighWater(slot->generation);
+    return slot->record;
+}
+
+void OrderStore::rebuildFreeList() {
+    // Descending walk leaves the free list in ascending order
+    uint32_t fresh = maxGeneration_ + 1 == 0 ? 1 : maxGeneration_ + 1;
+    freeHead_ = NO_SLOT;
+    for (size_t index = capacity(); index-- > 0;) {
+        Slot* slot = slotAt(static_cast<uint32_t>(index));
+        if (!slot->live) {
+            slot->generation = fresh;
+            slot->nextFree = freeHead_;
+            freeHead_ = static_cast<uint32_t>(index);
+        }
+    }
+    raiseGenerationHighWater(fresh);
+}
@@ -0,0 +1,309 @@
+#include "OrderTracer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+std::atomic<uint64_t> OrderTracer::threshold_{0};
+
+namespace {
+    // One span; sequence is its ring position + 1 once written and 0
+    // while a writer is filling it in
+    struct alignas(64) SpanSlot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> handle{0};
+        std::atomic<uint64_t> startTicks{0};
+        std::atomic<uint64_t> endTicks{0};
+        std::atomic<uint32_t> threadId{0};
+        std::atomic<uint8_t> stage{0};
+    };
+
+    struct SpanRing {
+        explicit SpanRing(size_t capacity) : slots(new SpanSlot[capacity]), mask(capacity - 1) {}
+
+        std::unique_ptr<SpanSlot[]> slots;
+        const uint64_t mask;
+        alignas(64) std::atomic<uint64_t> next{0};   // Positions handed out so far
+    };
+
+    // The ring of the current run. Rings are never freed: a writer that
+    // passed sampled() just before stop() may still be filling one in.
+    std::atomic<SpanRing*> activeRing{nullptr};
+
+    uint32_t currentThreadId() {
+        thread_local uint32_t id = static_cast<uint32_t>(::syscall(SYS_gettid));
+        return id;
+    }
+
+    struct Span {
+        OrderHandle handle;
+        uint64_t startTicks;
+        uint64_t endTicks;
+        uint32_t threadId;
+        TraceStage stage;
+    };
+
+    class Tracer {
+    public:
+        void start(const TraceOptions& options) {
+            if (!(options.sampleRate > 0.0 && options.sampleRate <= 1.0)) {
+                throw std::invalid_argument("Trace sample rate must be in (0, 1]");
+            }
+            if (options.capacity < 2 || (options.capacity & (options.capacity - 1)) != 0) {
+                throw std::invalid_argument("Trace capacity must be a power of two");
+            }
+            if (options.flushInterval.count() <= 0) {
+                throw std::invalid_argument("Trace flush interval must be positive");
+            }
+
+            std::lock_guard<std::mutex> lock(runMutex_);
+            if (running_) throw std::runtime_error("Order tracing is already running");
+            int fd = ::open(options.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) {
+                throw std::runtime_error("Failed to open trace file " + options.path + ": " + std::strerror(errno));
+            }
+
+            fd_ = fd;
+            options_ = options;
+            if (ring_) recordedBefore_.fetch_add(ring_->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            rings_.emplace_back(new SpanRing(options.capacity));
+            ring_ = rings_.back().get();
+            cursor_ = 0;
+            pids_.clear();
+            nextPid_ = 1;
+            firstEvent_ = true;
+            baseTicks_ = TscClock::now();
+            nanosPerTick_ = TscClock::nanosPerTick();
+            out_ = "[\n";
+            writeOut();
+
+            activeRing.store(ring_, std::memory_order_release);
+            running_ = true;
+            thread_ = std::thread(&Tracer::run, this);
+        }
+
+        void stop() {
+            {
+                std::lock_guard<std::mutex> lock(runMutex_);
+                if (!running_) return;
+                running_ = false;
+            }
+            cv_.notify_all();
+            thread_.join();
+
+            out_ = "\n]\n";
+            writeOut();
+            ::close(fd_);
+            fd_ = -1;
+        }
+
+        OrderTracer::Stats stats() const {
+            OrderTracer::Stats stats{};
+            SpanRing* ring = activeRing.load(std::memory_order_acquire);
+            stats.spansRecorded = recordedBefore_.load(std::memory_order_relaxed) +
+                                  (ring ? ring->next.load(std::memory_order_relaxed) : 0);
+            stats.spansExported = exported_.load(std::memory_order_relaxed);
+            stats.spansDropped = dropped_.load(std::memory_order_relaxed);
+            stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+    private:
+        void run() {
+            std::unique_lock<std::mutex> lock(runMutex_);
+            while (running_) {
+                cv_.wait_for(lock, options_.flushInterval);
+                lock.unlock();
+                exportSpans();
+                lock.lock();
+            }
+            lock.unlock();
+            exportSpans();
+        }
+
+        // Every span written since the last pass, as one write(). A slot
+        // still being filled in ends the pass; it is picked up next time.
+        void exportSpans() {
+            const uint64_t capacity = ring_->mask + 1;
+            const uint64_t end = ring_->next.load(std::memory_order_acquire);
+            uint64_t exported = 0, dropped = 0;
+            out_.clear();
+
+            while (cursor_ < end) {
+                if (end - cursor_ > capacity) {
+                    dropped += end - capacity - cursor_;   // Lapped by the writers
+                    cursor_ = end - capacity;
+                    continue;
+                }
+                const SpanSlot& slot = ring_->slots[cursor_ & ring_->mask];
+                uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+                if (sequence != cursor_ + 1) {
+                    if (sequence < cursor_ + 1) break;
+                    ++dropped;   // Already overwritten by a later span
+                    ++cursor_;
+                    continue;
+                }
+
+                Span span{slot.handle.load(std::memory_order_relaxed),
+                          slot.startTicks.load(std::memory_order_relaxed),
+                          slot.endTicks.load(std::memory_order_relaxed),
+                          slot.threadId.load(std::memory_order_relaxed),
+                          static_cast<TraceStage>(slot.stage.load(std::memory_order_relaxed))};
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                    ++dropped;
+                } else {
+                    appendSpan(span);
+                    ++exported;
+                }
+                ++cursor_;
+            }
+
+            if (!out_.empty()) writeOut();
+            exported_.fetch_add(exported, std::memory_order_relaxed);
+            dropped_.fetch_add(dropped, std::memory_order_relaxed);
+        }
+
+        // Each order is a trace "process", named by its order ID the first
+        // time one of its spans is exported
+        void appendSpan(const Span& span) {
+            char orderId[ORDER_ID_LENGTH + 1];
+            formatOrderId(span.handle, orderId);
+
+            auto inserted = pids_.emplace(span.handle, nextPid_);
+            uint32_t pid = inserted.first->second;
+            if (inserted.second) {
+                ++nextPid_;
+                appendEvent("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"%s\"}}",
+                            pid, orderId);
+            }
+
+            double startMicros = static_cast<int64_t>(span.startTicks - baseTicks_) * nanosPerTick_ / 1000.0;
+            int64_t durationTicks = static_cast<int64_t>(span.endTicks - span.startTicks);
+            double durationMicros = durationTicks > 0 ? durationTicks * nanosPerTick_ / 1000.0 : 0.0;
+            appendEvent("{\"name\":\"%s\",\"cat\":\"order\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,"
+                        "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"order_id\":\"%s\"}}",
+                        OrderTracer::stageName(span.stage), pid, span.threadId, startMicros, durationMicros,
+                        orderId);
+
+            // Orders seen long ago are unlikely to get more spans; a
+            // returning one just gets a second process
+            if (pids_.size() > MAX_TRACKED_ORDERS) pids_.clear();
+        }
+
+        template <class... Args>
+        void appendEvent(const char* format, Args... args) {
+            char text[320];
+            int length = std::snprintf(text, sizeof(text), format, args...);
+            if (!firstEvent_) out_ += ",\n";
+            firstEvent_ = false;
+            out_.append(text, static_cast<size_t>(std::min<int>(length, sizeof(text) - 1)));
+        }
+
+        void writeOut() {
+            const char* data = out_.data();
+            size_t remaining = out_.size();
+            while (remaining > 0) {
+                ssize_t written = ::write(fd_, data, remaining);
+                if (written < 0) {
+                    if (errno == EINTR) continue;
+                    break;   // The batch is lost; the trace stays readable up to it
+                }
+                data += written;
+                remaining -= static_cast<size_t>(written);
+            }
+            bytesWritten_.fetch_add(out_.size() - remaining, std::memory_order_relaxed);
+        }
+
+        static constexpr size_t MAX_TRACKED_ORDERS = 1 << 16;
+
+        std::mutex runMutex_;
+        std::condition_variable cv_;
+        bool running_{false};
+        std::thread thread_;
+        TraceOptions options_;
+        std::vector<std::unique_ptr<SpanRing>> rings_;
+
+        // Exporter only while running; ring_ stays the last run's after stop()
+        SpanRing* ring_{nullptr};
+        int fd_{-1};
+        uint64_t cursor_{0};
+        uint64_t baseTicks_{0};
+        double nanosPerTick_{1.0};
+        std::unordered_map<OrderHandle, uint32_t> pids_;
+        uint32_t nextPid_{1};
+        bool firstEvent_{true};
+        std::string out_;
+
+        std::atomic<uint64_t> recordedBefore_{0};   // Spans in the rings of earlier runs
+        std::atomic<uint64_t> exported_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint64_t> bytesWritten_{0};
+    };
+
+    // Never destroyed, like the rings
+    Tracer& tracer() {
+        static Tracer* instance = new Tracer();
+        return *instance;
+    }
+}
+
+void OrderTracer::start(const TraceOptions& options) {
+    tracer().start(options);
+    // Every handle's mix() is at most the threshold at rate 1
+    double scaled = options.sampleRate * 18446744073709551616.0;
+    uint64_t threshold = scaled >= 18446744073709551615.0 ? UINT64_MAX : static_cast<uint64_t>(scaled);
+    threshold_.store(threshold > 0 ? threshold : 1, std::memory_order_release);   // Publishes the ring
+}
+
+void OrderTracer::stop() {
+    threshold_.store(0, std::memory_order_relaxed);
+    tracer().stop();
+}
+
+OrderTracer::Stats OrderTracer::stats() {
+    return tracer().stats();
+}
+
+void OrderTracer::span(TraceStage stage, OrderHandle handle, uint64_t startTicks, uint64_t endTicks) {
+    SpanRing* ring = activeRing.load(std::memory_order_acquire);
+    if (!ring) return;
+
+    uint64_t position = ring->next.fetch_add(1, std::memory_order_relaxed);
+    SpanSlot& slot = ring->slots[position & ring->mask];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.handle.store(handle, std::memory_order_relaxed);
+    slot.startTicks.store(startTicks, std::memory_order_relaxed);
+    slot.endTicks.store(endTicks, std::memory_order_relaxed);
+    slot.threadId.store(currentThreadId(), std::memory_order_relaxed);
+    slot.stage.store(static_cast<uint8_t>(stage), std::memory_order_relaxed);
+
+    slot.sequence.store(position + 1, std::memory_order_release);
+}
+
+const char* OrderTracer::stageName(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::GRPC_HANDLER: return "grpc_handler";
+        case TraceStage::VALIDATION: return "validation";
+        case TraceStage::OMS_INSERT: return "oms_insert";
+        case TraceStage::QUEUE_WAIT: return "queue_wait";
+        case TraceStage::EXECUTION: return "execution";
+        case TraceStage::OMS_FILL: return "oms_fill";
+        case TraceStage::RESPONSE: return "response";
+        case TraceStage::COUNT: break;
+    }
+    return "unknown";
+}
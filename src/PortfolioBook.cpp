@@ -0,0 +1,386 @@
+#include "PortfolioBook.hpp"
+#include "BlackScholesBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
+
+PortfolioBook::PortfolioBook(const std::vector<OptionPosition>& positions) {
+    // Symbols are numbered in sorted order so groups come out per underlying
+    std::map<std::string, uint32_t> symbols;
+    for (const auto& position : positions) {
+        symbols.emplace(position.symbol, 0);
+    }
+    underlyings_.reserve(symbols.size());
+    for (auto& symbol : symbols) {
+        symbol.second = static_cast<uint32_t>(underlyings_.size());
+        underlyings_.push_back(symbol.first);
+    }
+
+    struct Entry {
+        uint32_t underlying;
+        double timeToExpiry;
+        size_t position;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i].quantity == 0.0) continue;
+        entries.push_back(Entry{symbols[positions[i].symbol], positions[i].timeToExpiry, i});
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.underlying != b.underlying) return a.underlying < b.underlying;
+        return a.timeToExpiry < b.timeToExpiry;
+    });
+
+    strike_.reserve(entries.size());
+    logStrike_.reserve(entries.size());
+    callSign_.reserve(entries.size());
+    quantity_.reserve(entries.size());
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        if (groups_.empty() || groups_.back().underlying != entry.underlying ||
+            groups_.back().timeToExpiry != entry.timeToExpiry) {
+            groups_.push_back(Group{entry.underlying, entry.timeToExpiry, strike_.size(), strike_.size(), 0.0, 0});
+        }
+        Group& group = groups_.back();
+        const OptionPosition& position = positions[entry.position];
+        ++group.positions;
+
+        if (position.strike <= 0.0) {
+            group.linearQuantity += position.quantity;
+            continue;
+        }
+        strike_.push_back(position.strike);
+        logStrike_.push_back(std::log(position.strike));
+        callSign_.push_back(position.isCall ? 1.0 : -1.0);
+        quantity_.push_back(position.quantity);
+        group.end = strike_.size();
+    }
+    positionCount_ = entries.size();
+
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        for (size_t begin = groups_[g].begin; begin < groups_[g].end; begin += CHUNK_SIZE) {
+            chunks_.push_back(Chunk{static_cast<uint32_t>(g), begin, std::min(begin + CHUNK_SIZE, groups_[g].end)});
+        }
+    }
+}
+
+std::vector<double> PortfolioBook::spotsFor(const std::unordered_map<std::string, double>& underlyingPrices) const {
+    // One string lookup per underlying; zero marks an unpriced one
+    std::vector<double> spots(underlyings_.size(), 0.0);
+    for (size_t u = 0; u < underlyings_.size(); ++u) {
+        auto it = underlyingPrices.find(underlyings_[u]);
+        if (it != underlyingPrices.end() && it->second > 0.0) {
+            spots[u] = it->second;
+        }
+    }
+    return spots;
+}
+
+PortfolioRevaluation PortfolioBook::revalue(const std::unordered_map<std::string, double>& underlyingPrices,
+                                            double riskFreeRate, double volatility, size_t maxThreads) const {
+    std::vector<double> spots = spotsFor(underlyingPrices);
+
+    // Each chunk is written by exactly one task; the breakdowns below are
+    // summed from these in a fixed order so they do not depend on scheduling
+    std::vector<GreekTotals> chunkTotals(chunks_.size());
+
+    auto priceChunks = [&](const tbb::blocked_range<size_t>& range, GreekTotals sum) {
+        for (size_t c = range.begin(); c != range.end(); ++c) {
+            const Chunk& chunk = chunks_[c];
+            const Group& group = groups_[chunk.group];
+            double spot = spots[group.underlying];
+            if (spot <= 0.0) continue;
+
+            BatchMarket market{spot, riskFreeRate, volatility, group.timeToExpiry};
+            BatchContracts contracts{&strike_[chunk.begin], &logStrike_[chunk.begin], &callSign_[chunk.begin],
+                                     &quantity_[chunk.begin], chunk.end - chunk.begin};
+            chunkTotals[c] = BlackScholesBatch::priceAndSum(market, contracts);
+            sum += chunkTotals[c];
+        }
+        return sum;
+    };
+    auto join = [](GreekTotals a, const GreekTotals& b) {
+        a += b;
+        return a;
+    };
+
+    tbb::task_arena arena(maxThreads > 0 ? static_cast<int>(maxThreads) : tbb::task_arena::automatic);
+    GreekTotals total = arena.execute([&] {
+        return tbb::parallel_reduce(tbb::blocked_range<size_t>(0, chunks_.size()), GreekTotals(),
+                                    priceChunks, join);
+    });
+
+    PortfolioRevaluation result;
+    result.byGroup.reserve(groups_.size());
+    std::map<double, RiskBucket> expiries;
+    size_t chunk = 0;
+
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        const Group& group = groups_[g];
+        double spot = spots[group.underlying];
+        if (spot <= 0.0) {
+            result.positionsSkipped += group.positions;
+            while (chunk < chunks_.size() && chunks_[chunk].group == g) ++chunk;
+            continue;
+        }
+
+        RiskBucket bucket{underlyings_[group.underlying], group.timeToExpiry, group.positions, GreekTotals()};
+        for (; chunk < chunks_.size() && chunks_[chunk].group == g; ++chunk) {
+            bucket.totals += chunkTotals[chunk];
+        }
+        GreekTotals linear;
+        linear.delta = group.linearQuantity;
+        linear.value = group.linearQuantity * spot;
+        bucket.totals += linear;
+        total += linear;
+        result.positionsPriced += group.positions;
+
+        // Groups arrive sorted by underlying, so its bucket is always the last
+        if (result.byUnderlying.empty() || result.byUnderlying.back().underlying != bucket.underlying) {
+            result.byUnderlying.push_back(RiskBucket{bucket.underlying, -1.0, 0, GreekTotals()});
+        }
+        result.byUnderlying.back().positions += bucket.positions;
+        result.byUnderlying.back().totals += bucket.totals;
+
+        RiskBucket& expiry = expiries.emplace(group.timeToExpiry,
+                                              RiskBucket{std::string(), group.timeToExpiry, 0, GreekTotals()})
+                                 .first->second;
+        expiry.positions += bucket.positions;
+        expiry.totals += bucket.totals;
+
+        result.byGroup.push_back(std::move(bucket));
+    }
+
+    result.byExpiry.reserve(expiries.size());
+    for (auto& expiry : expiries) {
+        result.byExpiry.push_back(std::move(expiry.second));
+    }
+
+    result.metrics.totalDelta = total.delta;
+    result.metrics.totalGamma = total.gamma;
+    result.metrics.totalTheta = total.theta;
+    result.metrics.totalVega = total.vega;
+    result.metrics.totalRho = total.rho;
+    result.metrics.portfolioValue = total.value;
+    return result;
+}
+
+std::vector<double> PortfolioBook::scenarioPnL(const ScenarioSet& scenarios,
+                                               const std::unordered_map<std::string, double>& underlyingPrices,
+                                               double riskFreeRate, double volatility, size_t maxThreads,
+                                               double* baseValue) const {
+    std::vector<double> spots = spotsFor(underlyingPrices);
+
+    // Scenario column of each of the book's underlyings, or none
+    constexpr size_t UNSHOCKED = SIZE_MAX;
+    std::vector<size_t> columns(underlyings_.size(), UNSHOCKED);
+    {
+        std::unordered_map<std::string, size_t> index;
+        for (size_t c = 0; c < scenarios.underlyings.size(); ++c) {
+            index.emplace(scenarios.underlyings[c], c);
+        }
+        for (size_t u = 0; u < underlyings_.size(); ++u) {
+            auto it = index.find(underlyings_[u]);
+            if (it != index.end()) columns[u] = it->second;
+        }
+    }
+
+    double base = 0.0;
+    for (const Group& group : groups_) {
+        double spot = spots[group.underlying];
+        if (spot <= 0.0) continue;
+        BatchMarket market{spot, riskFreeRate, volatility, group.timeToExpiry};
+        BatchContracts contracts{&strike_[group.begin], &logStrike_[group.begin], &callSign_[group.begin],
+                                 &quantity_[group.begin], group.end - group.begin};
+        base += BlackScholesBatch::valueSum(market, contracts) + group.linearQuantity * spot;
+    }
+    if (baseValue) *baseValue = base;
+
+    std::vector<double> pnl(scenarios.count, 0.0);
+    const size_t block = BlackScholesBatch::MAX_SCENARIOS;
+
+    auto priceBlocks = [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t first = range.begin(); first < range.end(); first += block) {
+            size_t count = std::min(block, range.end() - first);
+            double spot[block], logSpot[block], vol[block];
+            double* values = &pnl[first];
+            uint32_t shockedUnderlying = UINT32_MAX;
+
+            for (const Group& group : groups_) {
+                double baseSpot = spots[group.underlying];
+                if (baseSpot <= 0.0) continue;
+
+                // Groups are sorted by underlying: shocked inputs are built
+                // once per underlying, not once per expiry
+                if (group.underlying != shockedUnderlying) {
+                    shockedUnderlying = group.underlying;
+                    size_t column = columns[group.underlying];
+                    for (size_t s = 0; s < count; ++s) {
+                        double spotShock = column == UNSHOCKED ? 0.0 : scenarios.spotShock(first + s, column);
+                        double volShock = column == UNSHOCKED ? 0.0 : scenarios.volShock(first + s, column);
+                        spot[s] = std::max(baseSpot * (1.0 + spotShock), 1e-12);
+                        logSpot[s] = std::log(spot[s]);
+                        vol[s] = std::max(volatility * (1.0 + volShock), 1e-4);
+                    }
+                }
+
+                ScenarioMarkets markets{spot, logSpot, vol, count, riskFreeRate, group.timeToExpiry};
+                BatchContracts contracts{&strike_[group.begin], &logStrike_[group.begin], &callSign_[group.begin],
+                                         &quantity_[group.begin], group.end - group.begin};
+                BlackScholesBatch::addScenarioValues(markets, contracts, values);
+                if (group.linearQuantity != 0.0) {
+                    for (size_t s = 0; s < count; ++s) values[s] += group.linearQuantity * spot[s];
+                }
+            }
+            for (size_t s = 0; s < count; ++s) values[s] -= base;
+        }
+    };
+
+    tbb::task_arena arena(maxThreads > 0 ? static_cast<int>(maxThreads) : tbb::task_arena::automatic);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, scenarios.count, block), priceBlocks);
+    });
+    return pnl;
+}
+
+StressGrid PortfolioBook::stressGrid(const StressGridSpec& spec,
+                                     const std::unordered_map<std::string, double>& underlyingPrices,
+                                     double riskFreeRate, double volatility, size_t maxThreads) const {
+    std::vector<double> spots = spotsFor(underlyingPrices);
+
+    StressGrid grid;
+    grid.spotShifts = spec.spotShifts();
+    grid.volShifts = spec.volShifts();
+    const size_t points = grid.points();
+    const size_t volCount = grid.volShifts.size();
+    const double decay = spec.decayDays / 365.0;
+
+    // Groups of each priced underlying, and its value today
+    struct Slice {
+        uint32_t underlying;
+        size_t firstGroup;
+        size_t endGroup;
+        double baseValue;
+    };
+    std::vector<Slice> slices;
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        const Group& group = groups_[g];
+        double spot = spots[group.underlying];
+        if (spot <= 0.0) continue;
+        if (slices.empty() || slices.back().underlying != group.underlying) {
+            slices.push_back(Slice{group.underlying, g, g, 0.0});
+            grid.underlyings.push_back(underlyings_[group.underlying]);
+        }
+        BatchMarket market{spot, riskFreeRate, volatility, group.timeToExpiry};
+        BatchContracts contracts{&strike_[group.begin], &logStrike_[group.begin], &callSign_[group.begin],
+                                 &quantity_[group.begin], group.end - group.begin};
+        slices.back().baseValue += BlackScholesBatch::valueSum(market, contracts) + group.linearQuantity * spot;
+        slices.back().endGroup = g + 1;
+    }
+
+    grid.underlyingPnL.assign(slices.size() * points, 0.0);
+    const size_t block = BlackScholesBatch::MAX_SCENARIOS;
+    const size_t blocks = (points + block - 1) / block;
+
+    // Every task owns one underlying's block of grid points, so results do
+    // not depend on scheduling
+    auto priceTasks = [&](const tbb::blocked_range<size_t>& range) {
+        double spot[block], logSpot[block], vol[block];
+        for (size_t task = range.begin(); task != range.end(); ++task) {
+            const Slice& slice = slices[task / blocks];
+            size_t first = (task % blocks) * block;
+            size_t count = std::min(block, points - first);
+            double* values = &grid.underlyingPnL[(task / blocks) * points + first];
+
+            double baseSpot = spots[slice.underlying];
+            size_t row = SIZE_MAX;
+            for (size_t p = 0; p < count; ++p) {
+                size_t i = (first + p) / volCount;
+                if (i != row) {
+                    row = i;
+                    spot[p] = std::max(baseSpot * (1.0 + grid.spotShifts[i]), 1e-12);
+                    logSpot[p] = std::log(spot[p]);
+                } else {
+                    spot[p] = spot[p - 1];
+                    logSpot[p] = logSpot[p - 1];
+                }
+                vol[p] = std::max(volatility * (1.0 + grid.volShifts[(first + p) % volCount]), 1e-4);
+            }
+
+            for (size_t g = slice.firstGroup; g < slice.endGroup; ++g) {
+                const Group& group = groups_[g];
+                ScenarioMarkets markets{spot, logSpot, vol, count, riskFreeRate, group.timeToExpiry - decay};
+                BatchContracts contracts{&strike_[group.begin], &logStrike_[group.begin], &callSign_[group.begin],
+                                         &quantity_[group.begin], group.end - group.begin};
+                BlackScholesBatch::addScenarioValues(markets, contracts, values);
+                if (group.linearQuantity != 0.0) {
+                    for (size_t p = 0; p < count; ++p) values[p] += group.linearQuantity * spot[p];
+                }
+            }
+            for (size_t p = 0; p < count; ++p) values[p] -= slice.baseValue;
+        }
+    };
+
+    tbb::task_arena arena(maxThreads > 0 ? static_cast<int>(maxThreads) : tbb::task_arena::automatic);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, slices.size() * blocks), priceTasks);
+    });
+
+    grid.portfolioPnL.assign(points, 0.0);
+    for (size_t u = 0; u < slices.size(); ++u) {
+        const double* pnl = &grid.underlyingPnL[u * points];
+        for (size_t p = 0; p < points; ++p) grid.portfolioPnL[p] += pnl[p];
+    }
+    return grid;
+}
+
+std::unordered_map<std::string, ClassGroupRisk> PortfolioBook::classGroupRisk(
+    const MarginParameters& parameters, const std::unordered_map<std::string, double>& underlyingPrices,
+    double riskFreeRate, double volatility, size_t maxThreads) const {
+
+    std::vector<double> spots = spotsFor(underlyingPrices);
+    std::vector<ClassGroupRisk> groupRisk(groups_.size());
+
+    auto priceGroups = [&](const tbb::blocked_range<size_t>& range) {
+        for (size_t g = range.begin(); g != range.end(); ++g) {
+            const Group& group = groups_[g];
+            double spot = spots[group.underlying];
+            if (spot <= 0.0) continue;
+
+            MarginMarkets markets(parameters, spot, volatility);
+            double values[MarginMarkets::LANES] = {};
+            ScenarioMarkets scenarioMarkets{markets.spot, markets.logSpot, markets.volatility,
+                                            MarginMarkets::LANES, riskFreeRate, group.timeToExpiry};
+            BatchContracts contracts{&strike_[group.begin], &logStrike_[group.begin], &callSign_[group.begin],
+                                     &quantity_[group.begin], group.end - group.begin};
+            BlackScholesBatch::addScenarioValues(scenarioMarkets, contracts, values);
+            for (size_t s = 0; s < MarginMarkets::LANES; ++s) {
+                values[s] += group.linearQuantity * markets.spot[s];
+            }
+
+            ClassGroupRisk& risk = groupRisk[g];
+            risk.pnl = markets.riskArray(parameters, values);
+            for (size_t i = group.begin; i < group.end; ++i) {
+                if (quantity_[i] < 0.0) risk.shortOptions -= quantity_[i];
+            }
+        }
+    };
+
+    tbb::task_arena arena(maxThreads > 0 ? static_cast<int>(maxThreads) : tbb::task_arena::automatic);
+    arena.execute([&] {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, groups_.size()), priceGroups);
+    });
+
+    std::unordered_map<std::string, ClassGroupRisk> classes;
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        if (spots[groups_[g].underlying] <= 0.0) continue;
+        classes[underlyings_[groups_[g].underlying]].add(groupRisk[g]);
+    }
+    return classes;
+}
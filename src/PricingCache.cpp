@@ -0,0 +1,149 @@
+#include "PricingCache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+PricingCache::PricingCache(PricingCacheConfig config)
+    : config_(config),
+      shardCapacity_(std::max<size_t>(1, (config.capacity + SHARD_COUNT - 1) / SHARD_COUNT)),
+      shards_(new Shard[SHARD_COUNT]) {
+    if (!(config.spotTolerance > 0.0 && config.volTolerance > 0.0 && config.timeTolerance > 0.0)) {
+        throw std::invalid_argument("Pricing cache tolerances must be positive");
+    }
+    for (size_t s = 0; s < SHARD_COUNT; ++s) {
+        shards_[s].index.reserve(shardCapacity_);
+    }
+}
+
+size_t PricingCache::KeyHash::operator()(const Key& key) const {
+    // One multiply-xorshift round per 64-bit field: far fewer steps than
+    // byte-wise FNV on a lookup that is meant to beat pricing
+    uint64_t h = 0;
+    auto mix = [&h](uint64_t value) {
+        h = (h ^ value) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 32;
+    };
+    uint64_t bits;
+    std::memcpy(&bits, &key.strike, sizeof(bits));
+    mix(bits);
+    std::memcpy(&bits, &key.riskFreeRate, sizeof(bits));
+    mix(bits);
+    mix(static_cast<uint64_t>(key.spotBucket));
+    mix(static_cast<uint64_t>(key.volBucket));
+    mix(static_cast<uint64_t>(key.timeBucket));
+    mix(key.isCall ? 1u : 2u);
+    return static_cast<size_t>(h);
+}
+
+PricingCache::Key PricingCache::keyFor(const BlackScholesModel::OptionParameters& params) const {
+    // Spot buckets are equal in log space, so the tolerance is relative
+    return Key{params.strike,
+               params.riskFreeRate,
+               static_cast<int64_t>(std::floor(std::log(params.spot) / config_.spotTolerance)),
+               static_cast<int64_t>(std::floor(params.volatility / config_.volTolerance)),
+               static_cast<int64_t>(std::floor(params.timeToExpiry / config_.timeTolerance)),
+               params.isCall};
+}
+
+PricedOption PricingCache::fromCache(const Entry& entry, const BlackScholesModel::OptionParameters& params) const {
+    PricedOption priced = entry.priced;
+    if (!config_.taylorCorrection) return priced;
+
+    // Vega is per 1% of volatility; theta is per year of calendar time,
+    // which shortens the time to expiry
+    const BlackScholesModel::Greeks& greeks = entry.priced.greeks;
+    double spotMove = params.spot - entry.spot;
+    double volMove = params.volatility - entry.volatility;
+    double timeMove = params.timeToExpiry - entry.timeToExpiry;
+    priced.price += greeks.delta * spotMove + 0.5 * greeks.gamma * spotMove * spotMove +
+                    greeks.vega * 100.0 * volMove - greeks.theta * timeMove;
+    priced.price = std::max(priced.price, 0.0);
+    priced.greeks.delta += greeks.gamma * spotMove;
+    return priced;
+}
+
+void PricingCache::addRiskArray(PricedOption& priced, const BlackScholesModel::OptionParameters& params,
+                                const MarginParameters& margin) {
+    priced.riskArray = contractRiskArray(margin, params.spot, params.strike, params.isCall, params.timeToExpiry,
+                                         params.riskFreeRate, params.volatility);
+}
+
+PricedOption PricingCache::price(const BlackScholesModel::OptionParameters& params,
+                                 const MarginParameters* margin) {
+    if (!params.isValid()) {
+        throw std::invalid_argument("Invalid option parameters");
+    }
+    Key key = keyFor(params);
+    size_t hash = KeyHash()(key);
+    Shard& shard = shards_[hash % SHARD_COUNT];
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Entry& entry = shard.entries[it->second];
+            entry.referenced = true;
+            if (!margin || entry.hasRiskArray) {
+                ++shard.hits;
+                return fromCache(entry, params);
+            }
+        }
+        ++shard.misses;
+    }
+
+    // Priced outside the lock; two threads missing on the same key both
+    // price it and the second insert finds it already there
+    PricedOption priced;
+    priced.price = BlackScholesModel::calculateOptionPrice(params);
+    priced.greeks = BlackScholesModel::calculateGreeks(params);
+    if (margin) addRiskArray(priced, params, *margin);
+    Entry fresh{key, params.spot, params.volatility, params.timeToExpiry, priced, margin != nullptr, false};
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        // Priced by another thread meanwhile, or cached without a risk array
+        if (margin && !shard.entries[it->second].hasRiskArray) shard.entries[it->second] = fresh;
+        return priced;
+    }
+
+    size_t slot;
+    if (shard.entries.size() < shardCapacity_) {
+        slot = shard.entries.size();
+        shard.entries.push_back(fresh);
+    } else {
+        // CLOCK: clear reference bits until an unreferenced entry comes round
+        while (shard.entries[shard.hand].referenced) {
+            shard.entries[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shardCapacity_;
+        }
+        slot = shard.hand;
+        shard.hand = (shard.hand + 1) % shardCapacity_;
+        shard.index.erase(shard.entries[slot].key);
+        shard.entries[slot] = fresh;
+        ++shard.evictions;
+    }
+    shard.index.emplace(key, slot);
+    return priced;
+}
+
+PricingCache::Stats PricingCache::stats() const {
+    Stats stats;
+    for (size_t s = 0; s < SHARD_COUNT; ++s) {
+        std::lock_guard<std::mutex> lock(shards_[s].mutex);
+        stats.hits += shards_[s].hits;
+        stats.misses += shards_[s].misses;
+        stats.evictions += shards_[s].evictions;
+        stats.entries += shards_[s].entries.size();
+    }
+    return stats;
+}
+
+void PricingCache::clear() {
+    for (size_t s = 0; s < SHARD_COUNT; ++s) {
+        std::lock_guard<std::mutex> lock(shards_[s].mutex);
+        shards_[s].entries.clear();
+        shards_[s].index.clear();
+        shards_[s].hand = 0;
+    }
+}
@@ -0,0 +1,29 @@
+#include "QuoteConflator.hpp"
+
+QuoteConflator::QuoteConflator(size_t maxContracts)
+    : maxContracts_(maxContracts) {}
+
+bool QuoteConflator::offer(const OptionData& quote) {
+    InstrumentKey key = makeInstrumentKey(quote.underlying, quote.optionType, quote.strike, quote.expiry);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        pending_[it->second] = quote;
+        ++conflated_;
+        return true;
+    }
+    if (pending_.size() >= maxContracts_) {
+        ++dropped_;
+        return false;
+    }
+    index_.emplace(key, pending_.size());
+    pending_.push_back(quote);
+    return true;
+}
+
+void QuoteConflator::drain(std::vector<OptionData>& out) {
+    out.clear();
+    out.swap(pending_);
+    index_.clear();
+    conflated_ = 0;
+    dropped_ = 0;
+}
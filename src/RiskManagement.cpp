@@ -1,7 +1,33 @@
 #include "RiskManagement.hpp"
+#include "BlackScholesBatch.hpp"
+#include "DateUtils.hpp"
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 
+namespace {
+    // Contracts expire at the end of their UTC expiry day. Without a
+    // parsable expiry a contract is valued one year out, as the OMS does
+    // for positions.
+    // Symbols fit the small-string buffer, so the key costs no allocation
+    std::string symbolOf(const char* underlying) {
+        return std::string(underlying, strnlen(underlying, sizeof(InstrumentKey::underlying)));
+    }
+
+    int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void atomicAdd(std::atomic<double>& total, double change) {
+        if (change == 0.0) return;
+        double current = total.load(std::memory_order_relaxed);
+        while (!total.compare_exchange_weak(current, current + change, std::memory_order_relaxed)) {
+        }
+    }
+}
+
 RiskManagement::RiskManagement() {
     // Set default risk limits
     limits_.maxDelta = 1000.0;
@@ -10,6 +36,7 @@ RiskManagement::RiskManagement() {
     limits_.maxTheta = 500.0;
     limits_.maxPositionSize = 1000000.0;
     limits_.maxLoss = 100000.0;
+    limits_.marginCapital = 1000000.0;
 }
 
 RiskMetrics RiskManagement::calculatePortfolioRisk(
@@ -17,6 +44,16 @@ RiskMetrics RiskManagement::calculatePortfolioRisk(
     const std::unordered_map<std::string, double>& underlyingPrices) {
     
     RiskMetrics metrics{};
+    RiskLimits limits;
+    MarginParameters marginParameters;
+    std::shared_ptr<PricingCache> cache;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex_);
+        limits = limits_;
+        marginParameters = marginParameters_;
+        cache = pricingCache_;
+    }
+    std::unordered_map<std::string, ClassGroupRisk> classes;
     
     for (const auto& position : positions) {
         auto it = underlyingPrices.find(position.symbol);
@@ -34,8 +71,9 @@ RiskMetrics RiskManagement::calculatePortfolioRisk(
         };
         
         // Calculate option price and Greeks
-        double optionPrice = BlackScholesModel::calculateOptionPrice(params);
-        auto greeks = BlackScholesModel::calculateGreeks(params);
+        PricedOption priced = priceOption(cache.get(), params, &marginParameters);
+        double optionPrice = priced.price;
+        const auto& greeks = priced.greeks;
         
         // Multiply by position size
         metrics.totalDelta += greeks.delta * position.quantity;
@@ -45,33 +83,160 @@ RiskMetrics RiskManagement::calculatePortfolioRisk(
         metrics.totalRho += greeks.rho * position.quantity;
         
         metrics.portfolioValue += optionPrice * position.quantity;
+
+        classes[position.symbol].add(priced.riskArray, position.quantity, position.strike > 0.0, 1.0);
     }
     
     // Calculate VaR using historical simulation method
     metrics.valueAtRisk = calculateValueAtRisk(positions, 0.95);  // 95% confidence level
     
-    // Simple margin requirement calculation (can be made more sophisticated)
-    metrics.marginRequirement = std::max(
-        metrics.portfolioValue * 0.2,  // 20% of portfolio value
-        std::abs(metrics.totalDelta) * 100.0  // $100 per delta point
-    );
+    applyMargin(metrics, portfolioMargin(classes, marginParameters), limits);
     
     return metrics;
 }
 
+PortfolioRevaluation RiskManagement::revaluePortfolio(
+    const PortfolioBook& book,
+    const std::unordered_map<std::string, double>& underlyingPrices,
+    size_t maxThreads) const {
+
+    RiskLimits limits;
+    MarginParameters marginParameters;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex_);
+        limits = limits_;
+        marginParameters = marginParameters_;
+    }
+
+    PortfolioRevaluation result = book.revalue(underlyingPrices, DEFAULT_RISK_FREE_RATE, DEFAULT_VOLATILITY,
+                                               maxThreads);
+    auto classes = book.classGroupRisk(marginParameters, underlyingPrices, DEFAULT_RISK_FREE_RATE,
+                                       DEFAULT_VOLATILITY, maxThreads);
+    applyMargin(result.metrics, portfolioMargin(classes, marginParameters), limits);
+    return result;
+}
+
+ScenarioRiskResult RiskManagement::calculateScenarioRisk(
+    const PortfolioBook& book,
+    const ScenarioSet& scenarios,
+    const std::unordered_map<std::string, double>& underlyingPrices,
+    const std::vector<double>& confidenceLevels,
+    size_t maxThreads) const {
+
+    auto start = std::chrono::steady_clock::now();
+    ScenarioRiskResult result;
+    result.pnl = book.scenarioPnL(scenarios, underlyingPrices, DEFAULT_RISK_FREE_RATE, DEFAULT_VOLATILITY,
+                                  maxThreads, &result.baseValue);
+    result.levels = lossQuantiles(result.pnl, confidenceLevels);
+    result.elapsedMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+StressGrid RiskManagement::calculateStressGrid(
+    const PortfolioBook& book,
+    const std::unordered_map<std::string, double>& underlyingPrices,
+    const StressGridSpec& spec,
+    size_t maxThreads) const {
+
+    auto start = std::chrono::steady_clock::now();
+    StressGrid grid = book.stressGrid(spec, underlyingPrices, DEFAULT_RISK_FREE_RATE, DEFAULT_VOLATILITY,
+                                      maxThreads);
+    grid.elapsedMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count();
+    return grid;
+}
+
+void RiskManagement::applyScenarioRisk(RiskMetrics& metrics, const ScenarioRiskResult& risk) {
+    if (risk.levels.empty()) return;
+    metrics.valueAtRisk = risk.levels.front().valueAtRisk;
+    metrics.expectedShortfall = risk.levels.front().expectedShortfall;
+}
+
 bool RiskManagement::checkOrderRisk(const OptionPosition& newPosition, const RiskMetrics& currentRisk) {
-    // Add marginals from new position to current risk
-    return (std::abs(currentRisk.totalDelta) < limits_.maxDelta &&
-            std::abs(currentRisk.totalGamma) < limits_.maxGamma &&
-            std::abs(currentRisk.totalVega) < limits_.maxVega &&
-            std::abs(currentRisk.totalTheta) < limits_.maxTheta &&
-            currentRisk.portfolioValue < limits_.maxPositionSize);
+    // Marginal Greeks of the new position at the last known spot
+    BlackScholesModel::Greeks greeks;
+    double optionPrice = 0.0;
+    double spot = 0.0;
+    RiskLimits limits;
+    std::shared_ptr<PricingCache> cache;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex_);
+        auto it = underlyings_.find(newPosition.symbol);
+        if (it != underlyings_.end()) {
+            std::lock_guard<std::mutex> groupLock(it->second.group->mutex);
+            spot = it->second.spot;
+        }
+        limits = limits_;
+        cache = pricingCache_;
+    }
+    if (spot > 0.0 && newPosition.strike > 0.0 && newPosition.timeToExpiry > 0.0) {
+        BlackScholesModel::OptionParameters params{
+            spot,
+            newPosition.strike,
+            DEFAULT_RISK_FREE_RATE,
+            DEFAULT_VOLATILITY,
+            newPosition.timeToExpiry,
+            newPosition.isCall
+        };
+        PricedOption priced = priceOption(cache.get(), params, nullptr);
+        optionPrice = priced.price;
+        greeks = priced.greeks;
+    }
+
+    // Fails closed, as the live check does: a position that cannot be
+    // valued is rejected
+    double quantity = newPosition.quantity;
+    if (!(spot > 0.0) && quantity != 0.0) return false;
+    return withinLimit(0.0, quantity, limits.maxPositionSize) &&
+           withinLimit(currentRisk.totalDelta, greeks.delta * quantity, limits.maxDelta) &&
+           withinLimit(currentRisk.totalGamma, greeks.gamma * quantity, limits.maxGamma) &&
+           withinLimit(currentRisk.totalVega, greeks.vega * quantity, limits.maxVega) &&
+           withinLimit(currentRisk.totalTheta, greeks.theta * quantity, limits.maxTheta) &&
+           withinLimit(currentRisk.portfolioValue, optionPrice * quantity, limits.maxPositionSize);
 }
 
 void RiskManagement::setRiskLimits(const RiskLimits& limits) {
+    std::unique_lock<std::shared_mutex> lock(stateMutex_);
     limits_ = limits;
 }
 
+void RiskManagement::enablePricingCache(const PricingCacheConfig& config) {
+    auto cache = std::make_shared<PricingCache>(config);
+    std::unique_lock<std::shared_mutex> lock(stateMutex_);
+    pricingCache_ = std::move(cache);
+}
+
+PricingCache::Stats RiskManagement::getPricingCacheStats() const {
+    std::shared_ptr<PricingCache> cache;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex_);
+        cache = pricingCache_;
+    }
+    return cache ? cache->stats() : PricingCache::Stats();
+}
+
+void RiskManagement::setMarginParameters(const MarginParameters& parameters) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::unique_lock<std::shared_mutex> lock(stateMutex_);
+    marginParameters_ = parameters;
+    if (pricingCache_) {
+        // Cached risk arrays were built under the old scenarios
+        pricingCache_ = std::make_shared<PricingCache>(pricingCache_->config());
+    }
+    productGroups_.clear();
+    margin_.store(0.0);
+    for (auto& pair : underlyings_) {
+        joinProductGroup(pair.first, pair.second);
+        if (pair.second.spot > 0.0) repriceUnderlying(pair.second, now);
+    }
+    for (auto& group : productGroups_) {
+        refreshMargin(group.second);
+    }
+}
+
 double RiskManagement::calculateValueAtRisk(
     const std::vector<OptionPosition>& positions,
     double confidenceLevel) {
@@ -89,4 +254,599 @@ double RiskManagement::calculateValueAtRisk(
     // Using normal distribution approximation
     double z = boost::math::quantile(boost::math::normal(), confidenceLevel);
     return totalRisk * z * sqrt(1.0/252.0);  // Daily VaR
-}
\ No newline at end of file
+}
+
+bool RiskManagement::checkOrderRisk(const InstrumentKey& instrument, double signedQuantity) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex_);
+    // Read-only: a contract nothing is held or quoted in is priced into a
+    // temporary, so rejected and probing orders leave no state behind. An
+    // underlying never seen has no spot price and nothing held in it.
+    auto found = underlyings_.find(symbolOf(instrument.underlying));
+    if (found == underlyings_.end()) return false;
+    UnderlyingRisk& underlying = found->second;
+    std::lock_guard<std::mutex> groupLock(underlying.group->mutex);
+
+    ContractRisk unheld;
+    auto known = underlying.contracts.find(instrument);
+    ContractRisk& contract = known != underlying.contracts.end() ? known->second : unheld;
+    if (!withinLimit(contract.quantity, signedQuantity, limits_.maxPositionSize)) return false;
+
+    // Without a spot price nothing can be valued: only reducing trades pass
+    if (!(underlying.spot > 0.0)) {
+        return std::abs(contract.quantity + signedQuantity) <= std::abs(contract.quantity);
+    }
+    refreshContract(underlying, instrument, contract);
+
+    // Other groups may move the portfolio meanwhile; each sum is as of its
+    // load
+    const GreekTotals& unit = contract.perUnit;
+    const GreekTotals portfolio = portfolio_.load();
+    bool withinGreeks = withinLimit(portfolio.delta, unit.delta * signedQuantity, limits_.maxDelta) &&
+                        withinLimit(portfolio.gamma, unit.gamma * signedQuantity, limits_.maxGamma) &&
+                        withinLimit(portfolio.vega, unit.vega * signedQuantity, limits_.maxVega) &&
+                        withinLimit(portfolio.theta, unit.theta * signedQuantity, limits_.maxTheta) &&
+                        withinLimit(portfolio.value, unit.value * signedQuantity, limits_.maxPositionSize);
+    if (!withinGreeks || limits_.marginCapital <= 0.0) return withinGreeks;
+
+    // Margin after the trade: only this instrument's product group changes
+    ClassGroupRisk after = underlying.margin;
+    after.add(contract.riskArray, contract.quantity, contract.option, -1.0);
+    after.add(contract.riskArray, contract.quantity + signedQuantity, contract.option, 1.0);
+    double groupMargin = productGroupMargin(underlying.group->classes, marginParameters_, &underlying.margin, &after);
+    return withinLimit(margin_.load(), groupMargin - underlying.group->margin, limits_.marginCapital);
+}
+
+StrategyEvaluation RiskManagement::evaluateStrategies(const std::vector<Strategy>& candidates,
+                                                      double quantity) const {
+    auto started = std::chrono::steady_clock::now();
+    StrategyEvaluation evaluation;
+    evaluation.impacts.resize(candidates.size());
+
+    // Distinct contracts across the candidates: a scanner's candidates
+    // are drawn from the same few chains
+    std::unordered_map<InstrumentKey, uint32_t> contractIndex;
+    std::vector<InstrumentKey> contracts;
+    std::vector<uint32_t> legContracts;   // Every candidate's legs, one after another
+    for (const Strategy& candidate : candidates) {
+        validateStrategy(candidate);
+        for (const StrategyLeg& leg : candidate.legs) {
+            auto inserted = contractIndex.emplace(leg.instrument, static_cast<uint32_t>(contracts.size()));
+            if (inserted.second) contracts.push_back(leg.instrument);
+            legContracts.push_back(inserted.first->second);
+        }
+    }
+    const size_t count = contracts.size();
+    evaluation.contractsPriced = count;
+
+    // Copy what the candidates touch: each priced underlying's spot and
+    // product group (every class in it, for the offsets), and each
+    // contract's volatility and held quantity
+    constexpr uint32_t UNPRICED = UINT32_MAX;
+    struct ClassSnapshot {
+        double spot;
+        uint32_t group;   // Index into groups
+        uint32_t slot;    // This class within the group
+    };
+    struct GroupSnapshot {
+        std::vector<ClassGroupRisk> classes;
+        double margin;
+    };
+    std::vector<ClassSnapshot> classes;
+    std::vector<GroupSnapshot> groups;
+    std::vector<uint32_t> contractClass(count, UNPRICED);
+    std::vector<double> volatility(count, DEFAULT_VOLATILITY);
+    std::vector<double> held(count, 0.0);
+    GreekTotals portfolio;
+    double margin;
+    RiskLimits limits;
+    MarginParameters parameters;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex_);
+        portfolio = portfolio_.load();
+        margin = margin_.load();
+        limits = limits_;
+        parameters = marginParameters_;
+
+        std::unordered_map<std::string, uint32_t> classIndex;
+        std::unordered_map<const ProductGroup*, uint32_t> groupIndex;
+        for (size_t c = 0; c < count; ++c) {
+            const InstrumentKey& instrument = contracts[c];
+            std::string symbol(instrument.underlying, strnlen(instrument.underlying, sizeof(instrument.underlying)));
+            auto found = underlyings_.find(symbol);
+            if (found == underlyings_.end()) continue;
+            const UnderlyingRisk& underlying = found->second;
+            std::lock_guard<std::mutex> groupLock(underlying.group->mutex);
+            auto contract = underlying.contracts.find(instrument);
+            if (contract != underlying.contracts.end()) {
+                volatility[c] = contract->second.volatility;
+                held[c] = contract->second.quantity;
+            }
+            if (underlying.spot <= 0.0) continue;
+
+            auto known = classIndex.emplace(symbol, static_cast<uint32_t>(classes.size()));
+            if (known.second) {
+                auto group = groupIndex.emplace(underlying.group, static_cast<uint32_t>(groups.size()));
+                if (group.second) {
+                    GroupSnapshot snapshot;
+                    snapshot.margin = underlying.group->margin;
+                    for (const ClassGroupRisk* risk : underlying.group->classes) snapshot.classes.push_back(*risk);
+                    groups.push_back(std::move(snapshot));
+                }
+                const auto& members = underlying.group->classes;
+                uint32_t slot = static_cast<uint32_t>(
+                    std::find(members.begin(), members.end(), &underlying.margin) - members.begin());
+                classes.push_back(ClassSnapshot{underlying.spot, group.first->second, slot});
+            }
+            contractClass[c] = known.first->second;
+        }
+    }
+
+    // Per-unit value, Greeks and risk array of every contract. Options are
+    // sorted so that runs sharing an underlying, expiry and volatility go
+    // through the kernels as one batch.
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<double> timeToExpiry(count);
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    for (uint32_t c = 0; c < count; ++c) {
+        timeToExpiry[c] = yearsToExpiry(contracts[c].expiry, now);
+        if (contractClass[c] != UNPRICED) order.push_back(c);
+    }
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (contractClass[a] != contractClass[b]) return contractClass[a] < contractClass[b];
+        if (timeToExpiry[a] != timeToExpiry[b]) return timeToExpiry[a] < timeToExpiry[b];
+        return volatility[a] < volatility[b];
+    });
+
+    std::vector<double> strike(count), logStrike(count), callSign(count), ones(count, 1.0);
+    std::vector<double> value(count, 0.0), delta(count, 0.0), gamma(count, 0.0);
+    std::vector<double> theta(count, 0.0), vega(count, 0.0), rho(count, 0.0);
+    std::vector<RiskArray> riskArrays(count, RiskArray{});
+    std::vector<uint32_t> rank(count);   // Position of each contract in the sorted arrays
+
+    for (size_t begin = 0; begin < order.size();) {
+        const uint32_t first = order[begin];
+        const ClassSnapshot& underlying = classes[contractClass[first]];
+        size_t end = begin + 1;
+        while (end < order.size() && contractClass[order[end]] == contractClass[first] &&
+               timeToExpiry[order[end]] == timeToExpiry[first] && volatility[order[end]] == volatility[first]) {
+            ++end;
+        }
+
+        MarginMarkets markets(parameters, underlying.spot, volatility[first]);
+        ScenarioMarkets scenarioMarkets{markets.spot, markets.logSpot, markets.volatility, MarginMarkets::LANES,
+                                        DEFAULT_RISK_FREE_RATE, timeToExpiry[first]};
+        size_t options = begin;   // Contracts on the underlying itself are moved out of the batch
+        for (size_t i = begin; i < end; ++i) {
+            const uint32_t c = order[i];
+            if (contracts[c].strike > 0.0) {
+                rank[c] = static_cast<uint32_t>(options);
+                strike[options] = contracts[c].strike;
+                logStrike[options] = std::log(contracts[c].strike);
+                callSign[options] = contracts[c].isCall ? 1.0 : -1.0;
+                ++options;
+            } else {
+                // Linear: delta one, and the P&L of the spot moves
+                rank[c] = static_cast<uint32_t>(end - 1 - (i - options));
+                value[rank[c]] = underlying.spot;
+                delta[rank[c]] = 1.0;
+                double lanes[MarginMarkets::LANES];
+                std::copy(markets.spot, markets.spot + MarginMarkets::LANES, lanes);
+                riskArrays[rank[c]] = markets.riskArray(parameters, lanes);
+            }
+        }
+
+        const size_t batch = options - begin;
+        if (batch > 0) {
+            BatchMarket market{underlying.spot, DEFAULT_RISK_FREE_RATE, volatility[first], timeToExpiry[first]};
+            BatchContracts priced{&strike[begin], &logStrike[begin], &callSign[begin], &ones[begin], batch};
+            BlackScholesBatch::priceEach(market, priced, BatchGreeks{&value[begin], &delta[begin], &gamma[begin],
+                                                                     &theta[begin], &vega[begin], &rho[begin]});
+            // Risk arrays: each contract across the sixteen scenarios at once
+            for (size_t i = begin; i < options; ++i) {
+                double lanes[MarginMarkets::LANES] = {};
+                BatchContracts single{&strike[i], &logStrike[i], &callSign[i], &ones[i], 1};
+                BlackScholesBatch::addScenarioValues(scenarioMarkets, single, lanes);
+                riskArrays[i] = markets.riskArray(parameters, lanes);
+            }
+        }
+        begin = end;
+    }
+
+    // Combine each candidate's legs. Only the class groups it trades in
+    // change, so only their product groups are re-margined.
+    std::vector<std::pair<uint32_t, ClassGroupRisk>> touched;
+    std::vector<const ClassGroupRisk*> members;
+    size_t legOffset = 0;
+    for (size_t k = 0; k < candidates.size(); ++k) {
+        const Strategy& candidate = candidates[k];
+        StrategyImpact& impact = evaluation.impacts[k];
+        impact.priced = true;
+        touched.clear();
+        bool legsAllowed = true;   // Sizes, and unpriced legs only reducing
+
+        for (size_t l = 0; l < candidate.legs.size(); ++l) {
+            const uint32_t c = legContracts[legOffset + l];
+            const uint32_t classOf = contractClass[c];
+            const double ratio = candidate.legs[l].ratio;
+            const double traded = ratio * quantity;
+            legsAllowed = legsAllowed && withinLimit(held[c], traded, limits.maxPositionSize);
+            if (classOf == UNPRICED) {
+                impact.priced = false;
+                legsAllowed = legsAllowed && std::abs(held[c] + traded) <= std::abs(held[c]);
+                continue;
+            }
+            const uint32_t r = rank[c];
+            impact.price += ratio * value[r];
+            impact.greeks.value += traded * value[r];
+            impact.greeks.delta += traded * delta[r];
+            impact.greeks.gamma += traded * gamma[r];
+            impact.greeks.theta += traded * theta[r];
+            impact.greeks.vega += traded * vega[r];
+            impact.greeks.rho += traded * rho[r];
+
+            auto entry = std::find_if(touched.begin(), touched.end(),
+                                      [classOf](const std::pair<uint32_t, ClassGroupRisk>& t) {
+                                          return t.first == classOf;
+                                      });
+            if (entry == touched.end()) {
+                const ClassSnapshot& snapshot = classes[classOf];
+                touched.emplace_back(classOf, groups[snapshot.group].classes[snapshot.slot]);
+                entry = touched.end() - 1;
+            }
+            const bool option = contracts[c].strike > 0.0;
+            entry->second.add(riskArrays[r], held[c], option, -1.0);
+            entry->second.add(riskArrays[r], held[c] + traded, option, 1.0);
+        }
+
+        // Re-margin each product group touched, with its traded classes replaced
+        for (size_t t = 0; t < touched.size(); ++t) {
+            const uint32_t groupOf = classes[touched[t].first].group;
+            bool seen = false;
+            for (size_t p = 0; p < t; ++p) seen = seen || classes[touched[p].first].group == groupOf;
+            if (seen) continue;
+
+            const GroupSnapshot& group = groups[groupOf];
+            members.clear();
+            for (const ClassGroupRisk& risk : group.classes) members.push_back(&risk);
+            for (size_t q = t; q < touched.size(); ++q) {
+                const ClassSnapshot& snapshot = classes[touched[q].first];
+                if (snapshot.group == groupOf) members[snapshot.slot] = &touched[q].second;
+            }
+            impact.marginChange += productGroupMargin(members, parameters) - group.margin;
+        }
+        impact.marginAfter = margin + impact.marginChange;
+
+        const GreekTotals& marginal = impact.greeks;
+        impact.withinLimits = legsAllowed &&
+                              withinLimit(portfolio.delta, marginal.delta, limits.maxDelta) &&
+                              withinLimit(portfolio.gamma, marginal.gamma, limits.maxGamma) &&
+                              withinLimit(portfolio.vega, marginal.vega, limits.maxVega) &&
+                              withinLimit(portfolio.theta, marginal.theta, limits.maxTheta) &&
+                              withinLimit(portfolio.value, marginal.value, limits.maxPositionSize) &&
+                              (limits.marginCapital <= 0.0 ||
+                               withinLimit(margin, impact.marginChange, limits.marginCapital));
+        legOffset += candidate.legs.size();
+    }
+
+    evaluation.elapsedMillis = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - started).count();
+    return evaluation;
+}
+
+bool RiskManagement::checkStrategyRisk(const Strategy& strategy, double quantity) const {
+    return evaluateStrategies(std::vector<Strategy>{strategy}, quantity).impacts[0].withinLimits;
+}
+
+void RiskManagement::onFill(const InstrumentKey& instrument, double signedQuantity) {
+    std::shared_lock<std::shared_mutex> lock(stateMutex_);
+    UnderlyingRisk& underlying = underlyingFor(symbolOf(instrument.underlying), lock);
+    std::lock_guard<std::mutex> groupLock(underlying.group->mutex);
+    ContractRisk& contract = contractFor(underlying, instrument);
+
+    const GreekTotals before = underlying.totals;
+    applyContract(underlying, contract, -1.0);
+    contract.quantity += signedQuantity;
+    applyContract(underlying, contract, 1.0);
+    portfolio_.add(before, underlying.totals);
+    refreshMargin(*underlying.group);
+}
+
+void RiskManagement::onUnderlyingPrice(const std::string& underlying, double spot) {
+    if (!(spot > 0.0)) return;
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    std::shared_lock<std::shared_mutex> lock(stateMutex_);
+    UnderlyingRisk& risk = underlyingFor(underlying, lock);
+    std::lock_guard<std::mutex> groupLock(risk.group->mutex);
+    risk.spot = spot;
+    repriceUnderlying(risk, now);
+    refreshMargin(*risk.group);
+}
+
+void RiskManagement::onOptionQuote(const OptionData& quote) {
+    // Outside the range the pricer accepts
+    if (!(quote.impliedVol >= 1e-4 && quote.impliedVol <= 5.0)) return;
+    InstrumentKey instrument;
+    try {
+        instrument = makeInstrumentKey(quote.underlying, quote.optionType, quote.strike, quote.expiry);
+    } catch (const std::invalid_argument&) {
+        return;  // Not something an order could have been placed on
+    }
+
+    std::shared_lock<std::shared_mutex> lock(stateMutex_);
+    UnderlyingRisk& underlying = underlyingFor(symbolOf(instrument.underlying), lock);
+    std::lock_guard<std::mutex> groupLock(underlying.group->mutex);
+    auto it = underlying.contracts.find(instrument);
+    if (it == underlying.contracts.end()) {
+        ContractRisk contract;
+        contract.volatility = quote.impliedVol;
+        underlying.contracts.emplace(instrument, contract);
+        return;
+    }
+
+    ContractRisk& contract = it->second;
+    contract.volatility = quote.impliedVol;
+    if (contract.quantity == 0.0 || underlying.spot <= 0.0) {
+        contract.priced = false;
+        return;
+    }
+
+    const GreekTotals before = underlying.totals;
+    applyContract(underlying, contract, -1.0);
+    priceContract(instrument, contract, underlying.spot,
+                  std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::system_clock::now().time_since_epoch()).count());
+    applyContract(underlying, contract, 1.0);
+    portfolio_.add(before, underlying.totals);
+    refreshMargin(*underlying.group);
+}
+
+void RiskManagement::loadPositions(const std::vector<PositionRecord>& positions) {
+    std::unique_lock<std::shared_mutex> lock(stateMutex_);
+    portfolio_.add(portfolio_.load(), GreekTotals());
+    for (auto& pair : underlyings_) {
+        pair.second.totals = GreekTotals();
+        pair.second.margin = ClassGroupRisk();
+        for (auto& contract : pair.second.contracts) {
+            contract.second.quantity = 0.0;
+        }
+    }
+
+    for (const auto& position : positions) {
+        UnderlyingRisk& underlying = addUnderlying(symbolOf(position.instrument.underlying));
+        ContractRisk& contract = contractFor(underlying, position.instrument);
+        const GreekTotals before = underlying.totals;
+        applyContract(underlying, contract, -1.0);
+        contract.quantity += position.quantity;
+        applyContract(underlying, contract, 1.0);
+        portfolio_.add(before, underlying.totals);
+    }
+    for (auto& group : productGroups_) {
+        refreshMargin(group.second);
+    }
+}
+
+RiskMetrics RiskManagement::getCurrentRisk() const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex_);
+    const GreekTotals portfolio = portfolio_.load();
+    RiskMetrics metrics;
+    metrics.totalDelta = portfolio.delta;
+    metrics.totalGamma = portfolio.gamma;
+    metrics.totalTheta = portfolio.theta;
+    metrics.totalVega = portfolio.vega;
+    metrics.totalRho = portfolio.rho;
+    metrics.portfolioValue = portfolio.value;
+    applyMargin(metrics, margin_.load(), limits_);
+    return metrics;
+}
+
+GreekTotals RiskManagement::getUnderlyingRisk(const std::string& underlying) const {
+    std::shared_lock<std::shared_mutex> lock(stateMutex_);
+    auto it = underlyings_.find(underlying);
+    if (it == underlyings_.end()) return GreekTotals();
+    std::lock_guard<std::mutex> groupLock(it->second.group->mutex);
+    return it->second.totals;
+}
+
+std::vector<RiskBucket> RiskManagement::getUnderlyingRisks() const {
+    std::vector<RiskBucket> buckets;
+    {
+        std::shared_lock<std::shared_mutex> lock(stateMutex_);
+        for (const auto& pair : underlyings_) {
+            std::lock_guard<std::mutex> groupLock(pair.second.group->mutex);
+            size_t held = 0;
+            for (const auto& contract : pair.second.contracts) {
+                held += contract.second.quantity != 0.0;
+            }
+            if (held > 0) buckets.push_back(RiskBucket{pair.first, -1.0, held, pair.second.totals});
+        }
+    }
+    std::sort(buckets.begin(), buckets.end(),
+              [](const RiskBucket& a, const RiskBucket& b) { return a.underlying < b.underlying; });
+    return buckets;
+}
+
+RiskManagement::UnderlyingRisk& RiskManagement::underlyingFor(const std::string& underlying, SharedLock& lock) {
+    auto found = underlyings_.find(underlying);
+    if (found != underlyings_.end()) return found->second;
+
+    // Underlyings are never removed, and map nodes do not move, so the
+    // entry is still there once the shared lock is back
+    lock.unlock();
+    UnderlyingRisk* added;
+    {
+        std::unique_lock<std::shared_mutex> exclusive(stateMutex_);
+        added = &addUnderlying(underlying);
+    }
+    lock.lock();
+    return *added;
+}
+
+RiskManagement::UnderlyingRisk& RiskManagement::addUnderlying(const std::string& underlying) {
+    auto inserted = underlyings_.try_emplace(underlying);
+    if (inserted.second) joinProductGroup(underlying, inserted.first->second);
+    return inserted.first->second;
+}
+
+void RiskManagement::joinProductGroup(const std::string& underlying, UnderlyingRisk& risk) {
+    // Both maps are node-based, so the pointers survive later insertions
+    auto mapped = marginParameters_.productGroups.find(underlying);
+    ProductGroup& group = productGroups_[mapped != marginParameters_.productGroups.end() ? mapped->second
+                                                                                          : underlying];
+    group.classes.push_back(&risk.margin);
+    risk.group = &group;
+}
+
+void RiskManagement::repriceUnderlying(UnderlyingRisk& risk, int64_t nowNs) {
+    // Rebuild this underlying's totals and class group risk from its held
+    // contracts; the portfolio moves by the difference. Unheld contracts
+    // are re-priced lazily, the next time an order checks them.
+    GreekTotals totals;
+    ClassGroupRisk margin;
+    for (auto& pair : risk.contracts) {
+        ContractRisk& contract = pair.second;
+        if (contract.quantity == 0.0) {
+            contract.priced = false;
+            continue;
+        }
+        priceContract(pair.first, contract, risk.spot, nowNs);
+        totals.delta += contract.perUnit.delta * contract.quantity;
+        totals.gamma += contract.perUnit.gamma * contract.quantity;
+        totals.theta += contract.perUnit.theta * contract.quantity;
+        totals.vega += contract.perUnit.vega * contract.quantity;
+        totals.rho += contract.perUnit.rho * contract.quantity;
+        totals.value += contract.perUnit.value * contract.quantity;
+        margin.add(contract.riskArray, contract.quantity, contract.option, 1.0);
+    }
+
+    portfolio_.add(risk.totals, totals);
+    risk.totals = totals;
+    risk.margin = margin;
+}
+
+void RiskManagement::refreshMargin(ProductGroup& group) {
+    // Sixteen sums over the group's class groups, independent of book size
+    double margin = productGroupMargin(group.classes, marginParameters_);
+    atomicAdd(margin_, margin - group.margin);
+    group.margin = margin;
+}
+
+RiskManagement::ContractRisk& RiskManagement::contractFor(UnderlyingRisk& underlying,
+                                                          const InstrumentKey& instrument) {
+    ContractRisk& contract = underlying.contracts[instrument];
+    refreshContract(underlying, instrument, contract);
+    return contract;
+}
+
+void RiskManagement::refreshContract(const UnderlyingRisk& underlying, const InstrumentKey& instrument,
+                                     ContractRisk& contract) const {
+    contract.option = instrument.strike > 0.0;
+    if (!contract.priced && underlying.spot > 0.0) {
+        priceContract(instrument, contract, underlying.spot, nowNanos());
+    }
+}
+
+void RiskManagement::priceContract(const InstrumentKey& instrument, ContractRisk& contract,
+                                   double spot, int64_t nowNs) const {
+    GreekTotals& unit = contract.perUnit;
+    unit = GreekTotals();
+    contract.priced = true;
+
+    // No strike: an order on the underlying itself
+    if (instrument.strike <= 0.0) {
+        unit.delta = 1.0;
+        unit.value = spot;
+        contract.riskArray = contractRiskArray(marginParameters_, spot, 0.0, instrument.isCall, 0.0,
+                                               DEFAULT_RISK_FREE_RATE, contract.volatility);
+        return;
+    }
+
+    double timeToExpiry = yearsToExpiry(instrument.expiry, nowNs);
+
+    double intrinsic = instrument.isCall ? spot - instrument.strike : instrument.strike - spot;
+    if (timeToExpiry <= 0.0) {
+        contract.riskArray = contractRiskArray(marginParameters_, spot, instrument.strike, instrument.isCall,
+                                               timeToExpiry, DEFAULT_RISK_FREE_RATE, contract.volatility);
+        unit.value = std::max(intrinsic, 0.0);
+        if (intrinsic > 0.0) unit.delta = instrument.isCall ? 1.0 : -1.0;
+        return;
+    }
+
+    BlackScholesModel::OptionParameters params{
+        spot,
+        instrument.strike,
+        DEFAULT_RISK_FREE_RATE,
+        contract.volatility,
+        timeToExpiry,
+        instrument.isCall
+    };
+    PricedOption priced = priceOption(pricingCache_.get(), params, &marginParameters_);
+    contract.riskArray = priced.riskArray;
+    unit.delta = priced.greeks.delta;
+    unit.gamma = priced.greeks.gamma;
+    unit.theta = priced.greeks.theta;
+    unit.vega = priced.greeks.vega;
+    unit.rho = priced.greeks.rho;
+    unit.value = priced.price;
+}
+
+void RiskManagement::applyContract(UnderlyingRisk& underlying, const ContractRisk& contract, double sign) {
+    double quantity = sign * contract.quantity;
+    if (quantity == 0.0) return;
+    const GreekTotals& unit = contract.perUnit;
+    GreekTotals& totals = underlying.totals;
+    totals.delta += unit.delta * quantity;
+    totals.gamma += unit.gamma * quantity;
+    totals.theta += unit.theta * quantity;
+    totals.vega += unit.vega * quantity;
+    totals.rho += unit.rho * quantity;
+    totals.value += unit.value * quantity;
+    underlying.margin.add(contract.riskArray, contract.quantity, contract.option, sign);
+}
+
+PricedOption RiskManagement::priceOption(PricingCache* cache, const BlackScholesModel::OptionParameters& params,
+                                         const MarginParameters* margin) {
+    if (cache) return cache->price(params, margin);
+    PricedOption priced;
+    priced.price = BlackScholesModel::calculateOptionPrice(params);
+    priced.greeks = BlackScholesModel::calculateGreeks(params);
+    if (margin) {
+        priced.riskArray = contractRiskArray(*margin, params.spot, params.strike, params.isCall,
+                                             params.timeToExpiry, params.riskFreeRate, params.volatility);
+    }
+    return priced;
+}
+
+void RiskManagement::PortfolioTotals::add(const GreekTotals& before, const GreekTotals& after) {
+    atomicAdd(delta, after.delta - before.delta);
+    atomicAdd(gamma, after.gamma - before.gamma);
+    atomicAdd(theta, after.theta - before.theta);
+    atomicAdd(vega, after.vega - before.vega);
+    atomicAdd(rho, after.rho - before.rho);
+    atomicAdd(value, after.value - before.value);
+}
+
+GreekTotals RiskManagement::PortfolioTotals::load() const {
+    GreekTotals totals;
+    totals.delta = delta.load();
+    totals.gamma = gamma.load();
+    totals.theta = theta.load();
+    totals.vega = vega.load();
+    totals.rho = rho.load();
+    totals.value = value.load();
+    return totals;
+}
+
+void RiskManagement::applyMargin(RiskMetrics& metrics, double margin, const RiskLimits& limits) {
+    metrics.marginRequirement = margin;
+    metrics.marginUtilization = limits.marginCapital > 0.0 ? margin / limits.marginCapital : 0.0;
+}
+
+bool RiskManagement::withinLimit(double current, double marginal, double limit) const {
+    // Trades that reduce a breached exposure are always allowed
+    double after = std::abs(current + marginal);
+    return after < limit || after <= std::abs(current);
+}
@@ -0,0 +1,101 @@
+#include "RiskPublisher.hpp"
+#include "RiskManagement.hpp"
+#include <cmath>
+#include <stdexcept>
+
+RiskPublisher::RiskPublisher(RiskManagement& risk, RiskPublisherConfig config)
+    : risk_(risk), config_(config) {}
+
+RiskPublisher::~RiskPublisher() {
+    stop();
+}
+
+void RiskPublisher::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&RiskPublisher::run, this);
+}
+
+void RiskPublisher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void RiskPublisher::addListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        throw std::logic_error("Risk listeners must be added before the publisher starts");
+    }
+    listeners_.push_back(std::move(listener));
+}
+
+void RiskPublisher::onUnderlyingPrice(const std::string& underlying, double spot) {
+    if (!(spot > 0.0)) return;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spots_[underlying] = spot;
+        double& reference = references_[underlying];
+        if (reference <= 0.0) reference = spot;
+        if (!moved_ && std::abs(spot / reference - 1.0) >= config_.significantMove) {
+            moved_ = true;
+            wake = true;
+        }
+    }
+    // Only the first significant tick wakes the thread; the rest just update spots_
+    if (wake) cv_.notify_one();
+}
+
+std::shared_ptr<const RiskSnapshot> RiskPublisher::latest() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+void RiskPublisher::run() {
+    using Clock = std::chrono::steady_clock;
+    std::unique_lock<std::mutex> lock(mutex_);
+    Clock::time_point last = Clock::now() - config_.coalesceWindow;
+    const char* trigger = "CADENCE";
+
+    while (running_) {
+        // Hold off until the window after the previous recompute has
+        // passed, so the rest of a burst lands in this one
+        cv_.wait_until(lock, last + config_.coalesceWindow, [this] { return !running_; });
+        if (!running_) break;
+
+        moved_ = false;
+        references_ = spots_;
+        lock.unlock();
+
+        std::shared_ptr<const RiskSnapshot> snapshot = compute(trigger);
+        for (const Listener& listener : listeners_) {
+            listener(snapshot);
+        }
+
+        lock.lock();
+        latest_ = std::move(snapshot);
+        last = Clock::now();
+        trigger = cv_.wait_until(lock, last + config_.cadence, [this] { return !running_ || moved_; })
+                      ? "MOVE" : "CADENCE";
+    }
+}
+
+std::shared_ptr<const RiskSnapshot> RiskPublisher::compute(const char* trigger) {
+    auto snapshot = std::make_shared<RiskSnapshot>();
+    snapshot->sequence = ++sequence_;
+    snapshot->timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    snapshot->trigger = trigger;
+    // Both reads come from the incrementally maintained totals: no re-pricing
+    snapshot->metrics = risk_.getCurrentRisk();
+    snapshot->underlyings = risk_.getUnderlyingRisks();
+    recomputes_.fetch_add(1, std::memory_order_relaxed);
+    return snapshot;
+}
@@ -0,0 +1,147 @@
+#include "ScenarioRisk.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+ScenarioSet makeHistoricalScenarios(
+    const std::unordered_map<std::string, std::vector<double>>& closes,
+    const std::unordered_map<std::string, std::vector<double>>& impliedVols,
+    size_t horizonDays) {
+
+    if (horizonDays == 0) {
+        throw std::invalid_argument("Scenario horizon must be at least one day");
+    }
+
+    ScenarioSet set;
+    size_t shortest = SIZE_MAX;
+    for (const auto& history : closes) {
+        set.underlyings.push_back(history.first);
+        shortest = std::min(shortest, history.second.size());
+    }
+    std::sort(set.underlyings.begin(), set.underlyings.end());
+    if (set.underlyings.empty() || shortest <= horizonDays) {
+        throw std::invalid_argument("Price histories are too short for a " +
+                                    std::to_string(horizonDays) + "-day horizon");
+    }
+
+    set.count = shortest - horizonDays;
+    const size_t width = set.underlyings.size();
+    set.spotShocks.assign(set.count * width, 0.0);
+
+    for (size_t u = 0; u < width; ++u) {
+        const std::vector<double>& history = closes.at(set.underlyings[u]);
+        size_t offset = history.size() - shortest;
+        for (size_t s = 0; s < set.count; ++s) {
+            double from = history[offset + s];
+            double to = history[offset + s + horizonDays];
+            set.spotShocks[s * width + u] = from > 0.0 ? to / from - 1.0 : 0.0;
+        }
+
+        auto vols = impliedVols.find(set.underlyings[u]);
+        if (vols == impliedVols.end() || vols->second.size() < shortest) continue;
+        if (set.volShocks.empty()) {
+            set.volShocks.assign(set.count * width, 0.0);
+        }
+        offset = vols->second.size() - shortest;
+        for (size_t s = 0; s < set.count; ++s) {
+            double from = vols->second[offset + s];
+            double to = vols->second[offset + s + horizonDays];
+            set.volShocks[s * width + u] = from > 0.0 ? to / from - 1.0 : 0.0;
+        }
+    }
+    return set;
+}
+
+ScenarioSet makeMonteCarloScenarios(
+    const std::vector<std::string>& underlyings,
+    const MonteCarloParameters& parameters,
+    const std::unordered_map<std::string, double>& volatilities) {
+
+    if (parameters.correlation < 0.0 || parameters.correlation > 1.0 ||
+        std::abs(parameters.spotVolCorrelation) > 1.0) {
+        throw std::invalid_argument("Correlations must be within [0, 1] and [-1, 1]");
+    }
+
+    ScenarioSet set;
+    set.underlyings = underlyings;
+    set.count = parameters.scenarios;
+    const size_t width = underlyings.size();
+    set.spotShocks.resize(set.count * width);
+    set.volShocks.resize(set.count * width);
+
+    const double horizon = parameters.horizonDays / 252.0;
+    const double sqrtHorizon = std::sqrt(horizon);
+    const double market = std::sqrt(parameters.correlation);
+    const double idiosyncratic = std::sqrt(1.0 - parameters.correlation);
+    const double volVariance = parameters.volOfVol * parameters.volOfVol * horizon;
+    const double volCorrelated = parameters.spotVolCorrelation;
+    const double volIndependent = std::sqrt(1.0 - volCorrelated * volCorrelated);
+
+    std::vector<double> sigma(width);
+    for (size_t u = 0; u < width; ++u) {
+        auto it = volatilities.find(underlyings[u]);
+        sigma[u] = it != volatilities.end() ? it->second : parameters.defaultVolatility;
+    }
+
+    std::mt19937_64 rng(parameters.seed);
+    std::normal_distribution<double> normal;
+    for (size_t s = 0; s < set.count; ++s) {
+        double factor = normal(rng);
+        for (size_t u = 0; u < width; ++u) {
+            double z = market * factor + idiosyncratic * normal(rng);
+            double spotVariance = sigma[u] * sigma[u] * horizon;
+            set.spotShocks[s * width + u] = std::exp(sigma[u] * sqrtHorizon * z - 0.5 * spotVariance) - 1.0;
+
+            double w = volCorrelated * z + volIndependent * normal(rng);
+            set.volShocks[s * width + u] = std::exp(std::sqrt(volVariance) * w - 0.5 * volVariance) - 1.0;
+        }
+    }
+    return set;
+}
+
+namespace {
+    std::vector<double> gridAxis(double from, double to, double step, const char* name) {
+        if (!(step > 0.0) || to < from) {
+            throw std::invalid_argument(std::string("Invalid ") + name + " stress range");
+        }
+        // Rounded so that accumulated steps still land on the end point
+        size_t count = static_cast<size_t>(std::floor((to - from) / step + 1e-9)) + 1;
+        std::vector<double> axis(count);
+        for (size_t i = 0; i < count; ++i) {
+            axis[i] = from + static_cast<double>(i) * step;
+        }
+        return axis;
+    }
+}
+
+std::vector<double> StressGridSpec::spotShifts() const {
+    return gridAxis(spotMin, spotMax, spotStep, "spot");
+}
+
+std::vector<double> StressGridSpec::volShifts() const {
+    return gridAxis(volMin, volMax, volStep, "volatility");
+}
+
+std::vector<ScenarioRiskLevel> lossQuantiles(std::vector<double> pnl,
+                                             const std::vector<double>& confidenceLevels) {
+    std::vector<ScenarioRiskLevel> levels;
+    if (pnl.empty()) return levels;
+    std::sort(pnl.begin(), pnl.end());   // Worst first
+
+    for (double confidence : confidenceLevels) {
+        if (!(confidence > 0.0 && confidence < 1.0)) {
+            throw std::invalid_argument("Confidence level must be between 0 and 1");
+        }
+        // The epsilon keeps 10000 * (1 - 0.99) from rounding up to 101
+        double tailSize = static_cast<double>(pnl.size()) * (1.0 - confidence);
+        size_t tail = static_cast<size_t>(std::ceil(tailSize - 1e-9));
+        tail = std::max<size_t>(1, std::min(tail, pnl.size()));
+
+        double tailSum = 0.0;
+        for (size_t i = 0; i < tail; ++i) tailSum += pnl[i];
+        levels.push_back(ScenarioRiskLevel{confidence, -pnl[tail - 1], -tailSum / static_cast<double>(tail)});
+    }
+    return levels;
+}
@@ -0,0 +1,260 @@
+#include "SharedQuoteTable.hpp"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    struct Layout {
+        size_t slots;
+        size_t directory;
+        size_t index;
+        size_t size;
+    };
+
+    size_t alignUp(size_t offset) {
+        return (offset + 63) & ~size_t(63);
+    }
+
+    uint32_t indexSizeFor(uint32_t capacity) {
+        uint32_t size = 1;
+        while (size < 2 * capacity) size <<= 1;
+        return size;
+    }
+
+    Layout layoutFor(uint32_t capacity, uint32_t indexSize) {
+        Layout layout;
+        layout.slots = alignUp(sizeof(SharedQuoteHeader));
+        layout.directory = alignUp(layout.slots + capacity * sizeof(SharedQuoteSlot));
+        layout.index = alignUp(layout.directory + capacity * sizeof(SharedDirectoryEntry));
+        layout.size = alignUp(layout.index + indexSize * sizeof(std::atomic<uint32_t>));
+        return layout;
+    }
+
+    // POSIX names are "/name"
+    std::string shmName(const std::string& name) {
+        return !name.empty() && name[0] == '/' ? name : "/" + name;
+    }
+
+    // Fixed-width key fields, as the directory stores them
+    struct ContractKey {
+        char underlying[16];
+        char expiry[11];
+        bool isCall;
+        double strike;
+    };
+
+    bool makeKey(const std::string& underlying, const std::string& optionType, double strike,
+                 const std::string& expiry, ContractKey& key) {
+        if (underlying.size() >= sizeof(key.underlying) || expiry.size() >= sizeof(key.expiry)) return false;
+        std::memset(&key, 0, sizeof(key));
+        std::memcpy(key.underlying, underlying.data(), underlying.size());
+        std::memcpy(key.expiry, expiry.data(), expiry.size());
+        key.isCall = optionType == "CALL";
+        key.strike = strike;
+        return true;
+    }
+
+    // FNV-1a, the same in every process that maps the table
+    uint32_t hashKey(const ContractKey& key) {
+        uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](const char* data, size_t len) {
+            for (size_t i = 0; i < len && data[i] != '\0'; ++i) {
+                h = (h ^ static_cast<unsigned char>(data[i])) * 1099511628211ull;
+            }
+        };
+        mix(key.underlying, sizeof(key.underlying));
+        mix(key.expiry, sizeof(key.expiry));
+        h = (h ^ (key.isCall ? 1u : 2u)) * 1099511628211ull;
+        // Byte by byte: round strikes have all-zero low mantissa bits,
+        // which a single XOR would leave out of the low bits of the hash
+        unsigned char strike[sizeof(key.strike)];
+        std::memcpy(strike, &key.strike, sizeof(strike));
+        for (unsigned char byte : strike) {
+            h = (h ^ byte) * 1099511628211ull;
+        }
+        return static_cast<uint32_t>(h ^ (h >> 32));
+    }
+
+    bool sameContract(const SharedDirectoryEntry& contract, const ContractKey& key) {
+        return std::strncmp(contract.underlying, key.underlying, sizeof(key.underlying)) == 0 &&
+               std::strncmp(contract.expiry, key.expiry, sizeof(key.expiry)) == 0 &&
+               contract.isCall == key.isCall && contract.strike == key.strike;
+    }
+
+    std::runtime_error shmError(const std::string& what, const std::string& name) {
+        return std::runtime_error(what + " " + name + ": " + std::strerror(errno));
+    }
+}
+
+SharedQuoteTable::SharedQuoteTable(const std::string& name, uint32_t capacity)
+    : name_(shmName(name)) {
+    if (capacity == 0 || capacity > (1u << 24)) {
+        throw std::invalid_argument("Shared quote table capacity must be between 1 and 2^24");
+    }
+    const uint32_t indexSize = indexSizeFor(capacity);
+    const Layout layout = layoutFor(capacity, indexSize);
+    size_ = layout.size;
+
+    // A region left by an earlier run is replaced, not reused: its readers
+    // keep the old mapping and see it go stale
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) throw shmError("Failed to create shared quote table", name_);
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        std::runtime_error error = shmError("Failed to size shared quote table", name_);
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw error;
+    }
+    region_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region_ == MAP_FAILED) {
+        std::runtime_error error = shmError("Failed to map shared quote table", name_);
+        shm_unlink(name_.c_str());
+        throw error;
+    }
+
+    // The region comes zero-filled, which is a valid state for every
+    // atomic in it; only the header needs writing
+    char* base = static_cast<char*>(region_);
+    header_ = new (base) SharedQuoteHeader();
+    slots_ = reinterpret_cast<SharedQuoteSlot*>(base + layout.slots);
+    directory_ = reinterpret_cast<SharedDirectoryEntry*>(base + layout.directory);
+    index_ = reinterpret_cast<std::atomic<uint32_t>*>(base + layout.index);
+    defined_.assign(capacity, false);
+
+    header_->layoutVersion = SHARED_QUOTE_LAYOUT_VERSION;
+    header_->capacity = capacity;
+    header_->indexSize = indexSize;
+    header_->createdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header_->magic.store(SHARED_QUOTE_MAGIC, std::memory_order_release);
+}
+
+SharedQuoteTable::~SharedQuoteTable() {
+    munmap(region_, size_);
+    shm_unlink(name_.c_str());
+}
+
+bool SharedQuoteTable::publish(uint32_t id, const OptionData& data) {
+    uint32_t slotIndex = id - 1;
+    if (id == 0 || id > header_->capacity || (!defined_[slotIndex] && !define(slotIndex, data))) {
+        header_->overflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    SharedQuoteSlot& slot = slots_[slotIndex];
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.bid.store(data.bid, std::memory_order_relaxed);
+    slot.ask.store(data.ask, std::memory_order_relaxed);
+    slot.last.store(data.lastPrice, std::memory_order_relaxed);
+    slot.volume.store(data.volume, std::memory_order_relaxed);
+    slot.impliedVol.store(data.impliedVol, std::memory_order_relaxed);
+    slot.delta.store(data.delta, std::memory_order_relaxed);
+    slot.gamma.store(data.gamma, std::memory_order_relaxed);
+    slot.theta.store(data.theta, std::memory_order_relaxed);
+    slot.vega.store(data.vega, std::memory_order_relaxed);
+    slot.rho.store(data.rho, std::memory_order_relaxed);
+    slot.updateNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    return true;
+}
+
+// The directory entry is written, then marked defined, then indexed, so a
+// reader that gets to it by ID or by key sees it whole. A contract that
+// does not fit stays undefined, and its slot unused.
+bool SharedQuoteTable::define(uint32_t slot, const OptionData& data) {
+    ContractKey key;
+    if (!makeKey(data.underlying, data.optionType, data.strike, data.expiry, key)) return false;
+    SharedDirectoryEntry& contract = directory_[slot];
+    std::memcpy(contract.underlying, key.underlying, sizeof(key.underlying));
+    std::memcpy(contract.expiry, key.expiry, sizeof(key.expiry));
+    contract.isCall = key.isCall;
+    contract.strike = key.strike;
+    contract.defined.store(1, std::memory_order_release);
+
+    const uint32_t mask = header_->indexSize - 1;
+    for (uint32_t probe = hashKey(key) & mask;; probe = (probe + 1) & mask) {
+        if (index_[probe].load(std::memory_order_relaxed) == 0) {
+            index_[probe].store(slot + 1, std::memory_order_release);
+            break;
+        }
+    }
+    defined_[slot] = true;
+    header_->contracts.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+SharedQuoteReader::SharedQuoteReader(const std::string& name) {
+    const std::string path = shmName(name);
+    int fd = shm_open(path.c_str(), O_RDONLY, 0);
+    if (fd < 0) throw shmError("Failed to open shared quote table", path);
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(SharedQuoteHeader)) {
+        close(fd);
+        throw std::runtime_error("Not a shared quote table: " + path);
+    }
+    size_ = static_cast<size_t>(status.st_size);
+    region_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (region_ == MAP_FAILED) throw shmError("Failed to map shared quote table", path);
+
+    const char* base = static_cast<const char*>(region_);
+    header_ = reinterpret_cast<const SharedQuoteHeader*>(base);
+    if (header_->magic.load(std::memory_order_acquire) != SHARED_QUOTE_MAGIC ||
+        header_->layoutVersion != SHARED_QUOTE_LAYOUT_VERSION ||
+        header_->indexSize != indexSizeFor(header_->capacity) ||
+        layoutFor(header_->capacity, header_->indexSize).size != size_) {
+        munmap(region_, size_);
+        throw std::runtime_error("Not a shared quote table of layout version " +
+                                 std::to_string(SHARED_QUOTE_LAYOUT_VERSION) + ": " + path);
+    }
+
+    const Layout layout = layoutFor(header_->capacity, header_->indexSize);
+    slots_ = reinterpret_cast<const SharedQuoteSlot*>(base + layout.slots);
+    directory_ = reinterpret_cast<const SharedDirectoryEntry*>(base + layout.directory);
+    index_ = reinterpret_cast<const std::atomic<uint32_t>*>(base + layout.index);
+}
+
+SharedQuoteReader::~SharedQuoteReader() {
+    munmap(region_, size_);
+}
+
+bool SharedQuoteReader::find(const std::string& underlying, const std::string& optionType, double strike,
+                             const std::string& expiry, uint32_t& id) const {
+    ContractKey key;
+    if (!makeKey(underlying, optionType, strike, expiry, key)) return false;
+
+    const uint32_t mask = header_->indexSize - 1;
+    for (uint32_t probe = hashKey(key) & mask;; probe = (probe + 1) & mask) {
+        uint32_t entry = index_[probe].load(std::memory_order_acquire);
+        if (entry == 0) return false;
+        if (sameContract(directory_[entry - 1], key)) {
+            id = entry;
+            return true;
+        }
+    }
+}
+
+bool SharedQuoteReader::contract(uint32_t id, SharedContract& contract) const {
+    if (id == 0 || id > header_->capacity) return false;
+    const SharedDirectoryEntry& entry = directory_[id - 1];
+    if (entry.defined.load(std::memory_order_acquire) == 0) return false;
+    contract.underlying = entry.underlying;
+    contract.optionType = entry.isCall ? "CALL" : "PUT";
+    contract.strike = entry.strike;
+    contract.expiry = entry.expiry;
+    return true;
+}
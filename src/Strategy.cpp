@@ -0,0 +1,80 @@
+#include "Strategy.hpp"
+#include <stdexcept>
+
+namespace {
+    StrategyLeg leg(const std::string& underlying, const std::string& expiry, bool isCall,
+                    double strike, int32_t ratio) {
+        return StrategyLeg{makeInstrumentKey(underlying, isCall ? "CALL" : "PUT", strike, expiry), ratio};
+    }
+}
+
+void validateStrategy(const Strategy& strategy) {
+    if (strategy.legs.empty() || strategy.legs.size() > MAX_STRATEGY_LEGS) {
+        throw std::invalid_argument("A strategy needs between 1 and " +
+                                    std::to_string(MAX_STRATEGY_LEGS) + " legs");
+    }
+    for (size_t i = 0; i < strategy.legs.size(); ++i) {
+        const StrategyLeg& current = strategy.legs[i];
+        if (current.ratio == 0) {
+            throw std::invalid_argument("Strategy leg " + std::to_string(i + 1) + " has a zero ratio");
+        }
+        if (current.instrument.underlying[0] == '\0') {
+            throw std::invalid_argument("Strategy leg " + std::to_string(i + 1) + " has no underlying");
+        }
+        for (size_t j = 0; j < i; ++j) {
+            if (strategy.legs[j].instrument == current.instrument) {
+                throw std::invalid_argument("Strategy legs " + std::to_string(j + 1) + " and " +
+                                            std::to_string(i + 1) + " trade the same contract");
+            }
+        }
+    }
+}
+
+Strategy makeVerticalSpread(const std::string& underlying, const std::string& expiry, bool isCall,
+                            double lowerStrike, double upperStrike) {
+    if (!(lowerStrike < upperStrike)) {
+        throw std::invalid_argument("Vertical spread strikes must ascend");
+    }
+    return Strategy{isCall ? "Bull call spread" : "Bear put spread",
+                    {leg(underlying, expiry, isCall, lowerStrike, isCall ? 1 : -1),
+                     leg(underlying, expiry, isCall, upperStrike, isCall ? -1 : 1)}};
+}
+
+Strategy makeStraddle(const std::string& underlying, const std::string& expiry, double strike) {
+    return Strategy{"Straddle",
+                    {leg(underlying, expiry, true, strike, 1),
+                     leg(underlying, expiry, false, strike, 1)}};
+}
+
+Strategy makeStrangle(const std::string& underlying, const std::string& expiry,
+                      double putStrike, double callStrike) {
+    if (!(putStrike < callStrike)) {
+        throw std::invalid_argument("Strangle put strike must be below the call strike");
+    }
+    return Strategy{"Strangle",
+                    {leg(underlying, expiry, false, putStrike, 1),
+                     leg(underlying, expiry, true, callStrike, 1)}};
+}
+
+Strategy makeIronCondor(const std::string& underlying, const std::string& expiry,
+                        double putWing, double putShort, double callShort, double callWing) {
+    if (!(putWing < putShort && putShort < callShort && callShort < callWing)) {
+        throw std::invalid_argument("Iron condor strikes must ascend");
+    }
+    return Strategy{"Iron condor",
+                    {leg(underlying, expiry, false, putWing, 1),
+                     leg(underlying, expiry, false, putShort, -1),
+                     leg(underlying, expiry, true, callShort, -1),
+                     leg(underlying, expiry, true, callWing, 1)}};
+}
+
+Strategy makeCalendarSpread(const std::string& underlying, const std::string& nearExpiry,
+                            const std::string& farExpiry, bool isCall, double strike) {
+    // ISO dates compare chronologically as strings
+    if (!(nearExpiry < farExpiry)) {
+        throw std::invalid_argument("Calendar spread near expiry must precede the far expiry");
+    }
+    return Strategy{"Calendar spread",
+                    {leg(underlying, nearExpiry, isCall, strike, -1),
+                     leg(underlying, farExpiry, isCall, strike, 1)}};
+}
@@ -0,0 +1,41 @@
+#include "TscClock.hpp"
+#include <thread>
+
+namespace {
+    double calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+        using Clock = std::chrono::steady_clock;
+        // Each end pairs a clock read with the TSC read it brackets most
+        // tightly, so neither end carries a stray preemption
+        auto sample = [](Clock::time_point& time, uint64_t& ticks) {
+            uint64_t best = UINT64_MAX;
+            for (int i = 0; i < 16; ++i) {
+                uint64_t before = __rdtsc();
+                Clock::time_point read = Clock::now();
+                uint64_t after = __rdtsc();
+                if (after - before < best) {
+                    best = after - before;
+                    time = read;
+                    ticks = before + (after - before) / 2;
+                }
+            }
+        };
+
+        Clock::time_point startTime, endTime;
+        uint64_t startTicks = 0, endTicks = 0;
+        sample(startTime, startTicks);
+        std::this_thread::sleep_for(TscClock::CALIBRATION_TIME);
+        sample(endTime, endTicks);
+
+        double nanos = std::chrono::duration<double, std::nano>(endTime - startTime).count();
+        return endTicks > startTicks ? nanos / static_cast<double>(endTicks - startTicks) : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+}
+
+double TscClock::nanosPerTick() {
+    static const double calibrated = calibrate();
+    return calibrated;
+}
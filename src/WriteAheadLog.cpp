@@ -0,0 +1,347 @@
+#include "WriteAheadLog.hpp"
+#include "BinaryLog.hpp"
+#include "FileUtils.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    const std::string SEGMENT_PREFIX = "wal-";
+    const std::string SEGMENT_SUFFIX = ".log";
+
+    int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    std::string segmentName(uint64_t firstSequence) {
+        char name[48];
+        std::snprintf(name, sizeof(name), "wal-%020" PRIu64 ".log", firstSequence);
+        return name;
+    }
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& directory)
+    : WriteAheadLog(directory, Options{}) {}
+
+WriteAheadLog::WriteAheadLog(const std::string& directory, const Options& options)
+    : directory_(directory)
+    , options_(options) {
+    if (options_.lanes == 0) {
+        throw std::invalid_argument("Write-ahead log needs at least one lane");
+    }
+    ensureDirectory(directory_);
+
+    lanes_.reset(new Lane[options_.lanes]);
+    flushing_.resize(options_.lanes);
+    size_t laneBytes = std::max(options_.flushBytes / options_.lanes, sizeof(Frame)) * 2;
+    for (size_t i = 0; i < options_.lanes; ++i) {
+        lanes_[i].pending.reserve(laneBytes);
+        flushing_[i].reserve(laneBytes);
+    }
+    batch_.reserve(options_.flushBytes * 2);
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    stop();
+}
+
+uint32_t WriteAheadLog::checksum(const OrderEvent& event) {
+    // FNV-1a over the event bytes as written
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&event);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(OrderEvent); ++i) {
+        h = (h ^ bytes[i]) * 16777619u;
+    }
+    return h;
+}
+
+std::vector<WriteAheadLog::Segment> WriteAheadLog::listSegments() const {
+    std::vector<Segment> segments;
+    for (const auto& name : listFiles(directory_, SEGMENT_PREFIX, SEGMENT_SUFFIX)) {
+        // Zero-padded names sort in sequence order
+        std::string digits = name.substr(SEGMENT_PREFIX.size(),
+                                         name.size() - SEGMENT_PREFIX.size() - SEGMENT_SUFFIX.size());
+        char* end = nullptr;
+        uint64_t first = std::strtoull(digits.c_str(), &end, 10);
+        if (digits.empty() || *end != '\0') continue;
+        segments.push_back(Segment{first, directory_ + "/" + name});
+    }
+    return segments;
+}
+
+size_t WriteAheadLog::recover(uint64_t afterSequence, const std::function<void(const OrderEvent&)>& apply) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        throw std::runtime_error("Write-ahead log must be recovered before it is started");
+    }
+
+    std::vector<Segment> segments = listSegments();
+    uint64_t expected = afterSequence + 1;
+    size_t replayed = 0;
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+        // Every event in this segment is covered by the snapshot
+        if (i + 1 < segments.size() && segments[i + 1].firstSequence <= expected) {
+            continue;
+        }
+
+        MappedFile file(segments[i].path);
+        size_t frames = file.size() / sizeof(Frame);
+        const Frame* frame = reinterpret_cast<const Frame*>(file.data());
+        size_t valid = 0;
+
+        for (; valid < frames; ++valid, ++frame) {
+            if (frame->magic != FRAME_MAGIC || frame->checksum != checksum(frame->event)) {
+                break;
+            }
+            uint64_t sequence = frame->event.sequence;
+            if (sequence < expected) continue;
+            if (sequence != expected) {
+                throw std::runtime_error("Write-ahead log gap: expected event " + std::to_string(expected) +
+                                         ", found " + std::to_string(sequence) + " in " + segments[i].path);
+            }
+            apply(frame->event);
+            ++expected;
+            ++replayed;
+        }
+
+        if (valid * sizeof(Frame) != file.size()) {
+            if (i + 1 != segments.size()) {
+                throw std::runtime_error("Corrupt write-ahead log segment " + segments[i].path);
+            }
+            // Torn write from a crash mid-flush; nothing after it was acknowledged as durable
+            std::cerr << "Write-ahead log: discarding torn tail of " << segments[i].path
+                      << " after " << valid << " events" << std::endl;
+            file = MappedFile();
+            truncateFile(segments[i].path, valid * sizeof(Frame));
+        }
+    }
+
+    lastSequence_ = expected - 1;
+    flushedSequence_ = expected - 1;
+    durableSequence_ = expected - 1;
+    recovered_ = true;
+    return replayed;
+}
+
+void WriteAheadLog::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    if (!recovered_) {
+        throw std::runtime_error("Write-ahead log must be recovered before it is started");
+    }
+
+    openSegment(lastSequence_.load() + 1);
+    running_ = true;
+    flushThread_ = std::thread(&WriteAheadLog::flushLoop, this);
+}
+
+void WriteAheadLog::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    flushCv_.notify_all();
+    if (flushThread_.joinable()) {
+        flushThread_.join();
+    }
+    durableCv_.notify_all();
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+uint64_t WriteAheadLog::append(OrderEvent::Type type, const OrderRecord& order, size_t lane) {
+    Lane& target = lanes_[lane % options_.lanes];
+    uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+
+        // Frames are built in place; resize zeroes the padding bytes
+        size_t offset = target.pending.size();
+        target.pending.resize(offset + sizeof(Frame));
+        Frame* frame = reinterpret_cast<Frame*>(target.pending.data() + offset);
+
+        // Taken under the lane lock, so once the flusher holds every lane
+        // each sequence up to lastSequence_ is in some lane's buffer
+        sequence = lastSequence_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        frame->magic = FRAME_MAGIC;
+        frame->event.sequence = sequence;
+        frame->event.timestampNs = nowNanos();
+        frame->event.type = type;
+        frame->event.order = order;
+        frame->checksum = checksum(frame->event);
+    }
+
+    eventsAppended_.fetch_add(1, std::memory_order_relaxed);
+    uint64_t unflushed = sequence - flushedSequence_.load(std::memory_order_relaxed);
+    if (unflushed * sizeof(Frame) >= options_.flushBytes) {
+        flushCv_.notify_one();
+    }
+    return sequence;
+}
+
+void WriteAheadLog::waitDurable(uint64_t sequence) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushCv_.notify_one();
+    durableCv_.wait(lock, [&] {
+        return durableSequence_.load(std::memory_order_acquire) >= sequence || !running_;
+    });
+}
+
+void WriteAheadLog::truncateBefore(uint64_t sequence) {
+    std::vector<Segment> segments = listSegments();
+
+    // The newest segment is the one being written, so it always stays
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+        if (segments[i + 1].firstSequence > sequence + 1) break;
+        if (::unlink(segments[i].path.c_str()) != 0) {
+            LOG_WARN("Write-ahead log: failed to remove {}: {}", segments[i].path, std::strerror(errno));
+        }
+    }
+}
+
+WriteAheadLog::Stats WriteAheadLog::getStats() const {
+    Stats stats{};
+    stats.eventsAppended = eventsAppended_;
+    stats.batchesFlushed = batchesFlushed_;
+    stats.bytesWritten = bytesWritten_;
+    stats.durableSequence = durableSequence_;
+    return stats;
+}
+
+void WriteAheadLog::openSegment(uint64_t firstSequence) {
+    std::string path = directory_ + "/" + segmentName(firstSequence);
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open write-ahead log segment " + path + ": " + std::strerror(errno));
+    }
+    syncDirectory(directory_);
+
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = fd;
+    segmentSize_ = 0;
+}
+
+void WriteAheadLog::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        flushCv_.wait_for(lock, options_.flushInterval, [this] {
+            uint64_t unflushed = lastSequence_.load(std::memory_order_relaxed) -
+                                 flushedSequence_.load(std::memory_order_relaxed);
+            return !running_ || unflushed * sizeof(Frame) >= options_.flushBytes;
+        });
+        bool stopping = !running_;
+        lock.unlock();
+
+        // Group commit: everything appended since the last flush goes out
+        // with a single write and a single fdatasync
+        uint64_t batchLast = collectBatch();
+        if (!batch_.empty()) {
+            writeBatch(batch_);
+            if (segmentSize_ >= options_.segmentBytes) {
+                openSegment(batchLast + 1);
+            }
+        }
+
+        lock.lock();
+        if (!batch_.empty()) {
+            durableSequence_.store(batchLast, std::memory_order_release);
+            durableCv_.notify_all();
+        }
+        if (stopping) break;
+    }
+}
+
+uint64_t WriteAheadLog::collectBatch() {
+    // With every lane held no append is half done, so the lanes between
+    // them hold exactly the sequences after the last batch
+    uint64_t batchFirst, batchLast;
+    {
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(options_.lanes);
+        for (size_t i = 0; i < options_.lanes; ++i) {
+            locks.emplace_back(lanes_[i].mutex);
+        }
+        for (size_t i = 0; i < options_.lanes; ++i) {
+            lanes_[i].pending.swap(flushing_[i]);
+        }
+        batchFirst = flushedSequence_.load(std::memory_order_relaxed) + 1;
+        batchLast = lastSequence_.load(std::memory_order_acquire);
+        flushedSequence_.store(batchLast, std::memory_order_relaxed);
+    }
+
+    // Each lane is in sequence order and together they hold every sequence
+    // after the previous batch, so the merge repeatedly takes the run of
+    // consecutive frames from the lane holding the next sequence. With one
+    // lane that is a single copy.
+    batch_.clear();
+    std::vector<size_t> offsets(options_.lanes, 0);
+    uint64_t next = batchFirst;
+    while (next <= batchLast) {
+        size_t lane = 0;
+        for (; lane < options_.lanes; ++lane) {
+            const std::vector<char>& frames = flushing_[lane];
+            if (offsets[lane] < frames.size() &&
+                reinterpret_cast<const Frame*>(frames.data() + offsets[lane])->event.sequence == next) {
+                break;
+            }
+        }
+        if (lane == options_.lanes) {
+            std::cerr << "Write-ahead log lanes are missing event " << next << std::endl;
+            std::abort();
+        }
+
+        const std::vector<char>& frames = flushing_[lane];
+        size_t begin = offsets[lane];
+        size_t end = begin;
+        while (end < frames.size() && reinterpret_cast<const Frame*>(frames.data() + end)->event.sequence == next) {
+            end += sizeof(Frame);
+            ++next;
+        }
+        batch_.insert(batch_.end(), frames.begin() + begin, frames.begin() + end);
+        offsets[lane] = end;
+    }
+    for (std::vector<char>& flushing : flushing_) {
+        flushing.clear();
+    }
+    return batchLast;
+}
+
+void WriteAheadLog::writeBatch(const std::vector<char>& batch) {
+    const char* data = batch.data();
+    size_t remaining = batch.size();
+    while (remaining > 0) {
+        ssize_t written = ::write(fd_, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            // Carrying on would acknowledge orders that can never be recovered
+            std::cerr << "Write-ahead log write failed: " << std::strerror(errno) << std::endl;
+            std::abort();
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+
+    if (::fdatasync(fd_) != 0) {
+        std::cerr << "Write-ahead log sync failed: " << std::strerror(errno) << std::endl;
+        std::abort();
+    }
+
+    segmentSize_ += batch.size();
+    bytesWritten_.fetch_add(batch.size(), std::memory_order_relaxed);
+    batchesFlushed_.fetch_add(1, std::memory_order_relaxed);
+}
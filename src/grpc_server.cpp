@@ -1,15 +1,96 @@
 #include <grpcpp/grpcpp.h>
 #include <boost/asio.hpp>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include "BinaryLog.hpp"
+#include "Metrics.hpp"
 #include "MarketDataHandler.hpp"
 #include "OrderManagementSystem.hpp"
+#include "DeltaHedger.hpp"
 #include "ExecutionEngine.hpp"
+#include "OrderEventJournal.hpp"
+#include "OrderTracer.hpp"
 #include "RiskManagement.hpp"
+#include "RiskPublisher.hpp"
 #include "services/market_data_service.hpp"
+#include "services/market_data_service_v2.hpp"
+#include "services/metrics_service.hpp"
 #include "services/order_management_service.hpp"
+#include "services/order_management_service_v2.hpp"
+#include "services/quote_fanout.hpp"
 #include "services/execution_service.hpp"
+#include "services/risk_service.hpp"
+#include "services/rpc_server.hpp"
+
+namespace {
+    // Numeric settings are read before anything starts, so a malformed one
+    // stops the server with a message naming it instead of an exception
+    [[noreturn]] void badSetting(const char* name, const char* value, const char* expected) {
+        std::cerr << "Invalid " << name << "=\"" << value << "\": expected " << expected << std::endl;
+        std::exit(1);
+    }
+
+    long envInteger(const char* name, long fallback, long min, long max, const char* expected) {
+        const char* value = std::getenv(name);
+        if (!value) return fallback;
+        char* end = nullptr;
+        errno = 0;
+        long parsed = std::strtol(value, &end, 10);
+        if (end == value || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) {
+            badSetting(name, value, expected);
+        }
+        return parsed;
+    }
+
+    double envNumber(const char* name, double fallback, double min, double max, const char* expected) {
+        const char* value = std::getenv(name);
+        if (!value) return fallback;
+        char* end = nullptr;
+        errno = 0;
+        double parsed = std::strtod(value, &end);
+        // Written to reject NaN as well
+        if (end == value || *end != '\0' || errno == ERANGE || !(parsed >= min && parsed <= max)) {
+            badSetting(name, value, expected);
+        }
+        return parsed;
+    }
+}
 
 void RunServer() {
     std::string server_address("0.0.0.0:50051");
+
+    const long metricsInterval = envInteger("METRICS_INTERVAL_SECONDS", 10, 1, 86400,
+                                            "whole seconds from 1 to 86400");
+    const double traceSampleRate = envNumber("ORDER_TRACE_SAMPLE_RATE", TraceOptions{}.sampleRate, 0.0, 1.0,
+                                             "a fraction from 0 to 1");
+    const double hedgeBand = envNumber("HEDGE_DELTA_BAND", 0.0, std::numeric_limits<double>::min(), 1e12,
+                                       "a positive delta");
+    const long cqThreads = envInteger("GRPC_CQ_THREADS", 0, 0, 1024, "a thread count from 0 to 1024");
+    const long firstCpu = envInteger("GRPC_PIN_CQ_THREADS", -1, 0, std::numeric_limits<int>::max(),
+                                     "a CPU number");
+
+    // Per-order log lines go through the binary log: LOG_FILE names the
+    // file, stdout by default
+    LogOptions logOptions;
+    if (const char* logFile = std::getenv("LOG_FILE")) logOptions.path = logFile;
+    BinaryLog::start(logOptions);
+
+    // Stage latencies and counters are served by MetricsService; METRICS_FILE
+    // also names a Prometheus text file rewritten every METRICS_INTERVAL_SECONDS
+    if (const char* metricsFile = std::getenv("METRICS_FILE")) {
+        Metrics::startDump(metricsFile, std::chrono::seconds(metricsInterval));
+    }
+
+    // ORDER_TRACE_FILE turns on per-order tracing to that file (Chrome
+    // trace JSON) for ORDER_TRACE_SAMPLE_RATE of orders, 1% by default
+    if (const char* traceFile = std::getenv("ORDER_TRACE_FILE")) {
+        TraceOptions traceOptions;
+        traceOptions.path = traceFile;
+        traceOptions.sampleRate = traceSampleRate;
+        OrderTracer::start(traceOptions);
+    }
     
     // Initialize core components
     boost::asio::io_context io_context;
@@ -19,39 +100,99 @@ void RunServer() {
     OrderManagementSystem oms;
     ExecutionEngine execEngine;
     RiskManagement riskMgr;
+    RiskPublisher riskPublisher(riskMgr);
 
     // Connect components
     execEngine.setOrderManagementSystem(&oms);
     oms.setExecutionEngine(&execEngine);
 
-    // Initialize services
-    MarketDataServiceImpl marketDataService(mdHandler);
+    // Restore OMS state from the previous run and journal from here on
+    const char* dataDir = std::getenv("OMS_DATA_DIR");
+    oms.enablePersistence(dataDir ? dataDir : "oms_data");
+
+    // Pre-trade risk runs against live Greeks, re-priced on every spot tick;
+    // the publisher decides from the same ticks when to push fresh snapshots
+    riskMgr.enablePricingCache();
+    oms.setRiskManager(&riskMgr);
+
+    // Automatic delta hedging is opt-in: HEDGE_DELTA_BAND sets the net delta
+    // per underlying beyond which it hedges, back to a quarter of that
+    std::unique_ptr<DeltaHedger> hedger;
+    if (hedgeBand > 0.0) {
+        DeltaHedgerConfig hedgeConfig;
+        hedgeConfig.band.trigger = hedgeBand;
+        hedgeConfig.band.target = hedgeConfig.band.trigger / 4.0;
+        hedger.reset(new DeltaHedger(oms, riskMgr, hedgeConfig));
+    }
+
+    // MARKET_DATA_SHM names a shared-memory quote table for co-located
+    // readers (see SharedQuoteReader)
+    if (const char* quoteTable = std::getenv("MARKET_DATA_SHM")) {
+        mdHandler.enableSharedQuotes(quoteTable);
+    }
+
+    mdHandler.setPriceCallback([&riskMgr, &riskPublisher, &hedger](const std::string& symbol, double price) {
+        riskMgr.onUnderlyingPrice(symbol, price);
+        riskPublisher.onUnderlyingPrice(symbol, price);
+        if (hedger) hedger->onUnderlyingPrice(symbol, price);
+    });
+    mdHandler.addDataCallback([&riskMgr](const OptionData& quote) {
+        riskMgr.onOptionQuote(quote);
+    });
+
+    // Order and execution events for StreamExecutionEvents and GetExecutionReport
+    OrderEventJournal eventJournal(oms);
+
+    // Initialize services; both market data versions share one fan-out
+    QuoteFanout quoteFanout(mdHandler);
+    MarketDataServiceImpl marketDataService(quoteFanout);
     OrderManagementServiceImpl orderMgmtService(oms);
-    ExecutionServiceImpl executionService(execEngine);
+    ExecutionServiceImpl executionService(oms, eventJournal);
+    RiskServiceImpl riskService(riskPublisher);
+    MarketDataServiceV2Impl marketDataV2Service(quoteFanout);
+    OrderManagementServiceV2Impl orderMgmtV2Service(oms, mdHandler.instruments());
+    MetricsServiceImpl metricsService;
 
-    grpc::ServerBuilder builder;
-    builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
-    
-    // Register services
-    builder.RegisterService(&marketDataService);
-    builder.RegisterService(&orderMgmtService);
-    builder.RegisterService(&executionService);
+    // GRPC_SERVER_MODE=sync falls back to gRPC's thread pool for the unary
+    // RPCs; GRPC_CQ_THREADS sets the async polling threads and
+    // GRPC_PIN_CQ_THREADS pins them, from that CPU up
+    RpcServerConfig rpcConfig;
+    if (const char* mode = std::getenv("GRPC_SERVER_MODE")) {
+        if (std::string(mode) == "sync") rpcConfig.mode = RpcServerConfig::Mode::SYNC;
+    }
+    rpcConfig.completionQueueThreads = static_cast<size_t>(cqThreads);
+    if (firstCpu >= 0) {
+        rpcConfig.pinThreads = true;
+        rpcConfig.firstCpu = static_cast<int>(firstCpu);
+    }
 
-    std::unique_ptr<grpc::Server> server(builder.BuildAndStart());
-    std::cout << "Server listening on " << server_address << std::endl;
+    RpcServer server({marketDataService, orderMgmtService, executionService, riskService,
+                      marketDataV2Service, orderMgmtV2Service, metricsService}, rpcConfig);
+    server.start(server_address);
+    std::cout << "Server listening on " << server_address
+              << (rpcConfig.mode == RpcServerConfig::Mode::SYNC ? " (sync)" : " (async)") << std::endl;
 
     // Start components
     mdHandler.start();
+    eventJournal.start();
     oms.start();
     execEngine.start();
+    riskPublisher.start();
+    if (hedger) hedger->start();
 
     // Wait for server to shutdown
-    server->Wait();
+    server.wait();
 
     // Cleanup
+    if (hedger) hedger->stop();
+    riskPublisher.stop();
     execEngine.stop();
     mdHandler.stop();
     oms.stop();
+    eventJournal.stop();
+    OrderTracer::stop();
+    Metrics::stopDump();
+    BinaryLog::stop();
 }
 
 int main(int argc, char** argv) {
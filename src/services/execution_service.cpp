@@ -1,57 +1,260 @@
-#include <grpcpp/grpcpp.h>
-#include "execution.grpc.pb.h"
-#include "ExecutionEngine.hpp"
+#include "services/execution_service.hpp"
+#include "Metrics.hpp"
+#include "OrderManagementSystem.hpp"
+#include "OrderTracer.hpp"
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-class ExecutionServiceImpl final : public trading::ExecutionService::Service {
+namespace {
+    const char* const EVENT_TYPE_NAMES[] = {
+        "ACCEPTED", "REPLACED", "PARTIALLY_FILLED", "FILLED", "CANCELLED", "REJECTED", "EXPIRED"
+    };
+
+    const char* orderTypeName(OptionOrder::OrderType type) {
+        switch (type) {
+            case OptionOrder::OrderType::MARKET: return "MARKET";
+            case OptionOrder::OrderType::LIMIT: return "LIMIT";
+            case OptionOrder::OrderType::STOP: return "STOP";
+            case OptionOrder::OrderType::STOP_LIMIT: return "STOP_LIMIT";
+        }
+        return "";
+    }
+
+    const char* sideName(OptionOrder::Type type) {
+        return type == OptionOrder::Type::BUY_TO_OPEN || type == OptionOrder::Type::BUY_TO_CLOSE ? "BUY" : "SELL";
+    }
+
+    template <size_t N>
+    std::string fromFixed(const char (&text)[N]) {
+        return std::string(text, strnlen(text, N));
+    }
+
+    void fillEvent(const JournalEvent& event, trading::ExecutionEvent* out) {
+        const OrderRecord& order = event.order;
+        char orderId[ORDER_ID_LENGTH + 1];
+        formatOrderId(order.handle, orderId);
+
+        out->set_sequence(event.sequence);
+        out->set_timestamp(event.timestampNs);
+        out->set_type(EVENT_TYPE_NAMES[static_cast<size_t>(event.type)]);
+        out->set_order_id(orderId, ORDER_ID_LENGTH);
+        if (event.executionId != 0) out->set_execution_id(formatExecutionId(event.executionId));
+        out->set_symbol(fromFixed(order.instrument.underlying));
+        out->set_option_type(order.instrument.isCall ? "CALL" : "PUT");
+        out->set_strike(order.instrument.strike);
+        out->set_expiration_date(fromFixed(order.instrument.expiry));
+        out->set_side(sideName(order.type));
+        out->set_order_type(orderTypeName(order.orderType));
+        out->set_quantity(order.quantity);
+        out->set_price(order.limitPrice);
+
+        bool filled = order.status == OptionOrder::Status::FILLED;
+        out->set_filled_quantity(filled ? order.quantity : 0);
+        out->set_leaves_quantity(order.isActive ? order.quantity : 0);
+        if (filled) out->set_fill_price(order.fillPrice);
+    }
+}
+
+class ExecutionServiceImpl::EventStream final : public grpc::ServerWriteReactor<trading::ExecutionEventBatch> {
 public:
-    explicit ExecutionServiceImpl(ExecutionEngine& execEngine)
-        : execEngine_(execEngine) {}
-
-    grpc::Status ExecuteTrade(
-        grpc::ServerContext* context,
-        const trading::ExecuteTradeRequest* request,
-        trading::ExecuteTradeResponse* response) override {
-        
-        try {
-            OptionOrder order;
-            order.orderId = request->order_id();
-            order.underlying = request->symbol();
-            order.quantity = request->quantity();
-            order.limitPrice = request->price();
-            order.type = request->side() == "BUY" ? 
-                OptionOrder::Type::BUY_TO_OPEN : 
-                OptionOrder::Type::SELL_TO_OPEN;
-            order.orderType = OptionOrder::OrderType::MARKET;
-
-            execEngine_.addOrder(order);
-            
-            response->set_execution_id("EXEC-" + request->order_id());
-            response->set_success(true);
-            response->set_message("Trade executed successfully");
-            response->set_filled_quantity(request->quantity());
-            response->set_fill_price(request->price());
-            
-            return grpc::Status::OK;
-            
-        } catch (const std::exception& e) {
-            return grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+    EventStream(ExecutionServiceImpl& service, uint64_t nextSequence)
+        : service_(service), nextSequence_(nextSequence) {}
+
+    // New events may be in the journal
+    void wake() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writeNext();
+    }
+
+    void close(const grpc::Status& status) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(status);
+    }
+
+    void OnWriteDone(bool ok) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        if (!ok) {
+            finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Execution event stream write failed"));
+        } else {
+            writeNext();
         }
     }
 
-    grpc::Status GetExecutionReport(
-        grpc::ServerContext* context,
-        const trading::ExecutionReportRequest* request,
-        trading::ExecutionReportResponse* response) override {
-        
-        // In a real system, you would look up the execution report from a database
-        // For now, we'll create a simulated response
-        response->set_execution_id(request->execution_id());
-        response->set_order_id(request->execution_id().substr(5)); // Remove "EXEC-" prefix
-        response->set_status("FILLED");
-        
-        return grpc::Status::OK;
+    void OnCancel() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(grpc::Status::CANCELLED);
+    }
+
+    void OnDone() override {
+        service_.unsubscribe(this);
+        delete this;
     }
 
 private:
-    ExecutionEngine& execEngine_;
-};
\ No newline at end of file
+    // Callers hold mutex_. Reads the next batch from the stream's own
+    // position, so nothing is queued per stream beyond the batch in flight.
+    void writeNext() {
+        if (writing_ || finished_) return;
+
+        events_.clear();
+        if (!service_.journal_.read(nextSequence_, MAX_BATCH_EVENTS, events_)) {
+            finish(grpc::Status(grpc::StatusCode::OUT_OF_RANGE,
+                                "Sequence " + std::to_string(nextSequence_) + " is no longer retained; the oldest is " +
+                                std::to_string(service_.journal_.firstRetainedSequence())));
+            return;
+        }
+        if (events_.empty()) return;
+
+        batch_.Clear();
+        batch_.set_journal_id(service_.journal_.id());
+        batch_.mutable_events()->Reserve(static_cast<int>(events_.size()));
+        for (const JournalEvent& event : events_) {
+            fillEvent(event, batch_.add_events());
+        }
+        nextSequence_ = events_.back().sequence + 1;
+        writing_ = true;
+        StartWrite(&batch_);
+    }
+
+    void finish(const grpc::Status& status) {
+        if (finished_) return;
+        finished_ = true;
+        Finish(status);
+    }
+
+    ExecutionServiceImpl& service_;
+
+    std::mutex mutex_;
+    uint64_t nextSequence_;
+    std::vector<JournalEvent> events_;
+    trading::ExecutionEventBatch batch_;   // Owned by gRPC while writing_
+    bool writing_{false};
+    bool finished_{false};
+};
+
+ExecutionServiceImpl::ExecutionServiceImpl(OrderManagementSystem& oms, OrderEventJournal& journal)
+    : oms_(oms), journal_(journal) {
+    journal_.addListener([this](uint64_t) { notify(); });
+}
+
+grpc::Status ExecutionServiceImpl::ExecuteTrade(
+    grpc::ServerContext* context,
+    const trading::ExecuteTradeRequest* request,
+    trading::ExecuteTradeResponse* response) {
+
+    const uint64_t received = TscClock::now();
+    Metrics::increment(MetricCounter::ORDERS_RECEIVED);
+    try {
+        if (request->side() != "BUY" && request->side() != "SELL") {
+            throw std::invalid_argument("Side must be BUY or SELL: " + request->side());
+        }
+        if (!(request->quantity() > 0.0) || request->quantity() != std::floor(request->quantity())) {
+            throw std::invalid_argument("Quantity must be a positive whole number of contracts");
+        }
+
+        OptionOrder order{};
+        order.underlying = request->symbol();
+        order.optionType = request->option_type();
+        order.strike = request->strike();
+        order.expiry = request->expiration_date();
+        order.quantity = static_cast<int>(request->quantity());
+        order.limitPrice = request->price();
+        order.type = request->side() == "BUY" ?
+            OptionOrder::Type::BUY_TO_OPEN :
+            OptionOrder::Type::SELL_TO_OPEN;
+        order.orderType = OptionOrder::OrderType::MARKET;
+        order.timeInForce = OptionOrder::TimeInForce::DAY;
+
+        OrderRecord record = makeOrderRecord(order);
+        Metrics::recordSince(LatencyStage::ORDER_RECEIVE, received);
+        OrderHandle handle = oms_.submitOrder(record);
+        const uint64_t submitted = OrderTracer::sampled(handle) ? TscClock::now() : 0;
+
+        response->set_success(true);
+        response->set_order_id(formatOrderId(handle));
+        response->set_status("ACCEPTED");
+        response->set_message("Trade accepted; fills are reported on StreamExecutionEvents");
+        Metrics::recordSince(LatencyStage::ACK, received);
+        if (submitted) OrderTracer::traceHandler(handle, received, submitted);
+    } catch (const std::exception& e) {
+        response->set_success(false);
+        response->set_status("REJECTED");
+        response->set_message(e.what());
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status ExecutionServiceImpl::GetExecutionReport(
+    grpc::ServerContext* context,
+    const trading::ExecutionReportRequest* request,
+    trading::ExecutionReportResponse* response) {
+
+    uint64_t executionId;
+    ExecutionRecord execution;
+    if (!parseExecutionId(request->execution_id(), executionId) || !journal_.getExecution(executionId, execution)) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Execution not found: " + request->execution_id());
+    }
+
+    const OrderRecord& order = execution.order;
+    response->set_execution_id(formatExecutionId(execution.executionId));
+    response->set_order_id(formatOrderId(order.handle));
+    response->set_symbol(fromFixed(order.instrument.underlying));
+    response->set_option_type(order.instrument.isCall ? "CALL" : "PUT");
+    response->set_strike(order.instrument.strike);
+    response->set_expiration_date(fromFixed(order.instrument.expiry));
+    response->set_quantity(execution.quantity);
+    response->set_price(execution.price);
+    response->set_side(sideName(order.type));
+    response->set_timestamp(execution.timeNs);
+    response->set_status("FILLED");
+    response->set_commission(0.0);   // The simulated engine charges none
+    response->set_fees(0.0);
+    return grpc::Status::OK;
+}
+
+grpc::ServerWriteReactor<trading::ExecutionEventBatch>* ExecutionServiceImpl::StreamExecutionEvents(
+    grpc::CallbackServerContext* context,
+    const trading::ExecutionEventsRequest* request) {
+
+    uint64_t last = journal_.lastSequence();
+    uint64_t from = request->from_sequence() == 0 ? last + 1 : request->from_sequence();
+    auto* stream = new EventStream(*this, from);
+
+    // Stays out of streams_; unsubscribing it from OnDone is a no-op
+    if (request->journal_id() != 0 && request->journal_id() != journal_.id()) {
+        stream->close(grpc::Status(grpc::StatusCode::FAILED_PRECONDITION,
+                                   "The server has restarted since journal " + std::to_string(request->journal_id()) +
+                                   "; resume from sequence 1 of the new journal"));
+        return stream;
+    }
+    if (from > last + 1) {
+        stream->close(grpc::Status(grpc::StatusCode::OUT_OF_RANGE,
+                                   "Sequence " + std::to_string(from) + " is past the newest event, " +
+                                   std::to_string(last)));
+        return stream;
+    }
+
+    // Events appended from here on are picked up by the read in wake() or
+    // by the next notify(), whichever comes later
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams_.insert(stream);
+    stream->wake();
+    return stream;
+}
+
+void ExecutionServiceImpl::notify() {
+    // On the journal's thread
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (EventStream* stream : streams_) {
+        stream->wake();
+    }
+}
+
+void ExecutionServiceImpl::unsubscribe(EventStream* stream) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams_.erase(stream);
+}
@@ -1,84 +1,181 @@
 #include "services/market_data_service.hpp"
 #include "MarketDataHandler.hpp"
+#include "services/batch_stream.hpp"
+#include <grpcpp/impl/codegen/proto_utils.h>
 #include <chrono>
+#include <deque>
+#include <utility>
+#include <vector>
 
-MarketDataServiceImpl::MarketDataServiceImpl(MarketDataHandler& marketDataHandler)
-    : marketDataHandler_(marketDataHandler) {}
-
-grpc::Status MarketDataServiceImpl::StreamMarketData(
-    grpc::ServerContext* context,
-    const trading::MarketDataRequest* request,
-    grpc::ServerWriter<trading::MarketDataResponse>* writer) {
-    
-    // Subscribe to the requested symbol
-    marketDataHandler_.subscribeToSymbol(request->symbol());
-    
-    // Set up callback for market data updates
-    marketDataHandler_.setDataCallback([writer](const OptionData& data) {
-        trading::MarketDataResponse response;
-        response.set_symbol(data.underlying);
-        response.set_option_type(data.optionType);
-        response.set_strike(data.strike);
-        response.set_bid(data.bid);
-        response.set_ask(data.ask);
-        response.set_price(data.lastPrice);
-        response.set_volume(data.volume);
-        response.set_implied_volatility(data.impliedVol);
-        response.set_delta(data.delta);
-        response.set_gamma(data.gamma);
-        response.set_theta(data.theta);
-        response.set_vega(data.vega);
-        response.set_rho(data.rho);
-        response.set_timestamp(
+namespace {
+    void fillResponse(const OptionData& data, trading::MarketDataResponse* response) {
+        response->set_symbol(data.underlying);
+        response->set_option_type(data.optionType);
+        response->set_strike(data.strike);
+        response->set_bid(data.bid);
+        response->set_ask(data.ask);
+        response->set_price(data.lastPrice);
+        response->set_volume(data.volume);
+        response->set_implied_volatility(data.impliedVol);
+        response->set_delta(data.delta);
+        response->set_gamma(data.gamma);
+        response->set_theta(data.theta);
+        response->set_vega(data.vega);
+        response->set_rho(data.rho);
+        response->set_timestamp(
             std::chrono::system_clock::now().time_since_epoch().count()
         );
-        
-        writer->Write(response);
-    });
+    }
+
+    struct BatchCodec {
+        using Request = trading::MarketDataSubscription;
+        using Batch = trading::MarketDataBatch;
+
+        static bool parse(const Request& request, uint32_t& id, bool& add, QuoteFilter& filter,
+                          std::string& error) {
+            id = request.subscription_id();
+            add = request.action() == trading::MarketDataSubscription::ADD;
+            if (!add) return true;
+            if (request.filter().symbol().empty()) {
+                error = "Subscription " + std::to_string(id) + " has no symbol";
+                return false;
+            }
+            filter.underlying = request.filter().symbol();
+            filter.optionType = request.filter().option_type();
+            filter.expiry = request.filter().expiration();
+            filter.minStrike = request.filter().min_strike();
+            filter.maxStrike = request.filter().max_strike();
+            return true;
+        }
+
+        void encode(uint64_t sequence, uint32_t conflated, uint32_t dropped,
+                    const std::vector<OptionData>& ticks, Batch& batch) {
+            batch.set_sequence(sequence);
+            batch.set_conflated(conflated);
+            batch.set_dropped(dropped);
+            batch.mutable_ticks()->Reserve(static_cast<int>(ticks.size()));
+            for (const OptionData& tick : ticks) {
+                fillResponse(tick, batch.add_ticks());
+            }
+            batch.set_timestamp(std::chrono::system_clock::now().time_since_epoch().count());
+        }
+    };
+}
+
+class MarketDataServiceImpl::Subscription final
+    : public grpc::ServerWriteReactor<trading::MarketDataResponse>,
+      public QuoteSink {
+public:
+    Subscription(QuoteFanout& fanout, const trading::MarketDataRequest& request)
+        : fanout_(fanout), request_(request) {}
+
+    // Called with the fan-out lock held, in feed order. Empty request
+    // fields match every contract on the symbol.
+    void offer(const OptionData& data) override {
+        if ((!request_.option_type().empty() && request_.option_type() != data.optionType) ||
+            (request_.strike() > 0.0 && request_.strike() != data.strike) ||
+            (!request_.expiration().empty() && request_.expiration() != data.expiry)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        if (writing_) {
+            if (pending_.size() == MAX_PENDING_QUOTES) pending_.pop_front();
+            pending_.emplace_back();
+            fillResponse(data, &pending_.back());
+            return;
+        }
+        fillResponse(data, &current_);
+        write();
+    }
+
+    void OnWriteDone(bool ok) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        if (!ok) {
+            finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Market data stream write failed"));
+        } else if (!pending_.empty() && !finished_) {
+            current_ = std::move(pending_.front());
+            pending_.pop_front();
+            write();
+        }
+    }
+
+    void OnCancel() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(grpc::Status::CANCELLED);
+    }
+
+    // Ends the stream before any tick, when the fan-out would not watch its symbol
+    void reject(const grpc::Status& status) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(status);
+    }
+
+    void OnDone() override {
+        fanout_.remove(this);
+        delete this;
+    }
+
+private:
+    // Callers hold mutex_; current_ stays untouched until OnWriteDone
+    void write() {
+        writing_ = true;
+        StartWrite(&current_);
+    }
+
+    void finish(const grpc::Status& status) {
+        if (finished_) return;
+        finished_ = true;
+        pending_.clear();
+        Finish(status);
+    }
 
-    // Keep the stream open until the client disconnects
-    while (!context->IsCancelled()) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    QuoteFanout& fanout_;
+    const trading::MarketDataRequest request_;
+
+    std::mutex mutex_;
+    trading::MarketDataResponse current_;
+    std::deque<trading::MarketDataResponse> pending_;
+    bool writing_{false};
+    bool finished_{false};
+};
+
+MarketDataServiceImpl::MarketDataServiceImpl(QuoteFanout& fanout)
+    : fanout_(fanout), chainCache_(fanout.handler()) {}
+
+grpc::ServerWriteReactor<trading::MarketDataResponse>* MarketDataServiceImpl::StreamMarketData(
+    grpc::CallbackServerContext* context,
+    const trading::MarketDataRequest* request) {
+
+    auto* subscription = new Subscription(fanout_, *request);
+    if (!QuoteFanout::validSymbol(request->symbol())) {
+        subscription->reject(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid symbol"));
+    } else if (!fanout_.watch(subscription, request->symbol())) {
+        subscription->reject(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED, "Too many symbols watched"));
     }
+    return subscription;
+}
 
-    return grpc::Status::OK;
+grpc::ServerBidiReactor<trading::MarketDataSubscription, trading::MarketDataBatch>*
+MarketDataServiceImpl::SubscribeMarketData(grpc::CallbackServerContext* context) {
+    return new BatchStream<BatchCodec>(fanout_);
 }
 
-grpc::Status MarketDataServiceImpl::GetOptionChain(
-    grpc::ServerContext* context,
-    const trading::OptionChainRequest* request,
-    trading::OptionChainResponse* response) {
-    
-    // Get current market data for the symbol
-    auto data = marketDataHandler_.getLatestData(request->underlying_symbol());
-    
-    if (data.underlying.empty()) {
-        return grpc::Status(grpc::StatusCode::NOT_FOUND, "No data available for symbol");
+grpc::ServerUnaryReactor* MarketDataServiceImpl::GetOptionChain(
+    grpc::CallbackServerContext* context,
+    const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    trading::OptionChainRequest parsed;
+    grpc::ByteBuffer copy(*request);   // Deserialize consumes its buffer
+    if (!grpc::SerializationTraits<trading::OptionChainRequest>::Deserialize(&copy, &parsed).ok()) {
+        reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed OptionChainRequest"));
+        return reactor;
     }
 
-    // Add data to calls or puts based on option type
-    auto* target_list = (data.optionType == "CALL") ? 
-        response->mutable_calls() : response->mutable_puts();
-    
-    auto* option_data = target_list->Add();
-    option_data->set_symbol(data.underlying);
-    option_data->set_option_type(data.optionType);
-    option_data->set_strike(data.strike);
-    option_data->set_price(data.lastPrice);
-    option_data->set_bid(data.bid);
-    option_data->set_ask(data.ask);
-    option_data->set_volume(data.volume);
-    option_data->set_implied_volatility(data.impliedVol);
-    option_data->set_delta(data.delta);
-    option_data->set_gamma(data.gamma);
-    option_data->set_theta(data.theta);
-    option_data->set_vega(data.vega);
-    option_data->set_rho(data.rho);
-
-    response->set_underlying_price(data.getMidPrice());
-    response->set_timestamp(
-        std::chrono::system_clock::now().time_since_epoch().count()
-    );
-
-    return grpc::Status::OK;
-}
\ No newline at end of file
+    reactor->Finish(chainCache_.get(parsed.underlying_symbol(), parsed.expiration(), response));
+    return reactor;
+}
@@ -0,0 +1,106 @@
+#include "services/market_data_service_v2.hpp"
+#include "services/batch_stream.hpp"
+#include "services/wire_v2.hpp"
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+    struct V2Codec {
+        using Request = trading::v2::Subscription;
+        using Batch = trading::v2::QuoteBatch;
+
+        explicit V2Codec(InstrumentRegistry& instruments) : instruments(instruments) {}
+
+        static bool parse(const Request& request, uint32_t& id, bool& add, QuoteFilter& filter,
+                          std::string& error) {
+            id = request.subscription_id();
+            add = request.action() == trading::v2::Subscription::ADD;
+            if (!add) return true;
+
+            const trading::v2::ContractFilter& wire = request.filter();
+            if (wire.underlying().empty()) {
+                error = "Subscription " + std::to_string(id) + " has no underlying";
+                return false;
+            }
+            switch (wire.option_type()) {
+                case trading::v2::OPTION_TYPE_UNSPECIFIED: break;
+                case trading::v2::CALL: filter.optionType = "CALL"; break;
+                case trading::v2::PUT: filter.optionType = "PUT"; break;
+                default:
+                    error = "Subscription " + std::to_string(id) + " has an unknown option type";
+                    return false;
+            }
+            filter.underlying = wire.underlying();
+            filter.expiry = fromExpiryCode(wire.expiry());
+            filter.minStrike = fromFixedPrice(wire.min_strike());
+            filter.maxStrike = fromFixedPrice(wire.max_strike());
+            return true;
+        }
+
+        void encode(uint64_t sequence, uint32_t conflated, uint32_t dropped,
+                    const std::vector<OptionData>& ticks, Batch& batch) {
+            batch.set_sequence(sequence);
+            batch.set_conflated(conflated);
+            batch.set_dropped(dropped);
+            batch.mutable_quotes()->Reserve(static_cast<int>(ticks.size()));
+            for (const OptionData& tick : ticks) {
+                InstrumentKey key = makeInstrumentKey(tick.underlying, tick.optionType, tick.strike, tick.expiry);
+                uint32_t id = instruments.idFor(key);
+                if (sent.insert(id).second) fillInstrument(id, key, batch.add_instruments());
+                fillQuote(id, tick, batch.add_quotes());
+            }
+            batch.set_timestamp_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count());
+        }
+
+        InstrumentRegistry& instruments;
+        std::unordered_set<uint32_t> sent;   // Defined to this stream already
+    };
+}
+
+MarketDataServiceV2Impl::MarketDataServiceV2Impl(QuoteFanout& fanout)
+    : fanout_(fanout), chainCache_(fanout.handler(), OptionChainCache::Encoding::COLUMNS) {}
+
+grpc::ServerUnaryReactor* MarketDataServiceV2Impl::GetInstruments(
+    grpc::CallbackServerContext* context,
+    const trading::v2::InstrumentsRequest* request,
+    trading::v2::InstrumentsResponse* response) {
+
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    if (request->underlying().empty()) {
+        reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "underlying is required"));
+        return reactor;
+    }
+
+    auto instruments = fanout_.handler().instruments().instrumentsOf(request->underlying());
+    response->mutable_instruments()->Reserve(static_cast<int>(instruments.size()));
+    for (const auto& instrument : instruments) {
+        fillInstrument(instrument.first, instrument.second, response->add_instruments());
+    }
+    reactor->Finish(grpc::Status::OK);
+    return reactor;
+}
+
+grpc::ServerUnaryReactor* MarketDataServiceV2Impl::GetOptionChain(
+    grpc::CallbackServerContext* context,
+    const grpc::ByteBuffer* request,
+    grpc::ByteBuffer* response) {
+
+    grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+    trading::v2::OptionChainRequest parsed;
+    grpc::ByteBuffer copy(*request);   // Deserialize consumes its buffer
+    if (!grpc::SerializationTraits<trading::v2::OptionChainRequest>::Deserialize(&copy, &parsed).ok()) {
+        reactor->Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed OptionChainRequest"));
+        return reactor;
+    }
+
+    reactor->Finish(chainCache_.get(parsed.underlying(), fromExpiryCode(parsed.expiry()), response));
+    return reactor;
+}
+
+grpc::ServerBidiReactor<trading::v2::Subscription, trading::v2::QuoteBatch>*
+MarketDataServiceV2Impl::SubscribeMarketData(grpc::CallbackServerContext* context) {
+    return new BatchStream<V2Codec>(fanout_, fanout_.handler().instruments());
+}
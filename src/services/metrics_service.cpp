@@ -0,0 +1,32 @@
+#include "services/metrics_service.hpp"
+#include "Metrics.hpp"
+
+grpc::Status MetricsServiceImpl::GetMetrics(
+    grpc::ServerContext* context,
+    const trading::MetricsRequest* request,
+    trading::MetricsResponse* response) {
+
+    MetricsSnapshot snapshot = Metrics::snapshot();
+    response->set_timestamp(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        snapshot.takenAt.time_since_epoch()).count());
+
+    response->mutable_stages()->Reserve(static_cast<int>(snapshot.stages.size()));
+    for (const LatencySummary& summary : snapshot.stages) {
+        trading::StageLatency* stage = response->add_stages();
+        stage->set_stage(Metrics::stageName(summary.stage));
+        stage->set_count(summary.count);
+        stage->set_mean_micros(summary.meanNanos / 1000.0);
+        stage->set_p50_micros(summary.p50Nanos / 1000.0);
+        stage->set_p90_micros(summary.p90Nanos / 1000.0);
+        stage->set_p99_micros(summary.p99Nanos / 1000.0);
+        stage->set_p999_micros(summary.p999Nanos / 1000.0);
+        stage->set_max_micros(summary.maxNanos / 1000.0);
+    }
+
+    for (const auto& counter : snapshot.counters) {
+        trading::Counter* out = response->add_counters();
+        out->set_name(Metrics::counterName(counter.first));
+        out->set_value(counter.second);
+    }
+    return grpc::Status::OK;
+}
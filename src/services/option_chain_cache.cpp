@@ -0,0 +1,129 @@
+#include "services/option_chain_cache.hpp"
+#include "market_data.pb.h"
+#include "services/wire_v2.hpp"
+#include <google/protobuf/arena.h>
+#include <chrono>
+
+namespace {
+    void fillContract(const OptionData& data, trading::MarketDataResponse* contract) {
+        contract->set_symbol(data.underlying);
+        contract->set_option_type(data.optionType);
+        contract->set_strike(data.strike);
+        contract->set_bid(data.bid);
+        contract->set_ask(data.ask);
+        contract->set_price(data.lastPrice);
+        contract->set_volume(data.volume);
+        contract->set_implied_volatility(data.impliedVol);
+        contract->set_delta(data.delta);
+        contract->set_gamma(data.gamma);
+        contract->set_theta(data.theta);
+        contract->set_vega(data.vega);
+        contract->set_rho(data.rho);
+    }
+
+    size_t fillSide(const OptionChain::Contracts& contracts, const std::string& expiration,
+                    google::protobuf::RepeatedPtrField<trading::MarketDataResponse>* side) {
+        // (expiry, strike) keys put one expiry's contracts in a single run
+        auto begin = expiration.empty() ? contracts.begin() : contracts.lower_bound({expiration, -1.0});
+        size_t added = 0;
+        for (auto it = begin; it != contracts.end(); ++it) {
+            if (!expiration.empty() && it->first.first != expiration) break;
+            fillContract(it->second, side->Add());
+            ++added;
+        }
+        return added;
+    }
+}
+
+OptionChainCache::OptionChainCache(const MarketDataHandler& handler, Encoding encoding)
+    : handler_(handler), encoding_(encoding) {}
+
+grpc::Status OptionChainCache::get(const std::string& underlying, const std::string& expiration,
+                                   grpc::ByteBuffer* response) {
+    const std::string key = underlying + '\0' + expiration;
+    Entry* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = entries_.find(key);
+        if (found != entries_.end()) entry = found->second.get();
+    }
+
+    grpc::Slice bytes;
+    if (entry) {
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        uint64_t version = handler_.getChainVersion(underlying);
+        if (version == 0) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "No data available for symbol");
+        }
+        if (entry->version == version) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!build(underlying, expiration, *entry)) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "No contracts on expiration " + expiration);
+        }
+        bytes = entry->bytes;
+    } else {
+        // A slot is added only once its chain has been built, so requests
+        // for symbols or expirations without data leave nothing behind
+        std::unique_ptr<Entry> built(new Entry());
+        if (handler_.getChainVersion(underlying) == 0) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "No data available for symbol");
+        }
+        if (!build(underlying, expiration, *built)) {
+            return grpc::Status(grpc::StatusCode::NOT_FOUND, "No contracts on expiration " + expiration);
+        }
+        bytes = built->bytes;
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.emplace(key, std::move(built));   // Keeps the other if a concurrent first build won
+    }
+
+    // Takes a reference to the slice; the bytes are not copied
+    grpc::ByteBuffer buffer(&bytes, 1);
+    response->Swap(&buffer);
+    return grpc::Status::OK;
+}
+
+bool OptionChainCache::build(const std::string& underlying, const std::string& expiration, Entry& entry) {
+    OptionChain chain;
+    if (!handler_.getOptionChain(underlying, chain)) return false;
+
+    // One arena block holds the whole response; it is freed in one go
+    // once the bytes are out
+    google::protobuf::ArenaOptions options;
+    options.start_block_size = 64 * 1024;
+    options.max_block_size = 1024 * 1024;
+    google::protobuf::Arena arena(options);
+    google::protobuf::Message* message;
+    size_t contracts;
+    if (encoding_ == Encoding::ROWS) {
+        auto* rows = google::protobuf::Arena::CreateMessage<trading::OptionChainResponse>(&arena);
+        contracts = fillSide(chain.calls, expiration, rows->mutable_calls()) +
+                    fillSide(chain.puts, expiration, rows->mutable_puts());
+        rows->set_underlying_price(chain.underlyingPrice);
+        rows->set_timestamp(std::chrono::system_clock::now().time_since_epoch().count());
+        message = rows;
+    } else {
+        auto* columns = google::protobuf::Arena::CreateMessage<trading::v2::OptionChainColumns>(&arena);
+        contracts = fillChainColumns(chain, expiration, handler_.instruments(), columns);
+        columns->set_underlying(underlying);
+        columns->set_underlying_price(toFixedPrice(chain.underlyingPrice));
+        columns->set_timestamp_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        message = columns;
+    }
+    if (contracts == 0 && !expiration.empty()) return false;
+
+    // Straight into the slice that every response will reference
+    grpc::Slice bytes(message->ByteSizeLong());
+    message->SerializeWithCachedSizesToArray(const_cast<uint8_t*>(bytes.begin()));
+    entry.bytes = std::move(bytes);
+    entry.version = chain.version;
+    builds_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+OptionChainCache::Stats OptionChainCache::getStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.builds = builds_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -2,45 +2,104 @@
 #include "order_management.grpc.pb.h"
 #include "OrderManagementSystem.hpp"
 #include "services/order_management_service.hpp"
+#include "DateUtils.hpp"
+#include "Metrics.hpp"
+#include "OrderTracer.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
 
-OrderManagementServiceImpl::OrderManagementServiceImpl(OrderManagementSystem& oms)
-    : oms_(oms) {}
+namespace {
+    constexpr size_t DEFAULT_HISTORY_PAGE_SIZE = 100;
+    constexpr size_t MAX_HISTORY_PAGE_SIZE = 1000;
+
+    // Page tokens are "<submit time ns>:<order ID>" of the last order returned
+    std::string formatPageToken(const OrderHistoryCursor& cursor) {
+        return std::to_string(cursor.submitTimeNs) + ":" + formatOrderId(cursor.handle);
+    }
+
+    bool parsePageToken(const std::string& token, OrderHistoryCursor& cursor) {
+        size_t colon = token.find(':');
+        if (colon == std::string::npos || colon == 0) return false;
+
+        char* end = nullptr;
+        std::string time = token.substr(0, colon);
+        long long submitTimeNs = std::strtoll(time.c_str(), &end, 10);
+        if (*end != '\0') return false;
+
+        cursor.submitTimeNs = submitTimeNs;
+        return parseOrderId(token.substr(colon + 1), cursor.handle);
+    }
+
+    // The API order as the OMS takes it; throws std::invalid_argument for
+    // a field it does not recognize
+    OptionOrder makeOrder(const trading::OrderRequest& request) {
+        OptionOrder order{};
+        order.underlying = request.symbol();
+        order.optionType = request.option_type();
+        order.strike = request.strike();  // Using strike instead of strike_price
+        order.quantity = request.quantity();
+        order.expiry = request.expiration_date();
 
-grpc::Status OrderManagementServiceImpl::PlaceOrder(
-    grpc::ServerContext* context,
-    const trading::OrderRequest* request,
-    trading::OrderResponse* response) {
-    
-    try {
-        OptionOrder order;
-        order.underlying = request->symbol();
-        order.optionType = request->option_type();
-        order.strike = request->strike();  // Using strike instead of strike_price
-        order.quantity = request->quantity();
-        order.expiry = request->expiration_date();
-        
         // Set order type
-        if (request->order_type() == "MARKET") {
+        if (request.order_type() == "MARKET") {
             order.orderType = OptionOrder::OrderType::MARKET;
-        } else if (request->order_type() == "LIMIT") {
+        } else if (request.order_type() == "LIMIT") {
             order.orderType = OptionOrder::OrderType::LIMIT;
-            order.limitPrice = request->price();
+            order.limitPrice = request.price();
+        } else {
+            throw std::invalid_argument("Unsupported order type: " + request.order_type());
         }
-        
+
         // Set side
-        if (request->side() == "BUY") {
+        if (request.side() == "BUY") {
             order.type = OptionOrder::Type::BUY_TO_OPEN;
         } else {
             order.type = OptionOrder::Type::SELL_TO_OPEN;
         }
 
-        std::string orderId = oms_.submitOptionOrder(order);
+        // Set time in force (DAY when unspecified)
+        const std::string& tif = request.time_in_force();
+        if (tif.empty() || tif == "DAY") {
+            order.timeInForce = OptionOrder::TimeInForce::DAY;
+        } else if (tif == "GTC") {
+            order.timeInForce = OptionOrder::TimeInForce::GTC;
+        } else if (tif == "IOC") {
+            order.timeInForce = OptionOrder::TimeInForce::IOC;
+        } else if (tif == "GTD") {
+            order.timeInForce = OptionOrder::TimeInForce::GTD;
+            order.expireTime = std::chrono::system_clock::from_time_t(request.expire_time());
+        } else {
+            throw std::invalid_argument("Unknown time in force: " + tif);
+        }
+        return order;
+    }
+}
+
+OrderManagementServiceImpl::OrderManagementServiceImpl(OrderManagementSystem& oms)
+    : oms_(oms) {}
+
+grpc::Status OrderManagementServiceImpl::PlaceOrder(
+    grpc::ServerContext* context,
+    const trading::OrderRequest* request,
+    trading::OrderResponse* response) {
+    
+    const uint64_t received = TscClock::now();
+    Metrics::increment(MetricCounter::ORDERS_RECEIVED);
+    try {
+        OrderRecord order = makeOrderRecord(makeOrder(*request));
+        Metrics::recordSince(LatencyStage::ORDER_RECEIVE, received);
+        OrderHandle handle = oms_.submitOrder(order);
+        const uint64_t submitted = OrderTracer::sampled(handle) ? TscClock::now() : 0;
         
-        response->set_order_id(orderId);
+        response->set_order_id(formatOrderId(handle));
         response->set_status("PENDING");
         response->set_message("Order submitted successfully");
         
+        Metrics::recordSince(LatencyStage::ACK, received);
+        if (submitted) OrderTracer::traceHandler(handle, received, submitted);
         return grpc::Status::OK;
         
     } catch (const std::exception& e) {
@@ -117,9 +176,52 @@ grpc::Status OrderManagementServiceImpl::GetOrderHistory(
     const trading::OrderHistoryRequest* request,
     trading::OrderHistoryResponse* response) {
     
-    auto activeOrders = oms_.getActiveOrders();
+    OrderHistoryQuery query;
+    query.underlying = request->symbol();
+
+    // Dates are whole UTC days, both ends inclusive
+    int64_t days;
+    if (!request->start_date().empty()) {
+        if (!parseIsoDate(request->start_date().c_str(), days)) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid start_date: " + request->start_date());
+        }
+        query.startTimeNs = days * NANOS_PER_DAY;
+    }
+    if (!request->end_date().empty()) {
+        if (!parseIsoDate(request->end_date().c_str(), days)) {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid end_date: " + request->end_date());
+        }
+        query.endTimeNs = (days + 1) * NANOS_PER_DAY - 1;
+    }
+
+    if (!request->status().empty()) {
+        query.filterStatus = true;
+        if (request->status() == "PENDING") {
+            query.status = OptionOrder::Status::PENDING;
+        } else if (request->status() == "FILLED") {
+            query.status = OptionOrder::Status::FILLED;
+        } else if (request->status() == "CANCELLED") {
+            query.status = OptionOrder::Status::CANCELLED;
+        } else if (request->status() == "REJECTED") {
+            query.status = OptionOrder::Status::REJECTED;
+        } else {
+            return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Unknown status: " + request->status());
+        }
+    }
+
+    if (request->page_size() < 0) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "page_size must not be negative");
+    }
+    query.pageSize = request->page_size() == 0 ? DEFAULT_HISTORY_PAGE_SIZE
+                                               : std::min<size_t>(request->page_size(), MAX_HISTORY_PAGE_SIZE);
+    if (!request->page_token().empty() && !parsePageToken(request->page_token(), query.after)) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Invalid page_token");
+    }
+
+    OrderHistoryPage page = oms_.getOrderHistory(query);
     
-    for (const auto& order : activeOrders) {
+    for (const auto& record : page.orders) {
+        OptionOrder order = makeOptionOrder(record);
         auto* orderStatus = response->add_orders();
         orderStatus->set_order_id(order.orderId);
         orderStatus->set_symbol(order.underlying);
@@ -154,12 +256,155 @@ grpc::Status OrderManagementServiceImpl::GetOrderHistory(
             ).count()
         );
         
-        orderStatus->set_last_update_time(
-            std::chrono::duration_cast<std::chrono::seconds>(
-                order.fillTime.time_since_epoch()
-            ).count()
-        );
+        orderStatus->set_last_update_time(record.lastUpdateNs / 1000000000);
+    }
+
+    if (page.hasMore) {
+        response->set_next_page_token(formatPageToken(page.next()));
     }
 
     return grpc::Status::OK;
-}
\ No newline at end of file
+}
+
+// Requests are read one at a time and carried out as they arrive, so
+// acks come out in request order. Acks made while a write is in flight
+// go out together in the next one.
+class OrderManagementServiceImpl::OrderEntryStream final
+    : public grpc::ServerBidiReactor<trading::OrderEntryRequest, trading::OrderEntryAcks> {
+public:
+    explicit OrderEntryStream(OrderManagementServiceImpl& service) : service_(service) {
+        StartRead(&request_);
+    }
+
+    void OnReadDone(bool ok) override {
+        if (!ok) {
+            // The client is done sending; finish once its acks are out
+            std::lock_guard<std::mutex> lock(mutex_);
+            readsDone_ = true;
+            if (!writing_) finish(grpc::Status::OK);
+            return;
+        }
+
+        trading::OrderEntryAck ack;
+        service_.enter(request_, &ack);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        pending_.add_acks()->Swap(&ack);
+        if (!writing_) write();
+        if (pending_.acks_size() < MAX_PENDING_ACKS) {
+            StartRead(&request_);
+        } else {
+            readPaused_ = true;
+        }
+    }
+
+    void OnWriteDone(bool ok) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        if (!ok) {
+            finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Order entry stream write failed"));
+            return;
+        }
+        if (pending_.acks_size() > 0) {
+            write();
+        } else if (readsDone_) {
+            finish(grpc::Status::OK);
+        }
+        if (readPaused_ && !finished_) {
+            readPaused_ = false;
+            StartRead(&request_);
+        }
+    }
+
+    void OnCancel() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(grpc::Status::CANCELLED);
+    }
+
+    void OnDone() override {
+        delete this;
+    }
+
+private:
+    // Callers hold mutex_; current_ stays untouched until OnWriteDone
+    void write() {
+        current_.Clear();
+        current_.Swap(&pending_);
+        writing_ = true;
+        StartWrite(&current_);
+    }
+
+    void finish(const grpc::Status& status) {
+        if (finished_) return;
+        finished_ = true;
+        Finish(status);
+    }
+
+    OrderManagementServiceImpl& service_;
+    trading::OrderEntryRequest request_;   // Touched only by the read callbacks
+
+    std::mutex mutex_;
+    trading::OrderEntryAcks pending_;
+    trading::OrderEntryAcks current_;
+    bool writing_{false};
+    bool readPaused_{false};
+    bool readsDone_{false};
+    bool finished_{false};
+};
+
+grpc::ServerBidiReactor<trading::OrderEntryRequest, trading::OrderEntryAcks>* OrderManagementServiceImpl::OrderEntry(
+    grpc::CallbackServerContext* context) {
+    return new OrderEntryStream(*this);
+}
+
+void OrderManagementServiceImpl::enter(const trading::OrderEntryRequest& request, trading::OrderEntryAck* ack) {
+    ack->set_client_sequence(request.client_sequence());
+    try {
+        OrderHandle handle;
+        switch (request.action_case()) {
+            case trading::OrderEntryRequest::kPlace: {
+                const uint64_t received = TscClock::now();
+                Metrics::increment(MetricCounter::ORDERS_RECEIVED);
+                OrderRecord order = makeOrderRecord(makeOrder(request.place()));
+                Metrics::recordSince(LatencyStage::ORDER_RECEIVE, received);
+                handle = oms_.submitOrder(order);
+                const uint64_t submitted = OrderTracer::sampled(handle) ? TscClock::now() : 0;
+                ack->set_order_id(formatOrderId(handle));
+                ack->set_status("PENDING");
+                Metrics::recordSince(LatencyStage::ACK, received);
+                if (submitted) OrderTracer::traceHandler(handle, received, submitted);
+                return;
+            }
+
+            case trading::OrderEntryRequest::kCancel:
+                ack->set_order_id(request.cancel().order_id());
+                if (parseOrderId(request.cancel().order_id(), handle) && oms_.cancelOrder(handle)) {
+                    ack->set_status("CANCELLED");
+                } else {
+                    ack->set_status("REJECTED");
+                    ack->set_message("Order not found or no longer active");
+                }
+                return;
+
+            case trading::OrderEntryRequest::kReplace:
+                ack->set_order_id(request.replace().order_id());
+                if (parseOrderId(request.replace().order_id(), handle) &&
+                    oms_.replaceOrder(handle, makeOrderRecord(makeOrder(request.replace().order())))) {
+                    ack->set_status("PENDING");
+                } else {
+                    ack->set_status("REJECTED");
+                    ack->set_message("Order not found or no longer active");
+                }
+                return;
+
+            default:
+                ack->set_status("REJECTED");
+                ack->set_message("Empty order entry request");
+                return;
+        }
+    } catch (const std::exception& e) {
+        ack->set_status("REJECTED");
+        ack->set_message(e.what());
+    }
+}
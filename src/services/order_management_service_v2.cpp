@@ -0,0 +1,118 @@
+#include "services/order_management_service_v2.hpp"
+#include "services/wire_v2.hpp"
+#include "Metrics.hpp"
+#include "OrderTracer.hpp"
+#include <limits>
+
+namespace {
+    bool toOrderType(trading::v2::OrderType wire, OptionOrder::OrderType& type) {
+        switch (wire) {
+            case trading::v2::MARKET: type = OptionOrder::OrderType::MARKET; return true;
+            case trading::v2::LIMIT: type = OptionOrder::OrderType::LIMIT; return true;
+            case trading::v2::STOP: type = OptionOrder::OrderType::STOP; return true;
+            case trading::v2::STOP_LIMIT: type = OptionOrder::OrderType::STOP_LIMIT; return true;
+            default: return false;
+        }
+    }
+
+    bool toTimeInForce(trading::v2::TimeInForce wire, OptionOrder::TimeInForce& tif) {
+        switch (wire) {
+            case trading::v2::DAY: tif = OptionOrder::TimeInForce::DAY; return true;
+            case trading::v2::GTC: tif = OptionOrder::TimeInForce::GTC; return true;
+            case trading::v2::IOC: tif = OptionOrder::TimeInForce::IOC; return true;
+            case trading::v2::GTD: tif = OptionOrder::TimeInForce::GTD; return true;
+            default: return false;
+        }
+    }
+}
+
+OrderManagementServiceV2Impl::OrderManagementServiceV2Impl(OrderManagementSystem& oms,
+                                                           const InstrumentRegistry& instruments)
+    : oms_(oms), instruments_(instruments) {}
+
+grpc::Status OrderManagementServiceV2Impl::PlaceOrder(
+    grpc::ServerContext* context,
+    const trading::v2::OrderRequest* request,
+    trading::v2::OrderResponse* response) {
+
+    const uint64_t received = TscClock::now();
+    Metrics::increment(MetricCounter::ORDERS_RECEIVED);
+    OrderRecord order{};
+    if (!instruments_.lookup(request->instrument_id(), order.instrument)) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND,
+                            "Unknown instrument " + std::to_string(request->instrument_id()));
+    }
+    if (request->side() == trading::v2::BUY) {
+        order.type = OptionOrder::Type::BUY_TO_OPEN;
+    } else if (request->side() == trading::v2::SELL) {
+        order.type = OptionOrder::Type::SELL_TO_OPEN;
+    } else {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "side is required");
+    }
+    if (!toOrderType(request->order_type(), order.orderType)) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "order_type is required");
+    }
+    if (!toTimeInForce(request->time_in_force(), order.timeInForce)) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Unknown time_in_force");
+    }
+    if (request->quantity() > static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+        return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "quantity is too large");
+    }
+    order.quantity = static_cast<int32_t>(request->quantity());
+    order.limitPrice = fromFixedPrice(request->limit_price());
+    order.stopPrice = fromFixedPrice(request->stop_price());
+    if (order.timeInForce == OptionOrder::TimeInForce::GTD) order.expireTimeNs = request->expire_time_ns();
+
+    Metrics::recordSince(LatencyStage::ORDER_RECEIVE, received);
+    try {
+        OrderHandle handle = oms_.submitOrder(order);
+        const uint64_t submitted = OrderTracer::sampled(handle) ? TscClock::now() : 0;
+        response->set_order_handle(handle);
+        response->set_status(trading::v2::PENDING);
+        Metrics::recordSince(LatencyStage::ACK, received);
+        if (submitted) OrderTracer::traceHandler(handle, received, submitted);
+    } catch (const std::exception& e) {
+        response->set_status(trading::v2::REJECTED);
+        response->set_message(e.what());
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status OrderManagementServiceV2Impl::CancelOrder(
+    grpc::ServerContext* context,
+    const trading::v2::CancelOrderRequest* request,
+    trading::v2::CancelOrderResponse* response) {
+
+    if (oms_.cancelOrder(request->order_handle())) {
+        response->set_success(true);
+    } else {
+        response->set_success(false);
+        response->set_message("Order not found or no longer active");
+    }
+    return grpc::Status::OK;
+}
+
+grpc::Status OrderManagementServiceV2Impl::GetOrderStatus(
+    grpc::ServerContext* context,
+    const trading::v2::OrderStatusRequest* request,
+    trading::v2::OrderStatusResponse* response) {
+
+    OrderRecord order;
+    if (!oms_.findOrder(request->order_handle(), order)) {
+        return grpc::Status(grpc::StatusCode::NOT_FOUND, "Order not found");
+    }
+
+    uint32_t instrumentId = 0;
+    instruments_.find(order.instrument, instrumentId);
+    response->set_order_handle(order.handle);
+    response->set_instrument_id(instrumentId);
+    response->set_status(toWireStatus(order.status));
+    if (order.status == OptionOrder::Status::FILLED) {
+        response->set_filled_quantity(order.quantity);
+        response->set_average_price(toFixedPrice(order.fillPrice));
+    } else {
+        response->set_remaining_quantity(order.quantity);
+    }
+    response->set_last_update_ns(order.lastUpdateNs);
+    return grpc::Status::OK;
+}
@@ -0,0 +1,93 @@
+#include "services/quote_fanout.hpp"
+#include <cctype>
+
+QuoteFanout::QuoteFanout(MarketDataHandler& handler, std::chrono::milliseconds batchInterval)
+    : handler_(handler), batchInterval_(batchInterval) {
+    handler_.addDataCallback([this](const OptionData& data) {
+        publish(data);
+    });
+    batchThread_ = std::thread(&QuoteFanout::runBatches, this);
+}
+
+QuoteFanout::~QuoteFanout() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_all();
+    batchThread_.join();
+}
+
+bool QuoteFanout::validSymbol(const std::string& symbol) {
+    if (symbol.empty() || symbol.size() >= sizeof(InstrumentKey::underlying)) return false;
+    for (char c : symbol) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-' && c != '/' && c != '^') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QuoteFanout::watch(QuoteSink* sink, const std::string& underlying) {
+    if (!validSymbol(underlying)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = watchers_.find(underlying);
+    if (it == watchers_.end()) {
+        if (watchers_.size() >= MAX_FEED_SYMBOLS) return false;
+        it = watchers_.emplace(underlying, std::unordered_set<QuoteSink*>()).first;
+        handler_.subscribeToSymbol(underlying);
+    }
+    it->second.insert(sink);
+    return true;
+}
+
+void QuoteFanout::unwatch(QuoteSink* sink, const std::string& underlying) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = watchers_.find(underlying);
+    if (it == watchers_.end()) return;
+    it->second.erase(sink);
+    if (it->second.empty()) {
+        handler_.unsubscribeFromSymbol(underlying);
+        watchers_.erase(it);
+    }
+}
+
+void QuoteFanout::addBatched(QuoteSink* sink) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batched_.insert(sink);
+}
+
+void QuoteFanout::remove(QuoteSink* sink) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batched_.erase(sink);
+    for (auto it = watchers_.begin(); it != watchers_.end();) {
+        it->second.erase(sink);
+        if (it->second.empty()) {
+            handler_.unsubscribeFromSymbol(it->first);
+            it = watchers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QuoteFanout::publish(const OptionData& data) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = watchers_.find(data.underlying);
+    if (it == watchers_.end()) return;
+    for (QuoteSink* sink : it->second) {
+        sink->offer(data);
+    }
+}
+
+void QuoteFanout::runBatches() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto next = std::chrono::steady_clock::now() + batchInterval_;
+    while (running_) {
+        if (cv_.wait_until(lock, next, [this] { return !running_; })) break;
+        next += batchInterval_;
+        for (QuoteSink* sink : batched_) {
+            sink->flush();
+        }
+    }
+}
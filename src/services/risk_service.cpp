@@ -0,0 +1,178 @@
+#include "services/risk_service.hpp"
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <utility>
+
+namespace {
+    void fillGreeks(const GreekTotals& totals, trading::GreekSummary* greeks) {
+        greeks->set_delta(totals.delta);
+        greeks->set_gamma(totals.gamma);
+        greeks->set_theta(totals.theta);
+        greeks->set_vega(totals.vega);
+        greeks->set_rho(totals.rho);
+        greeks->set_value(totals.value);
+    }
+
+    void fillUpdate(const RiskSnapshot& snapshot, bool portfolioOnly, trading::RiskUpdate* update) {
+        const RiskMetrics& metrics = snapshot.metrics;
+        update->set_sequence(snapshot.sequence);
+        update->set_timestamp(snapshot.timestampNs);
+        update->set_trigger(snapshot.trigger);
+
+        GreekTotals portfolio;
+        portfolio.delta = metrics.totalDelta;
+        portfolio.gamma = metrics.totalGamma;
+        portfolio.theta = metrics.totalTheta;
+        portfolio.vega = metrics.totalVega;
+        portfolio.rho = metrics.totalRho;
+        portfolio.value = metrics.portfolioValue;
+        fillGreeks(portfolio, update->mutable_portfolio());
+        update->set_margin_requirement(metrics.marginRequirement);
+        update->set_margin_utilization(metrics.marginUtilization);
+
+        if (portfolioOnly) return;
+        update->mutable_underlyings()->Reserve(static_cast<int>(snapshot.underlyings.size()));
+        for (const RiskBucket& bucket : snapshot.underlyings) {
+            trading::UnderlyingRisk* underlying = update->add_underlyings();
+            underlying->set_underlying(bucket.underlying);
+            underlying->set_contracts(static_cast<int32_t>(bucket.positions));
+            fillGreeks(bucket.totals, underlying->mutable_greeks());
+        }
+    }
+
+    grpc::ByteBuffer serialize(const trading::RiskUpdate& update) {
+        grpc::ByteBuffer buffer;
+        bool ownBuffer = false;
+        grpc::SerializationTraits<trading::RiskUpdate>::Serialize(update, &buffer, &ownBuffer);
+        return buffer;
+    }
+}
+
+class RiskServiceImpl::Subscription final : public grpc::ServerWriteReactor<grpc::ByteBuffer> {
+public:
+    Subscription(RiskServiceImpl& service, bool portfolioOnly)
+        : service_(service), portfolioOnly_(portfolioOnly) {}
+
+    // Called with the service lock held, in publication order
+    void offer(std::shared_ptr<const EncodedSnapshot> snapshot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        if (writing_) {
+            pending_ = std::move(snapshot);   // Replaces any older one still waiting
+            return;
+        }
+        write(std::move(snapshot));
+    }
+
+    void close(const grpc::Status& status) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(status);
+    }
+
+    void OnWriteDone(bool ok) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        writing_ = false;
+        current_.reset();
+        if (!ok) {
+            finish(grpc::Status(grpc::StatusCode::UNAVAILABLE, "Risk stream write failed"));
+        } else if (pending_ && !finished_) {
+            write(std::move(pending_));
+        }
+    }
+
+    void OnCancel() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finish(grpc::Status::CANCELLED);
+    }
+
+    void OnDone() override {
+        service_.unsubscribe(this);
+        delete this;
+    }
+
+private:
+    // Callers hold mutex_
+    void write(std::shared_ptr<const EncodedSnapshot> snapshot) {
+        current_ = std::move(snapshot);   // Keeps the bytes alive until OnWriteDone
+        pending_.reset();
+        writing_ = true;
+        StartWrite(portfolioOnly_ ? &current_->portfolioOnly : &current_->full);
+    }
+
+    void finish(const grpc::Status& status) {
+        if (finished_) return;
+        finished_ = true;
+        pending_.reset();
+        Finish(status);
+    }
+
+    RiskServiceImpl& service_;
+    const bool portfolioOnly_;
+
+    std::mutex mutex_;
+    std::shared_ptr<const EncodedSnapshot> current_;
+    std::shared_ptr<const EncodedSnapshot> pending_;
+    bool writing_{false};
+    bool finished_{false};
+};
+
+RiskServiceImpl::RiskServiceImpl(RiskPublisher& publisher)
+    : publisher_(publisher) {
+    publisher_.addListener([this](const std::shared_ptr<const RiskSnapshot>& snapshot) {
+        publish(snapshot);
+    });
+}
+
+grpc::Status RiskServiceImpl::GetRisk(
+    grpc::ServerContext* context,
+    const trading::RiskRequest* request,
+    trading::RiskUpdate* response) {
+
+    std::shared_ptr<const RiskSnapshot> snapshot = publisher_.latest();
+    if (!snapshot) {
+        return grpc::Status(grpc::StatusCode::UNAVAILABLE, "No risk snapshot has been computed yet");
+    }
+    fillUpdate(*snapshot, request->portfolio_only(), response);
+    return grpc::Status::OK;
+}
+
+grpc::ServerWriteReactor<grpc::ByteBuffer>* RiskServiceImpl::StreamRisk(
+    grpc::CallbackServerContext* context,
+    const grpc::ByteBuffer* request) {
+
+    trading::RiskRequest parsed;
+    grpc::ByteBuffer copy(*request);   // Deserialize consumes its buffer
+    bool valid = grpc::SerializationTraits<trading::RiskRequest>::Deserialize(&copy, &parsed).ok();
+
+    auto* subscription = new Subscription(*this, parsed.portfolio_only());
+    if (!valid) {
+        // Stays out of subscriptions_; unsubscribing it from OnDone is a no-op
+        subscription->close(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, "Malformed RiskRequest"));
+        return subscription;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscriptions_.insert(subscription);
+    if (latest_) subscription->offer(latest_);
+    return subscription;
+}
+
+void RiskServiceImpl::publish(const std::shared_ptr<const RiskSnapshot>& snapshot) {
+    // Serialized once per shape, however many subscribers there are
+    auto encoded = std::make_shared<EncodedSnapshot>();
+    trading::RiskUpdate update;
+    fillUpdate(*snapshot, true, &update);
+    encoded->portfolioOnly = serialize(update);
+    fillUpdate(*snapshot, false, &update);   // Overwrites the same fields and adds the breakdown
+    encoded->full = serialize(update);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    latest_ = encoded;
+    for (Subscription* subscription : subscriptions_) {
+        subscription->offer(latest_);
+    }
+}
+
+void RiskServiceImpl::unsubscribe(Subscription* subscription) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    subscriptions_.erase(subscription);
+}
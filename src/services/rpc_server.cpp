@@ -0,0 +1,282 @@
+#include "services/rpc_server.hpp"
+#include "services/execution_service.hpp"
+#include "services/market_data_service.hpp"
+#include "services/metrics_service.hpp"
+#include "services/market_data_service_v2.hpp"
+#include "services/order_management_service.hpp"
+#include "services/order_management_service_v2.hpp"
+#include "services/risk_service.hpp"
+#include <grpcpp/impl/codegen/proto_utils.h>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <pthread.h>
+#include <sched.h>
+#include <stdexcept>
+
+namespace {
+    // A completion queue tag: one step of an RPC's life on the queue
+    class Call {
+    public:
+        virtual ~Call() = default;
+        virtual void proceed(bool ok) = 0;
+    };
+
+    template <class T>
+    struct NonDeduced {
+        using type = T;
+    };
+
+    // One unary RPC served by the synchronous handler of the service
+    // implementation, run inline on the polling thread. Each call re-arms
+    // the method on its queue as soon as a request arrives.
+    template <class Service, class Handler, class Request, class Response>
+    class UnaryCall final : public Call {
+    public:
+        using RequestMethod = void (Service::*)(grpc::ServerContext*, Request*,
+                                                grpc::ServerAsyncResponseWriter<Response>*,
+                                                grpc::CompletionQueue*, grpc::ServerCompletionQueue*, void*);
+        using HandlerMethod = grpc::Status (Handler::*)(grpc::ServerContext*, const Request*, Response*);
+
+        UnaryCall(Service& service, RequestMethod request, Handler& handler, HandlerMethod handle,
+                  grpc::ServerCompletionQueue* cq)
+            : service_(service), request_(request), handler_(handler), handle_(handle), cq_(cq),
+              responder_(&context_) {
+            (service_.*request_)(&context_, &requestMessage_, &responder_, cq_, cq_, this);
+        }
+
+        void proceed(bool ok) override {
+            // !ok: the queue is shutting down before a request arrived
+            if (!ok || finishing_) {
+                delete this;
+                return;
+            }
+            new UnaryCall(service_, request_, handler_, handle_, cq_);
+
+            grpc::Status status;
+            try {
+                status = (handler_.*handle_)(&context_, &requestMessage_, &response_);
+            } catch (const std::exception& e) {
+                status = grpc::Status(grpc::StatusCode::INTERNAL, e.what());
+            }
+            finishing_ = true;
+            if (status.ok()) {
+                responder_.Finish(response_, status, this);
+            } else {
+                responder_.FinishWithError(status, this);
+            }
+        }
+
+    private:
+        Service& service_;
+        const RequestMethod request_;
+        Handler& handler_;
+        const HandlerMethod handle_;
+        grpc::ServerCompletionQueue* const cq_;
+
+        grpc::ServerContext context_;
+        Request requestMessage_;
+        Response response_;
+        grpc::ServerAsyncResponseWriter<Response> responder_;
+        bool finishing_{false};
+    };
+
+    // The service type comes from the member pointer, which names the
+    // WithAsyncMethod_ base that declares it
+    template <class Service, class Handler, class Request, class Response>
+    void listenUnary(typename NonDeduced<Service>::type& service,
+                     void (Service::*request)(grpc::ServerContext*, Request*,
+                                              grpc::ServerAsyncResponseWriter<Response>*,
+                                              grpc::CompletionQueue*, grpc::ServerCompletionQueue*, void*),
+                     typename NonDeduced<Handler>::type& handler,
+                     grpc::Status (Handler::*handle)(grpc::ServerContext*, const Request*, Response*),
+                     grpc::ServerCompletionQueue* cq) {
+        new UnaryCall<Service, Handler, Request, Response>(service, request, handler, handle, cq);
+    }
+
+    using RiskAsyncBase = trading::RiskService::WithRawCallbackMethod_StreamRisk<
+        trading::RiskService::WithAsyncMethod_GetRisk<trading::RiskService::Service>>;
+
+    // StreamRisk stays a callback method, handed to the implementation
+    class AsyncRiskService final : public RiskAsyncBase {
+    public:
+        explicit AsyncRiskService(RiskServiceImpl& impl) : impl_(impl) {}
+
+        grpc::ServerWriteReactor<grpc::ByteBuffer>* StreamRisk(
+            grpc::CallbackServerContext* context,
+            const grpc::ByteBuffer* request) override {
+            return impl_.StreamRisk(context, request);
+        }
+
+    private:
+        RiskServiceImpl& impl_;
+    };
+
+    using OrdersAsyncBase = trading::OrderManagementService::WithCallbackMethod_OrderEntry<
+        trading::OrderManagementService::WithAsyncMethod_PlaceOrder<
+            trading::OrderManagementService::WithAsyncMethod_CancelOrder<
+                trading::OrderManagementService::WithAsyncMethod_GetOrderStatus<
+                    trading::OrderManagementService::WithAsyncMethod_GetOrderHistory<
+                        trading::OrderManagementService::Service>>>>>;
+
+    // OrderEntry stays a callback method, handed to the implementation
+    class AsyncOrderService final : public OrdersAsyncBase {
+    public:
+        explicit AsyncOrderService(OrderManagementServiceImpl& impl) : impl_(impl) {}
+
+        grpc::ServerBidiReactor<trading::OrderEntryRequest, trading::OrderEntryAcks>* OrderEntry(
+            grpc::CallbackServerContext* context) override {
+            return impl_.OrderEntry(context);
+        }
+
+    private:
+        OrderManagementServiceImpl& impl_;
+    };
+
+    using ExecutionAsyncBase = trading::ExecutionService::WithCallbackMethod_StreamExecutionEvents<
+        trading::ExecutionService::WithAsyncMethod_ExecuteTrade<
+            trading::ExecutionService::WithAsyncMethod_GetExecutionReport<
+                trading::ExecutionService::Service>>>;
+
+    // StreamExecutionEvents stays a callback method, handed to the implementation
+    class AsyncExecutionService final : public ExecutionAsyncBase {
+    public:
+        explicit AsyncExecutionService(ExecutionServiceImpl& impl) : impl_(impl) {}
+
+        grpc::ServerWriteReactor<trading::ExecutionEventBatch>* StreamExecutionEvents(
+            grpc::CallbackServerContext* context,
+            const trading::ExecutionEventsRequest* request) override {
+            return impl_.StreamExecutionEvents(context, request);
+        }
+
+    private:
+        ExecutionServiceImpl& impl_;
+    };
+
+    void pinToCpu(int cpu) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);   // Best effort
+    }
+}
+
+struct RpcServer::AsyncServices {
+    explicit AsyncServices(const Services& services)
+        : orders(services.orders), execution(services.execution), risk(services.risk) {}
+
+    AsyncOrderService orders;
+    AsyncExecutionService execution;
+    AsyncRiskService risk;
+    trading::v2::OrderManagementService::AsyncService ordersV2;
+    trading::MetricsService::AsyncService metrics;
+};
+
+RpcServer::RpcServer(const Services& services, RpcServerConfig config)
+    : services_(services), config_(config) {}
+
+RpcServer::~RpcServer() {
+    shutdown();
+}
+
+void RpcServer::start(const std::string& address) {
+    if (server_) {
+        throw std::runtime_error("RPC server already started");
+    }
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(address, grpc::InsecureServerCredentials(), &port_);
+
+    if (config_.mode == RpcServerConfig::Mode::SYNC) {
+        builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::MIN_POLLERS, config_.syncMinPollers);
+        builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::MAX_POLLERS, config_.syncMaxPollers);
+        builder.RegisterService(&services_.marketData);
+        builder.RegisterService(&services_.orders);
+        builder.RegisterService(&services_.execution);
+        builder.RegisterService(&services_.risk);
+        builder.RegisterService(&services_.marketDataV2);
+        builder.RegisterService(&services_.ordersV2);
+        builder.RegisterService(&services_.metrics);
+    } else {
+        // Market data has only callback methods, so it is the same service in both modes
+        async_.reset(new AsyncServices(services_));
+        builder.RegisterService(&services_.marketData);
+        builder.RegisterService(&async_->orders);
+        builder.RegisterService(&async_->execution);
+        builder.RegisterService(&async_->risk);
+        builder.RegisterService(&services_.marketDataV2);
+        builder.RegisterService(&async_->ordersV2);
+        builder.RegisterService(&async_->metrics);
+
+        size_t threads = config_.completionQueueThreads;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(builder.AddCompletionQueue());
+        }
+    }
+
+    server_ = builder.BuildAndStart();
+    if (!server_ || port_ == 0) {
+        throw std::runtime_error("Failed to start the RPC server on " + address);
+    }
+
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        listen(queues_[i].get());
+        pollers_.emplace_back(&RpcServer::poll, this, queues_[i].get(), i);
+    }
+}
+
+void RpcServer::listen(grpc::ServerCompletionQueue* cq) {
+    listenUnary(async_->orders, &AsyncOrderService::RequestPlaceOrder,
+                services_.orders, &OrderManagementServiceImpl::PlaceOrder, cq);
+    listenUnary(async_->orders, &AsyncOrderService::RequestCancelOrder,
+                services_.orders, &OrderManagementServiceImpl::CancelOrder, cq);
+    listenUnary(async_->orders, &AsyncOrderService::RequestGetOrderStatus,
+                services_.orders, &OrderManagementServiceImpl::GetOrderStatus, cq);
+    listenUnary(async_->orders, &AsyncOrderService::RequestGetOrderHistory,
+                services_.orders, &OrderManagementServiceImpl::GetOrderHistory, cq);
+    listenUnary(async_->execution, &AsyncExecutionService::RequestExecuteTrade,
+                services_.execution, &ExecutionServiceImpl::ExecuteTrade, cq);
+    listenUnary(async_->execution, &AsyncExecutionService::RequestGetExecutionReport,
+                services_.execution, &ExecutionServiceImpl::GetExecutionReport, cq);
+    listenUnary(async_->risk, &AsyncRiskService::RequestGetRisk,
+                services_.risk, &RiskServiceImpl::GetRisk, cq);
+    listenUnary(async_->ordersV2, &trading::v2::OrderManagementService::AsyncService::RequestPlaceOrder,
+                services_.ordersV2, &OrderManagementServiceV2Impl::PlaceOrder, cq);
+    listenUnary(async_->ordersV2, &trading::v2::OrderManagementService::AsyncService::RequestCancelOrder,
+                services_.ordersV2, &OrderManagementServiceV2Impl::CancelOrder, cq);
+    listenUnary(async_->ordersV2, &trading::v2::OrderManagementService::AsyncService::RequestGetOrderStatus,
+                services_.ordersV2, &OrderManagementServiceV2Impl::GetOrderStatus, cq);
+    listenUnary(async_->metrics, &trading::MetricsService::AsyncService::RequestGetMetrics,
+                services_.metrics, &MetricsServiceImpl::GetMetrics, cq);
+}
+
+void RpcServer::poll(grpc::ServerCompletionQueue* cq, size_t index) {
+    if (config_.pinThreads) {
+        int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        pinToCpu((config_.firstCpu + static_cast<int>(index)) % cores);
+    }
+
+    void* tag;
+    bool ok;
+    while (cq->Next(&tag, &ok)) {
+        static_cast<Call*>(tag)->proceed(ok);
+    }
+}
+
+void RpcServer::wait() {
+    if (server_) server_->Wait();
+}
+
+void RpcServer::shutdown() {
+    if (!server_ || stopped_.exchange(true)) return;
+
+    // Streams still open are cancelled rather than waited for
+    server_->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds(1));
+    for (auto& cq : queues_) {
+        cq->Shutdown();
+    }
+    for (std::thread& poller : pollers_) {
+        poller.join();
+    }
+}
@@ -0,0 +1,93 @@
+#include "services/wire_v2.hpp"
+#include "DateUtils.hpp"
+#include <cstdio>
+
+uint32_t toExpiryCode(const std::string& expiry) {
+    int64_t days;
+    if (!parseIsoDate(expiry.c_str(), days)) return 0;
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    return static_cast<uint32_t>(year * 10000 + month * 100 + day);
+}
+
+std::string fromExpiryCode(uint32_t code) {
+    if (code == 0) return std::string();
+    char expiry[16];
+    std::snprintf(expiry, sizeof(expiry), "%04u-%02u-%02u", code / 10000, code / 100 % 100, code % 100);
+    return expiry;
+}
+
+void fillInstrument(uint32_t id, const InstrumentKey& key, trading::v2::Instrument* instrument) {
+    instrument->set_id(id);
+    instrument->set_underlying(key.underlying);
+    instrument->set_option_type(key.isCall ? trading::v2::CALL : trading::v2::PUT);
+    instrument->set_strike(toFixedPrice(key.strike));
+    instrument->set_expiry(toExpiryCode(key.expiry));
+}
+
+void fillQuote(uint32_t id, const OptionData& data, trading::v2::Quote* quote) {
+    quote->set_instrument_id(id);
+    quote->set_bid(toFixedPrice(data.bid));
+    quote->set_ask(toFixedPrice(data.ask));
+    quote->set_last(toFixedPrice(data.lastPrice));
+    quote->set_volume(data.volume > 0 ? static_cast<uint32_t>(data.volume) : 0);
+    quote->set_implied_volatility(static_cast<float>(data.impliedVol));
+    quote->set_delta(static_cast<float>(data.delta));
+    quote->set_gamma(static_cast<float>(data.gamma));
+    quote->set_theta(static_cast<float>(data.theta));
+    quote->set_vega(static_cast<float>(data.vega));
+    quote->set_rho(static_cast<float>(data.rho));
+}
+
+namespace {
+    size_t appendSide(const OptionChain::Contracts& contracts, const std::string& expiry,
+                      const InstrumentRegistry& instruments, trading::v2::OptionChainColumns* columns) {
+        // (expiry, strike) keys put one expiry's contracts in a single run
+        auto begin = expiry.empty() ? contracts.begin() : contracts.lower_bound({expiry, -1.0});
+        size_t added = 0;
+        const std::string* runExpiry = nullptr;   // Parsed once per run of one expiry
+        uint32_t runCode = 0;
+        for (auto it = begin; it != contracts.end(); ++it) {
+            if (!expiry.empty() && it->first.first != expiry) break;
+            const OptionData& data = it->second;
+            if (!runExpiry || *runExpiry != it->first.first) {
+                runExpiry = &it->first.first;
+                runCode = toExpiryCode(*runExpiry);
+            }
+            uint32_t id = 0;
+            instruments.find(makeInstrumentKey(data.underlying, data.optionType, data.strike, data.expiry), id);
+            columns->add_instrument_id(id);
+            columns->add_expiry(runCode);
+            columns->add_strike(toFixedPrice(data.strike));
+            columns->add_bid(toFixedPrice(data.bid));
+            columns->add_ask(toFixedPrice(data.ask));
+            columns->add_last(toFixedPrice(data.lastPrice));
+            columns->add_volume(data.volume > 0 ? static_cast<uint32_t>(data.volume) : 0);
+            columns->add_implied_volatility(static_cast<float>(data.impliedVol));
+            columns->add_delta(static_cast<float>(data.delta));
+            columns->add_gamma(static_cast<float>(data.gamma));
+            columns->add_theta(static_cast<float>(data.theta));
+            columns->add_vega(static_cast<float>(data.vega));
+            columns->add_rho(static_cast<float>(data.rho));
+            ++added;
+        }
+        return added;
+    }
+}
+
+size_t fillChainColumns(const OptionChain& chain, const std::string& expiry,
+                        const InstrumentRegistry& instruments, trading::v2::OptionChainColumns* columns) {
+    size_t calls = appendSide(chain.calls, expiry, instruments, columns);
+    columns->set_call_count(static_cast<uint32_t>(calls));
+    return calls + appendSide(chain.puts, expiry, instruments, columns);
+}
+
+trading::v2::OrderStatus toWireStatus(OptionOrder::Status status) {
+    switch (status) {
+        case OptionOrder::Status::PENDING: return trading::v2::PENDING;
+        case OptionOrder::Status::FILLED: return trading::v2::FILLED;
+        case OptionOrder::Status::CANCELLED: return trading::v2::CANCELLED;
+        case OptionOrder::Status::REJECTED: return trading::v2::REJECTED;
+    }
+    return trading::v2::ORDER_STATUS_UNSPECIFIED;
+}